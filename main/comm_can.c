@@ -34,6 +34,7 @@
 #include "ublox.h"
 #include "lispif.h"
 #include "bms.h"
+#include "spsc_rb.h"
 #include "utils.h"
 #include "soc/gpio_sig_map.h"
 
@@ -55,6 +56,45 @@ static psw_status psw_stat[CAN_STATUS_MSGS_TO_STORE];
 #define RX_BUFFER_SIZE				PACKET_MAX_PL_LEN
 #define RXBUF_LEN					50
 
+// Windowed transfers. Every frame carries the sender id, so reassembly slots
+// are keyed by sender and several nodes can send to us at the same time.
+//
+// The frames are sent as CAN_PACKET_PROCESS_SHORT_BUFFER, so that they need
+// no packet ids of their own. The second byte, which selects how the buffer
+// is processed (0 - 3), holds the window frame type instead. Nodes without
+// windowed transfers do not process these frames, but they still set
+// rx_buffer_response_type to 1 as for any mode other than 3. A reply to a
+// mode 3 command that such a node sends after a window frame arrived is then
+// sent with mode 1 instead of 0.
+//   START: [sender, WIN_MODE_START, seq, send, len (16), crc (16)]
+//   DATA:  [sender, WIN_MODE_DATA | chunk, up to WIN_CHUNK_LEN bytes]
+//   POLL:  [sender, WIN_MODE_POLL, seq, crc (16)]
+//   ACK:   [sender, WIN_MODE_ACK | status, seq, next, map (32)]
+// seq numbers the transfers of a sender, so that an ack is only given for
+// the transfer that was actually received.
+#define WIN_MODE_START				0x40
+#define WIN_MODE_POLL				0x41
+#define WIN_MODE_ACK				0x44
+#define WIN_MODE_DATA				0x80
+
+#define WIN_SLOT_NUM				4
+#define WIN_DONE_NUM				8
+#define WIN_CHUNK_LEN				6
+#define WIN_CHUNKS_MAX				((RX_BUFFER_SIZE + WIN_CHUNK_LEN - 1) / WIN_CHUNK_LEN)
+#define WIN_SIZE					32
+#define WIN_ACK_TIMEOUT_MS			20
+#define WIN_RETRIES					8
+#define WIN_SLOT_TIMEOUT_MS			500
+
+#define WIN_ACK_PENDING				0
+#define WIN_ACK_DONE				1
+#define WIN_ACK_NO_SLOT				2
+#define WIN_ACK_CRC_ERROR			3
+
+#if WIN_CHUNKS_MAX > 128
+#error "The chunk index must fit next to WIN_MODE_DATA"
+#endif
+
 static twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
 static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 static twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(0, 0, TWAI_MODE_NORMAL);
@@ -73,16 +113,54 @@ static SemaphoreHandle_t send_mutex;
 static volatile HW_TYPE ping_hw_last = HW_TYPE_VESC;
 static uint8_t rx_buffer[RX_BUFFER_NUM][RX_BUFFER_SIZE];
 static int rx_buffer_offset[RX_BUFFER_NUM];
+static TickType_t rx_buffer_time[RX_BUFFER_NUM];
 static volatile unsigned int rx_buffer_last_id;
 static volatile unsigned int rx_buffer_response_type = 1;
 
-static twai_message_t rx_buf[RXBUF_LEN];
-static volatile int rx_write = 0;
-static volatile int rx_read = 0;
+static twai_message_t rx_buf_data[RXBUF_LEN];
+static spsc_rb_t rx_buf;
 static volatile bool use_vesc_decoder = true;
 
 static volatile int rx_recovery_cnt = 0;
 
+typedef struct {
+	int sender; // -1 when unused
+	uint8_t seq;
+	uint8_t commands_send;
+	bool done;
+	int len;
+	int chunks;
+	uint16_t crc;
+	uint32_t rx_map[(WIN_CHUNKS_MAX + 31) / 32];
+	TickType_t last_update;
+	uint8_t buffer[RX_BUFFER_SIZE];
+} win_rx_slot;
+
+static win_rx_slot win_slots[WIN_SLOT_NUM];
+
+// Transfers that have been acknowledged with WIN_ACK_DONE. The slot of a
+// finished transfer can be taken by another sender, and if the WIN_ACK_DONE
+// was lost the sender polls again. It is then answered from here, as
+// WIN_ACK_NO_SLOT would make it send the buffer and the command would run
+// a second time.
+typedef struct {
+	int sender; // -1 when unused
+	uint8_t seq;
+	uint16_t crc;
+} win_done_transfer;
+
+static win_done_transfer win_done[WIN_DONE_NUM];
+static int win_done_next = 0;
+static SemaphoreHandle_t win_ack_sem;
+static SemaphoreHandle_t win_send_mutex;
+static TaskHandle_t proc_task_handle = NULL;
+static volatile int win_ack_wait_id = -1;
+static volatile uint8_t win_ack_wait_seq;
+static uint8_t win_seq = 0;
+static volatile uint8_t win_ack_status;
+static volatile uint8_t win_ack_next;
+static volatile uint32_t win_ack_map;
+
 // Private functions
 static void update_baud(CAN_BAUD baudrate);
 
@@ -90,6 +168,233 @@ static void send_packet_wrapper(unsigned char *data, unsigned int len) {
 	comm_can_send_buffer(rx_buffer_last_id, data, len, rx_buffer_response_type);
 }
 
+static int rx_buffer_oldest(void) {
+	TickType_t now = xTaskGetTickCount();
+	int oldest = 0;
+
+	for (int i = 1;i < RX_BUFFER_NUM;i++) {
+		if ((now - rx_buffer_time[i]) > (now - rx_buffer_time[oldest])) {
+			oldest = i;
+		}
+	}
+
+	return oldest;
+}
+
+static bool is_blocked_when_replaced(uint8_t cmd) {
+	return cmd == COMM_JUMP_TO_BOOTLOADER ||
+			cmd == COMM_ERASE_NEW_APP ||
+			cmd == COMM_WRITE_NEW_APP_DATA ||
+			cmd == COMM_WRITE_NEW_APP_DATA_LZO ||
+			cmd == COMM_ERASE_BOOTLOADER;
+}
+
+static win_rx_slot *win_slot_get(int sender, bool create) {
+	TickType_t now = xTaskGetTickCount();
+	win_rx_slot *free_slot = NULL;
+
+	for (int i = 0;i < WIN_SLOT_NUM;i++) {
+		win_rx_slot *slot = &win_slots[i];
+
+		if (slot->sender == sender) {
+			return slot;
+		}
+
+		if (!free_slot && (slot->sender < 0 || slot->done ||
+				(now - slot->last_update) > (WIN_SLOT_TIMEOUT_MS / portTICK_PERIOD_MS))) {
+			free_slot = slot;
+		}
+	}
+
+	if (create && free_slot) {
+		free_slot->sender = sender;
+		return free_slot;
+	}
+
+	return NULL;
+}
+
+static void win_send_ack(uint8_t sender, uint8_t seq, uint8_t status, uint8_t next, uint32_t map) {
+	uint8_t buffer[8];
+	int32_t ind = 0;
+	buffer[ind++] = backup.config.controller_id;
+	buffer[ind++] = WIN_MODE_ACK | status;
+	buffer[ind++] = seq;
+	buffer[ind++] = next;
+	buffer_append_uint32(buffer, map, &ind);
+	comm_can_transmit_eid(sender | ((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), buffer, ind);
+}
+
+// Only the last finished transfer of each sender is kept.
+static void win_done_add(int sender, uint8_t seq, uint16_t crc) {
+	win_done_transfer *t = &win_done[win_done_next];
+
+	for (int i = 0;i < WIN_DONE_NUM;i++) {
+		if (win_done[i].sender == sender) {
+			t = &win_done[i];
+			break;
+		}
+	}
+
+	if (t == &win_done[win_done_next]) {
+		win_done_next = (win_done_next + 1) % WIN_DONE_NUM;
+	}
+
+	t->sender = sender;
+	t->seq = seq;
+	t->crc = crc;
+}
+
+static bool win_done_find(int sender, uint8_t seq, uint16_t crc) {
+	for (int i = 0;i < WIN_DONE_NUM;i++) {
+		win_done_transfer *t = &win_done[i];
+		if (t->sender == sender && t->seq == seq && t->crc == crc) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void win_handle_poll(uint8_t sender, uint8_t seq, uint16_t crc, bool is_replaced) {
+	win_rx_slot *slot = win_slot_get(sender, false);
+
+	// A buffer with the same content as the previous one has the same crc,
+	// only the sequence number tells the transfers apart.
+	if (!slot || slot->seq != seq || slot->crc != crc) {
+		if (win_done_find(sender, seq, crc)) {
+			win_send_ack(sender, seq, WIN_ACK_DONE, 0, 0);
+		} else {
+			win_send_ack(sender, seq, WIN_ACK_NO_SLOT, 0, 0);
+		}
+		return;
+	}
+
+	if (slot->done) {
+		win_send_ack(sender, seq, WIN_ACK_DONE, slot->chunks, 0);
+		return;
+	}
+
+	slot->last_update = xTaskGetTickCount();
+
+	int next = 0;
+	while (next < slot->chunks && (slot->rx_map[next / 32] & (1u << (next % 32)))) {
+		next++;
+	}
+
+	if (next < slot->chunks) {
+		uint32_t map = 0;
+		for (int i = 0;i < 32 && (next + i) < slot->chunks;i++) {
+			int c = next + i;
+			if (slot->rx_map[c / 32] & (1u << (c % 32))) {
+				map |= 1u << i;
+			}
+		}
+
+		win_send_ack(sender, seq, WIN_ACK_PENDING, next, map);
+		return;
+	}
+
+	if (crc16(slot->buffer, slot->len) != slot->crc) {
+		slot->sender = -1;
+		win_send_ack(sender, seq, WIN_ACK_CRC_ERROR, next, 0);
+		return;
+	}
+
+	// Acknowledge before processing so that the sender does not time out
+	// while the command runs. A repeated poll gets another WIN_ACK_DONE.
+	slot->done = true;
+	win_done_add(sender, seq, crc);
+	win_send_ack(sender, seq, WIN_ACK_DONE, next, 0);
+
+	if (is_replaced && is_blocked_when_replaced(slot->buffer[0])) {
+		return;
+	}
+
+	if (slot->commands_send == 0 || slot->commands_send == 3) {
+		rx_buffer_last_id = sender;
+	}
+
+	rx_buffer_response_type = slot->commands_send == 3 ? 0 : 1;
+
+	switch (slot->commands_send) {
+	case 0:
+	case 3:
+		commands_process_packet(slot->buffer, slot->len, send_packet_wrapper);
+		break;
+	case 1:
+		commands_send_packet_can_last(slot->buffer, slot->len);
+		break;
+	case 2:
+		commands_process_packet(slot->buffer, slot->len, 0);
+		break;
+	default:
+		break;
+	}
+}
+
+static void win_decode(uint8_t *data8, int len, bool is_replaced) {
+	int32_t ind = 0;
+	uint8_t sender = data8[0];
+	uint8_t mode = data8[1];
+
+	if (mode & WIN_MODE_DATA) {
+		win_rx_slot *slot = win_slot_get(sender, false);
+		int chunk = mode & 0x7F;
+		if (len < 3 || !slot || slot->done || chunk >= slot->chunks) {
+			return;
+		}
+
+		int offset = chunk * WIN_CHUNK_LEN;
+		int data_len = len - 2;
+		if ((offset + data_len) > slot->len) {
+			data_len = slot->len - offset;
+		}
+
+		memcpy(slot->buffer + offset, data8 + 2, data_len);
+		slot->rx_map[chunk / 32] |= 1u << (chunk % 32);
+		slot->last_update = xTaskGetTickCount();
+	} else if (mode == WIN_MODE_START) {
+		if (len < 8) {
+			return;
+		}
+
+		ind = 4;
+		int rxbuf_len = buffer_get_uint16(data8, &ind);
+		uint16_t crc = buffer_get_uint16(data8, &ind);
+		if (rxbuf_len > RX_BUFFER_SIZE) {
+			return;
+		}
+
+		win_rx_slot *slot = win_slot_get(sender, true);
+		if (!slot) {
+			return;
+		}
+
+		slot->seq = data8[2];
+		slot->commands_send = data8[3];
+		slot->len = rxbuf_len;
+		slot->crc = crc;
+		slot->chunks = (slot->len + WIN_CHUNK_LEN - 1) / WIN_CHUNK_LEN;
+		slot->done = false;
+		slot->last_update = xTaskGetTickCount();
+		memset(slot->rx_map, 0, sizeof(slot->rx_map));
+	} else if (mode == WIN_MODE_POLL) {
+		if (len >= 5) {
+			ind = 3;
+			win_handle_poll(sender, data8[2], buffer_get_uint16(data8, &ind), is_replaced);
+		}
+	} else if ((mode & ~0x03) == WIN_MODE_ACK) {
+		if (len >= 8 && sender == win_ack_wait_id && data8[2] == win_ack_wait_seq) {
+			ind = 3;
+			win_ack_status = mode & 0x03;
+			win_ack_next = data8[ind++];
+			win_ack_map = buffer_get_uint32(data8, &ind);
+			xSemaphoreGive(win_ack_sem);
+		}
+	}
+}
+
 static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced) {
 	int32_t ind = 0;
 	uint8_t crc_low;
@@ -116,7 +421,7 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 
 			if (buf_ind < 0) {
 				if (offset == 0) {
-					buf_ind = 0;
+					buf_ind = rx_buffer_oldest();
 				} else {
 					break;
 				}
@@ -124,6 +429,7 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 
 			memcpy(rx_buffer[buf_ind] + offset, data8, len);
 			rx_buffer_offset[buf_ind] = offset + len;
+			rx_buffer_time[buf_ind] = xTaskGetTickCount();
 		} break;
 
 		case CAN_PACKET_FILL_RX_BUFFER_LONG: {
@@ -142,7 +448,7 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 
 			if (buf_ind < 0) {
 				if (offset == 0) {
-					buf_ind = 0;
+					buf_ind = rx_buffer_oldest();
 				} else {
 					break;
 				}
@@ -151,6 +457,7 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 			if ((offset + len) <= RX_BUFFER_SIZE) {
 				memcpy(rx_buffer[buf_ind] + offset, data8, len);
 				rx_buffer_offset[buf_ind] = offset + len;
+				rx_buffer_time[buf_ind] = xTaskGetTickCount();
 			}
 		} break;
 
@@ -184,11 +491,11 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 				}
 			}
 
-			// Something is wrong, reset all buffers
+			// Incomplete or mixed up transfer. Drop it, but leave the other
+			// buffers alone as they can belong to transfers from other
+			// senders that are still in progress. Stale buffers are reused
+			// by rx_buffer_oldest.
 			if (buf_ind < 0) {
-				for (int i = 0; i < RX_BUFFER_NUM;i++) {
-					rx_buffer_offset[i] = 0;
-				}
 				break;
 			}
 
@@ -202,11 +509,7 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 							| (unsigned short) crc_low)) {
 
 				if (is_replaced) {
-					if (rx_buffer[buf_ind][0] == COMM_JUMP_TO_BOOTLOADER ||
-							rx_buffer[buf_ind][0] == COMM_ERASE_NEW_APP ||
-							rx_buffer[buf_ind][0] == COMM_WRITE_NEW_APP_DATA ||
-							rx_buffer[buf_ind][0] == COMM_WRITE_NEW_APP_DATA_LZO ||
-							rx_buffer[buf_ind][0] == COMM_ERASE_BOOTLOADER) {
+					if (is_blocked_when_replaced(rx_buffer[buf_ind][0])) {
 						break;
 					}
 				}
@@ -229,6 +532,11 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 		} break;
 
 		case CAN_PACKET_PROCESS_SHORT_BUFFER:
+			if (len >= 2 && data8[1] >= WIN_MODE_START) {
+				win_decode(data8, len, is_replaced);
+				break;
+			}
+
 			ind = 0;
 			unsigned int last_id = data8[ind++];
 			commands_send = data8[ind++];
@@ -244,11 +552,7 @@ static void decode_msg(uint32_t eid, uint8_t *data8, int len, bool is_replaced)
 			}
 
 			if (is_replaced) {
-				if (data8[ind] == COMM_JUMP_TO_BOOTLOADER ||
-						data8[ind] == COMM_ERASE_NEW_APP ||
-						data8[ind] == COMM_WRITE_NEW_APP_DATA ||
-						data8[ind] == COMM_WRITE_NEW_APP_DATA_LZO ||
-						data8[ind] == COMM_ERASE_BOOTLOADER) {
+				if (is_blocked_when_replaced(data8[ind])) {
 					break;
 				}
 			}
@@ -561,12 +865,7 @@ static void rx_task(void *arg) {
 		esp_err_t res = twai_receive(&rx_message, 2);
 
 		if (res == ESP_OK) {
-			rx_buf[rx_write] = rx_message;
-			rx_write++;
-			if (rx_write >= RXBUF_LEN) {
-				rx_write = 0;
-			}
-
+			spsc_rb_insert(&rx_buf, &rx_message);
 			xSemaphoreGive(proc_sem);
 		}
 
@@ -602,13 +901,8 @@ static void process_task(void *arg) {
 	for (;;) {
 		xSemaphoreTake(proc_sem, 10 / portTICK_PERIOD_MS);
 
-		while (rx_read != rx_write) {
-			twai_message_t *msg = &rx_buf[rx_read];
-			rx_read++;
-			if (rx_read >= RXBUF_LEN) {
-				rx_read = 0;
-			}
-
+		twai_message_t *msg;
+		while ((msg = spsc_rb_peek(&rx_buf)) != 0) {
 			lispif_process_can(msg->identifier, msg->data, msg->data_length_code, msg->extd);
 
 			if (use_vesc_decoder) {
@@ -618,6 +912,10 @@ static void process_task(void *arg) {
 					}
 				}
 			}
+
+			// Released only after processing so that rx_task cannot overwrite
+			// the message while it is in use.
+			spsc_rb_pop(&rx_buf, 0);
 		}
 	}
 
@@ -802,10 +1100,21 @@ void comm_can_start(int pin_tx, int pin_rx) {
 		proc_sem = xSemaphoreCreateBinary();
 		status_sem = xSemaphoreCreateBinary();
 		send_mutex = xSemaphoreCreateMutex();
+		win_ack_sem = xSemaphoreCreateBinary();
+		spsc_rb_init(&rx_buf, rx_buf_data, sizeof(twai_message_t), RXBUF_LEN);
+		win_send_mutex = xSemaphoreCreateMutex();
+
+		for (int i = 0;i < WIN_SLOT_NUM;i++) {
+			win_slots[i].sender = -1;
+		}
+
+		for (int i = 0;i < WIN_DONE_NUM;i++) {
+			win_done[i].sender = -1;
+		}
 
 		// The process-task is left running after the first init in case comm_can_stop
 		// is called from it.
-		xTaskCreatePinnedToCore(process_task, "can_proc", 3072, NULL, 8, NULL, tskNO_AFFINITY);
+		xTaskCreatePinnedToCore(process_task, "can_proc", 3072, NULL, 8, &proc_task_handle, tskNO_AFFINITY);
 
 		sem_init_done = true;
 	}
@@ -1075,6 +1384,159 @@ void comm_can_send_buffer(uint8_t controller_id, uint8_t *data, unsigned int len
 	}
 }
 
+/**
+ * Send a buffer up to RX_BUFFER_SIZE bytes using windowed transfers. Every frame
+ * carries the sender id, so the receiver reassembles into a buffer of its own
+ * for each sender and several nodes can send at the same time. After each
+ * window of up to WIN_SIZE frames the receiver is polled and answers with the
+ * first missing chunk and a map of the chunks it has after that, and only the
+ * missing chunks are sent again.
+ *
+ * The receiver must support windowed transfers. A receiver without them does
+ * not ack, so this returns false after the retries, and the frames change its
+ * reply mode as described at the window frame definitions. Buffers of 6 bytes
+ * or less, and calls from the CAN process task (which has to handle the acks),
+ * fall back to comm_can_send_buffer.
+ *
+ * This waits for acks, up to WIN_RETRIES ack timeouts per window, so it should
+ * not be called from tasks that must not block.
+ *
+ * @param controller_id
+ * The controller id to send to.
+ *
+ * @param data
+ * The payload.
+ *
+ * @param len
+ * The payload length.
+ *
+ * @param send
+ * Same as for comm_can_send_buffer.
+ *
+ * @return
+ * True if the receiver acknowledged the buffer, false otherwise. The fallback
+ * path has no acknowledgement and always returns true.
+ */
+bool comm_can_send_buffer_win(uint8_t controller_id, uint8_t *data, unsigned int len, uint8_t send) {
+	if (!init_done || len > RX_BUFFER_SIZE) {
+		return false;
+	}
+
+	if (len <= 6 || xTaskGetCurrentTaskHandle() == proc_task_handle) {
+		comm_can_send_buffer(controller_id, data, len, send);
+		return true;
+	}
+
+	xSemaphoreTake(win_send_mutex, portMAX_DELAY);
+
+	int chunks = (len + WIN_CHUNK_LEN - 1) / WIN_CHUNK_LEN;
+	uint32_t acked[(WIN_CHUNKS_MAX + 31) / 32];
+	uint8_t send_buffer[8];
+	uint16_t crc = crc16(data, len);
+	int next = 0;
+	int retries = 0;
+	bool restart = true;
+	bool res = false;
+
+	win_seq++;
+	win_ack_wait_seq = win_seq;
+	win_ack_wait_id = controller_id;
+
+	while (retries <= WIN_RETRIES) {
+		if (restart) {
+			int32_t ind = 0;
+			send_buffer[ind++] = backup.config.controller_id;
+			send_buffer[ind++] = WIN_MODE_START;
+			send_buffer[ind++] = win_seq;
+			send_buffer[ind++] = send;
+			buffer_append_uint16(send_buffer, len, &ind);
+			buffer_append_uint16(send_buffer, crc, &ind);
+			comm_can_transmit_eid(controller_id |
+					((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), send_buffer, ind);
+
+			memset(acked, 0, sizeof(acked));
+			next = 0;
+			restart = false;
+		}
+
+		for (int i = next;i < chunks && i < (next + WIN_SIZE);i++) {
+			if (acked[i / 32] & (1u << (i % 32))) {
+				continue;
+			}
+
+			int offset = i * WIN_CHUNK_LEN;
+			int send_len = len - offset;
+			if (send_len > WIN_CHUNK_LEN) {
+				send_len = WIN_CHUNK_LEN;
+			}
+
+			send_buffer[0] = backup.config.controller_id;
+			send_buffer[1] = WIN_MODE_DATA | i;
+			memcpy(send_buffer + 2, data + offset, send_len);
+			comm_can_transmit_eid(controller_id |
+					((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), send_buffer, send_len + 2);
+		}
+
+		// Drop acks to earlier polls that arrived late
+		xSemaphoreTake(win_ack_sem, 0);
+
+		// The sequence number and crc identify the transfer, so that a lost
+		// start frame is not mistaken for the previous transfer being
+		// acknowledged again, even if the previous buffer was the same.
+		int32_t ind = 0;
+		send_buffer[ind++] = backup.config.controller_id;
+		send_buffer[ind++] = WIN_MODE_POLL;
+		send_buffer[ind++] = win_seq;
+		buffer_append_uint16(send_buffer, crc, &ind);
+		comm_can_transmit_eid(controller_id |
+				((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), send_buffer, ind);
+
+		if (xSemaphoreTake(win_ack_sem, WIN_ACK_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+			retries++;
+			continue;
+		}
+
+		if (win_ack_status == WIN_ACK_DONE) {
+			res = true;
+			break;
+		} else if (win_ack_status == WIN_ACK_NO_SLOT) {
+			restart = true;
+			retries++;
+			continue;
+		} else if (win_ack_status != WIN_ACK_PENDING) {
+			break;
+		}
+
+		int ack_next = win_ack_next;
+		uint32_t ack_map = win_ack_map;
+
+		// Retries only count polls that did not make progress
+		if (ack_next > next) {
+			retries = 0;
+		} else {
+			retries++;
+		}
+
+		for (int i = next;i < ack_next && i < chunks;i++) {
+			acked[i / 32] |= 1u << (i % 32);
+		}
+
+		for (int i = 0;i < 32 && (ack_next + i) < chunks;i++) {
+			if (ack_map & (1u << i)) {
+				int c = ack_next + i;
+				acked[c / 32] |= 1u << (c % 32);
+			}
+		}
+
+		next = ack_next;
+	}
+
+	win_ack_wait_id = -1;
+	xSemaphoreGive(win_send_mutex);
+
+	return res;
+}
+
 /**
  * Check if a VESC on the CAN-bus responds.
  *
@@ -741,7 +741,8 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 	case COMM_LOG_STOP:
 	case COMM_LOG_CONFIG_FIELD:
 	case COMM_LOG_DATA_F32:
-	case COMM_LOG_DATA_F64: {
+	case COMM_LOG_DATA_F64:
+	case COMM_LOG_DATA_PACKED: {
 		log_process_packet(data - 1, len + 1);
 	} break;
 
@@ -772,6 +773,7 @@ void commands_process_packet(unsigned char *data, unsigned int len,
 
 	case COMM_LISP_SET_RUNNING:
 	case COMM_LISP_GET_STATS:
+	case COMM_LISP_GET_PROF:
 	case COMM_LISP_REPL_CMD:
 	case COMM_LISP_STREAM_CODE:
 	case COMM_LISP_RMSG: {
@@ -296,6 +296,10 @@ typedef enum {
 	COMM_FW_INFO							= 157,
 	
 	COMM_CAN_UPDATE_BAUD_ALL				= 158,
+
+	COMM_LOG_DATA_PACKED					= 159,
+
+	COMM_LISP_GET_PROF						= 160,
 } COMM_PACKET_ID;
 
 // CAN commands
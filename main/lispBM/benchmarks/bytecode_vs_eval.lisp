@@ -0,0 +1,41 @@
+;; Run the same functions interpreted and compiled with
+;; bytecode-compile: a recursive fib, a counting loop and a loop that
+;; calls an extension for every element of a buffer.
+
+(define buf (bufcreate 1000))
+
+(defun fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))
+
+(defun count (n)
+  (let ((s 0))
+    (progn
+      (loop ((i 0)) (< i n)
+            (progn (setq s (+ s i))
+                   (setq i (+ i 1))))
+      s)))
+
+(defun sum-buf (b n)
+  (let ((s 0))
+    (progn
+      (loop ((i 0)) (< i n)
+            (progn (setq s (+ s (bufget-u8 b i)))
+                   (setq i (+ i 1))))
+      s)))
+
+(defun bench (name f)
+  (let ((t0 (systime)))
+    (progn (f) (print name (secs-since t0)))))
+
+(defun run-all (tag)
+  (progn
+    (bench (str-merge tag " fib 20:      ") (fn () (fib 20)))
+    (bench (str-merge tag " loop 100000: ") (fn () (count 100000)))
+    (bench (str-merge tag " bufget 1000: ") (fn () (sum-buf buf 1000)))))
+
+(run-all "eval    ")
+
+(define fib (bytecode-compile fib))
+(define count (bytecode-compile count))
+(define sum-buf (bytecode-compile sum-buf))
+
+(run-all "bytecode")
@@ -0,0 +1,35 @@
+;; Time to build 10000 lines of CSV text, by joining a list of lines
+;; and with a string builder, and to split and replace in the result.
+;; Needs the repl and a larger heap and memory than its default, for
+;; example:
+;;   repl -H 400000 -M 11 --terminate -s csv_build_rate.lisp
+
+(define lines 10000)
+
+(define time-it (lambda (f)
+  (let ((t0 (systime)))
+    {
+    (f)
+    (secs-since t0)
+    })))
+
+(define build-join (lambda ()
+  (str-join (map (lambda (i) (to-str-delim "," i (* i 3) (mod (* i 7) 101) "ok")) (range lines))
+            "\n")))
+
+(define build-builder (lambda ()
+  (let ((sb (mk-str-builder)))
+    {
+    (loopfor i 0 (< i lines) (+ i 1)
+             (str-builder-append sb i \#, (* i 3) \#, (mod (* i 7) 101) ",ok\n"))
+    (str-builder-freeze sb)
+    })))
+
+(define csv (build-builder))
+
+(print "CSV size: " (str-len csv) " bytes")
+(print "str-join of lines: " (* 1000 (time-it build-join)) " ms")
+(print "str-builder: " (* 1000 (time-it build-builder)) " ms")
+(print "str-split into lines: " (* 1000 (time-it (lambda () (str-split csv "\n")))) " ms")
+(print "str-replace , with ;: " (* 1000 (time-it (lambda () (str-replace csv "," ";")))) " ms")
+(print "str-replace ,ok with , fine: " (* 1000 (time-it (lambda () (str-replace csv ",ok\n" ", fine\n")))) " ms")
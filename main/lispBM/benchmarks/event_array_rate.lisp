@@ -0,0 +1,28 @@
+;; Event rate for 1 KB and 16 KB byte arrays sent from C to the event
+;; handler, once flattened and unflattened and once as an owned buffer.
+;; Needs the repl and more memory than its default, for example:
+;;   repl -M 11 --terminate -s event_array_rate.lisp
+
+(event-register-handler (self))
+
+(define n 500)
+
+(define send-recv (lambda (i size owned)
+  (if (= i 0) t
+    {
+    (event-byte-array 'data-rx size owned)
+    (recv ((data-rx . (? arr)) (buflen arr)))
+    (send-recv (- i 1) size owned)
+    })))
+
+(define rate (lambda (size owned)
+  (let ((t0 (systime)))
+    {
+    (send-recv n size owned)
+    (/ n (secs-since t0))
+    })))
+
+(print "1 KB flat:   " (rate 1024 nil) " events/s")
+(print "1 KB owned:  " (rate 1024 t) " events/s")
+(print "16 KB flat:  " (rate 16384 nil) " events/s")
+(print "16 KB owned: " (rate 16384 t) " events/s")
@@ -0,0 +1,21 @@
+;; Time flatten on a 10k element list and on nested arrays.
+;; Needs the repl and a larger heap and memory than its default,
+;; for example:
+;;   repl -H 1000000 -M 11 --terminate -s flatten_rate.lisp
+
+(define ls (map (lambda (i) (if (= (mod i 2) 0) i (* i 1.5))) (range 10000)))
+
+(define row (lambda (i) (list-to-array (map (lambda (j) (+ i j)) (range 100)))))
+(define arr (list-to-array (map row (range 100))))
+
+(define flatten-time (lambda (v n)
+  (let ((t0 (systime)))
+    {
+    (loopfor i 0 (< i n) (+ i 1) (flatten v))
+    (/ (secs-since t0) n)
+    })))
+
+(define ls-secs (flatten-time ls 20))
+(define arr-secs (flatten-time arr 20))
+(print "list:   " (buflen (flatten ls)) " bytes, " (* 1000 ls-secs) " ms")
+(print "arrays: " (buflen (flatten arr)) " bytes, " (* 1000 arr-secs) " ms")
@@ -0,0 +1,53 @@
+;; Build a 300 entry table and look every key up 20 times, once with
+;; an alist and once with a hashmap. This is done first with integer
+;; keys and then with symbol keys.
+
+(define n 300)
+(define rounds 20)
+
+(define mk-int-keys (lambda (i acc)
+  (if (= i 0) acc
+    (mk-int-keys (- i 1) (cons i acc)))))
+
+(define mk-sym-keys (lambda (i acc)
+  (if (= i 0) acc
+    (mk-sym-keys (- i 1) (cons (str2sym (str-join (list "key" (to-str i)))) acc)))))
+
+(define fill-alist (lambda (ks a)
+  (if (eq ks nil) a
+    (fill-alist (cdr ks) (acons (car ks) 1 a)))))
+
+(define look-alist (lambda (a ks acc)
+  (if (eq ks nil) acc
+    (look-alist a (cdr ks) (+ acc (assoc a (car ks)))))))
+
+(define fill-map (lambda (m ks)
+  (if (eq ks nil) m
+    (progn (hashmap-set m (car ks) 1)
+           (fill-map m (cdr ks))))))
+
+(define look-map (lambda (m ks acc)
+  (if (eq ks nil) acc
+    (look-map m (cdr ks) (+ acc (hashmap-get m (car ks)))))))
+
+(define repeat (lambda (f tab ks r)
+  (if (= r 0) t
+    (progn (f tab ks 0) (repeat f tab ks (- r 1))))))
+
+(define bench-alist (lambda (ks)
+  (let ((t0 (systime)))
+    (progn (repeat look-alist (fill-alist ks nil) ks rounds)
+           (secs-since t0)))))
+
+(define bench-map (lambda (ks)
+  (let ((t0 (systime)))
+    (progn (repeat look-map (fill-map (mk-hashmap) ks) ks rounds)
+           (secs-since t0)))))
+
+(define int-keys (mk-int-keys n nil))
+(define sym-keys (mk-sym-keys n nil))
+
+(print "int alist:   " (bench-alist int-keys))
+(print "int hashmap: " (bench-map int-keys))
+(print "sym alist:   " (bench-alist sym-keys))
+(print "sym hashmap: " (bench-map sym-keys))
@@ -0,0 +1,26 @@
+;; Boot time and heap use after booting an image with 500 bindings.
+;; Create the image with the repl:
+;;   repl -H 100000 --terminate -s image_boot.lisp
+;; and then boot from it and run main:
+;;   time repl -H 100000 --silent --terminate --load_image=image_boot.lbm -e "(main)"
+
+(define mk-sym (lambda (pre i) (str2sym (str-merge pre (to-str i)))))
+
+;; 250 lists and 250 functions.
+(loopfor i 0 (< i 250) (+ i 1)
+         (eval (list 'define (mk-sym "data-" i) (list 'quote (range i (+ i 10))))))
+
+;; The closures are built with an empty environment, a lambda evaluated
+;; in the loop would capture the loop environment.
+(loopfor i 0 (< i 250) (+ i 1)
+         (eval (list 'define (mk-sym "fun-" i)
+                     (list 'quote (list 'closure '(x) (list '+ 'x i) nil)))))
+
+(defun main () {
+       (gc)
+       (print "cells in use after boot: " (lbm-heap-state 'get-num-alloc-cells))
+       (print "data-7: " data-7 " (fun-7 1): " (fun-7 1))
+       })
+
+(image-save)
+(fwrite-image (fopen "image_boot.lbm" "w"))
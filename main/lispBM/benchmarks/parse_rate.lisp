@@ -0,0 +1,26 @@
+;; Parse rate of read-program on a large string with symbols, numbers,
+;; strings and comments. Needs the repl and a larger heap and memory
+;; than its default, for example:
+;;   repl -H 1000000 -M 11 --terminate -s parse_rate.lisp
+
+(define chunk "(define f (lambda (x y) ; a comment that runs to the end of the line
+  (if (< x 10) (+ x 1.5 2.25e-3 0xff) (str-merge \"some string\" \"another \\\"one\\\"\" (to-str (* y 2u32))))))
+")
+
+(define copies 2000)
+
+(define make-src (lambda (n acc)
+  (if (= n 0) acc (make-src (- n 1) (cons chunk acc)))))
+
+(define src (str-join (make-src copies nil)))
+
+(define parse-time (lambda (n)
+  (let ((t0 (systime)))
+    {
+    (loopfor i 0 (< i n) (+ i 1) (read-program src))
+    (/ (secs-since t0) n)
+    })))
+
+(define secs (parse-time 10))
+(print "Source size: " (str-len src) " bytes")
+(print "read-program: " (* 1000 secs) " ms, " (/ (str-len src) (* 1024 secs)) " KB/s")
@@ -0,0 +1,24 @@
+;; Rate of to-str on values that print to about 100 KB. Needs the repl
+;; and a larger heap and memory than its default, for example:
+;;   repl -H 100000 -M 11 --terminate -s print_rate.lisp
+
+(define strs (map (lambda (i) "a string with \"quotes\" and a \\ backslash") (range 2500)))
+(define nums (range 20000))
+(define bytes (bufcreate 30000))
+(loopfor i 0 (< i 30000) (+ i 1) (bufset-u8 bytes i (mod (* i 7) 256)))
+
+(define print-time (lambda (v n)
+  (let ((t0 (systime)))
+    {
+    (loopfor i 0 (< i n) (+ i 1) (to-str v))
+    (/ (secs-since t0) n)
+    })))
+
+(define report (lambda (name v)
+  (let ((size (str-len (to-str v)))
+        (secs (print-time v 10)))
+    (print name ": " size " bytes, " (* 1000 secs) " ms, " (/ size (* 1024 secs)) " KB/s"))))
+
+(report "strings" strs)
+(report "numbers" nums)
+(report "bytes" bytes)
@@ -0,0 +1,31 @@
+;; Read rate of a literal for a 64 KB byte array and of a list of float
+;; literals. Needs the repl and a larger heap and memory than its
+;; default, for example:
+;;   repl -H 400000 -M 11 --terminate -s read_bytearray_rate.lisp
+
+(define elems 65536)
+
+(define make-elems (lambda (n acc)
+  (if (= n 0) acc (make-elems (- n 1) (cons (to-str (mod (* n 37) 256)) acc)))))
+
+(define arr-src (str-merge "[" (str-join (make-elems elems nil) " ") "]"))
+
+(define make-floats (lambda (n acc)
+  (if (= n 0) acc (make-floats (- n 1) (cons "3.14159 -2.5e-3 1000.125 0.1" acc)))))
+
+(define float-src (str-merge "(" (str-join (make-floats 4000 nil) " ") ")"))
+
+(define read-time (lambda (src n)
+  (let ((t0 (systime)))
+    {
+    (loopfor i 0 (< i n) (+ i 1) (read src))
+    (/ (secs-since t0) n)
+    })))
+
+(define arr-secs (read-time arr-src 10))
+(print "Byte array source: " (str-len arr-src) " bytes, " elems " elements")
+(print "read: " (* 1000 arr-secs) " ms, " (/ (str-len arr-src) (* 1024 arr-secs)) " KB/s")
+
+(define float-secs (read-time float-src 10))
+(print "Float list source: " (str-len float-src) " bytes")
+(print "read: " (* 1000 float-secs) " ms, " (/ (str-len float-src) (* 1024 float-secs)) " KB/s")
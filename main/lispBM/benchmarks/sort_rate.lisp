@@ -0,0 +1,40 @@
+;; Sort rate on 10000 element lists and arrays, with a fundamental
+;; comparator and with a closure. Needs the repl and a larger heap than
+;; its default, for example:
+;;   repl -H 100000 -M 11 --terminate -s sort_rate.lisp
+
+(define n 10000)
+
+(define rnd-state 4711)
+(define rnd (lambda ()
+  {
+  (setq rnd-state (mod (+ (* rnd-state 1103515245) 12345) 2147483648))
+  (/ rnd-state 65536)
+  }))
+
+(define make-list (lambda (n acc)
+  (if (= n 0) acc (make-list (- n 1) (cons (rnd) acc)))))
+
+(define ls (make-list n nil))
+(define arr (list-to-array ls))
+(define bytes (let ((b (bufcreate n)))
+                {
+                (loopfor i 0 (< i n) (+ i 1) (bufset-u8 b i (ix ls i)))
+                b
+                }))
+
+(define sort-time (lambda (cmp xs reps)
+  (let ((t0 (systime)))
+    {
+    (loopfor i 0 (< i reps) (+ i 1) (sort cmp xs))
+    (/ (secs-since t0) reps)
+    })))
+
+(define cmp-clo (lambda (a b) (< a b)))
+
+(print "list, <: " (* 1000 (sort-time < ls 10)) " ms")
+(print "list, closure: " (* 1000 (sort-time cmp-clo ls 2)) " ms")
+(print "array, <: " (* 1000 (sort-time < arr 10)) " ms")
+(print "array, closure: " (* 1000 (sort-time cmp-clo arr 2)) " ms")
+(print "byte array, <: " (* 1000 (sort-time < bytes 10)) " ms")
+(print "byte array, closure: " (* 1000 (sort-time cmp-clo bytes 2)) " ms")
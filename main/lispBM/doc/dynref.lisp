@@ -543,6 +543,7 @@
                        "LBM_USE_DYN_DEFSTRUCT : Add the defstruct mechanism, requires LBM_USE_DYN_FUNS and LBM_USE_DYN_MACROS."
                        "LBM_USE_DYN_LOOPS : Add loop macros, requires LBM_USE_DYN_MACROS."
 		       "LBM_USE_DYN_ARRAYS : Add functions on arrays. Requires LBM_USE_DYN_MACROS and LBM_USE_DYN_LOOPS."
+                       "LBM_USE_DYN_PRECOMPILED : Load the library from a precompiled (flattened) form instead of parsing and evaluating the source."
                        ))
              (para (list "The flags should be given to the compiler as -Dx for example -DLBM_USE_DYN_FUNS."
                          ))
@@ -2019,6 +2019,19 @@
                           (sort < a)
                           )
                          ))
+              (para (list "`sort` also accepts an array or a byte array and returns a new sorted array."
+                          "Arrays are sorted by merging runs that are first sorted by insertion."
+                          "Elements of a byte array are passed to the comparator as byte values."
+                          "A string is a byte array and is sorted the same way, including its terminating zero."
+                          "When the comparator is one of `<`, `>`, `<=`, `>=`, `str-cmp-asc` or `str-cmp-dsc`,"
+                          "lists and arrays are sorted without going through the evaluator for each comparison."
+                          "An element is placed before an equal element that came before it in the input when the"
+                          "comparator is strict, and after it when the comparator is not strict."
+                          ))
+              (program '(((define a [| 1 9 2 5 1 8 3 |])
+                          (sort < a)
+                          )
+                         ))
               end)))
 
 
@@ -2779,6 +2792,11 @@
                       ))
               (para (list "A flat value is a byte-array containing an encoding of the value."
                           ))
+              (para (list "By default, substructure that is shared is written once for every path"
+                          "that leads to it and circular values cannot be flattened. Passing a second"
+                          "non-nil argument, `(flatten expr t)`, writes shared nodes only once and refers back"
+                          "to them. The sharing, and any cycles, are then restored by `unflatten`."
+                          ))
               end)))
 
 (define fv-unflatten
@@ -32,9 +32,24 @@
                       ))
               end)))
 
+(define threads-stack-usage
+  (ref-entry "stack-usage"
+             (list
+              (para (list "`stack-usage` returns a list `(max-used size)` describing the stack of a thread."
+                          "`max-used` is the largest number of words the thread has had on its stack so far"
+                          "and `size` is the current size of the stack. Stacks grow on demand up to a maximum size"
+                          "so `size` may be larger than the size the thread was created with."
+                          "The form of a `stack-usage` expression is `(stack-usage)` for the calling thread"
+                          "or `(stack-usage pid)` for another thread."
+                          ))
+              (code '((stack-usage)
+                      ))
+              end)))
+
 (define chapter-threads
   (section 2 "Threads"
-           (list threads-mailbox-get)))
+           (list threads-mailbox-get
+                 threads-stack-usage)))
 
 
 (define num-free
@@ -124,6 +139,8 @@
               (para (list "`env-get` can be used to reify, turn into value, parts of the global environment."
                           "The global environment is stored as a hashtable and an index into this hashtable"
                           "is used to extract the bindings stored under that hash."
+                          "The hashtable grows as more globals are defined and the index wraps around"
+                          "at its current size."
                           ))
               (code-raw '((env-get 0)
                           (env-get 1)
@@ -333,6 +350,60 @@
                  show-em
                  )))
 
+(define define-opt
+  (ref-entry "set-define-optimization"
+             (list
+              (para (list "When define optimization is enabled, the body of a top-level"
+                          "`(define f (lambda ...))` is rewritten once before the closure is created."
+                          "Applications of global macros are expanded and applications of pure"
+                          "fundamental operations, such as `(* 2 3.14)`, to literal arguments are"
+                          "replaced by their result. The rewritten body is an ordinary expression."
+                          "Macros should be defined before the functions that use them."
+                          "Optimization is disabled by default."
+                          ))
+              (code '((set-define-optimization t)
+                      (set-define-optimization nil)
+                      ))
+              end)))
+
+(define chapter-evaluation
+  (section 2 "Evaluation"
+           (list define-opt
+                 )))
+
+
+(define ext-stats
+  (ref-entry "ext-stats"
+             (list
+              (para (list "`ext-stats` returns call statistics of extensions. It is only present"
+                          "when LBM is compiled with `-DLBM_EXTENSION_STATS`. The form of an `ext-stats`"
+                          "expression is `(ext-stats)` for all extensions that have been called"
+                          "or `(ext-stats ext)` for the extension `ext`."
+                          "Each extension is described by a list `(name calls total-time max-time histogram)`."
+                          "Times are in the units of the clock given to `lbm_set_extension_stats_clock`,"
+                          "microseconds in the REPL and in the VESC firmware."
+                          "Element i of the histogram is the number of calls that took from 2^i"
+                          "up to 2^(i+1) time units and the list ends at the last non-empty bucket."
+                          ))
+              (code '((ext-stats 'str-join)
+                      ))
+              end)))
+
+(define ext-stats-reset
+  (ref-entry "ext-stats-reset"
+             (list
+              (para (list "`ext-stats-reset` clears the call statistics of all extensions."
+                          ))
+              (code '((ext-stats-reset)
+                      ))
+              end)))
+
+(define chapter-extension-stats
+  (section 2 "Extension statistics"
+           (list ext-stats
+                 ext-stats-reset
+                 )))
+
 
 (define manual
   (list
@@ -345,6 +416,8 @@
                          "full mode the `-DFULL_RTS_LIB` flag must be used when compiling."
                          ))
              chapter-errors
+             chapter-evaluation
+             chapter-extension-stats
              chapter-environments
              chapter-gc
              chapter-memory
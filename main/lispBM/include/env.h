@@ -25,8 +25,28 @@
 extern "C" {
 #endif
 
+/** The global environment is a hash table of assoc lists indexed by the
+ *  low bits of the symbol id. It starts out with GLOBAL_ENV_ROOTS buckets
+ *  and doubles when there are more than GLOBAL_ENV_LOAD_FACTOR bindings
+ *  per bucket on average, up to GLOBAL_ENV_MAX_ROOTS buckets. The bucket
+ *  counts must be powers of two.
+ */
+#ifndef GLOBAL_ENV_ROOTS
 #define GLOBAL_ENV_ROOTS 32
-#define GLOBAL_ENV_MASK  0x1F
+#endif
+#ifndef GLOBAL_ENV_MAX_ROOTS
+#define GLOBAL_ENV_MAX_ROOTS 512
+#endif
+#ifndef GLOBAL_ENV_LOAD_FACTOR
+#define GLOBAL_ENV_LOAD_FACTOR 2
+#endif
+/** Number of runtime symbols whose global bindings are tracked for
+ *  incremental image saves. Bindings of symbols beyond this are always
+ *  saved. Must be a multiple of 32.
+ */
+#ifndef GLOBAL_ENV_DIRTY_BITS
+#define GLOBAL_ENV_DIRTY_BITS 2048
+#endif
 
 //environment interface
 /** Initialize the global environment. This sets the global environment to NIL
@@ -34,11 +54,24 @@ extern "C" {
  * \return true on success and false on failure.
  */
 bool lbm_init_env(void);
-/**
+/** The buckets are moved to a new array when the global environment
+ * grows, which only happens in lbm_global_env_set. The pointer must
+ * not be kept across a call to it.
  *
- * \return the global environment
+ * \return the global environment, an array of lbm_get_global_env_num_roots() buckets.
  */
 lbm_value *lbm_get_global_env(void);
+/**
+ * \return the current number of buckets in the global environment.
+ */
+lbm_uint lbm_get_global_env_num_roots(void);
+/** Get the bucket that a symbol is stored in. The pointer is valid
+ * for as long as the one returned by lbm_get_global_env.
+ *
+ * \param sym Symbol.
+ * \return Pointer to the bucket.
+ */
+lbm_value *lbm_global_env_bucket(lbm_value sym);
 /**
  * \return the size of the global env in number of heap cells.
  */
@@ -58,13 +91,36 @@ lbm_value lbm_env_copy_spine(lbm_value env);
  * \return True on success or false otherwise.
  */
 bool lbm_env_lookup_b(lbm_value *res, lbm_value sym, lbm_value env);
-/** Lookup a value in the global environment.
+#define GLOBAL_ENV_NOT_FOUND 0
+#define GLOBAL_ENV_FOUND     1
+#define GLOBAL_ENV_NO_MEM    2
+
+/** Lookup a value in the global environment. A value that
+ * lbm_image_boot left in the image is unflattened onto the heap and
+ * the binding updated. That cannot run GC, so when the heap is full
+ * GLOBAL_ENV_NO_MEM is returned and the caller can run GC and try again.
+ * Must be called from the evaluator or while it is paused.
+ *
  * \param res Result stored here
  * \param sym The key to look for in the environment
- * \param env The environment to search for the key.
- * \return True on success or false otherwise.
+ * \return GLOBAL_ENV_FOUND, GLOBAL_ENV_NOT_FOUND or GLOBAL_ENV_NO_MEM.
+ */
+int lbm_global_env_find(lbm_value *res, lbm_value sym);
+/** Lookup a value in the global environment, see lbm_global_env_find.
+ * \param res Result stored here
+ * \param sym The key to look for in the environment
+ * \return True on success or false otherwise, also when there is not enough heap for the value.
  */
 bool lbm_global_env_lookup(lbm_value *res, lbm_value sym);
+/** Unflatten the values in a bucket of the global environment that
+ * lbm_image_boot left in the image. For code that walks the buckets
+ * and uses the values directly. Must be called from the evaluator or
+ * while it is paused.
+ *
+ * \param ix Index of the bucket.
+ * \return False if the heap is full and some values are still in the image.
+ */
+bool lbm_global_env_unflatten_bucket(lbm_uint ix);
 /** Create a new binding on the environment or replace an old binding.
  *
  * \param env Environment to modify.
@@ -73,6 +129,41 @@ bool lbm_global_env_lookup(lbm_value *res, lbm_value sym);
  * \return The modified environment or lbm_enc_sym(SYM_MERROR) if GC needs to be run.
  */
 lbm_value lbm_env_set(lbm_value env, lbm_value key, lbm_value val);
+/** Create a new binding in the global environment or replace an old binding.
+ *  Adding a binding may grow the global environment.
+ *
+ * \param key A symbol to associate with a value.
+ * \param val The value.
+ * \return lbm_enc_sym(SYM_TRUE) or lbm_enc_sym(SYM_MERROR) if GC needs to be run.
+ */
+lbm_value lbm_global_env_set(lbm_value key, lbm_value val);
+/** Record that a global binding changed since the last image save.
+ *  lbm_global_env_set does this, code that updates a binding cell
+ *  directly must call it.
+ *
+ * \param key Symbol of the binding.
+ */
+void lbm_global_env_mark_dirty(lbm_value key);
+/** Treat every global binding as changed until the next
+ *  lbm_global_env_clear_dirty. Used when buckets are replaced wholesale.
+ */
+void lbm_global_env_mark_all_dirty(void);
+/** Check if a global binding changed since the last image save.
+ *
+ * \param key Symbol of the binding.
+ * \return true if the binding may have changed.
+ */
+bool lbm_global_env_is_dirty(lbm_value key);
+/** Check if a global binding may have been removed since the last
+ *  image save. lbm_env_drop_binding and lbm_global_env_mark_all_dirty
+ *  record this.
+ *
+ * \return true if a binding may have been removed.
+ */
+bool lbm_global_env_has_removed(void);
+/** Mark all global bindings as unchanged and forget removals.
+ */
+void lbm_global_env_clear_dirty(void);
 /** Create a new binding on the environment without destroying the old value.
  *  If the old value is unused (the key-value pair) it will be freed by GC
  *  at next convenience.
@@ -44,6 +44,7 @@ extern "C" {
 #define EVAL_CPS_CONTEXT_FLAG_CONST_SYMBOL_STRINGS  (uint32_t)0x04
 #define EVAL_CPS_CONTEXT_FLAG_INCREMENTAL_READ      (uint32_t)0x08
 #define EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN    (uint32_t)0x10
+#define EVAL_CPS_CONTEXT_FLAG_MACRO_PREEXPAND       (uint32_t)0x20
 #define EVAL_CPS_CONTEXT_READER_FLAGS_MASK          (EVAL_CPS_CONTEXT_FLAG_CONST | EVAL_CPS_CONTEXT_FLAG_CONST_SYMBOL_STRINGS | EVAL_CPS_CONTEXT_FLAG_INCREMENTAL_READ)
 
 /** The eval_context_t struct represents a lispbm process.
@@ -82,6 +83,10 @@ typedef struct eval_context_s{
   /* while reading */
   lbm_int row0;
   lbm_int row1;
+  /* Profiling, maintained while call tracking is enabled */
+  lbm_value prof_fun;   /* Name of the function being executed */
+  lbm_value prof_app;   /* Name of the function being applied */
+  lbm_value prof_ext;   /* Extension being executed */
   /* List structure */
   struct eval_context_s *prev;
   struct eval_context_s *next;
@@ -90,7 +95,9 @@ typedef struct eval_context_s{
 typedef enum {
   LBM_EVENT_FOR_HANDLER = 0,
   LBM_EVENT_UNBLOCK_CTX,
-  LBM_EVENT_DEFINE
+  LBM_EVENT_DEFINE,
+  LBM_EVENT_FOR_HANDLER_ARRAY,
+  LBM_EVENT_UNBLOCK_CTX_ARRAY
 } lbm_event_type_t;
 
 typedef struct {
@@ -184,6 +191,18 @@ bool lbm_event(lbm_flat_value_t *fv);
  * \return true on success.
  */
 bool lbm_event_unboxed(lbm_value unboxed);
+/** Send a byte array as an event to the event handler without copying it.
+ * The buffer must be allocated with lbm_malloc. If lbm_event_array returns
+ * true the LBM runtime system takes ownership of the buffer and it becomes
+ * the data of a byte array that is freed by the GC. If it returns false
+ * the C code is still responsible for freeing the buffer.
+ * \param tag An unboxed value, such as a symbol. If tag is not nil the
+ *            event is the pair (tag . array), otherwise just the array.
+ * \param buf Buffer allocated with lbm_malloc.
+ * \param len Number of bytes in the buffer, may be 0 for an empty array.
+ * \return true if the event was successfully enqueued to be sent, false otherwise.
+ */
+bool lbm_event_array(lbm_value tag, uint8_t *buf, lbm_uint len);
 /** Check if the event queue is empty.
  * \return true if event queue is empty, otherwise false.
  */
@@ -257,7 +276,7 @@ void lbm_set_critical_error_callback(void (*fptr)(void));
  *
  * \param program The program to evaluate in the context.
  * \param env An initial environment.
- * \param stack_size Stack size for the context.
+ * \param stack_size Initial stack size for the context, the stack grows on demand.
  * \param name Name of thread or NULL.
  * \return
  */
@@ -279,6 +298,15 @@ void lbm_undo_block_ctx_from_extension(void);
  * \param fv lbm_flat_value to give return as result from the unblocket process.
  */
 bool lbm_unblock_ctx(lbm_cid cid, lbm_flat_value_t *fv);
+/** Unblock a context that has been blocked by a C extension and give it
+ *  a byte array as result without copying. Ownership of the buffer is
+ *  handled as in lbm_event_array.
+ * \param cid Lisp process to wake up.
+ * \param buf Buffer allocated with lbm_malloc.
+ * \param len Number of bytes in the buffer.
+ * \return true if the event was successfully enqueued, false otherwise.
+ */
+bool lbm_unblock_ctx_array(lbm_cid cid, uint8_t *buf, lbm_uint len);
 /** Unblock a context bypassing the event-queue.
  * The return value is unchanged from when the context was blocked.
  * \param cid Lisp process to unblock.
@@ -327,6 +355,20 @@ void lbm_set_verbose(bool verbose);
  * \param hide true to hide error messages when trapped.
  */
 void lbm_set_hide_trapped_error(bool hide);
+/** Enable pre-expansion and constant folding of function definitions.
+ * When enabled, the body of a top-level (define f (lambda ...)) has its
+ * macro applications expanded and applications of pure fundamentals to
+ * literal arguments folded before the closure is created.
+ * \param enable true to rewrite definitions, false to leave them as read.
+ */
+void lbm_set_define_optimization(bool enable);
+/** Enable tracking of which named function each context is executing.
+ * While enabled, a non-tail call to a closure through a symbol pushes a
+ * small frame that restores the name of the caller on return, so that
+ * the profiler can attribute samples to functions and their callers.
+ * \param enable true to track calls, false to stop tracking.
+ */
+void lbm_set_call_tracking(bool enable);
 /** Set a usleep callback for use by the evaluator thread.
  *
  * \param fptr Pointer to a sleep function.
@@ -353,6 +395,12 @@ void lbm_set_printf_callback(int (*prnt)(const char*, ...));
  * an undefined symbol
  */
 void lbm_set_dynamic_load_callback(bool (*fptr)(const char *, const char **));
+/** Set a callback for looking up a precompiled form of code returned
+ * by the dynamic load callback. The callback fills in a flat value
+ * holding the value to bind to the symbol and returns true, or returns
+ * false to have the code string read and evaluated.
+ */
+void lbm_set_dynamic_load_flat_callback(bool (*fptr)(const char *, lbm_flat_value_t *));
 /** Get the CID of the currently executing context.
  *  Should be called from an extension where there is
  *  a guarantee that a context is running
@@ -364,6 +412,22 @@ lbm_cid lbm_get_current_cid(void);
  * a guarantee that a context is running
  */
 eval_context_t *lbm_get_current_context(void);
+
+/** Set the maximum size, in words, that a context stack may grow to.
+ * Context stacks start out at the size given when the context is
+ * created and grow on demand, from lbm_memory, up to this limit.
+ * Contexts created with a larger initial size keep that size as limit.
+ * By default the limit is 1/8 of lbm_memory, but at most 4096 words.
+ * \param max_size Maximum stack size in words, or 0 for the default.
+ */
+void lbm_set_max_stack_size(lbm_uint max_size);
+/** Get the stack high-water mark and current stack size of a context.
+ * \param cid Context to query.
+ * \param max_used Set to the largest number of stack words the context has used.
+ * \param size Set to the current size in words of the context stack.
+ * \return true if the context was found and false otherwise.
+ */
+bool lbm_get_stack_usage(lbm_cid cid, lbm_uint *max_used, lbm_uint *size);
 /** Surrenders remaining eval quota.
  *  Call this from extensions that takes non-trivial amounts of time.
  */
@@ -392,6 +456,15 @@ bool lbm_find_receiver_and_send(lbm_cid cid, lbm_value msg);
  * \return 1 on success
  */
 int lbm_perform_gc(void);
+/** Perform garbage collection with additional roots, for extensions
+ *  that hold heap values outside of the context stack.
+ *  Must be called from the eval thread.
+ *
+ * \param aux_data Array of values to mark. Values that are not pointers are skipped.
+ * \param aux_size Number of values in aux_data.
+ * \return 1 on success
+ */
+int lbm_perform_gc_aux(lbm_uint *aux_data, lbm_uint aux_size);
 /** Request that the runtime system performs a garbage collection on its earliers convenience.
  *  Can be called from any thread and does NOT require that the evaluator is paused.
  */
@@ -35,11 +35,33 @@ extern "C" {
  */
 typedef lbm_value (*extension_fptr)(lbm_value*,lbm_uint);
 
+#ifdef LBM_EXTENSION_STATS
+#ifndef LBM_EXTENSION_STATS_BUCKETS
+#define LBM_EXTENSION_STATS_BUCKETS 20
+#endif
+
+/** Call statistics of an extension. Times are in the units of the
+ *  clock set with lbm_set_extension_stats_clock. Bucket i of the
+ *  histogram counts calls that took from 2^i up to 2^(i+1) units.
+ *  Bucket 0 also counts calls shorter than one unit and the last
+ *  bucket all longer calls.
+ */
+typedef struct {
+  uint32_t calls;
+  uint32_t max_time;
+  uint64_t total_time;
+  uint32_t hist[LBM_EXTENSION_STATS_BUCKETS];
+} lbm_extension_stats_t;
+#endif
+
 /** Type representing an entry in the extension table
  */
 typedef struct {
   extension_fptr fptr;
   char *name;
+#ifdef LBM_EXTENSION_STATS
+  lbm_extension_stats_t stats;
+#endif
 } lbm_extension_t;
 
 
@@ -93,6 +115,32 @@ bool lbm_clr_extension(lbm_uint sym_id);
  */
 bool lbm_add_extension(char *sym_str, extension_fptr ext);
 
+#ifdef LBM_EXTENSION_STATS
+/** Set the clock used to time extension calls. The default clock is
+ *  the platform timestamp in microseconds.
+ * \param clock Function returning the current time. It may wrap around.
+ *               NULL selects the default clock.
+ */
+void lbm_set_extension_stats_clock(uint32_t (*clock)(void));
+/** Read the clock used to time extension calls.
+ * \return The current time in clock units.
+ */
+uint32_t lbm_extension_stats_clock(void);
+/** Add a call to the statistics of an extension.
+ * \param ext_ix Index of the extension in the extension table.
+ * \param time Duration of the call in clock units.
+ */
+void lbm_extension_stats_record(lbm_uint ext_ix, uint32_t time);
+/** Get the call statistics of an extension.
+ * \param ext_ix Index of the extension in the extension table.
+ * \return Pointer to the statistics or NULL if there is no such extension.
+ */
+lbm_extension_stats_t *lbm_get_extension_stats(lbm_uint ext_ix);
+/** Clear the call statistics of all extensions.
+ */
+void lbm_reset_extension_stats(void);
+#endif
+
 /** Check if an lbm_value is a symbol that is bound to an extension.
  * \param exp Key to look up.
  * \return true if the lbm_value respresents an extension otherwise false.
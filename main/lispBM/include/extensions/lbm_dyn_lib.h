@@ -19,7 +19,17 @@
 #ifndef LBM_DYN_LIB_H_
 #define LBM_DYN_LIB_H_
 
+#include "lbm_flat_value.h"
+
 void lbm_dyn_lib_init(void);
 bool lbm_dyn_lib_find(const char *str, const char **code);
+/** Look up the precompiled form of a dynamic library definition.
+ *  Only available when built with LBM_USE_DYN_PRECOMPILED.
+ *
+ * \param code Source string returned by lbm_dyn_lib_find.
+ * \param fv Flat value to point at the precompiled value of the definition.
+ * \return true if code is a dynamic library definition with a precompiled form.
+ */
+bool lbm_dyn_lib_find_flat(const char *code, lbm_flat_value_t *fv);
 
 #endif
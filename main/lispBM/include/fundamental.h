@@ -29,6 +29,7 @@
 extern "C" {
 #endif
   extern const fundamental_fun fundamental_table[];
+  extern const lbm_uint fundamental_table_size;
   bool struct_eq(lbm_value a, lbm_value b);
 #ifdef __cplusplus
 }
@@ -72,6 +72,7 @@ typedef struct lbm_char_channel_s {
   void *state;
   bool (*more)(struct lbm_char_channel_s *chan);
   int  (*peek)(struct lbm_char_channel_s *chan, unsigned int n, char *res);
+  int  (*peek_span)(struct lbm_char_channel_s *chan, const char **data, unsigned int *len);
   bool (*read)(struct lbm_char_channel_s *chan, char *res);
   bool (*drop)(struct lbm_char_channel_s *chan, unsigned int n);
   bool (*comment)(struct lbm_char_channel_s *chan);
@@ -115,6 +116,20 @@ bool lbm_channel_more(lbm_char_channel_t *chan);
  *       - CHANNEL_END: The sender side is closed and you are peeking outside of valid data.
  */
 int lbm_channel_peek(lbm_char_channel_t *chan, unsigned int n, char *res);
+/** Peek at the characters at the head of a channel that are stored
+ *  contiguously. The characters stay valid until they are read or
+ *  dropped. There may be more characters after the span, for example
+ *  when the buffer of a buffered channel wraps around, so
+ *  lbm_channel_peek should be used past its end.
+ *  \param chan The channel to peek into.
+ *  \param data Pointer that is set to the first character.
+ *  \param len Set to the number of characters in the span.
+ *  \return
+ *       - CHANNEL_SUCCESS: len is at least 1.
+ *       - CHANNEL_MORE: The channel is empty but more data may arrive.
+ *       - CHANNEL_END: The channel is empty and the sender side is closed.
+ */
+int lbm_channel_peek_span(lbm_char_channel_t *chan, const char **data, unsigned int *len);
 
 /** Read a character from the head of the channel.
  * \param chan The channel to read from.
@@ -123,7 +138,8 @@ int lbm_channel_peek(lbm_char_channel_t *chan, unsigned int n, char *res);
  */
 bool lbm_channel_read(lbm_char_channel_t *chan, char *res);
 
-/** Drop n characters from a channel.
+/** Drop n characters from a channel. Row and column are updated as
+ *  if the characters were read one by one.
  * \param chan The channel to drop characters from.
  * \param n The number of characters to drop.
  * \return true on successfully dropping n characters, false otherwise.
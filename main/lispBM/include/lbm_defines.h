@@ -169,6 +169,7 @@
 #define SYM_RECOVERED             0x28
 #define SYM_ERROR_FLASH_HEAP_FULL 0x29
 #define SYM_PLACEHOLDER 0x2A
+#define SYM_IMAGE_BINDING         0x2B /* Binding not yet unflattened from the image */
 
 
 //#define TYPE_CLASSIFIER_STARTS 0x30
@@ -426,6 +427,7 @@
 #define ENC_SYM_RECOVERED             ENC_SYM(SYM_RECOVERED)
 #define ENC_SYM_ERROR_FLASH_HEAP_FULL ENC_SYM(SYM_ERROR_FLASH_HEAP_FULL)
 #define ENC_SYM_PLACEHOLDER           ENC_SYM(SYM_PLACEHOLDER)
+#define ENC_SYM_IMAGE_BINDING         ENC_SYM(SYM_IMAGE_BINDING)
 
 #define ENC_SYM_ARRAY_TYPE            ENC_SYM(SYM_ARRAY_TYPE)
 #define ENC_SYM_RAW_I_TYPE            ENC_SYM(SYM_RAW_I_TYPE)
@@ -502,6 +504,7 @@
 #define ENC_SYM_PROGN_VAR           ENC_SYM(SYM_PROGN_VAR)
 #define ENC_SYM_SETQ                ENC_SYM(SYM_SETQ)
 #define ENC_SYM_MOVE_TO_FLASH       ENC_SYM(SYM_MOVE_TO_FLASH)
+#define ENC_SYM_LOOP                ENC_SYM(SYM_LOOP)
 #define ENC_SYM_IN_ENV              ENC_SYM(SYM_IN_ENV)
 
 #define ENC_SYM_SETVAR                ENC_SYM(SYM_SETVAR)
@@ -26,6 +26,15 @@ extern void lbm_defrag_mem_destroy(lbm_uint *ptr);
 extern lbm_value lbm_defrag_mem_alloc(lbm_uint *defrag_mem, lbm_uint nbytes);
 //extern lbm_value lbm_defrag_mem_alloc_lisparray(lbm_uint *defrag_mem, lbm_uint elts);
 extern void lbm_defrag_mem_free(lbm_uint* data);
+/** Set how many bytes of allocations an allocation may move to compact
+ *  a defrag mem when none of its tracked free ranges is large enough.
+ *  Compaction continues where the previous allocation left it. 0 turns
+ *  this off, then a defrag mem is only compacted when an allocation
+ *  has failed even after GC.
+ *
+ * \param nbytes Maximum number of bytes to move per allocation.
+ */
+extern void lbm_defrag_mem_set_compact_step(lbm_uint nbytes);
 
 static inline bool lbm_defrag_mem_valid(lbm_value arr) {
   return !(lbm_is_symbol_nil(lbm_car(arr))); 
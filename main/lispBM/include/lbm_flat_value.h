@@ -50,10 +50,23 @@ typedef struct {
 #define S_SHARED          0x20
 #define S_REF             0x21
 
+// Sharing preserving encoding, see flatten_value_sharing.
+// S_SHARING_HEADER is followed by the number of shared nodes (u32).
+// S_SHARED_LOCAL precedes the first occurrence of a shared node and
+// numbers it implicitly, S_REF_LOCAL (u32 number) refers back to it.
+#define S_SHARING_HEADER  0x22
+#define S_SHARED_LOCAL    0x23
+#define S_REF_LOCAL       0x24
+
 
 // Maximum number of recursive calls
 #define FLATTEN_VALUE_MAXIMUM_DEPTH 2000
 
+// Initial buffer size used by flatten_value. The buffer is grown as needed.
+#ifndef FLATTEN_VALUE_INITIAL_SIZE
+#define FLATTEN_VALUE_INITIAL_SIZE 64
+#endif
+
 #define FLATTEN_VALUE_OK  0
 #define FLATTEN_VALUE_ERROR_CANNOT_BE_FLATTENED -1
 #define FLATTEN_VALUE_ERROR_BUFFER_TOO_SMALL    -2
@@ -86,8 +99,23 @@ bool f_i64(lbm_flat_value_t *v, int64_t w);
 bool f_u64(lbm_flat_value_t *v, uint64_t w);
 bool f_lbm_array(lbm_flat_value_t *v, uint32_t num_bytes, uint8_t *data);
 lbm_value flatten_value(lbm_value v);
+/** Flatten a value preserving shared substructure and cycles.
+ *  Values without shared nodes are flattened as by flatten_value.
+ *
+ *  \param v Value to flatten.
+ *  \return A byte array holding the flat value or an error symbol.
+ */
+lbm_value flatten_value_sharing(lbm_value v);
 int flatten_value_c(lbm_flat_value_t *fv, lbm_value v);
 int flatten_value_size(lbm_value v, bool image);
+/** Check that a flat value can be unflattened on its own, that is
+ *  that it contains no references to nodes shared with other values
+ *  in an image.
+ *
+ *  \param v Flat value to check, starting at buf_pos.
+ *  \return True if the value is well formed and self contained.
+ */
+bool lbm_flat_value_is_self_contained(lbm_flat_value_t *v);
 void lbm_set_max_flatten_depth(int depth);
 int lbm_get_max_flatten_depth(void);
 
@@ -98,5 +126,21 @@ int lbm_get_max_flatten_depth(void);
  *  \return True on success and false otherwise.
  */
 bool lbm_unflatten_value(lbm_flat_value_t *v, lbm_value *res);
+/** Unflatten a flat value like lbm_unflatten_value but never run GC.
+ *  For use where the caller cannot let GC run. Fails with
+ *  ENC_SYM_MERROR in res if the heap is full.
+ *
+ *  \param v Flat value to unflatten.
+ *  \param res Pointer to where the result lbm_value should be stored.
+ *  \return True on success and false otherwise.
+ */
+bool lbm_unflatten_value_no_gc(lbm_flat_value_t *v, lbm_value *res);
 bool lbm_unflatten_value_sharing(sharing_table *st, lbm_uint *target_map, lbm_flat_value_t *v, lbm_value *res);
+/** Set a function that unflatten calls with every lisp array it has
+ *  filled in, before the array is used. It may change the contents of
+ *  the array but must not allocate.
+ *
+ *  \param fptr Function to call, or NULL for none.
+ */
+void lbm_set_unflatten_array_callback(void (*fptr)(lbm_value));
 #endif
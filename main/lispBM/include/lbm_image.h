@@ -63,6 +63,24 @@ bool lbm_image_has_extensions(void);
  */
 bool lbm_image_save_global_env(void);
 
+/**
+ * Save the global bindings that changed since the last save or boot.
+ * The new entries replace the old ones when the image is booted.
+ * Changes made by mutating a value in place (setcar, setix, ...)
+ * are not tracked and bindings that are undefined remain in the image.
+ * \return true on success otherwise false.
+ */
+bool lbm_image_save_global_env_incremental(void);
+
+/**
+ * Image space that a full rewrite of the image would free. This is the
+ * space used by bindings that later entries replace or whose keys are
+ * no longer bound, and by replaced extension tables and constant heap
+ * indices. Only meaningful after the image is booted.
+ * \return Number of bytes.
+ */
+uint32_t lbm_image_reclaimable(void);
+
 /**
  * Save the extension table to the image.
  * \return true on success otherwise false.
@@ -128,6 +146,11 @@ bool lbm_image_boot(void);
  */
 char *lbm_image_get_version(void);
 
+// Bindings that lbm_image_boot leaves in the image until first lookup
+// are bound to (ENC_SYM_IMAGE_BINDING . ix).
+bool lbm_image_is_binding(lbm_value v);
+lbm_value lbm_image_binding_value(lbm_value key, lbm_value v);
+
 
 
 /**
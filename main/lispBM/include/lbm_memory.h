@@ -186,6 +186,13 @@ void lbm_free(void *ptr);
  * \return 1 on success and 0 on failure.
  */
 int lbm_memory_shrink(lbm_uint *ptr, lbm_uint n);
+/** Grow an allocated array in place. Only succeeds if the memory
+ *  directly following the array is free.
+ * \param ptr Pointer to array to grow
+ * \param n New larger size of array
+ * \return 1 on success and 0 on failure.
+ */
+int lbm_memory_extend(lbm_uint *ptr, lbm_uint n);
 
 /** Check if a pointer points into the lbm_memory
  *
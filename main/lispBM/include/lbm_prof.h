@@ -22,6 +22,8 @@
 #include "eval_cps.h"
 
 #define LBM_PROF_MAX_NAME_SIZE 20
+/** Number of frames recorded per sample, innermost first. */
+#define LBM_PROF_MAX_DEPTH     8
 
 typedef struct {
   lbm_cid cid;
@@ -31,8 +33,44 @@ typedef struct {
   lbm_uint gc_count;
 } lbm_prof_t;
 
+/** Samples attributed to one function or extension. The symbol is nil
+ *  for code that does not run inside a named function. An entry with
+ *  total 0 is unused.
+ */
+typedef struct {
+  lbm_value sym;
+  lbm_uint  self;   /* Samples where it was the innermost frame */
+  lbm_uint  total;  /* Samples where it was among the recorded frames */
+} lbm_prof_fun_t;
+
+/** Samples of one call stack. An entry with count 0 is unused. */
+typedef struct {
+  lbm_value frames[LBM_PROF_MAX_DEPTH]; /* Innermost first */
+  lbm_uint  depth;
+  lbm_uint  count;
+} lbm_prof_stack_t;
+
 bool lbm_prof_init(lbm_prof_t *prof_data_buf,
                    lbm_uint    prof_data_buf_num);
+/** Set up the tables that samples are attributed to by function.
+ *  Either table can be left out by passing NULL. Call tracking must be
+ *  enabled with lbm_set_call_tracking for the frames to be known.
+ * \param fun_buf Table of per function sample counts.
+ * \param fun_buf_num Number of entries in fun_buf.
+ * \param stack_buf Table of per call stack sample counts.
+ * \param stack_buf_num Number of entries in stack_buf.
+ */
+void lbm_prof_init_functions(lbm_prof_fun_t   *fun_buf,
+                             lbm_uint          fun_buf_num,
+                             lbm_prof_stack_t *stack_buf,
+                             lbm_uint          stack_buf_num);
+/** Set by lbm_prof_sample when a sample of the call stack is due. */
+extern volatile bool lbm_prof_calls_pending;
+/** Record the call stack of the running context for the pending
+ *  sample. Called by the evaluator between evaluation steps.
+ * \param ctx The running context.
+ */
+void lbm_prof_sample_calls(eval_context_t *ctx);
 lbm_uint lbm_prof_get_num_samples(void);
 lbm_uint lbm_prof_get_num_system_samples(void);
 lbm_uint lbm_prof_get_num_sleep_samples(void);
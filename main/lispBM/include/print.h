@@ -52,6 +52,36 @@ int lbm_print_init(lbm_uint print_stack_size);
  */
 int lbm_print_value(char *buf, unsigned int len, lbm_value t);
 
+/** Size in bytes of the chunks that lbm_print_value_stream emits.
+ */
+#ifndef LBM_PRINT_CHUNK_SIZE
+#define LBM_PRINT_CHUNK_SIZE 128
+#endif
+
+/** Callback that receives the output of lbm_print_value_stream.
+ *  The data is not zero terminated.
+ *
+ * \param data Printed characters.
+ * \param len Number of characters, at most LBM_PRINT_CHUNK_SIZE.
+ * \param arg The argument given to lbm_print_value_stream.
+ * \return true to continue printing, false to stop.
+ */
+typedef bool (*lbm_print_emit_fun)(const char *data, unsigned int len, void *arg);
+
+/** Print an lbm_value in chunks of at most LBM_PRINT_CHUNK_SIZE bytes.
+ *  The output is not stored anywhere but in a chunk buffer on the C
+ *  stack. A cyclic value prints forever, so the output is limited to
+ *  max_len characters. When it would be longer, the first max_len
+ *  characters are emitted and printing fails.
+ *
+ * \param v The value to print.
+ * \param max_len Maximum number of characters to print.
+ * \param emit Function that is called with each chunk.
+ * \param arg Passed on to emit.
+ * \return the number of printed characters or a negative number on failure.
+ */
+int lbm_print_value_stream(lbm_value v, lbm_uint max_len, lbm_print_emit_fun emit, void *arg);
+
 #ifdef __cplusplus
 }
 #endif
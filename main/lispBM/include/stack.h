@@ -34,6 +34,7 @@ typedef struct {
   lbm_uint* data;
   lbm_uint sp;
   lbm_uint size;
+  lbm_uint max_size;
 } lbm_stack_t;
 
 /** Allocate a stack on the symbols and arrays memory.
@@ -43,6 +44,22 @@ typedef struct {
  * \return 1 on success and 0 on failure.
  */
 int lbm_stack_allocate(lbm_stack_t *s, lbm_uint stack_size);
+/** Allocate a stack on the symbols and arrays memory that can later be
+ *  grown, using lbm_stack_grow, up to max_size words.
+ * \param s Pointer to an lbm_stack_t to initialize.
+ * \param stack_size Initial size in words.
+ * \param max_size Maximum size in words that the stack may grow to.
+ * \return 1 on success and 0 on failure.
+ */
+int lbm_stack_allocate_growable(lbm_stack_t *s, lbm_uint stack_size, lbm_uint max_size);
+/** Grow a stack allocated on the symbols and arrays memory so that it
+ *  holds at least min_size words. The stack is moved to a new, larger,
+ *  allocation so any pointers into the old storage are invalidated.
+ * \param s Stack to grow.
+ * \param min_size Minimum size in words after growing.
+ * \return 1 on success and 0 if the maximum size would be exceeded or memory is full.
+ */
+int lbm_stack_grow(lbm_stack_t *s, lbm_uint min_size);
 /** Create a stack in a statically allocated array.
  *
  * \param s Pointer to an lbm_stack_t to initialize.
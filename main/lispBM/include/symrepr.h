@@ -45,6 +45,11 @@ typedef void (*symrepr_name_iterator_fun)(const char *);
  */
 void lbm_symrepr_set_symlist(lbm_uint *ls);
 
+/** Drop all entries from the name to id lookup cache. Needs to be called
+ *  if a name is removed from, or redirected in, the extension table or the symlist.
+ */
+void lbm_symrepr_clear_cache(void);
+
 /** Get the next to be assigned symbol id.
  * \return id;
  */
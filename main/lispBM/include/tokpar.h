@@ -139,6 +139,15 @@ int tok_double(lbm_char_channel_t *chan, token_float *result);
  * \return A positive value indicating number of characters used if successful. Otherwise a negative status indicator.
  */
 int tok_integer(lbm_char_channel_t *chan, token_int *result);
+/** Read byte array elements that are plain decimal numbers separated
+ *  by whitespace, directly from the characters that the channel has
+ *  buffered. Stops at the first element that needs the full tokenizer.
+ * \param chan Character channel to read characters from.
+ * \param data Where to store the elements.
+ * \param max Maximum number of elements to read.
+ * \return The number of elements read.
+ */
+unsigned int tok_bytearray_elements(lbm_char_channel_t *chan, uint8_t *data, unsigned int max);
 /** Clean off whitespace from head of the character stream
  * \return True if whitespace could be cleaned. False if stream has no more available characters at the moment.
  */
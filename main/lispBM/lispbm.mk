@@ -28,6 +28,8 @@ LISPBM_SRC = $(LISPBM)/src/env.c \
              $(LISPBM)/src/extensions/display_extensions.c \
              $(LISPBM)/src/extensions/tjpgd.c \
              $(LISPBM)/src/extensions/mutex_extensions.c \
+             $(LISPBM)/src/extensions/bytecode_extensions.c \
+             $(LISPBM)/src/extensions/hashmap_extensions.c \
              $(LISPBM)/src/extensions/lbm_dyn_lib.c \
              $(LISPBM)/src/extensions/schrift.c \
              $(LISPBM)/src/extensions/ttf_extensions.c
@@ -59,6 +61,8 @@ LISPBM_H = $(LISPBM)/include/env.h \
            $(LISPBM)/include/tokpar.h \
            $(LISPBM)/include/buffer.h \
            $(LISPBM)/include/extensions/array_extensions.h \
+           $(LISPBM)/include/extensions/bytecode_extensions.h \
+           $(LISPBM)/include/extensions/hashmap_extensions.h \
            $(LISPBM)/include/extensions/display_extensions.h \
            $(LISPBM)/include/extensions/lbm_dyn_lib.h \
            $(LISPBM)/include/extensions/math_extensions.h \
@@ -181,4 +181,6 @@ typedef enum {
 	//COMM_PINLOCK3							= 155,
 
 	COMM_SHUTDOWN							= 156,
+
+	COMM_LISP_GET_PROF						= 160,
 } COMM_PACKET_ID;
@@ -27,8 +27,10 @@
 
 #ifndef LBM_WIN
 #include <pthread.h>
+#include <signal.h>
 #include <sys/time.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 #endif
 
@@ -272,9 +274,14 @@ static size_t constants_memory_size = 4096;  // size words
 #define EXTENSION_STORAGE_SIZE 4096
 #define STR_SIZE 1024
 #define PROF_DATA_NUM 100
+#define PROF_FUN_NUM 64
+#define PROF_STACK_NUM 128
+#define PROF_PERIOD_US 200
 
 lbm_extension_t extensions[EXTENSION_STORAGE_SIZE];
 lbm_prof_t prof_data[100];
+lbm_prof_fun_t prof_fun_data[PROF_FUN_NUM];
+lbm_prof_stack_t prof_stack_data[PROF_STACK_NUM];
 
 static char *env_input_file = NULL;
 static char *env_output_file = NULL;
@@ -442,6 +449,12 @@ static int printf_callback(const char *format, ...) {
   return len;
 }
 
+static bool print_chunk_callback(const char *data, unsigned int len, void *arg) {
+  (void) arg;
+  printf_callback("%.*s", (int)len, data);
+  return true;
+}
+
 // Direct print callback for use when the when not in "REPL" mode.
 static int printf_direct_callback(const char *format, ...) {
 
@@ -524,14 +537,13 @@ void done_callback(eval_context_t *ctx) {
   // Only print result from contexts directly started by the REPL.
   bool dr = drop_reader(ctx->id);
   if (!repl_mode || dr) {
-    char output[1024];
-    lbm_value t = ctx->r;
-    lbm_print_value(output, 1024, t);
     if (!silent_mode) {
-      printf_callback("> %s\n", output);
-    } else {
-      printf_callback("%s\n", output);
+      printf_callback("> ");
+    }
+    if (lbm_print_value_stream(ctx->r, REPL_PRINT_MAX_LEN, print_chunk_callback, NULL) < 0) {
+      printf_callback("...");
     }
+    printf_callback("\n");
   }
 
   if (startup_cid != -1) {
@@ -560,15 +572,149 @@ DWORD WINAPI prof_thd(LPVOID lpParam) {
   return 0;
 }
 #else
+// Samples are taken on the ticks of an interval timer. SIGALRM is
+// blocked in all threads from the start of main and is received
+// synchronously here, so sampling never runs in a signal handler.
 void *prof_thd(void *v) {
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+
+  struct itimerval it;
+  it.it_interval.tv_sec = 0;
+  it.it_interval.tv_usec = PROF_PERIOD_US;
+  it.it_value = it.it_interval;
+  if (setitimer(ITIMER_REAL, &it, NULL) != 0) {
+    prof_running = false;
+    return NULL;
+  }
+
   while (prof_running) {
-    lbm_prof_sample();
-    sleep_callback(200);
+    int sig;
+    if (sigwait(&set, &sig) == 0) {
+      lbm_prof_sample();
+    }
   }
+
+  memset(&it, 0, sizeof(it));
+  setitimer(ITIMER_REAL, &it, NULL);
   return NULL;
 }
 #endif
 
+static void prof_start_functions(void) {
+  lbm_prof_init_functions(prof_fun_data, PROF_FUN_NUM,
+                          prof_stack_data, PROF_STACK_NUM);
+  lbm_set_call_tracking(true);
+}
+
+static const char *prof_sym_name(lbm_value sym) {
+  if (sym == ENC_SYM_NIL) return "<anon>";
+  const char *name = lbm_get_name_by_symbol(lbm_dec_sym(sym));
+  return name ? name : "<unknown>";
+}
+
+// Functions by number of samples where they were innermost. nl is
+// appended to each line as the two ways of printing differ.
+static void prof_print_functions(int (*pr)(const char *, ...), const char *nl) {
+  lbm_uint tot_samples = lbm_prof_get_num_samples();
+  if (tot_samples == 0) return;
+  bool printed[PROF_FUN_NUM] = {false};
+  pr("Function\tSelf\t%%Self\tTotal\t%%Total%s", nl);
+  for (int n = 0; n < PROF_FUN_NUM; n ++) {
+    int best = -1;
+    for (int i = 0; i < PROF_FUN_NUM; i ++) {
+      if (prof_fun_data[i].total == 0 || printed[i]) continue;
+      if (best < 0 || prof_fun_data[i].self > prof_fun_data[best].self) best = i;
+    }
+    if (best < 0) break;
+    printed[best] = true;
+    pr("%s\t%"PRI_UINT"\t%.3f\t%"PRI_UINT"\t%.3f%s",
+       prof_sym_name(prof_fun_data[best].sym),
+       prof_fun_data[best].self,
+       100.0 * ((double)prof_fun_data[best].self) / (double)tot_samples,
+       prof_fun_data[best].total,
+       100.0 * ((double)prof_fun_data[best].total) / (double)tot_samples,
+       nl);
+  }
+}
+
+// Call stacks in the folded format, outermost first, that flame graph
+// tools take as input.
+static void prof_print_flame(int (*pr)(const char *, ...), const char *nl) {
+  char line[256];
+  for (int i = 0; i < PROF_STACK_NUM; i ++) {
+    if (prof_stack_data[i].count == 0) break;
+    size_t pos = 0;
+    line[0] = 0;
+    for (lbm_uint j = prof_stack_data[i].depth; j > 0 && pos < sizeof(line); j --) {
+      int n = snprintf(line + pos, sizeof(line) - pos, "%s%s",
+                       prof_sym_name(prof_stack_data[i].frames[j-1]),
+                       j > 1 ? ";" : "");
+      if (n < 0) break;
+      pos += (size_t)n;
+    }
+    pr("%s %"PRI_UINT"%s", line, prof_stack_data[i].count, nl);
+  }
+}
+
+#ifdef LBM_EXTENSION_STATS
+#ifndef LBM_WIN
+// The platform timestamp is only updated every 100us, too coarse for
+// timing extension calls.
+static uint32_t ext_stats_clock_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000);
+}
+#endif
+
+// Extensions that have been called, by total time spent in them.
+static void ext_stats_print(int (*pr)(const char *, ...), const char *nl) {
+  lbm_uint num = lbm_get_num_extensions();
+  pr("Extension\tCalls\tTotal\tMax\tMean\tHistogram (us, log2 buckets)%s", nl);
+  uint64_t printed_below = UINT64_MAX;
+  lbm_uint printed_ix = 0;
+  while (true) {
+    // Next entry in order of decreasing total time, ties by index.
+    int best = -1;
+    for (lbm_uint i = 0; i < num; i ++) {
+      lbm_extension_stats_t *s = lbm_get_extension_stats(i);
+      if (s->calls == 0) continue;
+      if (s->total_time > printed_below ||
+          (s->total_time == printed_below && i <= printed_ix)) continue;
+      if (best < 0 ||
+          s->total_time > lbm_get_extension_stats((lbm_uint)best)->total_time) {
+        best = (int)i;
+      }
+    }
+    if (best < 0) break;
+    lbm_extension_stats_t *s = lbm_get_extension_stats((lbm_uint)best);
+    printed_below = s->total_time;
+    printed_ix = (lbm_uint)best;
+
+    char hist[256];
+    size_t pos = 0;
+    hist[0] = 0;
+    int last = LBM_EXTENSION_STATS_BUCKETS - 1;
+    while (last > 0 && s->hist[last] == 0) last --;
+    for (int b = 0; b <= last && pos < sizeof(hist); b ++) {
+      int n = snprintf(hist + pos, sizeof(hist) - pos, "%s%u", b ? " " : "", s->hist[b]);
+      if (n < 0) break;
+      pos += (size_t)n;
+    }
+    pr("%s\t%u\t%llu\t%u\t%.1f\t%s%s",
+       extension_table[best].name,
+       s->calls,
+       (unsigned long long)s->total_time,
+       s->max_time,
+       (double)s->total_time / (double)s->calls,
+       hist,
+       nl);
+  }
+}
+#endif
+
 /* load a file, caller is responsible for freeing the returned string */
 char * load_file(char *filename) {
   char *file_str = NULL;
@@ -626,6 +772,7 @@ void print_ctx_info(eval_context_t *ctx, void *arg1, void *arg2) {
     printf("ContextID: %"PRI_UINT"\n", ctx->id);
     printf("Stack SP: %"PRI_UINT"\n",  ctx->K.sp);
     printf("Stack SP max: %"PRI_UINT"\n", lbm_get_max_stack(&ctx->K));
+    printf("Stack size: %"PRI_UINT"\n", ctx->K.size);
     if (print_ret) {
       printf("Value: %s\n", output);
     } else {
@@ -682,9 +829,11 @@ void sym_it(const char *str) {
 
 #define BLDC_STUBS           0x040B
 #define VESC_EXPRESS_STUBS   0x040C
+#define DYN_LIB_FROM_SOURCE  0x040D
 
 bool use_bldc_stubs = false;
 bool use_vesc_express_stubs = false;
+static bool dyn_lib_from_source = false;
 
 struct option options[] = {
   {"help", no_argument, NULL, 'h'},
@@ -705,6 +854,7 @@ struct option options[] = {
   {"history_file", required_argument, NULL, HISTORY_FILE},
   {"bldc_stubs", no_argument, NULL, BLDC_STUBS},
   {"vesc_express_stubs", no_argument, NULL, VESC_EXPRESS_STUBS},
+  {"dyn_lib_from_source", no_argument, NULL, DYN_LIB_FROM_SOURCE},
   {0,0,0,0}};
 
 typedef struct src_list_s {
@@ -875,6 +1025,9 @@ void parse_opts(int argc, char **argv) {
       printf("    --bldc_stubs                      Load BLDC extension stub files\n");
       printf("    --vesc_express_stubs              Load Vesc Express extension stub files\n");
       printf("\n");
+      printf("    --dyn_lib_from_source             Load the dynamic library from source\n"\
+             "                                      even if a precompiled form exists.\n");
+      printf("\n");
 
       printf("memory-size-indices: \n"          \
              "Index | Words\n"                  \
@@ -970,6 +1123,9 @@ void parse_opts(int argc, char **argv) {
     case VESC_EXPRESS_STUBS:
       use_vesc_express_stubs = false;
       break;
+    case DYN_LIB_FROM_SOURCE:
+      dyn_lib_from_source = true;
+      break;
     default:
       break;
     }
@@ -1023,15 +1179,8 @@ bool load_flat_library(unsigned char *lib, unsigned int size) {
 
     pos += val_size;
 
-    lbm_uint ix_key  = sym_id & GLOBAL_ENV_MASK;
-    lbm_value *global_env = lbm_get_global_env();
-    lbm_uint orig_env = global_env[ix_key];
-    lbm_value new_env;
-
     // All of this should just succeed with no GC needed.
-    new_env = lbm_env_set(orig_env,sym,val);
-
-    global_env[ix_key] = new_env;
+    lbm_global_env_set(sym,val);
   }
   return true;
 }
@@ -1086,6 +1235,9 @@ int init_repl(void) {
   lbm_set_dynamic_load_callback(dynamic_loader);
   lbm_set_printf_callback(printf_direct_callback);
   // print directly to stdout until the REPL is running
+#if defined(LBM_EXTENSION_STATS) && !defined(LBM_WIN)
+  lbm_set_extension_stats_clock(ext_stats_clock_us);
+#endif
 
 
 
@@ -1145,6 +1297,10 @@ int init_repl(void) {
       printf("Image contains extensions\n");
   }
 
+  if (dyn_lib_from_source) {
+    lbm_set_dynamic_load_flat_callback(NULL);
+  }
+
 #ifdef WITH_SDL
   if (!lbm_sdl_init()) {
     return 0;
@@ -1367,13 +1523,42 @@ void startup_procedure(void) {
 }
 
 
+// Pauses the evaluator and unflattens the global values that are still
+// in the image, so that listings show the values.
+static void pause_for_env(void) {
+  lbm_pause_eval_with_gc(30);
+  while (lbm_get_eval_state() != EVAL_CPS_STATE_PAUSED) {
+    lbm_pause_eval();
+    sleep_callback(1);
+  }
+  lbm_uint n_roots = lbm_get_global_env_num_roots();
+  for (lbm_uint i = 0; i < n_roots; i ++) {
+    lbm_global_env_unflatten_bucket(i);
+  }
+}
+
+// Prints a (key . value) binding of the global environment.
+static void print_env_binding(char *buf, unsigned int len, lbm_value binding) {
+  if (lbm_image_is_binding(lbm_cdr(binding))) {
+    // No room on the heap for the value.
+    char name[64];
+    lbm_print_value(name, sizeof(name), lbm_car(binding));
+    snprintf(buf, len, "(%s . (in image))", name);
+  } else {
+    lbm_print_value(buf, len, binding);
+  }
+}
+
 int store_env(char *filename) {
   FILE *fp = fopen(env_output_file, "w");
   if (!fp) {
     terminate_repl(REPL_EXIT_UNABLE_TO_OPEN_ENV_FILE);
   }
   lbm_value* env = lbm_get_global_env();
-  for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+  lbm_uint n_roots = lbm_get_global_env_num_roots();
+  for (lbm_uint i = 0; i < n_roots; i ++) {
+    // Values still in the image are stored as values, not as references into it.
+    if (!lbm_global_env_unflatten_bucket(i)) return REPL_EXIT_ERROR_FLATTEN_NO_MEM;
     lbm_value curr = env[i];
     while(lbm_is_cons(curr)) {
       lbm_value name_field = lbm_caar(curr);
@@ -1592,6 +1777,7 @@ static void vescif_print_ctx_info(eval_context_t *ctx, void *arg1, void *arg2) {
   commands_printf_lisp("State: %s\n", state_string);
   commands_printf_lisp("Stack SP: %"PRI_UINT,  ctx->K.sp);
   commands_printf_lisp("Stack SP max: %"PRI_UINT, lbm_get_max_stack(&ctx->K));
+  commands_printf_lisp("Stack size: %"PRI_UINT, ctx->K.size);
   if (print_ret) {
     commands_printf_lisp("Value: %s\n", output);
   } else {
@@ -1620,6 +1806,7 @@ bool vescif_restart(bool print, bool load_code, bool load_imports) {
     void *a;
     pthread_join(prof_thread, &a);
 #endif
+    lbm_set_call_tracking(false);
   }
 
   if (lispbm_thd) {
@@ -1667,6 +1854,9 @@ bool vescif_restart(bool print, bool load_code, bool load_imports) {
   lbm_set_usleep_callback(sleep_callback);
   lbm_set_dynamic_load_callback(dynamic_loader);
   lbm_set_printf_callback(commands_printf_lisp);
+#if defined(LBM_EXTENSION_STATS) && !defined(LBM_WIN)
+  lbm_set_extension_stats_clock(ext_stats_clock_us);
+#endif
 
   init_exts();
   lbm_add_eval_symbols();
@@ -1943,7 +2133,8 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
     send_buffer_global[ind++] = '\0';
 
     lbm_value *glob_env = lbm_get_global_env();
-    for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+    lbm_uint n_roots = lbm_get_global_env_num_roots();
+    for (lbm_uint i = 0; i < n_roots; i ++) {
       if (ind > 300) {
         break;
       }
@@ -1976,6 +2167,53 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
     reply_func(send_buffer_global, (unsigned int)ind);
   } break;
 
+  case COMM_LISP_GET_PROF: {
+    // data[0]: 0 = samples per function, 1 = sampled call stacks
+    uint8_t what = len > 0 ? data[0] : 0;
+
+    uint8_t send_buffer_global[512];
+    int32_t ind = 0;
+
+    send_buffer_global[ind++] = packet_id;
+    send_buffer_global[ind++] = what;
+    send_buffer_global[ind++] = prof_running;
+    buffer_append_uint32(send_buffer_global, (uint32_t)lbm_prof_get_num_samples(), &ind);
+    buffer_append_uint32(send_buffer_global, (uint32_t)lbm_prof_get_num_system_samples(), &ind);
+    buffer_append_uint32(send_buffer_global, (uint32_t)lbm_prof_get_num_sleep_samples(), &ind);
+
+    if (what == 0) {
+      // Entries: name, self samples, total samples
+      for (int i = 0; i < PROF_FUN_NUM; i ++) {
+        if (prof_fun_data[i].total == 0) continue;
+        const char *name = prof_sym_name(prof_fun_data[i].sym);
+        if (ind + (int32_t)strlen(name) + 9 > 400) break;
+        strcpy((char*)(send_buffer_global + ind), name);
+        ind += (int32_t)strlen(name) + 1;
+        buffer_append_uint32(send_buffer_global, (uint32_t)prof_fun_data[i].self, &ind);
+        buffer_append_uint32(send_buffer_global, (uint32_t)prof_fun_data[i].total, &ind);
+      }
+    } else {
+      // Entries: samples, depth, names from the innermost frame
+      for (int i = 0; i < PROF_STACK_NUM; i ++) {
+        if (prof_stack_data[i].count == 0) break;
+        int32_t size = 5;
+        for (lbm_uint j = 0; j < prof_stack_data[i].depth; j ++) {
+          size += (int32_t)strlen(prof_sym_name(prof_stack_data[i].frames[j])) + 1;
+        }
+        if (ind + size > 400) break;
+        buffer_append_uint32(send_buffer_global, (uint32_t)prof_stack_data[i].count, &ind);
+        send_buffer_global[ind++] = (uint8_t)prof_stack_data[i].depth;
+        for (lbm_uint j = 0; j < prof_stack_data[i].depth; j ++) {
+          const char *name = prof_sym_name(prof_stack_data[i].frames[j]);
+          strcpy((char*)(send_buffer_global + ind), name);
+          ind += (int32_t)strlen(name) + 1;
+        }
+      }
+    }
+
+    reply_func(send_buffer_global, (unsigned int)ind);
+  } break;
+
   case COMM_LISP_REPL_CMD: {
     if (!lispbm_thd) {
       vescif_restart(true, false, true);
@@ -2004,6 +2242,14 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
         commands_printf_lisp(
                              ":prof report\n"
                              "  Print profiler report");
+        commands_printf_lisp(
+                             ":prof flame\n"
+                             "  Print sampled call stacks in folded format for flame graphs");
+#ifdef LBM_EXTENSION_STATS
+        commands_printf_lisp(
+                             ":extstats [reset]\n"
+                             "  Print or clear call counts and times of extensions");
+#endif
         commands_printf_lisp(
                              ":env\n"
                              "  Print current environment and variables");
@@ -2072,6 +2318,8 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
 #endif
         }
         lbm_prof_init(prof_data, PROF_DATA_NUM);
+        prof_start_functions();
+        prof_running = true;
 
 #ifdef LBM_WIN
         prof_thread = CreateThread(
@@ -2083,7 +2331,7 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
                                    NULL);
 #else
         if (pthread_create(&prof_thread, NULL, prof_thd, NULL)) {
-          prof_running = true;
+          prof_running = false;
           commands_printf_lisp("Error creating profiler thread\n");
         } else {
           commands_printf_lisp("Profiler started\n");
@@ -2100,6 +2348,7 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
           pthread_join(prof_thread,&a);
 #endif
         }
+        lbm_set_call_tracking(false);
         commands_printf_lisp("Profiler stopped. Issue command ':prof report' for statistics\n");
       } else if (strncmp(str, ":prof report", 12) == 0) {
         lbm_uint num_sleep = lbm_prof_get_num_sleep_samples();
@@ -2122,18 +2371,31 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
         commands_printf_lisp("System:\t%u\t%f%%\n", num_system, (double)(100.0 * ((float)num_system / (float)tot_samples)));
         commands_printf_lisp("Sleep:\t%u\t%f%%\n", num_sleep, (double)(100.0 * ((float)num_sleep / (float)tot_samples)));
         commands_printf_lisp("Total:\t%u samples\n", tot_samples);
+        prof_print_functions(commands_printf_lisp, "");
+      } else if (strncmp(str, ":prof flame", 11) == 0) {
+        prof_print_flame(commands_printf_lisp, "");
+#ifdef LBM_EXTENSION_STATS
+      } else if (strncmp(str, ":extstats reset", 15) == 0) {
+        lbm_reset_extension_stats();
+        commands_printf_lisp("Extension statistics cleared\n");
+      } else if (strncmp(str, ":extstats", 9) == 0) {
+        ext_stats_print(commands_printf_lisp, "");
+#endif
       } else if (strncmp(str, ":env", 4) == 0) {
+        pause_for_env();
         lbm_value *glob_env = lbm_get_global_env();
+        lbm_uint n_roots = lbm_get_global_env_num_roots();
         char output[128];
-        for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+        for (lbm_uint i = 0; i < n_roots; i ++) {
           lbm_value curr = glob_env[i];
           while (lbm_type_of(curr) == LBM_TYPE_CONS) {
-            lbm_print_value(output, sizeof(output), lbm_car(curr));
+            print_env_binding(output, sizeof(output), lbm_car(curr));
             curr = lbm_cdr(curr);
 
             commands_printf_lisp("  %s", output);
           }
         }
+        lbm_continue_eval();
       } else if (strncmp(str, ":ctxs", 5) == 0) {
         commands_printf_lisp("****** Contexts ******");
         lbm_all_ctxs_iterator(vescif_print_ctx_info, NULL,NULL);
@@ -2637,6 +2899,14 @@ int main(int argc, char **argv) {
 
   iobuffer_init();
 
+#ifndef LBM_WIN
+  // SIGALRM drives the profiler and is only taken by its thread.
+  sigset_t prof_set;
+  sigemptyset(&prof_set);
+  sigaddset(&prof_set, SIGALRM);
+  pthread_sigmask(SIG_BLOCK, &prof_set, NULL);
+#endif
+
   // ////////////////////////////////////////////////////////////
   // start timestamp cacher
 #ifdef LBM_WIN
@@ -2929,6 +3199,7 @@ int main(int argc, char **argv) {
         } else if (strncmp(str, ":prof start", 11) == 0) {
           lbm_prof_init(prof_data,
                         PROF_DATA_NUM);
+          prof_start_functions();
 #ifndef LBM_WIN
           pthread_t thd; // just forget this id.
           prof_running = true;
@@ -2942,6 +3213,7 @@ int main(int argc, char **argv) {
 #endif
         } else if (strncmp(str, ":prof stop", 10) == 0) {
           prof_running = false;
+          lbm_set_call_tracking(false);
           printf("Profiler stopped. Issue command ':prof report' for statistics\n.");
         } else if (strncmp(str, ":prof report", 12) == 0) {
           lbm_uint num_sleep = lbm_prof_get_num_sleep_samples();
@@ -2964,17 +3236,31 @@ int main(int argc, char **argv) {
           printf("System:\t%"PRI_UINT"\t%f%%\n", num_system, 100.0 * ((float)num_system / (float)tot_samples));
           printf("Sleep:\t%"PRI_UINT"\t%f%%\n", num_sleep, 100.0 * ((float)num_sleep / (float)tot_samples));
           printf("Total:\t%"PRI_UINT" samples\n", tot_samples);
+          printf("\n");
+          prof_print_functions(printf, "\n");
+        } else if (strncmp(str, ":prof flame", 11) == 0) {
+          prof_print_flame(printf, "\n");
+#ifdef LBM_EXTENSION_STATS
+        } else if (strncmp(str, ":extstats reset", 15) == 0) {
+          lbm_reset_extension_stats();
+          printf("Extension statistics cleared\n");
+        } else if (strncmp(str, ":extstats", 9) == 0) {
+          ext_stats_print(printf, "\n");
+#endif
         } else if (strncmp(str, ":env", 4) == 0) {
-          for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+          pause_for_env();
+          lbm_uint n_roots = lbm_get_global_env_num_roots();
+          for (lbm_uint i = 0; i < n_roots; i ++) {
             lbm_value *env = lbm_get_global_env();
             lbm_value curr = env[i];
-            printf("Environment [%d]:\r\n", i);
+            printf("Environment [%"PRI_UINT"]:\r\n", i);
             while (lbm_type_of(curr) == LBM_TYPE_CONS) {
-              lbm_print_value(output,1024, lbm_car(curr));
+              print_env_binding(output, 1024, lbm_car(curr));
               curr = lbm_cdr(curr);
               printf("  %s\r\n",output);
             }
           }
+          lbm_continue_eval();
         } else if (strncmp(str, ":state", 6) == 0) {
           switch (lbm_get_eval_state()) {
           case EVAL_CPS_STATE_DEAD:
@@ -38,6 +38,8 @@
 #include "extensions/lbm_dyn_lib.h"
 #include "extensions/ttf_extensions.h"
 #include "extensions/random_extensions.h"
+#include "extensions/bytecode_extensions.h"
+#include "extensions/hashmap_extensions.h"
 
 #include "eval_cps.h"
 #include "lbm_image.h"
@@ -177,19 +179,62 @@ static lbm_value ext_secs_since(lbm_value *args, lbm_uint argn) {
   return lbm_enc_float((float)diff / 1000000.0f);
 }
 
+// ////////////////////////////////////////////////////////////
+// Events
+
+// Stands in for the receive buffer of a driver.
+static uint8_t event_source[16384];
+
+// (event-byte-array tag n owned) posts (tag . array) with an n byte array
+// to the event handler. The array is flattened unless owned is true, in
+// which case the buffer is handed over with lbm_event_array.
+static lbm_value ext_event_byte_array(lbm_value *args, lbm_uint argn) {
+  if (argn < 2 || argn > 3 ||
+      !lbm_is_symbol(args[0]) ||
+      !lbm_is_number(args[1])) return ENC_SYM_TERROR;
+  lbm_uint n = lbm_dec_as_u32(args[1]);
+  if (n == 0 || n > sizeof(event_source)) return ENC_SYM_EERROR;
+  bool owned = argn == 3 && !lbm_is_symbol_nil(args[2]);
+
+  if (owned) {
+    uint8_t *buf = lbm_malloc(n);
+    if (!buf) return ENC_SYM_MERROR;
+    memcpy(buf, event_source, n);
+    if (!lbm_event_array(args[0], buf, n)) {
+      lbm_free(buf);
+      return ENC_SYM_NIL;
+    }
+  } else {
+    lbm_flat_value_t v;
+    if (!lbm_start_flatten(&v, n + 20)) return ENC_SYM_MERROR;
+    f_cons(&v);
+    f_sym(&v, lbm_dec_sym(args[0]));
+    f_lbm_array(&v, (uint32_t)n, event_source);
+    lbm_finish_flatten(&v);
+    if (!lbm_event(&v)) {
+      lbm_free(v.buf);
+      return ENC_SYM_NIL;
+    }
+  }
+  return ENC_SYM_TRUE;
+}
 
 static bool allow_print = true;
 void set_allow_print(bool on) {
   allow_print = on;
 }
 
+static bool print_chunk(const char *data, unsigned int len, void *arg) {
+  (void) arg;
+  lbm_printf_callback("%.*s", (int)len, data);
+  return true;
+}
+
 lbm_value ext_print(lbm_value *args, lbm_uint argn) {
   if (argn < 1) return lbm_enc_sym(SYM_NIL);
 
   if (!allow_print) return lbm_enc_sym(SYM_TRUE);
 
-  char output[1024];
-
   for (unsigned int i = 0; i < argn; i ++) {
     lbm_value t = args[i];
 
@@ -198,8 +243,9 @@ lbm_value ext_print(lbm_value *args, lbm_uint argn) {
       char *data = (char*)array->data;
       lbm_printf_callback("%s", data);
     } else {
-      lbm_print_value(output, 1024, t);
-      lbm_printf_callback("%s", output);
+      if (lbm_print_value_stream(t, REPL_PRINT_MAX_LEN, print_chunk, NULL) < 0) {
+        lbm_printf_callback("...");
+      }
     }
   }
   lbm_printf_callback("\n");
@@ -838,6 +884,23 @@ lbm_value ext_image_save(lbm_value *args, lbm_uint argn) {
   return r ? ENC_SYM_TRUE : ENC_SYM_NIL;
 }
 
+// Appends the bindings that changed since the last save. The extension
+// table is not saved again, extensions added since the last image-save
+// need a full image-save.
+lbm_value ext_image_save_incremental(lbm_value *args, lbm_uint argn) {
+  (void) args;
+  (void) argn;
+  bool r = lbm_image_save_global_env_incremental();
+  r = r && lbm_image_save_constant_heap_ix();
+  return r ? ENC_SYM_TRUE : ENC_SYM_NIL;
+}
+
+lbm_value ext_image_reclaimable(lbm_value *args, lbm_uint argn) {
+  (void) args;
+  (void) argn;
+  return lbm_enc_u32(lbm_image_reclaimable());
+}
+
 lbm_value ext_image_save_const_heap_ix(lbm_value *args, lbm_uint argn) {
   (void) args;
   (void) argn;
@@ -882,6 +945,8 @@ int init_exts(void) {
   lbm_dyn_lib_init();
   lbm_ttf_extensions_init();
   lbm_random_extensions_init();
+  lbm_bytecode_extensions_init();
+  lbm_hashmap_extensions_init();
 
   //lbm_value sym_seek_set;
   //lbm_value sym_seek_cur;
@@ -918,10 +983,13 @@ int init_exts(void) {
   lbm_add_extension("print", ext_print);
   lbm_add_extension("systime", ext_systime);
   lbm_add_extension("secs-since", ext_secs_since);
+  lbm_add_extension("event-byte-array", ext_event_byte_array);
 
   // boot images, snapshots, workspaces....
   lbm_add_extension("image-save-const-heap-ix", ext_image_save_const_heap_ix);
   lbm_add_extension("image-save", ext_image_save);
+  lbm_add_extension("image-save-incremental", ext_image_save_incremental);
+  lbm_add_extension("image-reclaimable", ext_image_reclaimable);
   // Math
   lbm_add_extension("rand", ext_rand);
   lbm_add_extension("rand-max", ext_rand_max);
@@ -24,6 +24,9 @@
 #include "extensions/math_extensions.h"
 #include "extensions/runtime_extensions.h"
 
+// Longest value printed by the REPL. Longer, or cyclic, values are cut
+// off and end with "..." instead.
+#define REPL_PRINT_MAX_LEN (128 * 1024)
 
 int init_exts(void);
 
@@ -0,0 +1,13 @@
+
+;; Load every definition of the dynamic library so that the global
+;; environment can be stored as the precompiled library.
+;; Used by "make dyn_lib_flat".
+
+(list defun defunret defmacro
+      loopfor loopwhile looprange loopforeach loopwhile-thd
+      defstruct)
+
+(list str-merge iota foldl foldr zipwith zip filter
+      str-cmp-asc str-cmp-dsc second third abs
+      create-struct is-struct accessor-sym access-set
+      list-to-array array-to-list array?)
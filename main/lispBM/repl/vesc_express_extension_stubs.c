@@ -723,6 +723,13 @@ static lbm_value ext_log_send_f64(lbm_value *args, lbm_uint argn) {
   return lbm_enc_sym(SYM_EERROR);
 }
 
+static lbm_value ext_log_send_packed(lbm_value *args, lbm_uint argn) {
+  (void)args;
+  (void)argn;
+  // TODO: Implement ext_log_send_packed
+  return lbm_enc_sym(SYM_EERROR);
+}
+
 static lbm_value ext_gnss_lat_lon(lbm_value *args, lbm_uint argn) {
   (void)args;
   (void)argn;
@@ -1199,6 +1206,20 @@ static lbm_value ext_zip_ls(lbm_value *args, lbm_uint argn) {
   return lbm_enc_sym(SYM_EERROR);
 }
 
+static lbm_value ext_zip(lbm_value *args, lbm_uint argn) {
+  (void)args;
+  (void)argn;
+  // TODO: Implement ext_zip
+  return lbm_enc_sym(SYM_EERROR);
+}
+
+static lbm_value ext_gzip(lbm_value *args, lbm_uint argn) {
+  (void)args;
+  (void)argn;
+  // TODO: Implement ext_gzip
+  return lbm_enc_sym(SYM_EERROR);
+}
+
 static lbm_value ext_connected_wifi(lbm_value *args, lbm_uint argn) {
   (void)args;
   (void)argn;
@@ -1431,6 +1452,7 @@ void load_vesc_express_extensions(void) {
     lbm_add_extension("log-config-field", ext_log_config_field);
     lbm_add_extension("log-send-f32", ext_log_send_f32);
     lbm_add_extension("log-send-f64", ext_log_send_f64);
+    lbm_add_extension("log-send-packed", ext_log_send_packed);
     lbm_add_extension("gnss-lat-lon", ext_gnss_lat_lon);
     lbm_add_extension("gnss-height", ext_gnss_height);
     lbm_add_extension("gnss-speed", ext_gnss_speed);
@@ -1499,6 +1521,8 @@ void load_vesc_express_extensions(void) {
     lbm_add_extension("pwm-set-duty", ext_pwm_set_duty);
     lbm_add_extension("unzip", ext_unzip);
     lbm_add_extension("zip-ls", ext_zip_ls);
+    lbm_add_extension("zip", ext_zip);
+    lbm_add_extension("gzip", ext_gzip);
     lbm_add_extension("connected-wifi", ext_connected_wifi);
     lbm_add_extension("connected-hub", ext_connected_hub);
     lbm_add_extension("connected-ble", ext_connected_ble);
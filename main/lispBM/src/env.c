@@ -24,18 +24,72 @@
 #include "env.h"
 #include "lbm_memory.h"
 
-static lbm_value env_global[GLOBAL_ENV_ROOTS];
+static lbm_value env_global_initial[GLOBAL_ENV_ROOTS];
+static lbm_value *env_global = env_global_initial;
+static lbm_uint env_global_roots = GLOBAL_ENV_ROOTS;
+static lbm_uint env_global_mask = GLOBAL_ENV_ROOTS - 1;
+// Bindings added since the last count. Bindings dropped through a
+// bucket pointer are not seen here, so the exact number is counted
+// before deciding to grow.
+static lbm_uint env_global_added = 0;
+static lbm_uint env_global_grow_at = GLOBAL_ENV_ROOTS * GLOBAL_ENV_LOAD_FACTOR + 1;
+
+// Bindings changed since the last image save, one bit per runtime
+// symbol id. When a bucket is replaced wholesale every binding counts
+// as changed. env_removed records that a binding may have been removed,
+// so that an image save looks for bindings the image still holds.
+static uint32_t env_dirty[GLOBAL_ENV_DIRTY_BITS / 32];
+static bool env_all_dirty = false;
+static bool env_removed = false;
 
 bool lbm_init_env(void) {
+  // lbm_memory is reinitialized together with the environment, so a
+  // grown table is not freed here.
+  env_global = env_global_initial;
+  env_global_roots = GLOBAL_ENV_ROOTS;
+  env_global_mask = GLOBAL_ENV_ROOTS - 1;
+  env_global_added = 0;
+  env_global_grow_at = GLOBAL_ENV_ROOTS * GLOBAL_ENV_LOAD_FACTOR + 1;
   for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
     env_global[i] = ENC_SYM_NIL;
   }
+  lbm_global_env_clear_dirty();
   return true;
 }
 
+void lbm_global_env_mark_dirty(lbm_value key) {
+  lbm_uint id = lbm_dec_sym(key) - RUNTIME_SYMBOLS_START;
+  if (id < GLOBAL_ENV_DIRTY_BITS) {
+    env_dirty[id / 32] |= (uint32_t)1 << (id % 32);
+  }
+}
+
+void lbm_global_env_mark_all_dirty(void) {
+  env_all_dirty = true;
+  env_removed = true;
+}
+
+bool lbm_global_env_is_dirty(lbm_value key) {
+  lbm_uint id = lbm_dec_sym(key) - RUNTIME_SYMBOLS_START;
+  if (env_all_dirty || id >= GLOBAL_ENV_DIRTY_BITS) return true;
+  return (env_dirty[id / 32] >> (id % 32)) & 1;
+}
+
+bool lbm_global_env_has_removed(void) {
+  return env_removed;
+}
+
+void lbm_global_env_clear_dirty(void) {
+  for (int i = 0; i < GLOBAL_ENV_DIRTY_BITS / 32; i ++) {
+    env_dirty[i] = 0;
+  }
+  env_all_dirty = false;
+  env_removed = false;
+}
+
 lbm_uint lbm_get_global_env_size(void) {
   lbm_uint n = 0;
-  for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+  for (lbm_uint i = 0; i < env_global_roots; i ++) {
     lbm_value curr = env_global[i];
     while (lbm_is_cons(curr)) {
       n++;
@@ -49,6 +103,98 @@ lbm_value *lbm_get_global_env(void) {
   return env_global;
 }
 
+lbm_uint lbm_get_global_env_num_roots(void) {
+  return env_global_roots;
+}
+
+lbm_value *lbm_global_env_bucket(lbm_value sym) {
+  return &env_global[lbm_dec_sym(sym) & env_global_mask];
+}
+
+// Move all bindings into a table with n_roots buckets. The spine cells
+// are relinked, so this only allocates the bucket array. Buckets that
+// were set to constant lists (env-set) cannot be relinked, and then the
+// table keeps its size.
+static bool env_global_resize(lbm_uint n_roots) {
+  for (lbm_uint i = 0; i < env_global_roots; i ++) {
+    lbm_value curr = env_global[i];
+    while (lbm_is_cons(curr)) {
+      if (!lbm_is_cons_rw(curr)) return false;
+      curr = lbm_cdr(curr);
+    }
+  }
+
+  lbm_value *new_env = (lbm_value*)lbm_malloc(n_roots * sizeof(lbm_value));
+  if (!new_env) return false;
+  for (lbm_uint i = 0; i < n_roots; i ++) {
+    new_env[i] = ENC_SYM_NIL;
+  }
+
+  lbm_uint new_mask = n_roots - 1;
+  for (lbm_uint i = 0; i < env_global_roots; i ++) {
+    lbm_value curr = env_global[i];
+    while (lbm_is_cons(curr)) {
+      lbm_value next = lbm_cdr(curr);
+      lbm_uint ix = lbm_dec_sym(lbm_caar(curr)) & new_mask;
+      lbm_set_cdr(curr, new_env[ix]);
+      new_env[ix] = curr;
+      curr = next;
+    }
+  }
+
+  if (env_global != env_global_initial) {
+    lbm_free(env_global);
+  }
+  env_global = new_env;
+  env_global_roots = n_roots;
+  env_global_mask = new_mask;
+  return true;
+}
+
+static void env_global_maybe_grow(void) {
+  lbm_uint n = lbm_get_global_env_size();
+  env_global_added = 0;
+  lbm_uint roots = env_global_roots;
+  while (n > roots * GLOBAL_ENV_LOAD_FACTOR && roots < GLOBAL_ENV_MAX_ROOTS) {
+    roots *= 2;
+  }
+  if (roots != env_global_roots && !env_global_resize(roots)) {
+    // Out of memory, try again after as many new bindings again.
+    env_global_grow_at = n;
+    return;
+  }
+  lbm_uint limit = env_global_roots * GLOBAL_ENV_LOAD_FACTOR;
+  if (limit >= n) {
+    env_global_grow_at = limit - n + 1;
+  } else {
+    // At GLOBAL_ENV_MAX_ROOTS, recount after as many new bindings again.
+    env_global_grow_at = n;
+  }
+}
+
+lbm_value lbm_global_env_set(lbm_value key, lbm_value val) {
+  lbm_value *bucket = lbm_global_env_bucket(key);
+  lbm_value orig_env = *bucket;
+  lbm_value old;
+  // Setting a binding to the value it already has leaves it clean.
+  if (lbm_env_lookup_b(&old, key, orig_env) && old == val) {
+    return ENC_SYM_TRUE;
+  }
+  lbm_value new_env = lbm_env_set(orig_env, key, val);
+  if (lbm_is_symbol(new_env)) {
+    return new_env;
+  }
+  *bucket = new_env;
+  lbm_global_env_mark_dirty(key);
+  if (new_env != orig_env) {
+    env_global_added ++;
+    if (env_global_added >= env_global_grow_at) {
+      env_global_maybe_grow();
+    }
+  }
+  return ENC_SYM_TRUE;
+}
+
 // Copy the list structure of an environment.
 lbm_value lbm_env_copy_spine(lbm_value env) {
 
@@ -89,20 +235,55 @@ bool lbm_env_lookup_b(lbm_value *res, lbm_value sym, lbm_value env) {
   return false;
 }
 
-bool lbm_global_env_lookup(lbm_value *res, lbm_value sym) {
+// Unflatten a binding that was left in the image at boot. GC cannot
+// run here, so when the heap is full the placeholder is returned and
+// eval_symbol retries after GC.
+static lbm_value env_image_binding(lbm_value c, lbm_value v) {
+  lbm_value val = lbm_image_binding_value(lbm_ref_cell(c)->car, v);
+  if (lbm_is_symbol(val)) return v;
+  if (lbm_is_cons_rw(c)) {
+    lbm_ref_cell(c)->cdr = val;
+  }
+  return val;
+}
+
+int lbm_global_env_find(lbm_value *res, lbm_value sym) {
   lbm_uint dec_sym = lbm_dec_sym(sym);
-  lbm_uint ix = dec_sym & GLOBAL_ENV_MASK;
+  lbm_uint ix = dec_sym & env_global_mask;
   lbm_value curr = env_global[ix];
 
   while (lbm_is_ptr(curr)) {
     lbm_value c = lbm_ref_cell(curr)->car;
     if ((lbm_ref_cell(c)->car) == sym) {
-      *res = lbm_ref_cell(c)->cdr;
-      return true;
+      lbm_value v = lbm_ref_cell(c)->cdr;
+      if (lbm_image_is_binding(v)) {
+        v = env_image_binding(c, v);
+        if (lbm_image_is_binding(v)) return GLOBAL_ENV_NO_MEM;
+      }
+      *res = v;
+      return GLOBAL_ENV_FOUND;
     }
     curr = lbm_ref_cell(curr)->cdr;
   }
-  return false;
+  return GLOBAL_ENV_NOT_FOUND;
+}
+
+bool lbm_global_env_lookup(lbm_value *res, lbm_value sym) {
+  return lbm_global_env_find(res, sym) == GLOBAL_ENV_FOUND;
+}
+
+bool lbm_global_env_unflatten_bucket(lbm_uint ix) {
+  lbm_value curr = env_global[ix & env_global_mask];
+  bool r = true;
+  while (lbm_is_cons(curr)) {
+    lbm_value c = lbm_ref_cell(curr)->car;
+    if (lbm_image_is_binding(lbm_ref_cell(c)->cdr) &&
+        lbm_image_is_binding(env_image_binding(c, lbm_ref_cell(c)->cdr))) {
+      r = false;
+    }
+    curr = lbm_ref_cell(curr)->cdr;
+  }
+  return r;
 }
 
 // TODO: env set should ideally copy environment if it has to update
@@ -160,6 +341,7 @@ lbm_value lbm_env_drop_binding(lbm_value env, lbm_value key) {
   lbm_value curr = env;
   // If key is first in env
   if (lbm_caar(curr) == key) {
+    env_removed = true;
     return lbm_cdr(curr);
   }
 
@@ -168,6 +350,7 @@ lbm_value lbm_env_drop_binding(lbm_value env, lbm_value key) {
 
   while (lbm_type_of(curr) == LBM_TYPE_CONS) {
     if (lbm_caar(curr) == key) {
+      env_removed = true;
       lbm_set_cdr(prev, lbm_cdr(curr));
       return env;
     }
@@ -73,6 +73,7 @@
 #include "platform_mutex.h"
 #include "platform_timestamp.h"
 #include "lbm_flat_value.h"
+#include "lbm_prof.h"
 
 #include <setjmp.h>
 #include <stdarg.h>
@@ -145,7 +146,11 @@ static jmp_buf critical_error_jmp_buf;
 #define READ_START_ARRAY           CONTINUATION(49)
 #define READ_APPEND_ARRAY          CONTINUATION(50)
 #define LOOP_ENV_PREP              CONTINUATION(51)
-#define NUM_CONTINUATIONS          52
+#define OPTIMIZE_DEFINE            CONTINUATION(52)
+#define OPTIMIZE_MACRO_DONE        CONTINUATION(53)
+#define PROF_RETURN                CONTINUATION(54)
+#define SORT_ARRAY                 CONTINUATION(55)
+#define NUM_CONTINUATIONS          56
 
 #define FM_NEED_GC       -1
 #define FM_NO_MATCH      -2
@@ -300,7 +305,12 @@ void lbm_request_gc(void) {
    sleep duration possible is 2 * 100us = 200us.
 */
 
-#define EVAL_CPS_DEFAULT_STACK_SIZE 256
+#define EVAL_CPS_DEFAULT_STACK_SIZE 128
+#define EVAL_CPS_DEFAULT_MAX_STACK_SIZE 4096
+// Unless set, a context stack may grow to at most 1/8 of lbm_memory.
+#define EVAL_CPS_MAX_STACK_MEMORY_DIV 8
+// No single evaluation step pushes more than this onto the stack.
+#define EVAL_CPS_STACK_HEADROOM 32
 #define EVAL_TIME_QUOTA 400 // time in used, if time quota
 #define EVAL_CPS_MIN_SLEEP 200
 #define EVAL_STEPS_QUOTA   10
@@ -335,6 +345,12 @@ static bool dynamic_load_nonsense(const char *sym, const char **code) {
   return false;
 }
 
+static bool dynamic_load_flat_nonsense(const char *code, lbm_flat_value_t *fv) {
+  (void) code;
+  (void) fv;
+  return false;
+}
+
 static int printf_nonsense(const char *fmt, ...) {
   (void) fmt;
   return 0;
@@ -353,6 +369,7 @@ static void (*usleep_callback)(uint32_t) = usleep_nonsense;
 static void (*ctx_done_callback)(eval_context_t *) = ctx_done_nonsense;
 int (*lbm_printf_callback)(const char *, ...) = printf_nonsense;
 static bool (*dynamic_load_callback)(const char *, const char **) = dynamic_load_nonsense;
+static bool (*dynamic_load_flat_callback)(const char *, lbm_flat_value_t *) = dynamic_load_flat_nonsense;
 
 void lbm_set_critical_error_callback(void (*fptr)(void)) {
   if (fptr == NULL) critical_error_callback = critical_nonsense;
@@ -379,6 +396,11 @@ void lbm_set_dynamic_load_callback(bool (*fptr)(const char *, const char **)) {
   else  dynamic_load_callback = fptr;
 }
 
+void lbm_set_dynamic_load_flat_callback(bool (*fptr)(const char *, lbm_flat_value_t *)) {
+  if (fptr == NULL) dynamic_load_flat_callback = dynamic_load_flat_nonsense;
+  else  dynamic_load_flat_callback = fptr;
+}
+
 static volatile lbm_event_t *lbm_events = NULL;
 static unsigned int lbm_events_head = 0;
 static unsigned int lbm_events_tail = 0;
@@ -460,6 +482,17 @@ bool lbm_event(lbm_flat_value_t *fv) {
   return false;
 }
 
+bool lbm_event_array(lbm_value tag, uint8_t *buf, lbm_uint len) {
+  if (buf && !lbm_is_ptr(tag)) {
+    if (lbm_event_handler_pid > 0) {
+      if (lbm_mailbox_free_space_for_cid(lbm_event_handler_pid) > lbm_event_queue_item_count()) {
+        return event_internal(LBM_EVENT_FOR_HANDLER_ARRAY, (lbm_uint)tag, (lbm_uint)buf, len);
+      }
+    }
+  }
+  return false;
+}
+
 static bool lbm_event_pop(lbm_event_t *event) {
   mutex_lock(&lbm_events_mutex);
   bool r = false;
@@ -495,6 +528,9 @@ static bool              is_atomic = false;
 // MODES
 static volatile bool lbm_verbose = false;
 static volatile bool lbm_hide_trapped_error = false;
+static volatile bool lbm_define_optimization = false;
+static volatile bool lbm_call_tracking = false;
+static lbm_uint max_stack_size = 0; // 0: derived from the lbm_memory size
 
 void lbm_toggle_verbose(void) {
   lbm_verbose = !lbm_verbose;
@@ -508,6 +544,24 @@ void lbm_set_hide_trapped_error(bool hide) {
   lbm_hide_trapped_error = hide;
 }
 
+void lbm_set_define_optimization(bool enable) {
+  lbm_define_optimization = enable;
+}
+
+void lbm_set_call_tracking(bool enable) {
+  lbm_call_tracking = enable;
+}
+
+void lbm_set_max_stack_size(lbm_uint max_size) {
+  max_stack_size = max_size;
+}
+
+static lbm_uint get_max_stack_size(void) {
+  if (max_stack_size) return max_stack_size;
+  lbm_uint max_size = lbm_memory_num_words() / EVAL_CPS_MAX_STACK_MEMORY_DIV;
+  return max_size < EVAL_CPS_DEFAULT_MAX_STACK_SIZE ? max_size : EVAL_CPS_DEFAULT_MAX_STACK_SIZE;
+}
+
 lbm_cid lbm_get_current_cid(void) {
   lbm_cid cid = -1;
   if (ctx_running)
@@ -846,13 +900,21 @@ void print_environments(char *buf, unsigned int size) {
   lbm_printf_callback("\tCurrent global environment:\n");
   lbm_value *glob_env = lbm_get_global_env();
 
-  for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+  lbm_uint n_roots = lbm_get_global_env_num_roots();
+  for (lbm_uint i = 0; i < n_roots; i ++) {
+    lbm_global_env_unflatten_bucket(i);
     lbm_value curr_g = glob_env[i];;
     while (lbm_type_of(curr_g) == LBM_TYPE_CONS) {
 
       lbm_print_value(buf, (size/2) - 1, lbm_caar(curr_g));
-      lbm_print_value(buf + (size/2),size/2, lbm_cdr(lbm_car(curr_g)));
-      lbm_printf_callback("\t%s = %s\n", buf, buf+(size/2));
+      lbm_value val = lbm_cdr(lbm_car(curr_g));
+      if (lbm_image_is_binding(val)) {
+        // No room on the heap for the value.
+        lbm_printf_callback("\t%s = (in image)\n", buf);
+      } else {
+        lbm_print_value(buf + (size/2),size/2, val);
+        lbm_printf_callback("\t%s = %s\n", buf, buf+(size/2));
+      }
       curr_g = lbm_cdr(curr_g);
     }
   }
@@ -1141,9 +1203,13 @@ static noreturn void error_ctx_base(lbm_value err_val, bool has_at, lbm_value at
 static noreturn void error_ctx_base(lbm_value err_val, bool has_at, lbm_value at, unsigned int row, unsigned int column) {
 #endif
   bool print_trapped = !lbm_hide_trapped_error && (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN);
+  // A failed macro pre-expansion is not an error of the program, the
+  // application is left as is and expanded at run time instead.
+  bool quiet = (lbm_hide_trapped_error &&
+                (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN)) ||
+               (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_MACRO_PREEXPAND);
 
-  if (!(lbm_hide_trapped_error &&
-        (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN))) {
+  if (!quiet) {
     print_error_message(err_val,
                         has_at,
                         at,
@@ -1157,7 +1223,7 @@ static noreturn void error_ctx_base(lbm_value err_val, bool has_at, lbm_value at
                         );
   }
 #ifdef LBM_USE_ERROR_LINENO
-  if (!lbm_hide_trapped_error) {
+  if (!quiet) {
     lbm_printf_callback("eval_cps.c line number: %d\n", line_no);
   }
 #endif
@@ -1349,11 +1415,11 @@ static lbm_cid lbm_create_ctx_parent(lbm_value program, lbm_value env, lbm_uint
     gc();
   }
 #endif
-  if (!lbm_stack_allocate(&ctx->K, stack_size)) {
+  if (!lbm_stack_allocate_growable(&ctx->K, stack_size, get_max_stack_size())) {
     lbm_uint roots[2] = {program, env};
     lbm_gc_mark_roots(roots, 2);
     gc();
-    if (!lbm_stack_allocate(&ctx->K, stack_size)) {
+    if (!lbm_stack_allocate_growable(&ctx->K, stack_size, get_max_stack_size())) {
       lbm_memory_free((lbm_uint*)ctx);
       return -1;
     }
@@ -1429,6 +1495,10 @@ static lbm_cid lbm_create_ctx_parent(lbm_value program, lbm_value env, lbm_uint
   ctx->row0 = -1;
   ctx->row1 = -1;
 
+  ctx->prof_fun = ENC_SYM_NIL;
+  ctx->prof_app = ENC_SYM_NIL;
+  ctx->prof_ext = ENC_SYM_NIL;
+
   ctx->id = cid;
   ctx->parent = parent;
 
@@ -1520,6 +1590,11 @@ bool lbm_unblock_ctx(lbm_cid cid, lbm_flat_value_t *fv) {
   return event_internal(LBM_EVENT_UNBLOCK_CTX, (lbm_uint)cid, (lbm_uint)fv->buf, fv->buf_size);
 }
 
+bool lbm_unblock_ctx_array(lbm_cid cid, uint8_t *buf, lbm_uint len) {
+  if (!buf) return false;
+  return event_internal(LBM_EVENT_UNBLOCK_CTX_ARRAY, (lbm_uint)cid, (lbm_uint)buf, len);
+}
+
 bool lbm_unblock_ctx_r(lbm_cid cid) {
   mutex_lock(&blocking_extension_mutex);
   bool r = false;
@@ -1619,6 +1694,29 @@ static uint32_t lbm_mailbox_free_space_for_cid(lbm_cid cid) {
   return res;
 }
 
+bool lbm_get_stack_usage(lbm_cid cid, lbm_uint *max_used, lbm_uint *size) {
+  eval_context_t *found = NULL;
+
+  mutex_lock(&qmutex);
+
+  found = lookup_ctx_nm(&blocked, cid);
+  if (!found) {
+    found = lookup_ctx_nm(&queue, cid);
+  }
+  if (!found && ctx_running && ctx_running->id == cid) {
+    found = ctx_running;
+  }
+
+  if (found) {
+    *max_used = lbm_get_max_stack(&found->K);
+    *size = found->K.size;
+  }
+
+  mutex_unlock(&qmutex);
+
+  return found != NULL;
+}
+
 /** find_receiver_and_send is used for message passing where
  * the semantics is that the oldest message is dropped if the
  * receiver mailbox is full.
@@ -1757,7 +1855,7 @@ static void mark_context(eval_context_t *ctx, void *arg1, void *arg2) {
   lbm_gc_mark_aux(ctx->K.data, ctx->K.sp);
 }
 
-static int gc(void) {
+static int gc_aux(lbm_uint *aux_data, lbm_uint aux_size) {
   if (ctx_running) {
     ctx_running->state = ctx_running->state | LBM_THREAD_STATE_GC_BIT;
   }
@@ -1768,7 +1866,8 @@ static int gc(void) {
   // The freelist should generally be NIL when GC runs.
   lbm_nil_freelist();
   lbm_value *env = lbm_get_global_env();
-  for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+  lbm_uint n_roots = lbm_get_global_env_num_roots();
+  for (lbm_uint i = 0; i < n_roots; i ++) {
     lbm_gc_mark_env(env[i]);
   }
 
@@ -1783,6 +1882,10 @@ static int gc(void) {
   }
   mutex_unlock(&qmutex);
 
+  if (aux_data) {
+    lbm_gc_mark_aux(aux_data, aux_size);
+  }
+
   int r = lbm_gc_sweep_phase();
   lbm_heap_new_freelist_length();
   lbm_memory_update_min_free();
@@ -1793,20 +1896,42 @@ static int gc(void) {
   return r;
 }
 
+static int gc(void) {
+  return gc_aux(NULL, 0);
+}
+
 int lbm_perform_gc(void) {
   return gc();
 }
 
+int lbm_perform_gc_aux(lbm_uint *aux_data, lbm_uint aux_size) {
+  return gc_aux(aux_data, aux_size);
+}
+
 /****************************************************/
 /* Evaluation functions                             */
 
 
+// Global lookup that runs GC when the heap is too full to unflatten a
+// binding that is still in the image.
+static bool global_lookup(lbm_value *res, lbm_value sym) {
+  int r = lbm_global_env_find(res, sym);
+  if (r == GLOBAL_ENV_NO_MEM) {
+    gc();
+    r = lbm_global_env_find(res, sym);
+    if (r == GLOBAL_ENV_NO_MEM) {
+      ERROR_CTX(ENC_SYM_MERROR);
+    }
+  }
+  return r == GLOBAL_ENV_FOUND;
+}
+
 static void eval_symbol(eval_context_t *ctx) {
   lbm_uint s = lbm_dec_sym(ctx->curr_exp);
   if (s >= RUNTIME_SYMBOLS_START) {
     lbm_value res = ENC_SYM_NIL;
     if (lbm_env_lookup_b(&res, ctx->curr_exp, ctx->curr_env) ||
-        lbm_global_env_lookup(&res, ctx->curr_exp)) {
+        global_lookup(&res, ctx->curr_exp)) {
       ctx->r =  res;
       ctx->app_cont = true;
       return;
@@ -1818,6 +1943,20 @@ static void eval_symbol(eval_context_t *ctx) {
     if (!dynamic_load_callback(sym_str, &code_str)) {
       ERROR_AT_CTX(ENC_SYM_NOT_FOUND, ctx->curr_exp);
     }
+    // A precompiled (flattened) form of the code is the value to bind
+    // and can be installed without running the reader and evaluator.
+    lbm_flat_value_t fv;
+    if (dynamic_load_flat_callback(code_str, &fv)) {
+      lbm_value val;
+      if (!lbm_unflatten_value(&fv, &val)) {
+        ERROR_CTX(val);
+      }
+      lbm_value def;
+      WITH_GC_RMBR_1(def, lbm_global_env_set(ctx->curr_exp, val), val);
+      ctx->r = val;
+      ctx->app_cont = true;
+      return;
+    }
     lbm_value *sptr = stack_reserve(ctx, 3);
     sptr[0] = ctx->curr_exp;
     sptr[1] = ctx->curr_env;
@@ -1950,6 +2089,281 @@ static void eval_call_cc_unsafe(eval_context_t *ctx) {
   ctx->curr_exp = get_cadr(ctx->curr_exp);
 }
 
+/****************************************************/
+/* Pre-expansion and folding of definitions          */
+
+/* With define optimization enabled, the body of a top-level
+ * (define f (lambda ...)) is rewritten before the closure is created:
+ *
+ *  - Applications of global macros are expanded once. Expansion is
+ *    performed against the global environment, by evaluating the macro
+ *    body in the defining context (see cont_optimize_define).
+ *  - Applications of pure fundamentals to literal arguments, such as
+ *    (* 2 3.14), are replaced by their result.
+ *
+ * Quoted data, patterns and binding positions are left untouched, and
+ * a macro name that is bound locally anywhere in the body is not
+ * expanded. The result is an ordinary expression so printing, flatten
+ * and image storage see a normal lambda.
+ */
+#define OPT_MAX_DEPTH       64
+#define OPT_MAX_EXPANSIONS  128
+#define OPT_MAX_FOLD_ARGS   8
+
+typedef struct {
+  eval_context_t *ctx;
+  lbm_value root;
+  lbm_value skip;   // Macro applications that failed to expand.
+  bool expand;
+} opt_state_t;
+
+static bool opt_is_pure_fundamental(lbm_value head) {
+  switch (head) {
+  case ENC_SYM(SYM_ADD):
+  case ENC_SYM(SYM_SUB):
+  case ENC_SYM(SYM_MUL):
+  case ENC_SYM(SYM_DIV):
+  case ENC_SYM(SYM_MOD):
+  case ENC_SYM(SYM_INT_DIV):
+  case ENC_SYM(SYM_EQ):
+  case ENC_SYM(SYM_NOT_EQ):
+  case ENC_SYM(SYM_NUMEQ):
+  case ENC_SYM(SYM_NUM_NOT_EQ):
+  case ENC_SYM(SYM_LT):
+  case ENC_SYM(SYM_GT):
+  case ENC_SYM(SYM_LEQ):
+  case ENC_SYM(SYM_GEQ):
+  case ENC_SYM(SYM_NOT):
+  case ENC_SYM(SYM_TO_I):
+  case ENC_SYM(SYM_TO_I32):
+  case ENC_SYM(SYM_TO_U):
+  case ENC_SYM(SYM_TO_U32):
+  case ENC_SYM(SYM_TO_FLOAT):
+  case ENC_SYM(SYM_TO_I64):
+  case ENC_SYM(SYM_TO_U64):
+  case ENC_SYM(SYM_TO_DOUBLE):
+  case ENC_SYM(SYM_TO_BYTE):
+  case ENC_SYM(SYM_SHL):
+  case ENC_SYM(SYM_SHR):
+  case ENC_SYM(SYM_BITWISE_AND):
+  case ENC_SYM(SYM_BITWISE_OR):
+  case ENC_SYM(SYM_BITWISE_XOR):
+  case ENC_SYM(SYM_BITWISE_NOT):
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Values that evaluate to themselves and cannot be mutated.
+static bool opt_is_literal(lbm_value v) {
+  return lbm_is_number(v) || v == ENC_SYM_TRUE || v == ENC_SYM_NIL;
+}
+
+static bool opt_occurs(lbm_value x, lbm_value sym, int depth) {
+  if (depth > OPT_MAX_DEPTH) return true;
+  while (lbm_is_cons(x)) {
+    if (opt_occurs(get_car(x), sym, depth + 1)) return true;
+    x = get_cdr(x);
+  }
+  return x == sym;
+}
+
+// Conservative check for a local binding of sym anywhere in x.
+static bool opt_binds(lbm_value x, lbm_value sym, int depth) {
+  if (depth > OPT_MAX_DEPTH) return true;
+  if (!lbm_is_cons(x)) return false;
+  lbm_value head = get_car(x);
+  lbm_value rest = get_cdr(x);
+  switch (head) {
+  case ENC_SYM_QUOTE:
+    return false;
+  case ENC_SYM_LAMBDA:
+  case ENC_SYM_MACRO:
+  case ENC_SYM_PROGN_VAR:
+    if (opt_occurs(get_car(rest), sym, depth)) return true;
+    break;
+  case ENC_SYM_LET:
+  case ENC_SYM_LOOP: {
+    lbm_value b = get_car(rest);
+    while (lbm_is_cons(b)) {
+      lbm_value binding = get_car(b);
+      if (lbm_is_cons(binding) ? opt_occurs(get_car(binding), sym, depth) : binding == sym) return true;
+      b = get_cdr(b);
+    }
+  } break;
+  case ENC_SYM_MATCH:
+  case ENC_SYM_RECEIVE:
+  case ENC_SYM_RECEIVE_TIMEOUT:
+    while (lbm_is_cons(rest)) {
+      lbm_value clause = get_car(rest);
+      if (lbm_is_cons(clause) && opt_occurs(get_car(clause), sym, depth)) return true;
+      rest = get_cdr(rest);
+    }
+    break;
+  default:
+    break;
+  }
+  while (lbm_is_cons(x)) {
+    if (opt_binds(get_car(x), sym, depth + 1)) return true;
+    x = get_cdr(x);
+  }
+  return false;
+}
+
+// Copy the cons structure of a macro expansion so that later folding
+// never writes into data shared with the macro definition.
+static lbm_value opt_copy(lbm_value x, int depth, bool *ok) {
+  if (!lbm_is_cons(x)) return x;
+  if (depth > OPT_MAX_DEPTH) {
+    *ok = false;
+    return ENC_SYM_NIL;
+  }
+  lbm_value res = ENC_SYM_NIL;
+  lbm_value last = ENC_SYM_NIL;
+  while (lbm_is_cons(x)) {
+    lbm_value a = opt_copy(get_car(x), depth + 1, ok);
+    if (!*ok) return ENC_SYM_NIL;
+    lbm_value c = lbm_cons(a, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(c)) {
+      *ok = false;
+      return ENC_SYM_NIL;
+    }
+    if (lbm_is_symbol_nil(last)) res = c;
+    else lbm_ref_cell(last)->cdr = c;
+    last = c;
+    x = get_cdr(x);
+  }
+  lbm_ref_cell(last)->cdr = x;
+  return res;
+}
+
+static void opt_fold(opt_state_t *s, lbm_value cell, lbm_value e) {
+  lbm_value args[OPT_MAX_FOLD_ARGS];
+  lbm_uint n = 0;
+  lbm_value a = get_cdr(e);
+  while (lbm_is_cons(a)) {
+    lbm_value v = get_car(a);
+    if (n == OPT_MAX_FOLD_ARGS || !opt_is_literal(v)) return;
+    args[n++] = v;
+    a = get_cdr(a);
+  }
+  if (n == 0) return;
+  // A fundamental may record a reason for an error it returns.
+  // That error never happens at this point, so keep the old reason.
+  const char *reason = s->ctx->error_reason;
+  lbm_value res = fundamental_table[lbm_dec_sym(get_car(e)) - FUNDAMENTAL_SYMBOLS_START](args, n, s->ctx);
+  s->ctx->error_reason = reason;
+  if (opt_is_literal(res)) {
+    lbm_ref_cell(cell)->car = res;
+  }
+}
+
+static lbm_value opt_walk(opt_state_t *s, lbm_value cell, int depth);
+
+static lbm_value opt_walk_list(opt_state_t *s, lbm_value l, int depth) {
+  while (lbm_is_cons(l)) {
+    lbm_value site = opt_walk(s, l, depth);
+    if (!lbm_is_symbol_nil(site)) return site;
+    l = get_cdr(l);
+  }
+  return ENC_SYM_NIL;
+}
+
+// Clauses of match, recv and recv-to. The pattern is not an expression.
+static lbm_value opt_walk_clauses(opt_state_t *s, lbm_value l, int depth) {
+  while (lbm_is_cons(l)) {
+    lbm_value site = opt_walk_list(s, get_cdr(get_car(l)), depth);
+    if (!lbm_is_symbol_nil(site)) return site;
+    l = get_cdr(l);
+  }
+  return ENC_SYM_NIL;
+}
+
+// GC cannot run while walking. A macro that is still in the image and
+// does not fit on the heap is left for the evaluator to expand.
+static bool opt_is_global_macro(lbm_value sym) {
+  lbm_value v;
+  return (lbm_is_symbol(sym) &&
+          lbm_dec_sym(sym) >= RUNTIME_SYMBOLS_START &&
+          lbm_global_env_lookup(&v, sym) &&
+          lbm_is_cons(v) &&
+          get_car(v) == ENC_SYM_MACRO);
+}
+
+// Walk the expression in the car of cell. Fundamental applications are
+// folded in place. Returns the first cell holding an expandable macro
+// application, or nil when there is none left.
+static lbm_value opt_walk(opt_state_t *s, lbm_value cell, int depth) {
+  lbm_value e = get_car(cell);
+  if (!lbm_is_cons(e) || lbm_is_constant(cell) || depth > OPT_MAX_DEPTH) {
+    return ENC_SYM_NIL;
+  }
+  lbm_value head = get_car(e);
+  lbm_value rest = get_cdr(e);
+  lbm_value site;
+  depth++;
+  switch (head) {
+  case ENC_SYM_QUOTE:
+  case ENC_SYM_MACRO:
+  case ENC_SYM_CLOSURE:
+  case ENC_SYM_CONT:
+  case ENC_SYM_CONT_SP:
+    return ENC_SYM_NIL;
+  case ENC_SYM_LAMBDA:
+  case ENC_SYM_PROGN_VAR:
+  case ENC_SYM_SETQ:
+  case ENC_SYM_DEFINE:
+    return opt_walk_list(s, get_cdr(rest), depth);
+  case ENC_SYM_LET:
+  case ENC_SYM_LOOP: {
+    lbm_value b = get_car(rest);
+    while (lbm_is_cons(b)) {
+      lbm_value binding = get_car(b);
+      if (lbm_is_cons(binding)) {
+        site = opt_walk_list(s, get_cdr(binding), depth);
+        if (!lbm_is_symbol_nil(site)) return site;
+      }
+      b = get_cdr(b);
+    }
+    return opt_walk_list(s, get_cdr(rest), depth);
+  }
+  case ENC_SYM_MATCH:
+  case ENC_SYM_RECEIVE_TIMEOUT:
+    site = opt_walk(s, rest, depth);
+    if (!lbm_is_symbol_nil(site)) return site;
+    return opt_walk_clauses(s, get_cdr(rest), depth);
+  case ENC_SYM_RECEIVE:
+    return opt_walk_clauses(s, rest, depth);
+  case ENC_SYM_COND:
+    while (lbm_is_cons(rest)) {
+      site = opt_walk_list(s, get_car(rest), depth);
+      if (!lbm_is_symbol_nil(site)) return site;
+      rest = get_cdr(rest);
+    }
+    return ENC_SYM_NIL;
+  default:
+    break;
+  }
+  if (opt_is_global_macro(head) && !opt_binds(s->root, head, 0)) {
+    // The arguments of a macro are code for the macro to inspect,
+    // they are not rewritten ahead of the expansion.
+    if (!s->expand) return ENC_SYM_NIL;
+    lbm_value sk = s->skip;
+    while (lbm_is_cons(sk)) {
+      if (get_car(sk) == cell) return ENC_SYM_NIL;
+      sk = get_cdr(sk);
+    }
+    return cell;
+  }
+  site = opt_walk_list(s, lbm_is_symbol(head) ? rest : e, depth);
+  if (!lbm_is_symbol_nil(site)) return site;
+  if (opt_is_pure_fundamental(head)) {
+    opt_fold(s, cell, e);
+  }
+  return ENC_SYM_NIL;
+}
+
 // (define sym exp)
 #define KEY 1
 #define VAL 2
@@ -1964,6 +2378,17 @@ static void eval_define(eval_context_t *ctx) {
       sptr[1] = SET_GLOBAL_ENV;
       if (ctx->flags & EVAL_CPS_CONTEXT_FLAG_CONST) {
         stack_reserve(ctx, 1)[0] = MOVE_VAL_TO_FLASH_DISPATCH;
+      } else if (lbm_define_optimization &&
+                 lbm_is_symbol_nil(ctx->curr_env) &&
+                 lbm_is_cons(parts[VAL]) &&
+                 get_car(parts[VAL]) == ENC_SYM_LAMBDA) {
+        lbm_value *optr = stack_reserve(ctx, 4);
+        optr[0] = parts[VAL];
+        optr[1] = ENC_SYM_NIL;
+        optr[2] = lbm_enc_u(OPT_MAX_EXPANSIONS);
+        optr[3] = OPTIMIZE_DEFINE;
+        ctx->app_cont = true;
+        return;
       }
       ctx->curr_exp = parts[VAL];
       return;
@@ -2450,15 +2875,9 @@ static void cont_set_global_env(eval_context_t *ctx){
   lbm_value val = ctx->r;
 
   lbm_value key = ctx->K.data[--ctx->K.sp];
-  lbm_uint dec_key = lbm_dec_sym(key);
-  lbm_uint ix_key  = dec_key & GLOBAL_ENV_MASK;
-  lbm_value *global_env = lbm_get_global_env();
-  lbm_uint orig_env = global_env[ix_key];
-  lbm_value new_env;
+  lbm_value res;
   // A key is a symbol and should not need to be remembered.
-  WITH_GC(new_env, lbm_env_set(orig_env,key,val));
-
-  global_env[ix_key] = new_env;
+  WITH_GC(res, lbm_global_env_set(key,val));
   ctx->r = val;
 
   ctx->app_cont = true;
@@ -2570,9 +2989,14 @@ static lbm_value setup_cont(eval_context_t *ctx, lbm_value args) {
     ERROR_CTX(ENC_SYM_EERROR);
   }
 
+  lbm_array_header_t *arr = assume_array(c);
+  // The continuation may have been captured when the stack was larger.
+  if (!lbm_stack_grow(&ctx->K, arr->size / sizeof(lbm_uint))) {
+    ERROR_CTX(ENC_SYM_STACK_ERROR);
+  }
+
   lbm_stack_clear(&ctx->K);
 
-  lbm_array_header_t *arr = assume_array(c);
   ctx->K.sp = arr->size / sizeof(lbm_uint);
   memcpy(ctx->K.data, arr->data, arr->size);
 
@@ -2693,11 +3117,11 @@ static lbm_value perform_setvar(lbm_value key, lbm_value val, lbm_value env) {
   if (s >= RUNTIME_SYMBOLS_START) {
     lbm_value new_env = lbm_env_modify_binding(env, key, val);
     if (lbm_is_symbol(new_env) && new_env == ENC_SYM_NOT_FOUND) {
-      lbm_uint ix_key = lbm_dec_sym(key) & GLOBAL_ENV_MASK;
-      lbm_value *glob_env = lbm_get_global_env();
-      new_env = lbm_env_modify_binding(glob_env[ix_key], key, val);
+      lbm_value *bucket = lbm_global_env_bucket(key);
+      new_env = lbm_env_modify_binding(*bucket, key, val);
       if (new_env != ENC_SYM_NOT_FOUND) {
-        glob_env[ix_key] = new_env;
+        *bucket = new_env;
+        lbm_global_env_mark_dirty(key);
       }
     }
     if (lbm_is_symbol(new_env) && new_env == ENC_SYM_NOT_FOUND) {
@@ -3120,20 +3544,22 @@ static void apply_reverse(lbm_value *args, lbm_uint nargs, eval_context_t *ctx)
 }
 
 static void apply_flatten(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
-  if (nargs == 1) {
+  if (nargs == 1 || nargs == 2) {
+    // An optional second non-nil argument preserves sharing and cycles.
+    bool sharing = nargs == 2 && args[1] != ENC_SYM_NIL;
 #ifdef LBM_ALWAYS_GC
     gc();
 #endif
-    lbm_value v = flatten_value(args[0]);
+    lbm_value v = sharing ? flatten_value_sharing(args[0]) : flatten_value(args[0]);
     if ( v == ENC_SYM_MERROR) {
       gc();
-      v = flatten_value(args[0]);
+      v = sharing ? flatten_value_sharing(args[0]) : flatten_value(args[0]);
     }
 
     if (lbm_is_symbol(v)) {
       ERROR_AT_CTX(v, ENC_SYM_FLATTEN);
     } else {
-      lbm_stack_drop(&ctx->K, 2);
+      lbm_stack_drop(&ctx->K, nargs+1);
       ctx->r = v;
       ctx->app_cont = true;
     }
@@ -3217,11 +3643,352 @@ static lbm_value cmp_to_clo(lbm_value cmp) {
   return closure;
 }
 
+/****************************************************/
+/* Sorting with a direct comparator                 */
+
+// Comparators that are applied from C instead of through the
+// evaluator. The numerical comparisons are the fundamentals themselves
+// and a closure of the form (lambda (a b) (< (str-cmp a b) 0)) or
+// (lambda (a b) (> (str-cmp a b) 0)), such as str-cmp-asc and
+// str-cmp-dsc from the dynamic library, becomes a strcmp.
+
+static lbm_value sort_str_cmp(lbm_value *args, bool asc) {
+  char *a = lbm_dec_str(args[0]);
+  char *b = lbm_dec_str(args[1]);
+  if (!a || !b) {
+    lbm_set_error_suspect(a ? args[1] : args[0]);
+    return ENC_SYM_TERROR;
+  }
+  int r = strcmp(a, b);
+  return (asc ? r < 0 : r > 0) ? ENC_SYM_TRUE : ENC_SYM_NIL;
+}
+
+static lbm_value sort_str_cmp_asc(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  (void) nargs;
+  (void) ctx;
+  return sort_str_cmp(args, true);
+}
+
+static lbm_value sort_str_cmp_dsc(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  (void) nargs;
+  (void) ctx;
+  return sort_str_cmp(args, false);
+}
+
+static fundamental_fun sort_direct_cmp(lbm_value cmp) {
+  switch (cmp) {
+  case ENC_SYM_LT:
+  case ENC_SYM_GT:
+  case ENC_SYM_LEQ:
+  case ENC_SYM_GEQ:
+    return fundamental_table[lbm_dec_sym(cmp) - FUNDAMENTAL_SYMBOLS_START];
+  default:
+    break;
+  }
+  if (!lbm_is_closure(cmp)) return NULL;
+
+  lbm_value cl[3];
+  extract_n(lbm_cdr(cmp), cl, 3);
+  lbm_value par[3];
+  lbm_value body[4];
+  lbm_value app[4];
+  if (extract_n(cl[CLO_PARAMS], par, 2) != ENC_SYM_NIL ||
+      extract_n(cl[CLO_BODY], body, 3) != ENC_SYM_NIL ||
+      !lbm_is_cons(body[1]) ||
+      extract_n(body[1], app, 3) != ENC_SYM_NIL ||
+      body[2] != lbm_enc_i(0) ||
+      app[1] != par[0] || app[2] != par[1] ||
+      !lbm_is_symbol(par[0]) || !lbm_is_symbol(par[1]) ||
+      par[1] == ENC_SYM_NIL || par[0] == par[1]) {
+    return NULL;
+  }
+  lbm_uint str_cmp_sym;
+  if (!lbm_get_symbol_by_name("str-cmp", &str_cmp_sym) ||
+      app[0] != lbm_enc_sym(str_cmp_sym)) {
+    return NULL;
+  }
+  if (body[0] == ENC_SYM_LT) return sort_str_cmp_asc;
+  if (body[0] == ENC_SYM_GT) return sort_str_cmp_dsc;
+  return NULL;
+}
+
+static bool sort_direct_apply(fundamental_fun cmp, lbm_value a, lbm_value b, lbm_value sym, eval_context_t *ctx) {
+  lbm_value args[2] = {a, b};
+  lbm_value r = cmp(args, 2, ctx);
+  if (lbm_is_error(r)) {
+    ERROR_AT_CTX(r, sym);
+  }
+  return r != ENC_SYM_NIL;
+}
+
+// Merge two lists in place. As in cont_merge_rest, the head of a is
+// taken when the comparator holds and the head of b otherwise.
+static lbm_value sort_list_merge_direct(fundamental_fun cmp, lbm_value a, lbm_value b, lbm_value *last, lbm_value sym, eval_context_t *ctx) {
+  lbm_value head = ENC_SYM_NIL;
+  lbm_value tail = ENC_SYM_NIL;
+  while (lbm_is_cons(a) && lbm_is_cons(b)) {
+    lbm_value next;
+    if (sort_direct_apply(cmp, lbm_car(a), lbm_car(b), sym, ctx)) {
+      next = a;
+      a = lbm_cdr(a);
+    } else {
+      next = b;
+      b = lbm_cdr(b);
+    }
+    if (head == ENC_SYM_NIL) {
+      head = next;
+    } else {
+      lbm_set_cdr(tail, next);
+    }
+    tail = next;
+  }
+  lbm_value rest = lbm_is_cons(a) ? a : b;
+  if (head == ENC_SYM_NIL) {
+    head = rest;
+  } else {
+    lbm_set_cdr(tail, rest);
+  }
+  while (lbm_is_cons(rest)) {
+    tail = rest;
+    rest = lbm_cdr(rest);
+  }
+  *last = tail;
+  return head;
+}
+
+// Cut list after n cells and return the remainder.
+static lbm_value sort_list_split(lbm_value list, lbm_uint n) {
+  lbm_value curr = list;
+  for (lbm_uint i = 1; i < n && lbm_is_cons(curr); i ++) {
+    curr = lbm_cdr(curr);
+  }
+  if (!lbm_is_cons(curr)) return ENC_SYM_NIL;
+  lbm_value rest = lbm_cdr(curr);
+  lbm_set_cdr(curr, ENC_SYM_NIL);
+  return rest;
+}
+
+// Bottom-up merge sort of the cells of a list of length len. Nothing is
+// allocated.
+static lbm_value sort_list_direct(fundamental_fun cmp, lbm_value list, lbm_uint len, eval_context_t *ctx) {
+  for (lbm_uint width = 1; width < len; width *= 2) {
+    lbm_value rest = list;
+    lbm_value head = ENC_SYM_NIL;
+    lbm_value tail = ENC_SYM_NIL;
+    while (lbm_is_cons(rest)) {
+      lbm_value a = rest;
+      lbm_value b = sort_list_split(a, width);
+      rest = sort_list_split(b, width);
+      lbm_value last;
+      lbm_value merged = sort_list_merge_direct(cmp, a, b, &last, ENC_SYM_SORT, ctx);
+      if (head == ENC_SYM_NIL) {
+        head = merged;
+      } else {
+        lbm_set_cdr(tail, merged);
+      }
+      tail = last;
+    }
+    list = head;
+  }
+  return list;
+}
+
+/****************************************************/
+/* Sorting arrays                                   */
+
+// Runs of this length are insertion sorted before they are merged.
+#define SORT_RUN_LENGTH 8
+
+// The sort of an array is a resumable loop that stops at each
+// comparison. A direct comparator is applied in a C loop and a closure
+// is evaluated between the steps by cont_sort_array.
+typedef struct {
+  lbm_value src;  // Array holding the elements of the current pass.
+  lbm_value dst;  // Array the merge pass writes to.
+  lbm_uint n;
+  bool bytes;
+  lbm_uint width; // Length of sorted runs, 0 while insertion sorting.
+  lbm_uint i;     // Element being inserted or start of the runs being merged.
+  lbm_uint j;     // Insertion position or position in the left run.
+  lbm_uint r;     // Position in the right run.
+  lbm_value x;    // Element being inserted.
+} sort_array_t;
+
+static inline lbm_uint sort_elt_size(sort_array_t *s) {
+  return s->bytes ? 1 : sizeof(lbm_value);
+}
+
+// Byte array elements are passed to the comparator as byte values.
+static inline lbm_value sort_get(sort_array_t *s, lbm_value arr, lbm_uint i) {
+  lbm_array_header_t *h = assume_array(arr);
+  if (s->bytes) return lbm_enc_char(((uint8_t*)h->data)[i]);
+  return ((lbm_value*)h->data)[i];
+}
+
+static inline void sort_put(sort_array_t *s, lbm_value arr, lbm_uint i, lbm_value v) {
+  lbm_array_header_t *h = assume_array(arr);
+  if (s->bytes) {
+    ((uint8_t*)h->data)[i] = lbm_dec_char(v);
+  } else {
+    ((lbm_value*)h->data)[i] = v;
+  }
+}
+
+static inline void sort_move(sort_array_t *s, lbm_value dst, lbm_uint di, lbm_value src, lbm_uint si, lbm_uint n) {
+  lbm_array_header_t *dh = assume_array(dst);
+  lbm_array_header_t *sh = assume_array(src);
+  lbm_uint sz = sort_elt_size(s);
+  memmove((uint8_t*)dh->data + di * sz, (uint8_t*)sh->data + si * sz, n * sz);
+}
+
+// Advance the sort. If pending, holds is the outcome of the comparison
+// last returned. Returns true with the next pair to compare in a and b
+// or false when the sorted elements are in s->src.
+static bool sort_array_step(sort_array_t *s, bool pending, bool holds, lbm_value *a, lbm_value *b) {
+  lbm_uint n = s->n;
+  if (s->width == 0) {
+    if (pending) {
+      if (!holds) {
+        sort_move(s, s->src, s->j, s->src, s->j - 1, 1);
+        s->j --;
+        if (s->j > s->i - (s->i % SORT_RUN_LENGTH)) {
+          *a = sort_get(s, s->src, s->j - 1);
+          *b = s->x;
+          return true;
+        }
+      }
+      sort_put(s, s->src, s->j, s->x);
+      s->i ++;
+      pending = false;
+    }
+    while (s->i < n) {
+      if (s->i % SORT_RUN_LENGTH) {
+        s->x = sort_get(s, s->src, s->i);
+        s->j = s->i;
+        *a = sort_get(s, s->src, s->j - 1);
+        *b = s->x;
+        return true;
+      }
+      s->i ++;
+    }
+    s->x = ENC_SYM_NIL;
+    s->width = SORT_RUN_LENGTH;
+    s->i = 0;
+  }
+
+  while (s->width < n) {
+    lbm_uint mid = s->i + s->width < n ? s->i + s->width : n;
+    lbm_uint hi = mid + s->width < n ? mid + s->width : n;
+    if (pending) {
+      lbm_uint k = s->j + s->r - mid;
+      if (holds) {
+        sort_move(s, s->dst, k, s->src, s->j, 1);
+        s->j ++;
+      } else {
+        sort_move(s, s->dst, k, s->src, s->r, 1);
+        s->r ++;
+      }
+      pending = false;
+    } else {
+      s->j = s->i;
+      s->r = mid;
+    }
+    if (s->j < mid && s->r < hi) {
+      *a = sort_get(s, s->src, s->j);
+      *b = sort_get(s, s->src, s->r);
+      return true;
+    }
+    lbm_uint k = s->j + s->r - mid;
+    sort_move(s, s->dst, k, s->src, s->j, mid - s->j);
+    k += mid - s->j;
+    sort_move(s, s->dst, k, s->src, s->r, hi - s->r);
+    s->i = hi;
+    if (s->i >= n) {
+      lbm_value tmp = s->src;
+      s->src = s->dst;
+      s->dst = tmp;
+      s->width *= 2;
+      s->i = 0;
+    }
+  }
+  return false;
+}
+
+static int sort_allocate_array(lbm_value *res, bool bytes, lbm_uint n) {
+  if (bytes) return lbm_heap_allocate_array(res, n);
+  return lbm_heap_allocate_lisp_array(res, n);
+}
+
+// Replace arrs[0] with a copy of the array. A second array for the
+// merge passes goes in arrs[1] if there is more than one run. Both
+// slots must be on the stack.
+static void sort_array_init(sort_array_t *s, lbm_value *arrs) {
+  lbm_array_header_t *h = assume_array(arrs[0]);
+  s->bytes = lbm_is_array_r(arrs[0]);
+  s->n = h->size / sort_elt_size(s);
+  s->width = 0;
+  s->i = 0;
+  s->j = 0;
+  s->r = 0;
+  s->x = ENC_SYM_NIL;
+  s->dst = ENC_SYM_NIL;
+  arrs[1] = ENC_SYM_NIL;
+
+  lbm_value copy;
+  if (!sort_allocate_array(&copy, s->bytes, s->n)) {
+    gc();
+    if (!sort_allocate_array(&copy, s->bytes, s->n)) {
+      ERROR_CTX(ENC_SYM_MERROR);
+    }
+  }
+  h = assume_array(arrs[0]);
+  if (h->size > 0) {
+    memcpy(assume_array(copy)->data, h->data, h->size);
+  }
+  arrs[0] = copy;
+  s->src = copy;
+
+  if (s->n > SORT_RUN_LENGTH) {
+    lbm_value tmp;
+    if (!sort_allocate_array(&tmp, s->bytes, s->n)) {
+      gc();
+      if (!sort_allocate_array(&tmp, s->bytes, s->n)) {
+        ERROR_CTX(ENC_SYM_MERROR);
+      }
+    }
+    arrs[1] = tmp;
+    s->dst = tmp;
+  }
+}
+
+static void sort_array_save(sort_array_t *s, lbm_uint *sptr) {
+  sptr[4] = s->src;
+  sptr[5] = s->dst;
+  sptr[6] = lbm_enc_u(s->width);
+  sptr[7] = lbm_enc_u(s->i);
+  sptr[8] = lbm_enc_u(s->j);
+  sptr[9] = lbm_enc_u(s->r);
+  sptr[10] = s->x;
+}
+
+static void sort_array_load(sort_array_t *s, lbm_uint *sptr) {
+  s->src = sptr[4];
+  s->dst = sptr[5];
+  s->bytes = lbm_is_array_r(s->src);
+  s->n = assume_array(s->src)->size / sort_elt_size(s);
+  s->width = lbm_dec_u(sptr[6]);
+  s->i = lbm_dec_u(sptr[7]);
+  s->j = lbm_dec_u(sptr[8]);
+  s->r = lbm_dec_u(sptr[9]);
+  s->x = sptr[10];
+}
+
 // (merge comparator list1 list2)
 static void apply_merge(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   if (nargs == 3 && lbm_is_list(args[1]) && lbm_is_list(args[2])) {
 
-    if (!lbm_is_closure(args[0])) {
+    fundamental_fun direct = sort_direct_cmp(args[0]);
+    if (!direct && !lbm_is_closure(args[0])) {
       args[0] = cmp_to_clo(args[0]);
     }
 
@@ -3246,6 +4013,13 @@ static void apply_merge(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
       ctx->app_cont = true;
       return;
     }
+    if (direct) {
+      lbm_value last;
+      ctx->r = sort_list_merge_direct(direct, a, b, &last, ENC_SYM_MERGE, ctx);
+      lbm_stack_drop(&ctx->K, 4);
+      ctx->app_cont = true;
+      return;
+    }
 
     args[1] = a; // keep safe by replacing the original on stack.
     args[2] = b;
@@ -3290,11 +4064,83 @@ static void apply_merge(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   ERROR_AT_CTX(ENC_SYM_TERROR, ENC_SYM_MERGE);
 }
 
+// (sort comparator array)
+static void apply_sort_array(lbm_value *args, eval_context_t *ctx) {
+  sort_array_t s;
+  lbm_value a;
+  lbm_value b;
+
+  fundamental_fun direct = sort_direct_cmp(args[0]);
+  if (direct) {
+    args[0] = args[1];
+    sort_array_init(&s, args);
+    bool pending = false;
+    bool holds = false;
+    while (sort_array_step(&s, pending, holds, &a, &b)) {
+      holds = sort_direct_apply(direct, a, b, ENC_SYM_SORT, ctx);
+      pending = true;
+    }
+    ctx->r = s.src;
+    lbm_stack_drop(&ctx->K, 3);
+    ctx->app_cont = true;
+    return;
+  }
+
+  if (!lbm_is_closure(args[0])) {
+    args[0] = cmp_to_clo(args[0]);
+  }
+  lbm_value cl[3]; // Comparator closure
+  extract_n(lbm_cdr(args[0]), cl, 3);
+  if (lbm_list_length(cl[CLO_PARAMS]) != 2) {
+    ERROR_AT_CTX(ENC_SYM_TERROR, ENC_SYM_SORT);
+  }
+  lbm_value arr = args[1];
+
+  lbm_stack_drop(&ctx->K, 3);
+  lbm_uint *sptr = stack_reserve(ctx, 12);
+  sptr[0] = cl[CLO_BODY];
+  sptr[1] = cl[CLO_ENV];
+  sptr[2] = get_car(cl[CLO_PARAMS]);
+  sptr[3] = get_cadr(cl[CLO_PARAMS]);
+  sptr[4] = arr;
+  sptr[5] = ENC_SYM_NIL;
+  sptr[6] = ENC_SYM_NIL;
+  sptr[7] = ENC_SYM_NIL;
+  sptr[8] = ENC_SYM_NIL;
+  sptr[9] = ENC_SYM_NIL;
+  sptr[10] = ENC_SYM_NIL;
+  sptr[11] = SORT_ARRAY;
+  sort_array_init(&s, &sptr[4]);
+
+  if (!sort_array_step(&s, false, false, &a, &b)) {
+    ctx->r = s.src;
+    lbm_stack_drop(&ctx->K, 12);
+    ctx->app_cont = true;
+    return;
+  }
+  // a and b are still elements of the array on the stack.
+  lbm_value new_env0;
+  lbm_value new_env;
+  WITH_GC(new_env0, lbm_env_set(sptr[1], sptr[2], a));
+  WITH_GC_RMBR_1(new_env, lbm_env_set(new_env0, sptr[3], b), new_env0);
+  sptr[1] = new_env;
+  sort_array_save(&s, sptr);
+  ctx->curr_exp = sptr[0];
+  ctx->curr_env = new_env;
+}
+
 // (sort comparator list)
 static void apply_sort(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  // Every byte array is sorted as raw bytes. For a string that includes
+  // its terminating zero.
+  if (nargs == 2 && (lbm_is_array_r(args[1]) || lbm_is_lisp_array_r(args[1]))) {
+    apply_sort_array(args, ctx);
+    return;
+  }
   if (nargs == 2 && lbm_is_list(args[1])) {
 
-    if (!lbm_is_closure(args[0])) {
+    fundamental_fun direct = sort_direct_cmp(args[0]);
+    if (!direct && !lbm_is_closure(args[0])) {
       args[0] = cmp_to_clo(args[0]);
     }
 
@@ -3308,6 +4154,13 @@ static void apply_sort(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
       return;
     }
 
+    if (direct) {
+      ctx->r = sort_list_direct(direct, list_copy, (lbm_uint)len, ctx);
+      lbm_stack_drop(&ctx->K, 3);
+      ctx->app_cont = true;
+      return;
+    }
+
     args[1] = list_copy; // Keep safe, original replaced on stack.
 
     // Take the headmost 2, 1-element sublists.
@@ -3457,6 +4310,20 @@ static const apply_fun fun_table[] =
    apply_apply,
   };
 
+#ifdef LBM_EXTENSION_STATS
+// Each call is timed separately so that a garbage collection between
+// a call that ran out of memory and its retry is not included.
+static lbm_value call_extension(lbm_uint ix, extension_fptr f, lbm_value *args, lbm_uint argn) {
+  uint32_t t0 = lbm_extension_stats_clock();
+  lbm_value res = f(args, argn);
+  lbm_extension_stats_record(ix, lbm_extension_stats_clock() - t0);
+  return res;
+}
+#define CALL_EXTENSION(ix, f, args, argn) call_extension((ix), (f), (args), (argn))
+#else
+#define CALL_EXTENSION(ix, f, args, argn) (f)((args), (argn))
+#endif
+
 /***************************************************/
 /* Application of function that takes arguments    */
 /* passed over the stack.                          */
@@ -3472,10 +4339,13 @@ static void application(eval_context_t *ctx, lbm_value *fun_args, lbm_uint arg_c
 
   switch (fun_kind) {
   case SYMBOL_KIND_EXTENSION: {
-    extension_fptr f = extension_table[SYMBOL_IX(fun_val)].fptr;
+    lbm_uint ext_ix = SYMBOL_IX(fun_val);
+    extension_fptr f = extension_table[ext_ix].fptr;
 
     lbm_value ext_res;
-    WITH_GC(ext_res, f(&fun_args[1], arg_count));
+    if (lbm_call_tracking) ctx->prof_ext = fun;
+    WITH_GC(ext_res, CALL_EXTENSION(ext_ix, f, &fun_args[1], arg_count));
+    ctx->prof_ext = ENC_SYM_NIL;
     if (lbm_is_error(ext_res)) { //Error other than merror
       ERROR_AT_CTX(ext_res, fun);
     }
@@ -3517,6 +4387,55 @@ static void application(eval_context_t *ctx, lbm_value *fun_args, lbm_uint arg_c
   }
 }
 
+/***************************************************/
+/* Call tracking for the profiler                  */
+
+/* While call tracking is enabled, applying a closure through a symbol
+ * places a frame [caller, name, PROF_RETURN] below the argument
+ * evaluation frames. Once the arguments are bound and the body starts,
+ * prof_enter makes name the current function. When the body returns,
+ * cont_prof_return restores the caller. A call in tail position finds
+ * the frame of the current function on top of the stack and reuses it,
+ * so loops do not grow the stack.
+ */
+
+// sptr[0] = environment to evaluate the args in
+// sptr[1] = args list
+static lbm_uint *prof_push_call(eval_context_t *ctx, lbm_uint *sptr) {
+  if (ctx->K.sp >= 4 && sptr[-1] == PROF_RETURN) {
+    sptr[-2] = ctx->prof_app;
+    return sptr;
+  }
+  stack_reserve(ctx, 3);
+  sptr[3] = sptr[0];
+  sptr[4] = sptr[1];
+  sptr[0] = ctx->prof_fun;
+  sptr[1] = ctx->prof_app;
+  sptr[2] = PROF_RETURN;
+  return sptr + 3;
+}
+
+static inline void prof_enter(eval_context_t *ctx) {
+  if (lbm_call_tracking &&
+      ctx->K.sp >= 3 &&
+      ctx->K.data[ctx->K.sp - 1] == PROF_RETURN) {
+    ctx->prof_fun = ctx->K.data[ctx->K.sp - 2];
+  }
+}
+
+// Lets the profiler recognize the frames when sampling a stack.
+const lbm_uint lbm_cont_prof_return = PROF_RETURN;
+
+// cont_prof_return
+//
+// s[sp-2] = name of the caller
+// s[sp-1] = name of the function returning
+static void cont_prof_return(eval_context_t *ctx) {
+  ctx->K.sp -= 2;
+  ctx->prof_fun = ctx->K.data[ctx->K.sp];
+  ctx->app_cont = true;
+}
+
 // cont_cloure_application_args
 //
 // s[sp-5]  = environment to evaluate the args in.
@@ -3557,6 +4476,7 @@ static void cont_closure_application_args(eval_context_t *ctx) {
     lbm_stack_drop(&ctx->K, 5);
     ctx->curr_env = binder;
     ctx->curr_exp = exp;
+    prof_enter(ctx);
   } else if (p_nil) {
     lbm_value rest_binder = allocate_binding(ENC_SYM_REST_ARGS, ENC_SYM_NIL, binder);
     sptr[2] = rest_binder;
@@ -3608,6 +4528,7 @@ static void cont_closure_args_rest(eval_context_t *ctx) {
     lbm_stack_drop(&ctx->K, 5);
     ctx->curr_env = clo_env;
     ctx->curr_exp = exp;
+    prof_enter(ctx);
   } else {
     stack_reserve(ctx,1)[0] = CLOSURE_ARGS_REST;
     sptr[3] = get_cdr(args);
@@ -4013,6 +4934,45 @@ static void cont_merge_rest(eval_context_t *ctx) {
   ctx->curr_env = cmp_env;
 }
 
+// sort_array stack contents
+// s[sp-11] = cmp
+// s[sp-10] = cmp_env
+// s[sp-9]  = par1
+// s[sp-8]  = par2
+// s[sp-7]  = src array
+// s[sp-6]  = dst array
+// s[sp-5]  = width
+// s[sp-4]  = i
+// s[sp-3]  = j
+// s[sp-2]  = r
+// s[sp-1]  = x
+//
+// ctx->r outcome of the comparison
+static void cont_sort_array(eval_context_t *ctx) {
+  lbm_uint *sptr = get_stack_ptr(ctx, 11);
+  sort_array_t s;
+  lbm_value a;
+  lbm_value b;
+  sort_array_load(&s, sptr);
+  if (sort_array_step(&s, true, ctx->r != ENC_SYM_NIL, &a, &b)) {
+    // The parameters are bound in the environment already
+    // and the operations below should never need GC.
+    lbm_value new_env0 = lbm_env_set(sptr[1], sptr[2], a);
+    lbm_value new_env = lbm_env_set(new_env0, sptr[3], b);
+    if (lbm_is_symbol(new_env0) || lbm_is_symbol(new_env)) {
+      ERROR_CTX(ENC_SYM_FATAL_ERROR);
+    }
+    sort_array_save(&s, sptr);
+    stack_reserve(ctx,1)[0] = SORT_ARRAY;
+    ctx->curr_exp = sptr[0];
+    ctx->curr_env = new_env;
+    return;
+  }
+  ctx->r = s.src;
+  lbm_stack_drop(&ctx->K, 11);
+  ctx->app_cont = true;
+}
+
 // merge_layer stack contents
 // s[sp-9] = cmp
 // s[sp-8] = cmp_env
@@ -4609,8 +5569,14 @@ static void cont_read_append_bytearray(eval_context_t *ctx) {
   lbm_array_header_t *arr = assume_array(array);
   if (lbm_is_number(ctx->r)) {
     ((uint8_t*)arr->data)[ix] = (uint8_t)lbm_dec_as_u32(ctx->r);
+    ix ++;
+    // Plain decimal elements that follow are read in bulk.
+    lbm_char_channel_t *chan = lbm_dec_channel(stream);
+    if (chan && ix < size - 1) {
+      ix += tok_bytearray_elements(chan, (uint8_t*)arr->data + ix, (unsigned int)(size - 1 - ix));
+    }
 
-    sptr[2] = lbm_enc_u(ix + 1);
+    sptr[2] = lbm_enc_u(ix);
     lbm_value *rptr = stack_reserve(ctx, 4);
     rptr[0] = READ_APPEND_BYTEARRAY;
     rptr[1] = stream;
@@ -4891,6 +5857,102 @@ static void cont_read_dot_terminate(eval_context_t *ctx) {
   }
 }
 
+// cont_optimize_define
+//
+// sptr[0] = lambda expression being defined
+// sptr[1] = list of macro applications that failed to expand
+// sptr[2] = number of expansions left
+//
+// Folds the body and expands the first macro application found.
+// When nothing is left to expand, the lambda is evaluated as usual.
+static void cont_optimize_define(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 3);
+  opt_state_t s;
+  s.ctx = ctx;
+  s.root = sptr[0];
+  s.skip = sptr[1];
+  lbm_uint budget = lbm_dec_u(sptr[2]);
+  s.expand = budget > 0;
+  lbm_value site = opt_walk_list(&s, get_cdr(get_cdr(s.root)), 0);
+  if (lbm_is_symbol_nil(site)) {
+    lbm_stack_drop(&ctx->K, 3);
+    ctx->curr_exp = s.root;
+    ctx->curr_env = ENC_SYM_NIL;
+    return;
+  }
+  sptr[2] = lbm_enc_u(budget - 1);
+
+  lbm_value app = get_car(site);
+  lbm_value macro = ENC_SYM_NIL;
+  lbm_global_env_lookup(&macro, get_car(app));
+
+  lbm_value retval;
+  WITH_GC(retval, lbm_heap_allocate_list(2));
+  lbm_ref_cell(retval)->car = ENC_SYM_EXIT_OK;
+  lbm_value *rptr = stack_reserve(ctx, 5);
+  rptr[0] = site;
+  rptr[1] = OPTIMIZE_MACRO_DONE;
+  rptr[2] = retval;
+  rptr[3] = ctx->flags;
+  rptr[4] = EXCEPTION_HANDLER;
+  // Errors from here on unroll to the exception handler and leave
+  // the application unexpanded.
+  ctx->flags |= EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN | EVAL_CPS_CONTEXT_FLAG_MACRO_PREEXPAND;
+
+  lbm_value curr_param = get_cadr(macro);
+  lbm_value curr_arg = get_cdr(app);
+  lbm_value expand_env = ENC_SYM_NIL;
+  while (lbm_is_cons(curr_param) &&
+         lbm_is_cons(curr_arg)) {
+    lbm_value entry = cons_with_gc(get_car(curr_param), get_car(curr_arg), expand_env);
+    expand_env = cons_with_gc(entry, expand_env, ENC_SYM_NIL);
+    curr_param = get_cdr(curr_param);
+    curr_arg = get_cdr(curr_arg);
+  }
+#ifdef LBM_USE_MACRO_REST_ARGS
+  if (lbm_is_cons(curr_arg)) {
+    expand_env = allocate_binding(ENC_SYM_REST_ARGS, curr_arg, expand_env);
+  }
+#endif
+  ctx->curr_exp = get_cadr(get_cdr(macro));
+  ctx->curr_env = expand_env;
+}
+
+// cont_optimize_macro_done
+//
+// sptr[0] = lambda expression being defined
+// sptr[1] = list of macro applications that failed to expand
+// sptr[2] = number of expansions left
+// sptr[3] = cell holding the expanded application
+//
+// ctx->r  = (exit-ok expansion) or (exit-error error)
+static void cont_optimize_macro_done(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 4);
+  lbm_value site = sptr[3];
+  bool ok = get_car(ctx->r) == ENC_SYM_EXIT_OK;
+  // A macro that expands into an application of itself is left to be
+  // expanded lazily at run time, expanding it here does not terminate.
+  if (ok && opt_occurs(get_cadr(ctx->r), get_car(get_car(site)), 0)) {
+    ok = false;
+  }
+  if (ok) {
+    lbm_value exp = opt_copy(get_cadr(ctx->r), 0, &ok);
+    if (!ok) {
+      gc();
+      ok = true;
+      exp = opt_copy(get_cadr(ctx->r), 0, &ok);
+    }
+    if (ok) {
+      lbm_ref_cell(site)->car = exp;
+    }
+  }
+  if (!ok) {
+    sptr[1] = cons_with_gc(site, sptr[1], ENC_SYM_NIL);
+  }
+  sptr[3] = OPTIMIZE_DEFINE;
+  ctx->app_cont = true;
+}
+
 static void cont_read_done(eval_context_t *ctx) {
   //lbm_value reader_mode = ctx->K.data[--ctx->K.sp];
   --ctx->K.sp;
@@ -4948,6 +6010,9 @@ static void cont_application_start(eval_context_t *ctx) {
     lbm_value args = (lbm_value)sptr[1];
     switch (lbm_ref_cell(ctx->r)->car) { // Already checked that is_cons
     case ENC_SYM_CLOSURE: {
+      if (lbm_call_tracking) {
+        sptr = prof_push_call(ctx, sptr);
+      }
       lbm_value cl[3];
       extract_n(get_cdr(ctx->r), cl, 3);
       lbm_value arg_env = (lbm_value)sptr[0];
@@ -4970,6 +6035,7 @@ static void cont_application_start(eval_context_t *ctx) {
         lbm_stack_drop(&ctx->K, 6);
         ctx->curr_exp = cl[CLO_BODY];
         ctx->curr_env = cl[CLO_ENV];
+        prof_enter(ctx);
       } else if (p_nil) {
         reserved[1] = get_cdr(args);      // protect cdr(args) from allocate_binding
         ctx->curr_exp = get_car(args);    // protect car(args) from allocate binding
@@ -5045,10 +6111,12 @@ lbm_flash_status request_flash_storage_cell(lbm_value val, lbm_value *res) {
 
 static void cont_move_to_flash(eval_context_t *ctx) {
 
-  lbm_value args = ctx->K.data[--ctx->K.sp];
+  // args stays on the stack while the lookup may run GC.
+  lbm_value args = ctx->K.data[ctx->K.sp - 1];
 
   if (lbm_is_symbol_nil(args)) {
     // Done looping over arguments. return true.
+    ctx->K.sp--;
     ctx->r = ENC_SYM_TRUE;
     ctx->app_cont = true;
     return;
@@ -5058,7 +6126,9 @@ static void cont_move_to_flash(eval_context_t *ctx) {
   get_car_and_cdr(args, &first_arg, &rest);
 
   lbm_value val;
-  if (lbm_is_symbol(first_arg) && lbm_global_env_lookup(&val, first_arg)) {
+  bool found = lbm_is_symbol(first_arg) && global_lookup(&val, first_arg);
+  ctx->K.sp--;
+  if (found) {
     // Prepare to copy the rest of the arguments when done with first.
     lbm_value *rptr = stack_reserve(ctx, 2);
     rptr[0] = rest;
@@ -5609,6 +6679,10 @@ static const cont_fun continuations[NUM_CONTINUATIONS] =
     cont_read_start_array,
     cont_read_append_array,
     cont_loop_env_prep,
+    cont_optimize_define,
+    cont_optimize_macro_done,
+    cont_prof_return,
+    cont_sort_array,
   };
 
 /*********************************************************/
@@ -5651,6 +6725,17 @@ static const evaluator_fun evaluators[] =
 static void evaluation_step(void){
   eval_context_t *ctx = ctx_running;
 
+  // Between steps no pointers into the stack are held, so this is
+  // where the stack is grown, keeping enough free space for one step.
+  if (ctx->K.size - ctx->K.sp < EVAL_CPS_STACK_HEADROOM) {
+    lbm_uint want = ctx->K.sp + EVAL_CPS_STACK_HEADROOM;
+    lbm_stack_grow(&ctx->K, want < ctx->K.max_size ? want : ctx->K.max_size);
+  }
+
+  if (lbm_call_tracking && lbm_prof_calls_pending) {
+    lbm_prof_sample_calls(ctx);
+  }
+
   if (ctx->app_cont) {
     lbm_value k = ctx->K.data[--ctx->K.sp];
     ctx->app_cont = false;
@@ -5678,6 +6763,9 @@ static void evaluation_step(void){
      * At this point head can be anything. It should evaluate
      * into a form that can be applied (closure, symbol, ...) though.
      */
+    if (lbm_call_tracking) {
+      ctx->prof_app = lbm_is_symbol(h) ? h : ENC_SYM_NIL;
+    }
     lbm_value *reserved = stack_reserve(ctx, 3);
     reserved[0] = ctx->curr_env; // INFER: stack_reserve aborts context if error.
     reserved[1] = cell->cdr;
@@ -5716,6 +6804,8 @@ static void apply_apply(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
         evaluators[eval_index](ctx);
         return;
       } else { // lbm_is_symbol(fun)
+        lbm_uint want = ctx->K.sp + lbm_list_length(arg_list) + 1 + EVAL_CPS_STACK_HEADROOM;
+        lbm_stack_grow(&ctx->K, want < ctx->K.max_size ? want : ctx->K.max_size);
         stack_reserve(ctx, 1)[0] = fun;
         size_t arg_count = 0;
         for (lbm_value current = arg_list; lbm_is_cons(current); current = lbm_ref_cell(current)->cdr) {
@@ -5867,15 +6957,9 @@ static void handle_event_unblock_ctx(lbm_cid cid, lbm_value v) {
 }
 
 static void handle_event_define(lbm_value key, lbm_value val) {
-  lbm_uint dec_key = lbm_dec_sym(key);
-  lbm_uint ix_key  = dec_key & GLOBAL_ENV_MASK;
-  lbm_value *global_env = lbm_get_global_env();
-  lbm_uint orig_env = global_env[ix_key];
-  lbm_value new_env;
+  lbm_value res;
   // A key is a symbol and should not need to be remembered.
-  WITH_GC(new_env, lbm_env_set(orig_env,key,val));
-
-  global_env[ix_key] = new_env;
+  WITH_GC(res, lbm_global_env_set(key,val));
 }
 
 static lbm_value get_event_value(lbm_event_t *e) {
@@ -5894,6 +6978,31 @@ static lbm_value get_event_value(lbm_event_t *e) {
   return v;
 }
 
+// The buffer of an array event becomes the data of a byte array as is.
+// If the array cannot be created the buffer is freed and the result
+// is merror.
+static lbm_value get_event_array(lbm_event_t *e, lbm_value tag) {
+  lbm_value v;
+  if (!lbm_lift_array(&v, (char*)e->buf_ptr, e->buf_len)) {
+    gc();
+    if (!lbm_lift_array(&v, (char*)e->buf_ptr, e->buf_len)) {
+      lbm_free((void*)e->buf_ptr);
+      return ENC_SYM_MERROR;
+    }
+  }
+  if (tag != ENC_SYM_NIL) {
+    lbm_value pair = lbm_cons(tag, v);
+    if (lbm_is_symbol_merror(pair)) {
+      lbm_gc_mark_phase(v);
+      gc();
+      pair = lbm_cons(tag, v);
+    }
+    // On failure the array is garbage and its buffer is freed by the GC.
+    v = pair;
+  }
+  return v;
+}
+
 // In a scenario where C is enqueuing events and other LBM threads
 // are sendind mail to event handler concurrently, old events will
 // be dropped as the backpressure mechanism wont detect this scenario.
@@ -5906,15 +7015,22 @@ static void process_events(void) {
 
   lbm_event_t e;
   while (lbm_event_pop(&e)) {
-    lbm_value event_val = get_event_value(&e);
+    lbm_value event_val;
     switch(e.type) {
     case LBM_EVENT_UNBLOCK_CTX:
+      event_val = get_event_value(&e);
+      handle_event_unblock_ctx((lbm_cid)e.parameter, event_val);
+      break;
+    case LBM_EVENT_UNBLOCK_CTX_ARRAY:
+      event_val = get_event_array(&e, ENC_SYM_NIL);
       handle_event_unblock_ctx((lbm_cid)e.parameter, event_val);
       break;
     case LBM_EVENT_DEFINE:
+      event_val = get_event_value(&e);
       handle_event_define((lbm_value)e.parameter, event_val);
       break;
     case LBM_EVENT_FOR_HANDLER:
+      event_val = get_event_value(&e);
       if (lbm_event_handler_pid >= 0) {
         //If multiple events for handler, this is wasteful!
         // TODO: Find the event_handler once and send all mails.
@@ -5922,6 +7038,12 @@ static void process_events(void) {
         lbm_find_receiver_and_send(lbm_event_handler_pid, event_val);
       }
       break;
+    case LBM_EVENT_FOR_HANDLER_ARRAY:
+      event_val = get_event_array(&e, (lbm_value)e.parameter);
+      if (lbm_event_handler_pid >= 0 && !lbm_is_symbol_merror(event_val)) {
+        lbm_find_receiver_and_send(lbm_event_handler_pid, event_val);
+      }
+      break;
     }
   }
 }
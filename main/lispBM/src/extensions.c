@@ -25,6 +25,9 @@
 
 #include "extensions.h"
 #include "lbm_utils.h"
+#ifdef LBM_EXTENSION_STATS
+#include "platform_timestamp.h"
+#endif
 
 static lbm_uint ext_max    = 0;
 static lbm_uint next_extension_ix = 0;
@@ -53,6 +56,7 @@ bool lbm_extensions_init(lbm_extension_t *extension_storage, lbm_uint extension_
 
   next_extension_ix = 0;
   ext_max = (lbm_uint)extension_storage_size;
+  lbm_symrepr_clear_cache();
 
   return true;
 }
@@ -81,6 +85,7 @@ bool lbm_clr_extension(lbm_uint sym_id) {
   }
   extension_table[ext_id].name = NULL;
   extension_table[ext_id].fptr = lbm_extensions_default;
+  lbm_symrepr_clear_cache();
   return true;
 }
 
@@ -123,6 +128,42 @@ bool lbm_add_extension(char *sym_str, extension_fptr ext) {
   return false;
 }
 
+#ifdef LBM_EXTENSION_STATS
+static uint32_t (*stats_clock)(void) = timestamp;
+
+void lbm_set_extension_stats_clock(uint32_t (*clock)(void)) {
+  stats_clock = clock ? clock : timestamp;
+}
+
+uint32_t lbm_extension_stats_clock(void) {
+  return stats_clock();
+}
+
+void lbm_extension_stats_record(lbm_uint ext_ix, uint32_t time) {
+  if (ext_ix >= ext_max) return;
+  lbm_extension_stats_t *s = &extension_table[ext_ix].stats;
+  s->calls ++;
+  s->total_time += time;
+  if (time > s->max_time) s->max_time = time;
+  unsigned int b = 0;
+  while ((time >>= 1) && b < LBM_EXTENSION_STATS_BUCKETS - 1) {
+    b ++;
+  }
+  s->hist[b] ++;
+}
+
+lbm_extension_stats_t *lbm_get_extension_stats(lbm_uint ext_ix) {
+  if (ext_ix >= next_extension_ix) return NULL;
+  return &extension_table[ext_ix].stats;
+}
+
+void lbm_reset_extension_stats(void) {
+  for (lbm_uint i = 0; i < ext_max; i ++) {
+    memset(&extension_table[i].stats, 0, sizeof(lbm_extension_stats_t));
+  }
+}
+#endif
+
 // Helpers for extension developers:
 
 static bool lbm_is_number_all(lbm_value *args, lbm_uint argn) {
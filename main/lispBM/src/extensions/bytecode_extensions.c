@@ -0,0 +1,1187 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Bytecode compiler and VM for a subset of closures.
+
+   (bytecode-compile clo) takes a closure and, if its body only uses
+   the supported subset, returns a new closure with the same parameters
+   and environment where the body is replaced by
+
+     (eval (bytecode-run code consts p0 ... pn))
+
+   code is a byte array and consts a lisp array of the constants and
+   symbols the code refers to. The first constant is the original
+   body. Calling the closure goes through the evaluator as usual: the
+   parameters are bound and bytecode-run is applied as an extension.
+   Inside bytecode-run parameters and let bound variables live in
+   numbered slots and calls to other compiled closures run in the VM
+   without going back to the evaluator. bytecode-run returns its
+   result quoted where needed, so eval just produces the value.
+
+   If the code refers to a global that is no longer defined,
+   bytecode-run returns the original body instead and eval runs it in
+   the evaluator from the start.
+
+   Supported subset:
+   - constants, quote, parameters and let/loop bound variables,
+     setq to those variables and references to global variables.
+   - if, cond with (test expr) clauses, and, or, progn, let and loop.
+   - applications of fundamentals that have no side effects.
+   - applications of extensions.
+   - calls to global functions that are compiled, or to the
+     closure being compiled (for recursion).
+
+   Anything else, for example lambda, call-cc, recv or apply
+   functions such as spawn or sleep, makes bytecode-compile return
+   the closure unchanged.
+
+   Yielding: after BC_YIELD_BUDGET backward jumps and calls the VM
+   saves its frames and stack in a lisp array and returns
+   (eval (bytecode-resume state)). The evaluator can switch to other
+   contexts before it applies bytecode-resume, which continues where
+   the VM stopped. Long loops therefore do not starve other contexts.
+
+   Extensions are applied by the evaluator. The VM yields with
+   (eval (bytecode-resume state (ext 'a0 ... 'an))), so an extension
+   can block the context or raise an error as it does when it is
+   called from interpreted code, and bytecode-resume continues with
+   its result. Calls to globals that are not compiled closures, for
+   example a callee that has been redefined since, are yielded the
+   same way with the quoted value of the global in place of ext.
+   As such calls can have side effects, falling back to the original
+   body after one is an error. If an allocation fails the VM collects
+   garbage with its stack as roots and runs the instruction again. If
+   memory is still short it returns MERROR and the evaluator applies
+   bytecode-run or bytecode-resume again, which starts over from the
+   call or the last yield.
+
+   The VM stack and frames are allocated from lbm_memory for each
+   run and freed when it returns or yields. If the allocation fails
+   the call falls back to the evaluator, and a call that needs more
+   stack or frames than the VM has is applied by the evaluator. Code
+   arrays are not trusted: every instruction checks its operands
+   against the frame, so a code array built by hand can only cause an
+   eval_error.
+*/
+
+#include <lbm_memory.h>
+#include <heap.h>
+#include <eval_cps.h>
+#include <extensions.h>
+#include <fundamental.h>
+#include <env.h>
+#include <lbm_utils.h>
+#include <lbm_constants.h>
+
+#include "extensions/bytecode_extensions.h"
+
+#ifndef BC_MAX_CODE
+#define BC_MAX_CODE    1024
+#endif
+#ifndef BC_MAX_CONSTS
+#define BC_MAX_CONSTS  64
+#endif
+#ifndef BC_MAX_SLOTS
+#define BC_MAX_SLOTS   32
+#endif
+// Calls that need more stack or frames than this run in the evaluator.
+#ifndef BC_STACK_SIZE
+#define BC_STACK_SIZE  128
+#endif
+#ifndef BC_MAX_FRAMES
+#define BC_MAX_FRAMES  32
+#endif
+// Backward jumps and calls before the VM yields to the evaluator.
+#ifndef BC_YIELD_BUDGET
+#define BC_YIELD_BUDGET 256
+#endif
+
+// Code header: number of parameters, number of slots, max operand depth.
+#define BC_HEADER_SIZE 3
+
+typedef enum {
+  BC_NIL,         //                 -> nil
+  BC_TRUE,        //                 -> t
+  BC_INT,         // i8              -> i
+  BC_CONST,       // u8 k            -> consts[k]
+  BC_LOCAL,       // u8 s            -> slot[s]
+  BC_SET_LOCAL,   // u8 s          v -> v, slot[s] = v
+  BC_GLOBAL,      // u8 k            -> value of global consts[k]
+  BC_POP,         //               v ->
+  BC_JMP,         // u16 a
+  BC_JMP_NIL,     // u16 a         v ->        jump if v is nil
+  BC_AND_JMP,     // u16 a         v -> v      jump if v is nil, else pop
+  BC_OR_JMP,      // u16 a         v -> v      jump if v is not nil, else pop
+  BC_FUND,        // u8 f, u8 n  args -> r     fundamental_table[f]
+  BC_ADD,         //             a b -> r
+  BC_SUB,         //             a b -> r
+  BC_LT,          //             a b -> r
+  BC_GT,          //             a b -> r
+  BC_NUM_EQ,      //             a b -> r
+  BC_CALL,        // u8 k, u8 n  args -> r     call global consts[k]
+  BC_TAIL_CALL,   // u8 k, u8 n  args -> r     same, reusing the frame
+  BC_EXT,         // u8 k, u8 n  args -> r     extension consts[k]
+  BC_RET          //               v ->
+} bc_op_t;
+
+static lbm_uint sym_bytecode_run;
+static lbm_uint sym_bytecode_resume;
+
+// ////////////////////////////////////////////////////////////
+// Compiler
+
+typedef struct {
+  uint8_t code[BC_MAX_CODE];
+  lbm_uint pc;
+  lbm_value consts[BC_MAX_CONSTS];
+  lbm_uint n_consts;
+  lbm_value scope[BC_MAX_SLOTS];
+  lbm_uint n_scope;
+  lbm_uint n_slots;
+  int depth;
+  int max_depth;
+  lbm_value clo;
+  lbm_value clo_env;
+  bool ok;
+  bool no_mem; // A global is still in the image and the heap is full.
+} bc_compiler_t;
+
+// The body of a compiled closure is (eval (bytecode-run code consts p0 ... pn))
+static bool is_compiled_closure(lbm_value v, lbm_value *code, lbm_value *consts) {
+  if (!lbm_is_cons(v) || lbm_car(v) != ENC_SYM_CLOSURE) return false;
+  lbm_value body = lbm_car(lbm_cdr(lbm_cdr(v)));
+  if (!lbm_is_cons(body) || lbm_car(body) != ENC_SYM_EVAL) return false;
+  body = lbm_car(lbm_cdr(body));
+  if (!lbm_is_cons(body) || lbm_car(body) != lbm_enc_sym(sym_bytecode_run)) return false;
+  lbm_value rest = lbm_cdr(body);
+  *code = lbm_car(rest);
+  *consts = lbm_car(lbm_cdr(rest));
+  return lbm_is_array_r(*code) && lbm_is_lisp_array_r(*consts);
+}
+
+static void emit(bc_compiler_t *c, uint8_t b) {
+  if (c->pc < BC_MAX_CODE) {
+    c->code[c->pc++] = b;
+  } else {
+    c->ok = false;
+  }
+}
+
+static void emit_u16(bc_compiler_t *c, lbm_uint v) {
+  emit(c, (uint8_t)(v >> 8));
+  emit(c, (uint8_t)v);
+}
+
+static void patch_u16(bc_compiler_t *c, lbm_uint at, lbm_uint v) {
+  if (at + 1 < BC_MAX_CODE) {
+    c->code[at] = (uint8_t)(v >> 8);
+    c->code[at + 1] = (uint8_t)v;
+  }
+}
+
+// Emit a jump with an unknown target, return where to patch it.
+static lbm_uint emit_jump(bc_compiler_t *c, uint8_t op) {
+  emit(c, op);
+  lbm_uint at = c->pc;
+  emit_u16(c, 0);
+  return at;
+}
+
+static void adjust_depth(bc_compiler_t *c, int d) {
+  c->depth += d;
+  if (c->depth > c->max_depth) c->max_depth = c->depth;
+}
+
+static int add_const(bc_compiler_t *c, lbm_value v) {
+  for (lbm_uint i = 0; i < c->n_consts; i ++) {
+    if (c->consts[i] == v) return (int)i;
+  }
+  if (c->n_consts >= BC_MAX_CONSTS) {
+    c->ok = false;
+    return 0;
+  }
+  c->consts[c->n_consts] = v;
+  return (int)c->n_consts++;
+}
+
+static int lookup_local(bc_compiler_t *c, lbm_value sym) {
+  for (int i = (int)c->n_scope - 1; i >= 0; i --) {
+    if (c->scope[i] == sym) return i;
+  }
+  return -1;
+}
+
+static int push_local(bc_compiler_t *c, lbm_value sym) {
+  if (!lbm_is_symbol(sym) || lbm_dec_sym(sym) < RUNTIME_SYMBOLS_START ||
+      c->n_scope >= BC_MAX_SLOTS) {
+    c->ok = false;
+    return 0;
+  }
+  c->scope[c->n_scope] = sym;
+  c->n_scope ++;
+  if (c->n_scope > c->n_slots) c->n_slots = c->n_scope;
+  return (int)c->n_scope - 1;
+}
+
+// Free variables must be globals. Variables captured in the closure
+// environment can be changed with setq from elsewhere, so those are
+// left to the evaluator.
+static bool is_global_ref(bc_compiler_t *c, lbm_value sym) {
+  lbm_value v;
+  if (lbm_dec_sym(sym) < RUNTIME_SYMBOLS_START) return false;
+  if (lbm_env_lookup_b(&v, sym, c->clo_env)) return false;
+  int r = lbm_global_env_find(&v, sym);
+  if (r == GLOBAL_ENV_NO_MEM) c->no_mem = true;
+  return r != GLOBAL_ENV_NOT_FOUND;
+}
+
+static bool is_pure_fundamental(lbm_uint s) {
+  switch (s) {
+  case SYM_PERFORM_GC:
+  case SYM_SET_MAILBOX_SIZE:
+  case SYM_UNDEFINE:
+  case SYM_SET_CAR:
+  case SYM_SET_CDR:
+  case SYM_SET_IX:
+  case SYM_SET_ASSOC:
+  case SYM_REG_EVENT_HANDLER:
+  case SYM_CUSTOM_DESTRUCT:
+  case SYM_DM_CREATE:
+  case SYM_DM_ALLOC:
+    return false;
+  default:
+    return true;
+  }
+}
+
+static void compile_exp(bc_compiler_t *c, lbm_value e, bool tail);
+
+static void compile_const(bc_compiler_t *c, lbm_value v) {
+  if (v == ENC_SYM_NIL) {
+    emit(c, BC_NIL);
+  } else if (v == ENC_SYM_TRUE) {
+    emit(c, BC_TRUE);
+  } else if (lbm_type_of(v) == LBM_TYPE_I &&
+             lbm_dec_i(v) >= -128 && lbm_dec_i(v) <= 127) {
+    emit(c, BC_INT);
+    emit(c, (uint8_t)(int8_t)lbm_dec_i(v));
+  } else {
+    emit(c, BC_CONST);
+    emit(c, (uint8_t)add_const(c, v));
+  }
+  adjust_depth(c, 1);
+}
+
+static void compile_symbol(bc_compiler_t *c, lbm_value sym) {
+  if (lbm_dec_sym(sym) < RUNTIME_SYMBOLS_START) {
+    // Special symbols evaluate to themselves
+    compile_const(c, sym);
+    return;
+  }
+  int slot = lookup_local(c, sym);
+  if (slot >= 0) {
+    emit(c, BC_LOCAL);
+    emit(c, (uint8_t)slot);
+  } else if (is_global_ref(c, sym)) {
+    emit(c, BC_GLOBAL);
+    emit(c, (uint8_t)add_const(c, sym));
+  } else {
+    c->ok = false;
+  }
+  adjust_depth(c, 1);
+}
+
+// (progn e0 ... en)
+static void compile_body(bc_compiler_t *c, lbm_value body, bool tail) {
+  if (!lbm_is_cons(body)) {
+    compile_const(c, ENC_SYM_NIL);
+    return;
+  }
+  while (lbm_is_cons(body) && c->ok) {
+    lbm_value rest = lbm_cdr(body);
+    bool last = !lbm_is_cons(rest);
+    compile_exp(c, lbm_car(body), tail && last);
+    if (!last) {
+      emit(c, BC_POP);
+      adjust_depth(c, -1);
+    }
+    body = rest;
+  }
+}
+
+// Bindings are evaluated in order and can refer to earlier ones.
+static lbm_uint compile_bindings(bc_compiler_t *c, lbm_value binds) {
+  lbm_uint n = 0;
+  while (lbm_is_cons(binds) && c->ok) {
+    lbm_value b = lbm_car(binds);
+    if (!lbm_is_cons(b) || lbm_is_cons(lbm_cdr(lbm_cdr(b)))) {
+      c->ok = false;
+      break;
+    }
+    int slot = push_local(c, lbm_car(b));
+    n ++;
+    compile_exp(c, lbm_car(lbm_cdr(b)), false);
+    emit(c, BC_SET_LOCAL);
+    emit(c, (uint8_t)slot);
+    emit(c, BC_POP);
+    adjust_depth(c, -1);
+    binds = lbm_cdr(binds);
+  }
+  return n;
+}
+
+static void compile_if(bc_compiler_t *c, lbm_value args, bool tail) {
+  compile_exp(c, lbm_car(args), false);
+  lbm_uint to_else = emit_jump(c, BC_JMP_NIL);
+  adjust_depth(c, -1);
+  compile_exp(c, lbm_car(lbm_cdr(args)), tail);
+  lbm_uint to_end = emit_jump(c, BC_JMP);
+  adjust_depth(c, -1);
+  patch_u16(c, to_else, c->pc);
+  lbm_value else_part = lbm_cdr(lbm_cdr(args));
+  if (lbm_is_cons(else_part)) {
+    compile_exp(c, lbm_car(else_part), tail);
+  } else {
+    compile_const(c, ENC_SYM_NIL);
+  }
+  patch_u16(c, to_end, c->pc);
+}
+
+// (cond (c0 e0) ... (cn en))
+// Other clause shapes are a syntax error in the evaluator, so they
+// are left to it.
+static void compile_cond(bc_compiler_t *c, lbm_value clauses, bool tail) {
+  lbm_uint ends[BC_MAX_SLOTS];
+  lbm_uint n_ends = 0;
+  while (lbm_is_cons(clauses) && c->ok) {
+    lbm_value cl = lbm_car(clauses);
+    if (lbm_list_length(cl) != 2 || n_ends >= BC_MAX_SLOTS) {
+      c->ok = false;
+      return;
+    }
+    compile_exp(c, lbm_car(cl), false);
+    lbm_uint next = emit_jump(c, BC_JMP_NIL);
+    adjust_depth(c, -1);
+    compile_exp(c, lbm_car(lbm_cdr(cl)), tail);
+    ends[n_ends++] = emit_jump(c, BC_JMP);
+    adjust_depth(c, -1);
+    patch_u16(c, next, c->pc);
+    clauses = lbm_cdr(clauses);
+  }
+  compile_const(c, ENC_SYM_NIL);
+  for (lbm_uint i = 0; i < n_ends; i ++) {
+    patch_u16(c, ends[i], c->pc);
+  }
+}
+
+// and: value of the last argument or the first nil, t for no arguments
+// or: the first non-nil value, nil for no arguments
+static void compile_and_or(bc_compiler_t *c, lbm_value args, bool is_and) {
+  if (!lbm_is_cons(args)) {
+    compile_const(c, is_and ? ENC_SYM_TRUE : ENC_SYM_NIL);
+    return;
+  }
+  lbm_uint ends[BC_MAX_SLOTS];
+  lbm_uint n_ends = 0;
+  while (lbm_is_cons(args) && c->ok) {
+    compile_exp(c, lbm_car(args), false);
+    args = lbm_cdr(args);
+    if (lbm_is_cons(args)) {
+      if (n_ends >= BC_MAX_SLOTS) {
+        c->ok = false;
+        return;
+      }
+      ends[n_ends++] = emit_jump(c, is_and ? BC_AND_JMP : BC_OR_JMP);
+      adjust_depth(c, -1);
+    }
+  }
+  for (lbm_uint i = 0; i < n_ends; i ++) {
+    patch_u16(c, ends[i], c->pc);
+  }
+}
+
+static void compile_let(bc_compiler_t *c, lbm_value args, bool tail) {
+  lbm_uint scope = c->n_scope;
+  compile_bindings(c, lbm_car(args));
+  compile_exp(c, lbm_car(lbm_cdr(args)), tail);
+  c->n_scope = scope;
+}
+
+// (loop bindings cond body), evaluates to nil
+static void compile_loop(bc_compiler_t *c, lbm_value args) {
+  lbm_uint scope = c->n_scope;
+  compile_bindings(c, lbm_car(args));
+  lbm_uint top = c->pc;
+  compile_exp(c, lbm_car(lbm_cdr(args)), false);
+  lbm_uint to_end = emit_jump(c, BC_JMP_NIL);
+  adjust_depth(c, -1);
+  compile_exp(c, lbm_car(lbm_cdr(lbm_cdr(args))), false);
+  emit(c, BC_POP);
+  adjust_depth(c, -1);
+  emit(c, BC_JMP);
+  emit_u16(c, top);
+  patch_u16(c, to_end, c->pc);
+  compile_const(c, ENC_SYM_NIL);
+  c->n_scope = scope;
+}
+
+static lbm_uint compile_args(bc_compiler_t *c, lbm_value args) {
+  lbm_uint n = 0;
+  while (lbm_is_cons(args) && c->ok) {
+    compile_exp(c, lbm_car(args), false);
+    n ++;
+    args = lbm_cdr(args);
+  }
+  if (n > 255) c->ok = false;
+  return n;
+}
+
+static void compile_application(bc_compiler_t *c, lbm_value fun, lbm_value args, bool tail) {
+  lbm_uint s = lbm_dec_sym(fun);
+
+  if (SYMBOL_KIND(s) == SYMBOL_KIND_FUNDAMENTAL) {
+    if (!is_pure_fundamental(s) || SYMBOL_IX(s) >= fundamental_table_size) {
+      c->ok = false;
+      return;
+    }
+    lbm_uint n = compile_args(c, args);
+    if (n == 2 && (s == SYM_ADD || s == SYM_SUB || s == SYM_LT ||
+                   s == SYM_GT || s == SYM_NUMEQ)) {
+      switch (s) {
+      case SYM_ADD: emit(c, BC_ADD); break;
+      case SYM_SUB: emit(c, BC_SUB); break;
+      case SYM_LT: emit(c, BC_LT); break;
+      case SYM_GT: emit(c, BC_GT); break;
+      default: emit(c, BC_NUM_EQ); break;
+      }
+    } else {
+      emit(c, BC_FUND);
+      emit(c, (uint8_t)SYMBOL_IX(s));
+      emit(c, (uint8_t)n);
+    }
+    adjust_depth(c, 1 - (int)n);
+    return;
+  }
+
+  if (SYMBOL_KIND(s) == SYMBOL_KIND_EXTENSION) {
+    if (!lbm_is_extension(fun)) {
+      c->ok = false;
+      return;
+    }
+    lbm_uint n = compile_args(c, args);
+    emit(c, BC_EXT);
+    emit(c, (uint8_t)add_const(c, fun));
+    emit(c, (uint8_t)n);
+    adjust_depth(c, 1 - (int)n);
+    return;
+  }
+
+  if (s < RUNTIME_SYMBOLS_START || lookup_local(c, fun) >= 0) {
+    c->ok = false;
+    return;
+  }
+
+  // The callee has to be compiled already, or be the closure that
+  // is being compiled now.
+  lbm_value v;
+  lbm_value code, consts;
+  int r = GLOBAL_ENV_NOT_FOUND;
+  if (!lbm_env_lookup_b(&v, fun, c->clo_env)) {
+    r = lbm_global_env_find(&v, fun);
+  }
+  if (r == GLOBAL_ENV_NO_MEM) c->no_mem = true;
+  if (r != GLOBAL_ENV_FOUND ||
+      (v != c->clo && !is_compiled_closure(v, &code, &consts))) {
+    c->ok = false;
+    return;
+  }
+
+  lbm_uint n = compile_args(c, args);
+  emit(c, tail ? BC_TAIL_CALL : BC_CALL);
+  emit(c, (uint8_t)add_const(c, fun));
+  emit(c, (uint8_t)n);
+  adjust_depth(c, 1 - (int)n);
+}
+
+static void compile_exp(bc_compiler_t *c, lbm_value e, bool tail) {
+  if (!c->ok) return;
+
+  if (lbm_is_symbol(e)) {
+    compile_symbol(c, e);
+    return;
+  }
+
+  if (!lbm_is_cons(e)) {
+    compile_const(c, e);
+    return;
+  }
+
+  lbm_value head = lbm_car(e);
+  lbm_value args = lbm_cdr(e);
+
+  if (!lbm_is_symbol(head)) {
+    c->ok = false;
+    return;
+  }
+
+  switch (head) {
+  case ENC_SYM_QUOTE: compile_const(c, lbm_car(args)); break;
+  case ENC_SYM_IF: compile_if(c, args, tail); break;
+  case ENC_SYM_COND: compile_cond(c, args, tail); break;
+  case ENC_SYM_AND: compile_and_or(c, args, true); break;
+  case ENC_SYM_OR: compile_and_or(c, args, false); break;
+  case ENC_SYM_PROGN: compile_body(c, args, tail); break;
+  case ENC_SYM_LET: compile_let(c, args, tail); break;
+  case ENC_SYM(SYM_LOOP): compile_loop(c, args); break;
+  case ENC_SYM_SETQ: {
+    int slot = lookup_local(c, lbm_car(args));
+    if (slot < 0) {
+      c->ok = false;
+      return;
+    }
+    compile_exp(c, lbm_car(lbm_cdr(args)), false);
+    emit(c, BC_SET_LOCAL);
+    emit(c, (uint8_t)slot);
+  } break;
+  default:
+    if (lbm_dec_sym(head) <= SPECIAL_SYMBOLS_END) {
+      // lambda, define, call-cc, recv and other special forms
+      c->ok = false;
+    } else {
+      compile_application(c, head, args, tail);
+    }
+    break;
+  }
+}
+
+static lbm_value bytecode_compile(lbm_value clo) {
+  lbm_value params = lbm_car(lbm_cdr(clo));
+  lbm_value body = lbm_car(lbm_cdr(lbm_cdr(clo)));
+
+  bc_compiler_t *c = (bc_compiler_t*)lbm_malloc(sizeof(bc_compiler_t));
+  if (!c) return ENC_SYM_MERROR;
+  memset(c, 0, sizeof(bc_compiler_t));
+  c->ok = true;
+  c->clo = clo;
+  c->clo_env = lbm_car(lbm_cdr(lbm_cdr(lbm_cdr(clo))));
+  c->pc = BC_HEADER_SIZE;
+  add_const(c, body);
+
+  lbm_uint n_params = 0;
+  lbm_value p = params;
+  while (lbm_is_cons(p) && c->ok) {
+    push_local(c, lbm_car(p));
+    n_params ++;
+    p = lbm_cdr(p);
+  }
+  if (!lbm_is_symbol_nil(p)) c->ok = false;
+
+  compile_exp(c, body, true);
+  emit(c, BC_RET);
+
+  lbm_value res = clo;
+  if (c->ok && c->max_depth < 256) {
+    c->code[0] = (uint8_t)n_params;
+    c->code[1] = (uint8_t)c->n_slots;
+    c->code[2] = (uint8_t)c->max_depth;
+
+    lbm_value code;
+    lbm_value consts;
+    lbm_value run = ENC_SYM_MERROR;
+    if (lbm_heap_allocate_array(&code, c->pc) &&
+        lbm_heap_allocate_lisp_array(&consts, c->n_consts)) {
+      memcpy(lbm_dec_array_rw(code)->data, c->code, c->pc);
+      if (c->n_consts > 0) {
+        lbm_array_header_t *ka = (lbm_array_header_t*)lbm_car(consts);
+        memcpy(ka->data, c->consts, c->n_consts * sizeof(lbm_value));
+      }
+      // (eval (bytecode-run code consts p0 ... pn))
+      run = lbm_cons(consts, params);
+      run = lbm_cons(code, run);
+      run = lbm_cons(lbm_enc_sym(sym_bytecode_run), run);
+      run = lbm_heap_allocate_list_init(2, ENC_SYM_EVAL, run);
+    }
+    res = ENC_SYM_MERROR;
+    if (!lbm_is_symbol_merror(run)) {
+      res = lbm_heap_allocate_list_init(4,
+                                        ENC_SYM_CLOSURE,
+                                        params,
+                                        run,
+                                        c->clo_env);
+    }
+  }
+
+  if (c->no_mem) res = ENC_SYM_MERROR;
+  lbm_free(c);
+  return res;
+}
+
+// ////////////////////////////////////////////////////////////
+// VM
+
+typedef struct {
+  const uint8_t *code;
+  lbm_uint code_size;
+  const lbm_value *consts;
+  lbm_uint n_consts;
+  lbm_uint pc;
+  lbm_value *base;
+} bc_frame_t;
+
+#define BC_FRAME_VALS (2 * BC_MAX_FRAMES)
+
+typedef struct {
+  // The code and consts arrays of each frame followed by the stack,
+  // so that a GC can mark both as one range.
+  lbm_value vals[BC_FRAME_VALS + BC_STACK_SIZE];
+  lbm_value *stack;
+  bc_frame_t frames[BC_MAX_FRAMES];
+  lbm_uint budget;
+  bool full;        // A call did not fit in the stack or frames.
+  bool old_effects; // The evaluator applied a call before the state was saved.
+} bc_vm_t;
+
+// State saved by a yield: [effects, n_frames, frames ..., stack ...]
+// with code, consts, pc and base index for each frame.
+#define BC_STATE_HEADER 2
+#define BC_STATE_FRAME  4
+
+// The VM is allocated for each run and freed when it returns or
+// yields, so it takes no memory while no compiled code runs.
+static bc_vm_t *vm_alloc(void) {
+  bc_vm_t *vm = (bc_vm_t*)lbm_malloc(sizeof(bc_vm_t));
+  if (!vm) return NULL;
+  for (lbm_uint i = 0; i < BC_FRAME_VALS; i ++) {
+    vm->vals[i] = ENC_SYM_NIL;
+  }
+  vm->stack = vm->vals + BC_FRAME_VALS;
+  vm->budget = BC_YIELD_BUDGET;
+  vm->full = false;
+  vm->old_effects = false;
+  return vm;
+}
+
+static void vm_gc(bc_vm_t *vm, lbm_value *sp) {
+  lbm_perform_gc_aux(vm->vals, (lbm_uint)(sp - vm->vals));
+}
+
+// Slots of a frame, followed by at most code[2] operands.
+#define BC_OPS(f) ((f)->base + (f)->code[1])
+
+// Set up frame f for code/consts with its slots at base.
+static bool set_frame(bc_vm_t *vm, bc_frame_t *f, lbm_value code, lbm_value consts, lbm_value *base) {
+  lbm_array_header_t *ca = lbm_dec_array_r(code);
+  lbm_array_header_t *ka = (lbm_array_header_t*)lbm_car(consts);
+  const uint8_t *c = (const uint8_t*)ca->data;
+  if (ca->size <= BC_HEADER_SIZE || c[1] < c[0]) {
+    return false;
+  }
+  if (base + c[1] + c[2] > vm->stack + BC_STACK_SIZE) {
+    vm->full = true;
+    return false;
+  }
+  lbm_uint i = (lbm_uint)(f - vm->frames);
+  vm->vals[2 * i] = code;
+  vm->vals[2 * i + 1] = consts;
+  f->code = c;
+  f->code_size = ca->size;
+  f->consts = (const lbm_value*)ka->data;
+  f->n_consts = ka->size / sizeof(lbm_value);
+  f->pc = BC_HEADER_SIZE;
+  f->base = base;
+  return true;
+}
+
+// A frame for code with its slots at base fits in the stack. Code
+// with a malformed header fits, set_frame reports it.
+static bool frame_fits(bc_vm_t *vm, lbm_value code, lbm_value *base) {
+  lbm_array_header_t *ca = lbm_dec_array_r(code);
+  const uint8_t *c = (const uint8_t*)ca->data;
+  return ca->size <= BC_HEADER_SIZE || base + c[1] + c[2] <= vm->stack + BC_STACK_SIZE;
+}
+
+// Set up frame f for a call with its n arguments at base.
+static bool enter(bc_vm_t *vm, bc_frame_t *f, lbm_value code, lbm_value consts, lbm_value *base, lbm_uint n, lbm_value **sp) {
+  if (!set_frame(vm, f, code, consts, base)) return false;
+  if (f->code[0] != n) {
+    lbm_set_error_reason((char*)lbm_error_str_num_args);
+    return false;
+  }
+  for (lbm_uint i = n; i < f->code[1]; i ++) {
+    base[i] = ENC_SYM_NIL;
+  }
+  *sp = BC_OPS(f);
+  return true;
+}
+
+static lbm_value call_fundamental(lbm_uint f, lbm_value *args, lbm_uint n) {
+  return fundamental_table[f](args, n, lbm_get_current_context());
+}
+
+// Values other than numbers and special symbols are quoted so that
+// eval produces them unchanged.
+static lbm_value quote_value(lbm_value v) {
+  if (lbm_is_cons(v) ||
+      (lbm_is_symbol(v) && lbm_dec_sym(v) >= RUNTIME_SYMBOLS_START)) {
+    return lbm_heap_allocate_list_init(2, ENC_SYM_QUOTE, v);
+  }
+  return v;
+}
+
+// (fun 'a0 ... 'an) for the evaluator to apply.
+static lbm_value call_form(lbm_value fun, lbm_value *args, lbm_uint n) {
+  lbm_value form = lbm_heap_allocate_list(n + 1);
+  if (lbm_is_symbol_merror(form)) return form;
+  lbm_value curr = form;
+  lbm_set_car(curr, fun);
+  for (lbm_uint i = 0; i < n; i ++) {
+    lbm_value a = quote_value(args[i]);
+    if (lbm_is_symbol_merror(a)) return a;
+    curr = lbm_cdr(curr);
+    lbm_set_car(curr, a);
+  }
+  return form;
+}
+
+// Save the VM state in a lisp array and return
+// (eval (bytecode-resume state)) for the evaluator to continue with,
+// or (eval (bytecode-resume state call)) when call is a call for the
+// evaluator to apply first.
+static lbm_value vm_yield(bc_vm_t *vm, bc_frame_t *f, lbm_value *sp, lbm_value call) {
+  lbm_uint n_frames = (lbm_uint)(f - vm->frames) + 1;
+  lbm_uint n_stack = (lbm_uint)(sp - vm->stack);
+  lbm_value state;
+  if (!lbm_heap_allocate_lisp_array(&state, BC_STATE_HEADER + BC_STATE_FRAME * n_frames + n_stack)) {
+    return ENC_SYM_MERROR;
+  }
+  lbm_value res;
+  if (lbm_is_symbol_nil(call)) {
+    res = lbm_heap_allocate_list_init(2, lbm_enc_sym(sym_bytecode_resume), state);
+  } else {
+    res = lbm_heap_allocate_list_init(3, lbm_enc_sym(sym_bytecode_resume), state, call);
+  }
+  if (lbm_is_symbol_merror(res)) return res;
+  res = lbm_heap_allocate_list_init(2, ENC_SYM_EVAL, res);
+  if (lbm_is_symbol_merror(res)) return res;
+
+  lbm_value *d = (lbm_value*)((lbm_array_header_t*)lbm_car(state))->data;
+  bool effects = vm->old_effects || !lbm_is_symbol_nil(call);
+  d[0] = effects ? ENC_SYM_TRUE : ENC_SYM_NIL;
+  d[1] = lbm_enc_u(n_frames);
+  d += BC_STATE_HEADER;
+  for (lbm_uint i = 0; i < n_frames; i ++) {
+    d[0] = vm->vals[2 * i];
+    d[1] = vm->vals[2 * i + 1];
+    d[2] = lbm_enc_u(vm->frames[i].pc);
+    d[3] = lbm_enc_u((lbm_uint)(vm->frames[i].base - vm->stack));
+    d += BC_STATE_FRAME;
+  }
+  memcpy(d, vm->stack, n_stack * sizeof(lbm_value));
+  return res;
+}
+
+#define BC_FAIL(err) do { res = (err); goto bc_done; } while (0)
+#define BC_FALLBACK() do { fallback = true; goto bc_done; } while (0)
+#define BC_MERROR() goto bc_merror
+#define BC_BAD_CODE() do {                              \
+    lbm_set_error_reason("Malformed bytecode");         \
+    BC_FAIL(ENC_SYM_EERROR);                            \
+  } while (0)
+#define BC_CHECK_CODE(n) if (f->pc + (n) > f->code_size) BC_BAD_CODE()
+#define BC_CHECK_SLOT(s) if ((s) >= f->code[1]) BC_BAD_CODE()
+#define BC_CHECK_CONST(k) if ((k) >= f->n_consts) BC_BAD_CODE()
+#define BC_CHECK_STACK(pop, push) if (!stack_ok(f, sp, (pop), (push))) BC_BAD_CODE()
+
+// An instruction that pops pop operands and then pushes push stays
+// within the operands of frame f.
+static inline bool stack_ok(bc_frame_t *f, lbm_value *sp, lbm_uint pop, lbm_uint push) {
+  lbm_uint depth = (lbm_uint)(sp - BC_OPS(f));
+  return depth >= pop && depth - pop + push <= f->code[2];
+}
+
+// Runs until the outermost frame returns, an error, a fallback or a
+// yield. If an allocation fails the heap is collected with the VM
+// stack as roots and the instruction is run again.
+//
+// The operands of a frame are checked to stay between its slots and
+// the depth in its code header, so code arrays built by hand cannot
+// write outside the VM. Calls that need more stack or frames than
+// the VM has are applied by the evaluator.
+static lbm_value vm_run(bc_vm_t *vm, bc_frame_t *f, lbm_value *sp) {
+  lbm_value res = ENC_SYM_NIL;
+  bool fallback = false;
+  bool retry = false;
+  lbm_uint op_pc;
+  lbm_value *op_sp;
+
+  for (;;) {
+    op_pc = f->pc;
+    op_sp = sp;
+    if (vm->budget == 0) {
+      res = vm_yield(vm, f, sp, ENC_SYM_NIL);
+      if (lbm_is_symbol_merror(res)) BC_MERROR();
+      goto bc_done;
+    }
+    BC_CHECK_CODE(1);
+    uint8_t op = f->code[f->pc++];
+    switch (op) {
+    case BC_NIL:
+      BC_CHECK_STACK(0, 1);
+      *sp++ = ENC_SYM_NIL;
+      break;
+    case BC_TRUE:
+      BC_CHECK_STACK(0, 1);
+      *sp++ = ENC_SYM_TRUE;
+      break;
+    case BC_INT:
+      BC_CHECK_CODE(1);
+      BC_CHECK_STACK(0, 1);
+      *sp++ = lbm_enc_i((int8_t)f->code[f->pc++]);
+      break;
+    case BC_CONST: {
+      BC_CHECK_CODE(1);
+      uint8_t k = f->code[f->pc++];
+      BC_CHECK_CONST(k);
+      BC_CHECK_STACK(0, 1);
+      *sp++ = f->consts[k];
+    } break;
+    case BC_LOCAL: {
+      BC_CHECK_CODE(1);
+      uint8_t s = f->code[f->pc++];
+      BC_CHECK_SLOT(s);
+      BC_CHECK_STACK(0, 1);
+      *sp++ = f->base[s];
+    } break;
+    case BC_SET_LOCAL: {
+      BC_CHECK_CODE(1);
+      uint8_t s = f->code[f->pc++];
+      BC_CHECK_SLOT(s);
+      BC_CHECK_STACK(1, 1);
+      f->base[s] = sp[-1];
+    } break;
+    case BC_GLOBAL: {
+      BC_CHECK_CODE(1);
+      uint8_t k = f->code[f->pc++];
+      BC_CHECK_CONST(k);
+      BC_CHECK_STACK(0, 1);
+      int r = lbm_global_env_find(sp, f->consts[k]);
+      if (r == GLOBAL_ENV_NO_MEM) BC_MERROR();
+      if (r != GLOBAL_ENV_FOUND) BC_FALLBACK();
+      sp++;
+    } break;
+    case BC_POP:
+      BC_CHECK_STACK(1, 0);
+      sp--;
+      break;
+    case BC_JMP: {
+      BC_CHECK_CODE(2);
+      lbm_uint to = ((lbm_uint)f->code[f->pc] << 8) | f->code[f->pc + 1];
+      // Backward jumps are loops
+      if (to < f->pc) vm->budget --;
+      f->pc = to;
+    } break;
+    case BC_JMP_NIL:
+      BC_CHECK_CODE(2);
+      BC_CHECK_STACK(1, 0);
+      if (lbm_is_symbol_nil(*--sp)) {
+        f->pc = ((lbm_uint)f->code[f->pc] << 8) | f->code[f->pc + 1];
+      } else {
+        f->pc += 2;
+      }
+      break;
+    case BC_AND_JMP:
+    case BC_OR_JMP:
+      BC_CHECK_CODE(2);
+      BC_CHECK_STACK(1, 1);
+      if (lbm_is_symbol_nil(sp[-1]) == (op == BC_AND_JMP)) {
+        f->pc = ((lbm_uint)f->code[f->pc] << 8) | f->code[f->pc + 1];
+      } else {
+        sp--;
+        f->pc += 2;
+      }
+      break;
+    case BC_FUND: {
+      BC_CHECK_CODE(2);
+      uint8_t fi = f->code[f->pc++];
+      uint8_t n = f->code[f->pc++];
+      if (fi >= fundamental_table_size) BC_BAD_CODE();
+      BC_CHECK_STACK(n, 1);
+      sp -= n;
+      lbm_value r = call_fundamental(fi, sp, n);
+      if (lbm_is_symbol_merror(r)) BC_MERROR();
+      if (lbm_is_error(r)) BC_FAIL(r);
+      *sp++ = r;
+    } break;
+    case BC_ADD:
+    case BC_SUB:
+    case BC_LT:
+    case BC_GT:
+    case BC_NUM_EQ: {
+      BC_CHECK_STACK(2, 1);
+      lbm_value a = sp[-2];
+      lbm_value b = sp[-1];
+      lbm_value r;
+      if (lbm_type_of(a) == LBM_TYPE_I && lbm_type_of(b) == LBM_TYPE_I) {
+        lbm_int x = lbm_dec_i(a);
+        lbm_int y = lbm_dec_i(b);
+        switch (op) {
+        case BC_ADD: r = lbm_enc_i(x + y); break;
+        case BC_SUB: r = lbm_enc_i(x - y); break;
+        case BC_LT: r = x < y ? ENC_SYM_TRUE : ENC_SYM_NIL; break;
+        case BC_GT: r = x > y ? ENC_SYM_TRUE : ENC_SYM_NIL; break;
+        default: r = x == y ? ENC_SYM_TRUE : ENC_SYM_NIL; break;
+        }
+      } else {
+        lbm_uint fi;
+        switch (op) {
+        case BC_ADD: fi = SYMBOL_IX(SYM_ADD); break;
+        case BC_SUB: fi = SYMBOL_IX(SYM_SUB); break;
+        case BC_LT: fi = SYMBOL_IX(SYM_LT); break;
+        case BC_GT: fi = SYMBOL_IX(SYM_GT); break;
+        default: fi = SYMBOL_IX(SYM_NUMEQ); break;
+        }
+        r = call_fundamental(fi, sp - 2, 2);
+        if (lbm_is_symbol_merror(r)) BC_MERROR();
+        if (lbm_is_error(r)) BC_FAIL(r);
+      }
+      sp -= 2;
+      *sp++ = r;
+    } break;
+    case BC_CALL:
+    case BC_TAIL_CALL: {
+      BC_CHECK_CODE(2);
+      uint8_t k = f->code[f->pc++];
+      uint8_t n = f->code[f->pc++];
+      BC_CHECK_CONST(k);
+      BC_CHECK_STACK(n, 1);
+      lbm_value fun;
+      lbm_value fcode, fconsts;
+      int r = lbm_global_env_find(&fun, f->consts[k]);
+      if (r == GLOBAL_ENV_NO_MEM) BC_MERROR();
+      if (r != GLOBAL_ENV_FOUND) BC_FALLBACK();
+      lbm_value *call_args = sp - n;
+      if (!is_compiled_closure(fun, &fcode, &fconsts) ||
+          (op == BC_CALL && f + 1 >= vm->frames + BC_MAX_FRAMES) ||
+          !frame_fits(vm, fcode, op == BC_TAIL_CALL ? f->base : call_args)) {
+        // The evaluator applies callees that are not compiled or do
+        // not fit in the VM, and the VM continues with the result.
+        lbm_value head = quote_value(fun);
+        if (lbm_is_symbol_merror(head)) BC_MERROR();
+        lbm_value call = call_form(head, call_args, n);
+        if (lbm_is_symbol_merror(call)) BC_MERROR();
+        res = vm_yield(vm, f, call_args, call);
+        if (lbm_is_symbol_merror(res)) BC_MERROR();
+        goto bc_done;
+      }
+      if (op == BC_TAIL_CALL) {
+        memmove(f->base, call_args, n * sizeof(lbm_value));
+        call_args = f->base;
+      } else {
+        f++;
+      }
+      if (!enter(vm, f, fcode, fconsts, call_args, n, &sp)) {
+        BC_FAIL(ENC_SYM_EERROR);
+      }
+      vm->budget --;
+    } break;
+    case BC_EXT: {
+      // The evaluator applies the extension, so that it can block
+      // and report errors as usual, and then resumes the VM with
+      // the result.
+      BC_CHECK_CODE(2);
+      uint8_t k = f->code[f->pc++];
+      uint8_t n = f->code[f->pc++];
+      BC_CHECK_CONST(k);
+      if (!lbm_is_extension(f->consts[k])) BC_BAD_CODE();
+      BC_CHECK_STACK(n, 1);
+      sp -= n;
+      lbm_value call = call_form(f->consts[k], sp, n);
+      if (lbm_is_symbol_merror(call)) BC_MERROR();
+      res = vm_yield(vm, f, sp, call);
+      if (lbm_is_symbol_merror(res)) BC_MERROR();
+      goto bc_done;
+    }
+    case BC_RET: {
+      BC_CHECK_STACK(1, 0);
+      lbm_value r = sp[-1];
+      if (f == vm->frames) {
+        r = quote_value(r);
+        if (lbm_is_symbol_merror(r)) BC_MERROR();
+        BC_FAIL(r);
+      }
+      lbm_uint i = (lbm_uint)(f - vm->frames);
+      vm->vals[2 * i] = ENC_SYM_NIL;
+      vm->vals[2 * i + 1] = ENC_SYM_NIL;
+      sp = f->base;
+      *sp++ = r;
+      f--;
+    } break;
+    default:
+      BC_BAD_CODE();
+    }
+    retry = false;
+    continue;
+  bc_merror:
+    // Returning MERROR makes the evaluator collect garbage and apply
+    // bytecode-run or bytecode-resume again. That starts over from
+    // the call or from the last yield, so no extension runs twice.
+    if (retry) BC_FAIL(ENC_SYM_MERROR);
+    retry = true;
+    f->pc = op_pc;
+    sp = op_sp;
+    vm_gc(vm, sp);
+  }
+ bc_done:
+  if (fallback) {
+    if (vm->old_effects) {
+      lbm_set_error_reason("Compiled code cannot fall back to the evaluator after a call it yielded for");
+      return ENC_SYM_EERROR;
+    }
+    // The original body of the outermost compiled closure
+    return vm->frames[0].consts[0];
+  }
+  return res;
+}
+
+static lbm_value bc_execute(lbm_value code, lbm_value consts, lbm_value *args, lbm_uint argn) {
+  lbm_array_header_t *ka = (lbm_array_header_t*)lbm_car(consts);
+  if (ka->size < sizeof(lbm_value)) return ENC_SYM_EERROR;
+  // The original body
+  lbm_value body = ((lbm_value*)ka->data)[0];
+
+  if (argn > BC_STACK_SIZE) return body;
+  bc_vm_t *vm = vm_alloc();
+  if (!vm) return body;
+
+  lbm_value res = ENC_SYM_EERROR;
+  lbm_value *sp;
+  memcpy(vm->stack, args, argn * sizeof(lbm_value));
+  if (enter(vm, vm->frames, code, consts, vm->stack, argn, &sp)) {
+    res = vm_run(vm, vm->frames, sp);
+  } else if (vm->full) {
+    res = body;
+  }
+  lbm_free(vm);
+  return res;
+}
+
+// Restores a state saved by vm_yield, pushes result if there is one
+// and continues. The state is checked as the code is: the frames
+// must nest and every stack pointer must be within its frame.
+static lbm_value bc_resume(lbm_value state, lbm_value *result) {
+  lbm_array_header_t *h = (lbm_array_header_t*)lbm_car(state);
+  lbm_value *d = (lbm_value*)h->data;
+  lbm_uint n = h->size / sizeof(lbm_value);
+  if (n < BC_STATE_HEADER || lbm_type_of(d[1]) != LBM_TYPE_U) return ENC_SYM_TERROR;
+  lbm_uint n_frames = lbm_dec_u(d[1]);
+  if (n_frames == 0 || n_frames > BC_MAX_FRAMES ||
+      n < BC_STATE_HEADER + BC_STATE_FRAME * n_frames ||
+      n - BC_STATE_HEADER - BC_STATE_FRAME * n_frames > BC_STACK_SIZE) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint n_stack = n - BC_STATE_HEADER - BC_STATE_FRAME * n_frames;
+
+  bc_vm_t *vm = vm_alloc();
+  if (!vm) return ENC_SYM_MERROR;
+  vm->old_effects = !lbm_is_symbol_nil(d[0]);
+
+  lbm_value res = ENC_SYM_TERROR;
+  lbm_value *fd = d + BC_STATE_HEADER;
+  lbm_value *sp = vm->stack + n_stack;
+  memcpy(vm->stack, fd + BC_STATE_FRAME * n_frames, n_stack * sizeof(lbm_value));
+  lbm_uint i;
+  for (i = 0; i < n_frames; i ++) {
+    bc_frame_t *f = &vm->frames[i];
+    if (!lbm_is_array_r(fd[0]) || !lbm_is_lisp_array_r(fd[1]) ||
+        lbm_type_of(fd[2]) != LBM_TYPE_U || lbm_type_of(fd[3]) != LBM_TYPE_U ||
+        lbm_dec_u(fd[3]) > n_stack ||
+        !set_frame(vm, f, fd[0], fd[1], vm->stack + lbm_dec_u(fd[3])) ||
+        lbm_dec_u(fd[2]) >= f->code_size) {
+      break;
+    }
+    // A frame returns to the operands of the frame below it.
+    if (i > 0) {
+      bc_frame_t *caller = f - 1;
+      if (f->base < BC_OPS(caller) ||
+          f->base >= BC_OPS(caller) + caller->code[2]) {
+        break;
+      }
+    }
+    f->pc = lbm_dec_u(fd[2]);
+    fd += BC_STATE_FRAME;
+  }
+  if (i == n_frames) {
+    bc_frame_t *f = &vm->frames[n_frames - 1];
+    lbm_uint room = result ? 1 : 0;
+    if (sp >= BC_OPS(f) && sp + room <= BC_OPS(f) + f->code[2]) {
+      if (result) *sp++ = *result;
+      res = vm_run(vm, f, sp);
+    }
+  }
+  lbm_free(vm);
+  return res;
+}
+
+// ////////////////////////////////////////////////////////////
+// Extensions
+
+/* (bytecode-compile clo)
+   Returns a compiled version of clo, or clo itself if its body uses
+   something the compiler does not support. */
+static lbm_value ext_bytecode_compile(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !lbm_is_cons(args[0]) || lbm_car(args[0]) != ENC_SYM_CLOSURE) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_value code, consts;
+  if (is_compiled_closure(args[0], &code, &consts)) {
+    return args[0];
+  }
+  return bytecode_compile(args[0]);
+}
+
+/* (bytecode-run code consts arg0 ... argn) */
+static lbm_value ext_bytecode_run(lbm_value *args, lbm_uint argn) {
+  if (argn < 2 || !lbm_is_array_r(args[0]) || !lbm_is_lisp_array_r(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  return bc_execute(args[0], args[1], &args[2], argn - 2);
+}
+
+/* (bytecode-resume state)
+   (bytecode-resume state result) */
+static lbm_value ext_bytecode_resume(lbm_value *args, lbm_uint argn) {
+  if (argn < 1 || argn > 2 || !lbm_is_lisp_array_r(args[0])) {
+    return ENC_SYM_TERROR;
+  }
+  return bc_resume(args[0], argn == 2 ? &args[1] : NULL);
+}
+
+/* (bytecode-compiled? f) */
+static lbm_value ext_bytecode_is_compiled(lbm_value *args, lbm_uint argn) {
+  LBM_CHECK_ARGN(1);
+  lbm_value code, consts;
+  return is_compiled_closure(args[0], &code, &consts) ? ENC_SYM_TRUE : ENC_SYM_NIL;
+}
+
+void lbm_bytecode_extensions_init(void) {
+  lbm_add_extension("bytecode-compile", ext_bytecode_compile);
+  lbm_add_extension("bytecode-run", ext_bytecode_run);
+  lbm_add_extension("bytecode-resume", ext_bytecode_resume);
+  lbm_add_extension("bytecode-compiled?", ext_bytecode_is_compiled);
+  lbm_get_symbol_by_name("bytecode-run", &sym_bytecode_run);
+  lbm_get_symbol_by_name("bytecode-resume", &sym_bytecode_resume);
+}
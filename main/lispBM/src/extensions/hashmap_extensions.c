@@ -0,0 +1,414 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "extensions/hashmap_extensions.h"
+
+#include "extensions.h"
+#include "fundamental.h"
+#include "lbm_flat_value.h"
+
+#ifdef LBM_OPT_HASHMAP_EXTENSIONS_SIZE
+#pragma GCC optimize ("-Os")
+#endif
+#ifdef LBM_OPT_HASHMAP_EXTENSIONS_SIZE_AGGRESSIVE
+#pragma GCC optimize ("-Oz")
+#endif
+
+// Hash maps and hash sets.
+//
+// A hash map is a lisp array [tag count buckets] where tag is the
+// symbol hashmap or hashset, count is the number of entries and
+// buckets is a lisp array of association lists ((key . val) ...).
+// A hash set is a hash map where every value is t.
+//
+// Building on lisp arrays and lists means that the GC marks the
+// contents and that maps can be flattened, sent in messages and
+// stored in images like any other value.
+//
+// Keys are compared with struct_eq (as eq, assoc and set-insert do)
+// and can be numbers, symbols or byte arrays (strings). Symbols are
+// hashed by id. Flattening a symbol stores its name and the runtime
+// that unflattens it can give that name a different id, so every map
+// that unflatten builds, also when an image binding is loaded, is
+// rehashed before it is used. Maps stored as constants in an image
+// keep their ids, as the image restores the symbol table.
+
+#define HASH_TAG      0
+#define HASH_COUNT    1
+#define HASH_BUCKETS  2
+#define HASH_SIZE     3
+
+#define HASH_DEFAULT_BUCKETS 16
+#define HASH_MAX_BUCKETS     1024
+// Grow the bucket array when the average bucket holds more than
+// this many entries.
+#define HASH_LOAD_FACTOR     2
+
+static lbm_uint sym_hashmap;
+static lbm_uint sym_hashset;
+
+// FNV-1a
+static uint32_t hash_bytes(uint32_t h, const uint8_t *data, lbm_uint n) {
+  for (lbm_uint i = 0; i < n; i ++) {
+    h ^= data[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Keys that are equal under struct_eq hash equally: struct_eq
+// requires equal types and a code for the type is part of the hash.
+// Integers are hashed as 64 bit values so that the hash does not
+// depend on the word size.
+static bool hash_key(lbm_value key, uint32_t *res) {
+  uint8_t code;
+  uint32_t h;
+  switch (lbm_type_of_functional(key)) {
+  case LBM_TYPE_ARRAY: {
+    lbm_array_header_t *arr = lbm_dec_array_r(key);
+    if (!arr) return false;
+    code = 2;
+    h = hash_bytes(2166136261u, &code, 1);
+    *res = hash_bytes(h, (const uint8_t*)arr->data, arr->size);
+    return true;
+  }
+  case LBM_TYPE_FLOAT: {
+    float v = lbm_dec_float(key);
+    if (v == 0.0f) v = 0.0f; // -0.0 == 0.0
+    code = 3;
+    h = hash_bytes(2166136261u, &code, 1);
+    *res = hash_bytes(h, (const uint8_t*)&v, sizeof(float));
+    return true;
+  }
+  case LBM_TYPE_DOUBLE: {
+    double v = lbm_dec_double(key);
+    if (v == 0.0) v = 0.0;
+    code = 4;
+    h = hash_bytes(2166136261u, &code, 1);
+    *res = hash_bytes(h, (const uint8_t*)&v, sizeof(double));
+    return true;
+  }
+  default:
+    break;
+  }
+  uint64_t v;
+  switch (lbm_type_of_functional(key)) {
+  case LBM_TYPE_SYMBOL: code = 1; v = lbm_dec_sym(key); break;
+  case LBM_TYPE_CHAR: code = 5;  v = lbm_dec_char(key); break;
+  case LBM_TYPE_I:    code = 6;  v = (uint64_t)lbm_dec_i(key); break;
+  case LBM_TYPE_U:    code = 7;  v = lbm_dec_u(key); break;
+  case LBM_TYPE_I32:  code = 8;  v = (uint64_t)lbm_dec_i32(key); break;
+  case LBM_TYPE_U32:  code = 9;  v = lbm_dec_u32(key); break;
+  case LBM_TYPE_I64:  code = 10; v = (uint64_t)lbm_dec_i64(key); break;
+  case LBM_TYPE_U64:  code = 11; v = lbm_dec_u64(key); break;
+  default:
+    return false;
+  }
+  h = hash_bytes(2166136261u, &code, 1);
+  *res = hash_bytes(h, (const uint8_t*)&v, sizeof(uint64_t));
+  return true;
+}
+
+static lbm_value *lisp_array_data(lbm_value arr, lbm_uint *size) {
+  lbm_array_header_t *header = (lbm_array_header_t*)lbm_car(arr);
+  *size = header->size / sizeof(lbm_value);
+  return (lbm_value*)header->data;
+}
+
+static bool is_hash(lbm_value v, lbm_uint tag) {
+  if (!lbm_is_lisp_array_r(v)) return false;
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(v, &size);
+  return (size == HASH_SIZE &&
+          lbm_is_symbol(data[HASH_TAG]) &&
+          (tag == 0 ? (lbm_dec_sym(data[HASH_TAG]) == sym_hashmap ||
+                       lbm_dec_sym(data[HASH_TAG]) == sym_hashset)
+                    : lbm_dec_sym(data[HASH_TAG]) == tag) &&
+          lbm_is_number(data[HASH_COUNT]) &&
+          lbm_is_lisp_array_r(data[HASH_BUCKETS]));
+}
+
+static bool is_hash_rw(lbm_value v, lbm_uint tag) {
+  if (!is_hash(v, tag) || !lbm_is_lisp_array_rw(v)) return false;
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(v, &size);
+  return lbm_is_lisp_array_rw(data[HASH_BUCKETS]);
+}
+
+// The bucket that key belongs in, or NULL if key cannot be hashed.
+static lbm_value *hash_bucket(lbm_value hash, lbm_value key) {
+  uint32_t h;
+  if (!hash_key(key, &h)) return NULL;
+  lbm_uint n;
+  lbm_value *data = lisp_array_data(hash, &n);
+  lbm_value *buckets = lisp_array_data(data[HASH_BUCKETS], &n);
+  if (n == 0) return NULL;
+  return &buckets[h & (n - 1)];
+}
+
+// The (key . val) pair for key in bucket, or nil.
+static lbm_value bucket_find(lbm_value bucket, lbm_value key) {
+  while (lbm_is_cons(bucket)) {
+    lbm_value pair = lbm_car(bucket);
+    if (struct_eq(lbm_car(pair), key)) {
+      return pair;
+    }
+    bucket = lbm_cdr(bucket);
+  }
+  return ENC_SYM_NIL;
+}
+
+static lbm_uint round_buckets(lbm_uint n) {
+  lbm_uint r = 4;
+  while (r < n && r < HASH_MAX_BUCKETS) r <<= 1;
+  return r;
+}
+
+static lbm_value mk_hash(lbm_uint tag, lbm_value *args, lbm_uint argn) {
+  lbm_uint n = HASH_DEFAULT_BUCKETS;
+  if (argn == 1 && lbm_is_number(args[0])) {
+    n = round_buckets(lbm_dec_as_u32(args[0]));
+  } else if (argn != 0) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_value buckets;
+  lbm_value hash;
+  if (!lbm_heap_allocate_lisp_array(&buckets, n) ||
+      !lbm_heap_allocate_lisp_array(&hash, HASH_SIZE)) {
+    return ENC_SYM_MERROR;
+  }
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(hash, &size);
+  data[HASH_TAG] = lbm_enc_sym(tag);
+  data[HASH_COUNT] = lbm_enc_i(0);
+  data[HASH_BUCKETS] = buckets;
+  return hash;
+}
+
+// Move every entry of the n buckets in old to the bucket its key
+// hashes to in the new_n buckets in nb, which can be old itself. Only
+// the spine cells are relinked, nothing is allocated.
+static void relink(lbm_value *old, lbm_uint n, lbm_value *nb, lbm_uint new_n) {
+  lbm_value all = ENC_SYM_NIL;
+  for (lbm_uint i = 0; i < n; i ++) {
+    lbm_value curr = old[i];
+    while (lbm_is_cons(curr)) {
+      lbm_value next = lbm_cdr(curr);
+      lbm_set_cdr(curr, all);
+      all = curr;
+      curr = next;
+    }
+    old[i] = ENC_SYM_NIL;
+  }
+  while (lbm_is_cons(all)) {
+    lbm_value next = lbm_cdr(all);
+    uint32_t h = 0;
+    hash_key(lbm_car(lbm_car(all)), &h);
+    lbm_value *b = &nb[h & (new_n - 1)];
+    lbm_set_cdr(all, *b);
+    *b = all;
+    all = next;
+  }
+}
+
+// Double the number of buckets when the load is too high. If the
+// allocation of the new bucket array fails the map keeps working with
+// the current buckets.
+static void maybe_grow(lbm_value hash) {
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(hash, &size);
+  lbm_uint n;
+  lbm_value *old = lisp_array_data(data[HASH_BUCKETS], &n);
+  lbm_uint count = (lbm_uint)lbm_dec_as_i32(data[HASH_COUNT]);
+  if (n >= HASH_MAX_BUCKETS || count < n * HASH_LOAD_FACTOR ||
+      !lbm_is_lisp_array_rw(data[HASH_BUCKETS])) {
+    return;
+  }
+  lbm_value new_buckets;
+  if (!lbm_heap_allocate_lisp_array(&new_buckets, n * 2)) {
+    return;
+  }
+  lbm_uint new_n;
+  lbm_value *nb = lisp_array_data(new_buckets, &new_n);
+  relink(old, n, nb, new_n);
+  data[HASH_BUCKETS] = new_buckets;
+}
+
+// Called by unflatten for every lisp array it builds. The symbol ids
+// of the keys can differ from those the map was built with.
+static void rehash_unflattened(lbm_value arr) {
+  if (!is_hash_rw(arr, 0)) return;
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(arr, &size);
+  lbm_uint n;
+  lbm_value *buckets = lisp_array_data(data[HASH_BUCKETS], &n);
+  if (n == 0) return;
+  relink(buckets, n, buckets, n);
+}
+
+static lbm_value hash_set(lbm_value hash, lbm_value key, lbm_value val) {
+  lbm_value *bucket = hash_bucket(hash, key);
+  if (!bucket) return ENC_SYM_TERROR;
+  lbm_value pair = bucket_find(*bucket, key);
+  if (lbm_is_cons(pair)) {
+    if (!lbm_is_cons_rw(pair)) return ENC_SYM_EERROR;
+    lbm_set_cdr(pair, val);
+    return hash;
+  }
+  // A new entry. Grow first so that the entry goes into its final
+  // bucket. If the allocations below fail the extension is retried
+  // after GC, and then finds the map already grown.
+  maybe_grow(hash);
+  bucket = hash_bucket(hash, key);
+  pair = lbm_cons(key, val);
+  if (lbm_is_symbol_merror(pair)) return pair;
+  lbm_value cell = lbm_cons(pair, *bucket);
+  if (lbm_is_symbol_merror(cell)) return cell;
+  *bucket = cell;
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(hash, &size);
+  data[HASH_COUNT] = lbm_enc_i(lbm_dec_i(data[HASH_COUNT]) + 1);
+  return hash;
+}
+
+/* (mk-hashmap [num-buckets]) */
+static lbm_value ext_mk_hashmap(lbm_value *args, lbm_uint argn) {
+  return mk_hash(sym_hashmap, args, argn);
+}
+
+/* (mk-hashset [num-buckets]) */
+static lbm_value ext_mk_hashset(lbm_value *args, lbm_uint argn) {
+  return mk_hash(sym_hashset, args, argn);
+}
+
+/* (hashmap-set map key val) */
+static lbm_value ext_hashmap_set(lbm_value *args, lbm_uint argn) {
+  if (argn != 3 || !is_hash_rw(args[0], sym_hashmap)) return ENC_SYM_TERROR;
+  return hash_set(args[0], args[1], args[2]);
+}
+
+/* (hashset-insert set key) */
+static lbm_value ext_hashset_insert(lbm_value *args, lbm_uint argn) {
+  if (argn != 2 || !is_hash_rw(args[0], sym_hashset)) return ENC_SYM_TERROR;
+  return hash_set(args[0], args[1], ENC_SYM_TRUE);
+}
+
+/* (hashmap-get map key [default]) */
+static lbm_value ext_hashmap_get(lbm_value *args, lbm_uint argn) {
+  if ((argn != 2 && argn != 3) || !is_hash(args[0], sym_hashmap)) return ENC_SYM_TERROR;
+  lbm_value *bucket = hash_bucket(args[0], args[1]);
+  if (!bucket) return ENC_SYM_TERROR;
+  lbm_value pair = bucket_find(*bucket, args[1]);
+  if (lbm_is_cons(pair)) return lbm_cdr(pair);
+  return argn == 3 ? args[2] : ENC_SYM_NIL;
+}
+
+/* (hash-has map-or-set key) */
+static lbm_value ext_hash_has(lbm_value *args, lbm_uint argn) {
+  if (argn != 2 || !is_hash(args[0], 0)) return ENC_SYM_TERROR;
+  lbm_value *bucket = hash_bucket(args[0], args[1]);
+  if (!bucket) return ENC_SYM_TERROR;
+  return lbm_is_cons(bucket_find(*bucket, args[1])) ? ENC_SYM_TRUE : ENC_SYM_NIL;
+}
+
+/* (hash-del map-or-set key) */
+static lbm_value ext_hash_del(lbm_value *args, lbm_uint argn) {
+  if (argn != 2 || !is_hash_rw(args[0], 0)) return ENC_SYM_TERROR;
+  lbm_value *bucket = hash_bucket(args[0], args[1]);
+  if (!bucket) return ENC_SYM_TERROR;
+  lbm_value prev = ENC_SYM_NIL;
+  lbm_value curr = *bucket;
+  while (lbm_is_cons(curr)) {
+    if (struct_eq(lbm_car(lbm_car(curr)), args[1])) {
+      if (lbm_is_cons(prev)) {
+        lbm_set_cdr(prev, lbm_cdr(curr));
+      } else {
+        *bucket = lbm_cdr(curr);
+      }
+      lbm_uint size;
+      lbm_value *data = lisp_array_data(args[0], &size);
+      data[HASH_COUNT] = lbm_enc_i(lbm_dec_i(data[HASH_COUNT]) - 1);
+      break;
+    }
+    prev = curr;
+    curr = lbm_cdr(curr);
+  }
+  return args[0];
+}
+
+/* (hash-count map-or-set) */
+static lbm_value ext_hash_count(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !is_hash(args[0], 0)) return ENC_SYM_TERROR;
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(args[0], &size);
+  return data[HASH_COUNT];
+}
+
+// List of the keys, or of the (key . val) pairs, in bucket order.
+static lbm_value hash_to_list(lbm_value hash, bool pairs) {
+  lbm_uint size;
+  lbm_value *data = lisp_array_data(hash, &size);
+  lbm_uint n;
+  lbm_value *buckets = lisp_array_data(data[HASH_BUCKETS], &n);
+  lbm_value res = ENC_SYM_NIL;
+  for (lbm_uint i = n; i > 0; i --) {
+    lbm_value curr = buckets[i - 1];
+    while (lbm_is_cons(curr)) {
+      lbm_value pair = lbm_car(curr);
+      lbm_value elt = pair;
+      if (pairs) {
+        elt = lbm_cons(lbm_car(pair), lbm_cdr(pair));
+        if (lbm_is_symbol_merror(elt)) return elt;
+      } else {
+        elt = lbm_car(pair);
+      }
+      res = lbm_cons(elt, res);
+      if (lbm_is_symbol_merror(res)) return res;
+      curr = lbm_cdr(curr);
+    }
+  }
+  return res;
+}
+
+/* (hash-keys map-or-set) */
+static lbm_value ext_hash_keys(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !is_hash(args[0], 0)) return ENC_SYM_TERROR;
+  return hash_to_list(args[0], false);
+}
+
+/* (hashmap-to-list map) */
+static lbm_value ext_hashmap_to_list(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !is_hash(args[0], sym_hashmap)) return ENC_SYM_TERROR;
+  return hash_to_list(args[0], true);
+}
+
+void lbm_hashmap_extensions_init(void) {
+  lbm_add_symbol_const("hashmap", &sym_hashmap);
+  lbm_add_symbol_const("hashset", &sym_hashset);
+  lbm_set_unflatten_array_callback(rehash_unflattened);
+
+  lbm_add_extension("mk-hashmap", ext_mk_hashmap);
+  lbm_add_extension("mk-hashset", ext_mk_hashset);
+  lbm_add_extension("hashmap-set", ext_hashmap_set);
+  lbm_add_extension("hashmap-get", ext_hashmap_get);
+  lbm_add_extension("hashset-insert", ext_hashset_insert);
+  lbm_add_extension("hash-has", ext_hash_has);
+  lbm_add_extension("hash-del", ext_hash_del);
+  lbm_add_extension("hash-count", ext_hash_count);
+  lbm_add_extension("hash-keys", ext_hash_keys);
+  lbm_add_extension("hashmap-to-list", ext_hashmap_to_list);
+}
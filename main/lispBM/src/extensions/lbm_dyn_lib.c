@@ -18,6 +18,13 @@
 */
 
 #include <extensions.h>
+#include <extensions/lbm_dyn_lib.h>
+#include <eval_cps.h>
+
+#ifdef LBM_USE_DYN_PRECOMPILED
+// Generated by "make dyn_lib_flat" in the repl directory.
+#include "lbm_dyn_lib_flat.h"
+#endif
 
 #if defined(LBM_USE_DYN_FUNS) || defined(LBM_USE_DYN_ARRAYS)
 static const char* lbm_dyn_fun[] = {
@@ -323,8 +330,83 @@ static lbm_value ext_me_loopforeach(lbm_value *args, lbm_uint argn) {
 #endif
 
 
+// PRECOMPILED DEFINITIONS /////////////////////////////////////////////////
+#ifdef LBM_USE_DYN_PRECOMPILED
+
+// The precompiled library is a sequence of entries, each holding the
+// name and the flattened value of one definition:
+// [name size (u32 le)][name][value size (u32 le)][flat value]
+static uint32_t read_u32_le(const unsigned char *data) {
+  return (uint32_t)data[0] |
+    ((uint32_t)data[1] << 8) |
+    ((uint32_t)data[2] << 16) |
+    ((uint32_t)data[3] << 24);
+}
+
+static bool find_precompiled(const char *name, unsigned int name_len, lbm_flat_value_t *fv) {
+  unsigned int pos = 0;
+  while (pos + 8 <= dyn_lib_env_len) {
+    uint32_t entry_name_len = read_u32_le(dyn_lib_env + pos);
+    const unsigned char *entry_name = dyn_lib_env + pos + 4;
+    pos += 4 + entry_name_len;
+    uint32_t val_size = read_u32_le(dyn_lib_env + pos);
+    pos += 4;
+    if (entry_name_len == name_len &&
+        memcmp(entry_name, name, name_len) == 0) {
+      // Unflattening only reads from the buffer.
+      fv->buf = (uint8_t*)(dyn_lib_env + pos);
+      fv->buf_size = val_size;
+      fv->buf_pos = 0;
+      return true;
+    }
+    pos += val_size;
+  }
+  return false;
+}
+
+// Only code strings that belong to the library tables are replaced,
+// so that a user loader can still provide its own definitions.
+static bool code_name(const char *code, const char **name) {
+#ifdef LBM_USE_DYN_MACROS
+  for (unsigned int i = 0; i < (sizeof(lbm_dyn_macros) / sizeof(lbm_dyn_macros[0]));i++) {
+    if (code == lbm_dyn_macros[i]) {
+      *name = code + 8;
+      return true;
+    }
+  }
+#endif
+#if defined(LBM_USE_DYN_FUNS) || defined(LBM_USE_DYN_ARRAYS)
+  for (unsigned int i = 0; i < (sizeof(lbm_dyn_fun) / sizeof(lbm_dyn_fun[0]));i++) {
+    if (code == lbm_dyn_fun[i]) {
+      *name = code + 7;
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+#endif
+
+bool lbm_dyn_lib_find_flat(const char *code, lbm_flat_value_t *fv) {
+#ifdef LBM_USE_DYN_PRECOMPILED
+  const char *name;
+  if (code_name(code, &name)) {
+    unsigned int n = 0;
+    while (name[n] != 0 && name[n] != ' ') n++;
+    return find_precompiled(name, n, fv);
+  }
+#else
+  (void)code;
+  (void)fv;
+#endif
+  return false;
+}
+
 // DYN_LIB_INIT ////////////////////////////////////////////////////////////
 void lbm_dyn_lib_init(void) {
+#ifdef LBM_USE_DYN_PRECOMPILED
+  lbm_set_dynamic_load_flat_callback(lbm_dyn_lib_find_flat);
+#endif
 #ifdef LBM_USE_DYN_MACROS
   lbm_add_symbol_const("return", &sym_return);
 
@@ -0,0 +1,489 @@
+static const unsigned char dyn_lib_env[] = {
+  0x0d, 0x00, 0x00, 0x00, 0x61, 0x72, 0x72, 0x61, 0x79, 0x2d, 0x74, 0x6f,
+  0x2d, 0x6c, 0x69, 0x73, 0x74, 0x0e, 0x01, 0x00, 0x00, 0x01, 0x03, 0x63,
+  0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x61, 0x72,
+  0x72, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x65,
+  0x74, 0x00, 0x01, 0x01, 0x01, 0x03, 0x6e, 0x00, 0x01, 0x01, 0x03, 0x6c,
+  0x65, 0x6e, 0x67, 0x74, 0x68, 0x00, 0x01, 0x03, 0x61, 0x72, 0x72, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x73, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x70,
+  0x72, 0x6f, 0x67, 0x6e, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x6f, 0x6f, 0x70,
+  0x66, 0x6f, 0x72, 0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x01, 0x03, 0x2d,
+  0x00, 0x01, 0x03, 0x6e, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x01, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x3e, 0x3d, 0x00, 0x01, 0x03,
+  0x69, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x2d, 0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x05,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x70, 0x72, 0x6f, 0x67, 0x6e, 0x00, 0x01, 0x01, 0x03, 0x73, 0x65, 0x74,
+  0x71, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x00, 0x01, 0x01, 0x03, 0x63, 0x6f,
+  0x6e, 0x73, 0x00, 0x01, 0x01, 0x03, 0x69, 0x78, 0x00, 0x01, 0x03, 0x61,
+  0x72, 0x72, 0x00, 0x01, 0x03, 0x69, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x03, 0x6c, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x03, 0x6c, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x06, 0x00, 0x00, 0x00, 0x61, 0x72, 0x72, 0x61, 0x79,
+  0x3f, 0x4f, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75,
+  0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x61, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x65, 0x71, 0x00, 0x01, 0x01, 0x03, 0x74, 0x79,
+  0x70, 0x65, 0x2d, 0x6f, 0x66, 0x00, 0x01, 0x03, 0x61, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x03, 0x74, 0x79, 0x70, 0x65, 0x2d, 0x6c, 0x69,
+  0x73, 0x70, 0x61, 0x72, 0x72, 0x61, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x09, 0x00, 0x00, 0x00, 0x73, 0x74, 0x72, 0x2d, 0x6d, 0x65, 0x72, 0x67,
+  0x65, 0x3e, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75,
+  0x72, 0x65, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x73, 0x74, 0x72, 0x2d, 0x6a, 0x6f, 0x69, 0x6e, 0x00, 0x01, 0x01, 0x03,
+  0x72, 0x65, 0x73, 0x74, 0x2d, 0x61, 0x72, 0x67, 0x73, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x00, 0x00, 0x00, 0x7a,
+  0x69, 0x70, 0x46, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73,
+  0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x78, 0x73, 0x00, 0x01, 0x03,
+  0x79, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x7a,
+  0x69, 0x70, 0x77, 0x69, 0x74, 0x68, 0x00, 0x01, 0x03, 0x63, 0x6f, 0x6e,
+  0x73, 0x00, 0x01, 0x03, 0x78, 0x73, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x63, 0x72, 0x65, 0x61,
+  0x74, 0x65, 0x2d, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0xa7, 0x01, 0x00,
+  0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01,
+  0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x6e, 0x75, 0x6d,
+  0x2d, 0x66, 0x69, 0x65, 0x6c, 0x64, 0x73, 0x00, 0x01, 0x03, 0x69, 0x6e,
+  0x69, 0x74, 0x69, 0x61, 0x6c, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x70, 0x72, 0x6f, 0x67, 0x6e, 0x00, 0x01, 0x01, 0x03,
+  0x76, 0x61, 0x72, 0x00, 0x01, 0x03, 0x61, 0x72, 0x72, 0x00, 0x01, 0x01,
+  0x03, 0x6d, 0x6b, 0x61, 0x72, 0x72, 0x61, 0x79, 0x00, 0x01, 0x01, 0x03,
+  0x2b, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x6e, 0x75,
+  0x6d, 0x2d, 0x66, 0x69, 0x65, 0x6c, 0x64, 0x73, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x73, 0x65, 0x74, 0x69, 0x78, 0x00, 0x01, 0x03, 0x61,
+  0x72, 0x72, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x6e,
+  0x61, 0x6d, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x76, 0x61, 0x72, 0x00, 0x01, 0x03, 0x6e, 0x75, 0x6d, 0x5f, 0x69, 0x6e,
+  0x69, 0x74, 0x73, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x65, 0x6e, 0x67, 0x74,
+  0x68, 0x00, 0x01, 0x03, 0x69, 0x6e, 0x69, 0x74, 0x69, 0x61, 0x6c, 0x73,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x69, 0x66, 0x00, 0x01, 0x03, 0x69, 0x6e, 0x69, 0x74, 0x69,
+  0x61, 0x6c, 0x73, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x6f, 0x6f, 0x70, 0x66,
+  0x6f, 0x72, 0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00,
+  0x00, 0x01, 0x01, 0x03, 0x61, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x3c,
+  0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x03, 0x6e, 0x75, 0x6d, 0x2d, 0x66,
+  0x69, 0x65, 0x6c, 0x64, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x3c, 0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x03, 0x6e, 0x75,
+  0x6d, 0x5f, 0x69, 0x6e, 0x69, 0x74, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x2b, 0x00, 0x01,
+  0x03, 0x69, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x01, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x73, 0x65, 0x74, 0x69, 0x78, 0x00, 0x01,
+  0x03, 0x61, 0x72, 0x72, 0x00, 0x01, 0x01, 0x03, 0x2b, 0x00, 0x01, 0x03,
+  0x69, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x69, 0x78, 0x00, 0x01, 0x03, 0x69, 0x6e, 0x69,
+  0x74, 0x69, 0x61, 0x6c, 0x73, 0x00, 0x01, 0x03, 0x69, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x61, 0x72, 0x72, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x09, 0x00, 0x00, 0x00, 0x69, 0x73, 0x2d, 0x73,
+  0x74, 0x72, 0x75, 0x63, 0x74, 0x98, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63,
+  0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x73, 0x74,
+  0x72, 0x75, 0x63, 0x74, 0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x61, 0x6e, 0x64, 0x00,
+  0x01, 0x01, 0x03, 0x65, 0x71, 0x00, 0x01, 0x01, 0x03, 0x74, 0x79, 0x70,
+  0x65, 0x2d, 0x6f, 0x66, 0x00, 0x01, 0x03, 0x73, 0x74, 0x72, 0x75, 0x63,
+  0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x74, 0x79, 0x70,
+  0x65, 0x2d, 0x6c, 0x69, 0x73, 0x70, 0x61, 0x72, 0x72, 0x61, 0x79, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x65, 0x71, 0x00, 0x01,
+  0x01, 0x03, 0x69, 0x78, 0x00, 0x01, 0x03, 0x73, 0x74, 0x72, 0x75, 0x63,
+  0x74, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x61, 0x63, 0x63,
+  0x65, 0x73, 0x73, 0x6f, 0x72, 0x2d, 0x73, 0x79, 0x6d, 0x73, 0x00, 0x00,
+  0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01,
+  0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x66, 0x69, 0x65,
+  0x6c, 0x64, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x73,
+  0x74, 0x72, 0x32, 0x73, 0x79, 0x6d, 0x00, 0x01, 0x01, 0x03, 0x73, 0x74,
+  0x72, 0x2d, 0x6d, 0x65, 0x72, 0x67, 0x65, 0x00, 0x01, 0x03, 0x6e, 0x61,
+  0x6d, 0x65, 0x00, 0x01, 0x0d, 0x00, 0x00, 0x00, 0x02, 0x2d, 0x00, 0x01,
+  0x01, 0x03, 0x73, 0x79, 0x6d, 0x32, 0x73, 0x74, 0x72, 0x00, 0x01, 0x03,
+  0x66, 0x69, 0x65, 0x6c, 0x64, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x0a, 0x00, 0x00, 0x00,
+  0x61, 0x63, 0x63, 0x65, 0x73, 0x73, 0x2d, 0x73, 0x65, 0x74, 0xa5, 0x00,
+  0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00,
+  0x01, 0x01, 0x03, 0x69, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x61, 0x6d, 0x62, 0x64, 0x61, 0x00, 0x01, 0x01, 0x03, 0x73,
+  0x74, 0x72, 0x75, 0x63, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x69, 0x66, 0x00, 0x01, 0x01, 0x03, 0x72, 0x65, 0x73, 0x74,
+  0x2d, 0x61, 0x72, 0x67, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x73, 0x65, 0x74, 0x69, 0x78, 0x00, 0x01, 0x03, 0x73, 0x74,
+  0x72, 0x75, 0x63, 0x74, 0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x01, 0x03,
+  0x72, 0x65, 0x73, 0x74, 0x2d, 0x61, 0x72, 0x67, 0x73, 0x00, 0x01, 0x05,
+  0x00, 0x00, 0x00, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x69, 0x78, 0x00, 0x01, 0x03, 0x73, 0x74,
+  0x72, 0x75, 0x63, 0x74, 0x00, 0x01, 0x03, 0x69, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x04,
+  0x00, 0x00, 0x00, 0x69, 0x6f, 0x74, 0x61, 0x31, 0x00, 0x00, 0x00, 0x01,
+  0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03,
+  0x6e, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x72, 0x61,
+  0x6e, 0x67, 0x65, 0x00, 0x01, 0x03, 0x6e, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x05, 0x00, 0x00, 0x00, 0x64, 0x65, 0x66, 0x75, 0x6e, 0x4e, 0x00, 0x00,
+  0x00, 0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01, 0x01, 0x03,
+  0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x61, 0x72, 0x67, 0x73, 0x00,
+  0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x6d, 0x65, 0x2d, 0x64, 0x65, 0x66, 0x75, 0x6e, 0x00,
+  0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x61, 0x72, 0x67,
+  0x73, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x05, 0x00, 0x00, 0x00, 0x66,
+  0x6f, 0x6c, 0x64, 0x6c, 0x9c, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c,
+  0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x66, 0x00, 0x01,
+  0x03, 0x69, 0x6e, 0x69, 0x74, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x69, 0x66, 0x00, 0x01,
+  0x01, 0x03, 0x65, 0x71, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x01,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03,
+  0x69, 0x6e, 0x69, 0x74, 0x00, 0x01, 0x01, 0x03, 0x66, 0x6f, 0x6c, 0x64,
+  0x6c, 0x00, 0x01, 0x03, 0x66, 0x00, 0x01, 0x01, 0x03, 0x66, 0x00, 0x01,
+  0x03, 0x69, 0x6e, 0x69, 0x74, 0x00, 0x01, 0x01, 0x03, 0x63, 0x61, 0x72,
+  0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x63, 0x64, 0x72, 0x00,
+  0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x08, 0x00, 0x00, 0x00,
+  0x64, 0x65, 0x66, 0x75, 0x6e, 0x72, 0x65, 0x74, 0x51, 0x00, 0x00, 0x00,
+  0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01, 0x01, 0x03, 0x6e,
+  0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x61, 0x72, 0x67, 0x73, 0x00, 0x01,
+  0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x6d, 0x65, 0x2d, 0x64, 0x65, 0x66, 0x75, 0x6e, 0x72, 0x65,
+  0x74, 0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x61,
+  0x72, 0x67, 0x73, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x05, 0x00, 0x00,
+  0x00, 0x66, 0x6f, 0x6c, 0x64, 0x72, 0x9c, 0x00, 0x00, 0x00, 0x01, 0x03,
+  0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x66,
+  0x00, 0x01, 0x03, 0x69, 0x6e, 0x69, 0x74, 0x00, 0x01, 0x03, 0x6c, 0x73,
+  0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x69, 0x66,
+  0x00, 0x01, 0x01, 0x03, 0x65, 0x71, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74,
+  0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x03, 0x69, 0x6e, 0x69, 0x74, 0x00, 0x01, 0x01, 0x03, 0x66, 0x00,
+  0x01, 0x01, 0x03, 0x63, 0x61, 0x72, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x66, 0x6f, 0x6c,
+  0x64, 0x72, 0x00, 0x01, 0x03, 0x66, 0x00, 0x01, 0x03, 0x69, 0x6e, 0x69,
+  0x74, 0x00, 0x01, 0x01, 0x03, 0x63, 0x64, 0x72, 0x00, 0x01, 0x03, 0x6c,
+  0x73, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x08, 0x00,
+  0x00, 0x00, 0x64, 0x65, 0x66, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0xc8, 0x00,
+  0x00, 0x00, 0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01, 0x01,
+  0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01, 0x03, 0x61, 0x72, 0x67, 0x73,
+  0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01,
+  0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x64,
+  0x65, 0x66, 0x69, 0x6e, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00,
+  0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x61,
+  0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f,
+  0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x61, 0x72, 0x67, 0x73,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73,
+  0x74, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x07, 0x00,
+  0x00, 0x00, 0x7a, 0x69, 0x70, 0x77, 0x69, 0x74, 0x68, 0x38, 0x01, 0x00,
+  0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01,
+  0x01, 0x03, 0x66, 0x00, 0x01, 0x03, 0x78, 0x73, 0x00, 0x01, 0x03, 0x79,
+  0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x65,
+  0x74, 0x00, 0x01, 0x01, 0x01, 0x03, 0x7a, 0x69, 0x70, 0x2d, 0x61, 0x63,
+  0x63, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x61, 0x6d, 0x62, 0x64, 0x61, 0x00,
+  0x01, 0x01, 0x03, 0x61, 0x63, 0x63, 0x00, 0x01, 0x03, 0x78, 0x73, 0x00,
+  0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x69, 0x66, 0x00, 0x01, 0x01, 0x03, 0x61, 0x6e, 0x64, 0x00, 0x01,
+  0x03, 0x78, 0x73, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x7a, 0x69, 0x70, 0x2d, 0x61, 0x63, 0x63,
+  0x00, 0x01, 0x01, 0x03, 0x63, 0x6f, 0x6e, 0x73, 0x00, 0x01, 0x01, 0x03,
+  0x66, 0x00, 0x01, 0x01, 0x03, 0x63, 0x61, 0x72, 0x00, 0x01, 0x03, 0x78,
+  0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x63, 0x61,
+  0x72, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x61, 0x63, 0x63, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x63, 0x64, 0x72, 0x00, 0x01,
+  0x03, 0x78, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x63, 0x64, 0x72, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x61, 0x63, 0x63,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x72, 0x65, 0x76, 0x65, 0x72, 0x73, 0x65, 0x00, 0x01, 0x01, 0x03, 0x7a,
+  0x69, 0x70, 0x2d, 0x61, 0x63, 0x63, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x03, 0x78, 0x73, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x07, 0x00, 0x00, 0x00, 0x6c, 0x6f, 0x6f, 0x70, 0x66, 0x6f, 0x72,
+  0x6c, 0x00, 0x00, 0x00, 0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00,
+  0x01, 0x01, 0x03, 0x69, 0x74, 0x00, 0x01, 0x03, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x00, 0x01, 0x03, 0x63, 0x6e, 0x64, 0x00, 0x01, 0x03, 0x75, 0x70,
+  0x64, 0x61, 0x74, 0x65, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x65, 0x2d, 0x6c,
+  0x6f, 0x6f, 0x70, 0x66, 0x6f, 0x72, 0x00, 0x01, 0x03, 0x69, 0x74, 0x00,
+  0x01, 0x03, 0x73, 0x74, 0x61, 0x72, 0x74, 0x00, 0x01, 0x03, 0x63, 0x6e,
+  0x64, 0x00, 0x01, 0x03, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x00, 0x01,
+  0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x06, 0x00, 0x00, 0x00, 0x66, 0x69, 0x6c, 0x74,
+  0x65, 0x72, 0x6a, 0x01, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73,
+  0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x66, 0x00, 0x01, 0x03, 0x6c,
+  0x73, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c,
+  0x65, 0x74, 0x00, 0x01, 0x01, 0x01, 0x03, 0x66, 0x69, 0x6c, 0x74, 0x65,
+  0x72, 0x2d, 0x72, 0x65, 0x63, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x61, 0x6d,
+  0x62, 0x64, 0x61, 0x00, 0x01, 0x01, 0x03, 0x66, 0x00, 0x01, 0x03, 0x6c,
+  0x73, 0x74, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x69, 0x66, 0x00, 0x01, 0x01, 0x03, 0x65, 0x71,
+  0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x72, 0x65, 0x76,
+  0x65, 0x72, 0x73, 0x65, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x69, 0x66, 0x00, 0x01, 0x01, 0x03,
+  0x66, 0x00, 0x01, 0x01, 0x03, 0x63, 0x61, 0x72, 0x00, 0x01, 0x03, 0x6c,
+  0x73, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x2d, 0x72,
+  0x65, 0x63, 0x00, 0x01, 0x03, 0x66, 0x00, 0x01, 0x01, 0x03, 0x63, 0x64,
+  0x72, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x63, 0x6f, 0x6e, 0x73, 0x00, 0x01, 0x01, 0x03,
+  0x63, 0x61, 0x72, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x66, 0x69, 0x6c,
+  0x74, 0x65, 0x72, 0x2d, 0x72, 0x65, 0x63, 0x00, 0x01, 0x03, 0x66, 0x00,
+  0x01, 0x01, 0x03, 0x63, 0x64, 0x72, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x79, 0x73, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x66, 0x69, 0x6c, 0x74,
+  0x65, 0x72, 0x2d, 0x72, 0x65, 0x63, 0x00, 0x01, 0x03, 0x66, 0x00, 0x01,
+  0x03, 0x6c, 0x73, 0x74, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x09, 0x00, 0x00, 0x00,
+  0x6c, 0x6f, 0x6f, 0x70, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x42, 0x00, 0x00,
+  0x00, 0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01, 0x01, 0x03,
+  0x63, 0x6e, 0x64, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x65, 0x2d, 0x6c, 0x6f,
+  0x6f, 0x70, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x00, 0x01, 0x03, 0x63, 0x6e,
+  0x64, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x73,
+  0x74, 0x72, 0x2d, 0x63, 0x6d, 0x70, 0x2d, 0x61, 0x73, 0x63, 0x4b, 0x00,
+  0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00,
+  0x01, 0x01, 0x03, 0x61, 0x00, 0x01, 0x03, 0x62, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x3c, 0x00, 0x01, 0x01, 0x03, 0x73, 0x74,
+  0x72, 0x2d, 0x63, 0x6d, 0x70, 0x00, 0x01, 0x03, 0x61, 0x00, 0x01, 0x03,
+  0x62, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x09, 0x00, 0x00, 0x00, 0x6c, 0x6f, 0x6f,
+  0x70, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x5c, 0x00, 0x00, 0x00, 0x01, 0x03,
+  0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01, 0x01, 0x03, 0x69, 0x74, 0x00,
+  0x01, 0x03, 0x73, 0x74, 0x61, 0x72, 0x74, 0x00, 0x01, 0x03, 0x65, 0x6e,
+  0x64, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x65, 0x2d, 0x6c, 0x6f, 0x6f, 0x70,
+  0x72, 0x61, 0x6e, 0x67, 0x65, 0x00, 0x01, 0x03, 0x69, 0x74, 0x00, 0x01,
+  0x03, 0x73, 0x74, 0x61, 0x72, 0x74, 0x00, 0x01, 0x03, 0x65, 0x6e, 0x64,
+  0x00, 0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x73, 0x74,
+  0x72, 0x2d, 0x63, 0x6d, 0x70, 0x2d, 0x64, 0x73, 0x63, 0x4b, 0x00, 0x00,
+  0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01,
+  0x01, 0x03, 0x61, 0x00, 0x01, 0x03, 0x62, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x3e, 0x00, 0x01, 0x01, 0x03, 0x73, 0x74, 0x72,
+  0x2d, 0x63, 0x6d, 0x70, 0x00, 0x01, 0x03, 0x61, 0x00, 0x01, 0x03, 0x62,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x6c, 0x6f, 0x6f, 0x70,
+  0x66, 0x6f, 0x72, 0x65, 0x61, 0x63, 0x68, 0x4e, 0x00, 0x00, 0x00, 0x01,
+  0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01, 0x01, 0x03, 0x69, 0x74,
+  0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00, 0x01, 0x03, 0x62, 0x6f, 0x64,
+  0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x65,
+  0x2d, 0x6c, 0x6f, 0x6f, 0x70, 0x66, 0x6f, 0x72, 0x65, 0x61, 0x63, 0x68,
+  0x00, 0x01, 0x03, 0x69, 0x74, 0x00, 0x01, 0x03, 0x6c, 0x73, 0x74, 0x00,
+  0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x06, 0x00, 0x00, 0x00, 0x73, 0x65, 0x63,
+  0x6f, 0x6e, 0x64, 0x3b, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f,
+  0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x78, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x63, 0x61, 0x72, 0x00, 0x01, 0x01,
+  0x03, 0x63, 0x64, 0x72, 0x00, 0x01, 0x03, 0x78, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x6c, 0x6f,
+  0x6f, 0x70, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x2d, 0x74, 0x68, 0x64, 0x2b,
+  0x01, 0x00, 0x00, 0x01, 0x03, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x00, 0x01,
+  0x01, 0x03, 0x73, 0x74, 0x6b, 0x00, 0x01, 0x03, 0x63, 0x6e, 0x64, 0x00,
+  0x01, 0x03, 0x62, 0x6f, 0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01,
+  0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x73, 0x70,
+  0x61, 0x77, 0x6e, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x69, 0x66, 0x00, 0x01, 0x01, 0x03, 0x6c,
+  0x69, 0x73, 0x74, 0x3f, 0x00, 0x01, 0x03, 0x73, 0x74, 0x6b, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x73, 0x74, 0x6b, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x73, 0x74, 0x6b, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x61, 0x70, 0x70,
+  0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65,
+  0x00, 0x01, 0x01, 0x03, 0x6c, 0x61, 0x6d, 0x62, 0x64, 0x61, 0x00, 0x01,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01,
+  0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03,
+  0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x6f, 0x6f,
+  0x70, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74,
+  0x00, 0x01, 0x03, 0x63, 0x6e, 0x64, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x62, 0x6f,
+  0x64, 0x79, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x05, 0x00, 0x00, 0x00, 0x74, 0x68, 0x69, 0x72, 0x64, 0x47,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65,
+  0x00, 0x01, 0x01, 0x03, 0x78, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x63, 0x61, 0x72, 0x00, 0x01, 0x01, 0x03, 0x63, 0x64, 0x72,
+  0x00, 0x01, 0x01, 0x03, 0x63, 0x64, 0x72, 0x00, 0x01, 0x03, 0x78, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x09, 0x00, 0x00, 0x00, 0x64, 0x65, 0x66, 0x73, 0x74, 0x72,
+  0x75, 0x63, 0x74, 0x66, 0x05, 0x00, 0x00, 0x01, 0x03, 0x6d, 0x61, 0x63,
+  0x72, 0x6f, 0x00, 0x01, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x01,
+  0x03, 0x6c, 0x69, 0x73, 0x74, 0x2d, 0x6f, 0x66, 0x2d, 0x66, 0x69, 0x65,
+  0x6c, 0x64, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x70, 0x72, 0x6f, 0x67, 0x6e, 0x00, 0x01, 0x01, 0x03, 0x76, 0x61, 0x72,
+  0x00, 0x01, 0x03, 0x6e, 0x75, 0x6d, 0x2d, 0x66, 0x69, 0x65, 0x6c, 0x64,
+  0x73, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x00,
+  0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x2d, 0x6f, 0x66, 0x2d, 0x66, 0x69,
+  0x65, 0x6c, 0x64, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x76, 0x61, 0x72, 0x00, 0x01, 0x03,
+  0x6e, 0x61, 0x6d, 0x65, 0x2d, 0x61, 0x73, 0x2d, 0x73, 0x74, 0x72, 0x69,
+  0x6e, 0x67, 0x00, 0x01, 0x01, 0x03, 0x73, 0x79, 0x6d, 0x32, 0x73, 0x74,
+  0x72, 0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x76, 0x61,
+  0x72, 0x00, 0x01, 0x03, 0x6e, 0x65, 0x77, 0x2d, 0x63, 0x72, 0x65, 0x61,
+  0x74, 0x65, 0x2d, 0x73, 0x79, 0x6d, 0x00, 0x01, 0x01, 0x03, 0x73, 0x74,
+  0x72, 0x32, 0x73, 0x79, 0x6d, 0x00, 0x01, 0x01, 0x03, 0x73, 0x74, 0x72,
+  0x2d, 0x6d, 0x65, 0x72, 0x67, 0x65, 0x00, 0x01, 0x0d, 0x00, 0x00, 0x00,
+  0x06, 0x6d, 0x61, 0x6b, 0x65, 0x2d, 0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d,
+  0x65, 0x2d, 0x61, 0x73, 0x2d, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x76, 0x61, 0x72, 0x00, 0x01, 0x03,
+  0x6e, 0x65, 0x77, 0x2d, 0x70, 0x72, 0x65, 0x64, 0x2d, 0x73, 0x79, 0x6d,
+  0x00, 0x01, 0x01, 0x03, 0x73, 0x74, 0x72, 0x32, 0x73, 0x79, 0x6d, 0x00,
+  0x01, 0x01, 0x03, 0x73, 0x74, 0x72, 0x2d, 0x6d, 0x65, 0x72, 0x67, 0x65,
+  0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x2d, 0x61, 0x73, 0x2d, 0x73,
+  0x74, 0x72, 0x69, 0x6e, 0x67, 0x00, 0x01, 0x0d, 0x00, 0x00, 0x00, 0x02,
+  0x3f, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x76, 0x61, 0x72, 0x00,
+  0x01, 0x03, 0x66, 0x69, 0x65, 0x6c, 0x64, 0x2d, 0x69, 0x78, 0x00, 0x01,
+  0x01, 0x03, 0x7a, 0x69, 0x70, 0x00, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74,
+  0x2d, 0x6f, 0x66, 0x2d, 0x66, 0x69, 0x65, 0x6c, 0x64, 0x73, 0x00, 0x01,
+  0x01, 0x03, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x00, 0x01, 0x05, 0x00, 0x00,
+  0x00, 0x01, 0x01, 0x01, 0x03, 0x2b, 0x00, 0x01, 0x03, 0x6e, 0x75, 0x6d,
+  0x2d, 0x66, 0x69, 0x65, 0x6c, 0x64, 0x73, 0x00, 0x01, 0x05, 0x00, 0x00,
+  0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71,
+  0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x70, 0x72, 0x6f, 0x67,
+  0x6e, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x61,
+  0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f,
+  0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01,
+  0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x6e, 0x65, 0x77,
+  0x2d, 0x63, 0x72, 0x65, 0x61, 0x74, 0x65, 0x2d, 0x73, 0x79, 0x6d, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74,
+  0x00, 0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01,
+  0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x6c,
+  0x61, 0x6d, 0x62, 0x64, 0x61, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x61, 0x70, 0x70,
+  0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65,
+  0x00, 0x01, 0x01, 0x03, 0x63, 0x72, 0x65, 0x61, 0x74, 0x65, 0x2d, 0x73,
+  0x74, 0x72, 0x75, 0x63, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00,
+  0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01,
+  0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75,
+  0x6f, 0x74, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03,
+  0x6e, 0x61, 0x6d, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c,
+  0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x6e, 0x75, 0x6d, 0x2d, 0x66, 0x69,
+  0x65, 0x6c, 0x64, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f,
+  0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x72, 0x65, 0x73, 0x74, 0x2d, 0x61,
+  0x72, 0x67, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03,
+  0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75,
+  0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x64, 0x65, 0x66, 0x69, 0x6e,
+  0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x6e, 0x65,
+  0x77, 0x2d, 0x70, 0x72, 0x65, 0x64, 0x2d, 0x73, 0x79, 0x6d, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00,
+  0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x00, 0x01, 0x01,
+  0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x61,
+  0x6d, 0x62, 0x64, 0x61, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73, 0x74, 0x00, 0x01,
+  0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01, 0x01, 0x03, 0x73,
+  0x74, 0x72, 0x75, 0x63, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65,
+  0x6e, 0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00,
+  0x01, 0x01, 0x03, 0x69, 0x73, 0x2d, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74,
+  0x00, 0x01, 0x03, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c,
+  0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x61, 0x70, 0x70, 0x65, 0x6e,
+  0x64, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01,
+  0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x69, 0x73,
+  0x74, 0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x61, 0x70,
+  0x00, 0x01, 0x01, 0x03, 0x6c, 0x61, 0x6d, 0x62, 0x64, 0x61, 0x00, 0x01,
+  0x01, 0x03, 0x78, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x03, 0x64, 0x65, 0x66, 0x69, 0x6e,
+  0x65, 0x00, 0x01, 0x01, 0x03, 0x61, 0x63, 0x63, 0x65, 0x73, 0x73, 0x6f,
+  0x72, 0x2d, 0x73, 0x79, 0x6d, 0x00, 0x01, 0x03, 0x6e, 0x61, 0x6d, 0x65,
+  0x2d, 0x61, 0x73, 0x2d, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x00, 0x01,
+  0x01, 0x03, 0x63, 0x61, 0x72, 0x00, 0x01, 0x03, 0x78, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x61,
+  0x63, 0x63, 0x65, 0x73, 0x73, 0x2d, 0x73, 0x65, 0x74, 0x00, 0x01, 0x01,
+  0x03, 0x63, 0x64, 0x72, 0x00, 0x01, 0x03, 0x78, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x66, 0x69, 0x65, 0x6c, 0x64,
+  0x2d, 0x69, 0x78, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03,
+  0x6c, 0x69, 0x73, 0x74, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f, 0x74,
+  0x65, 0x00, 0x01, 0x01, 0x03, 0x71, 0x75, 0x6f, 0x74, 0x65, 0x00, 0x01,
+  0x03, 0x74, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x00, 0x00,
+  0x00, 0x61, 0x62, 0x73, 0x50, 0x00, 0x00, 0x00, 0x01, 0x03, 0x63, 0x6c,
+  0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01, 0x01, 0x03, 0x78, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x69, 0x66, 0x00, 0x01, 0x01,
+  0x03, 0x3c, 0x00, 0x01, 0x03, 0x78, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x2d, 0x00, 0x01,
+  0x03, 0x78, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x78, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x6c, 0x69, 0x73, 0x74,
+  0x2d, 0x74, 0x6f, 0x2d, 0x61, 0x72, 0x72, 0x61, 0x79, 0x00, 0x01, 0x00,
+  0x00, 0x01, 0x03, 0x63, 0x6c, 0x6f, 0x73, 0x75, 0x72, 0x65, 0x00, 0x01,
+  0x01, 0x03, 0x6c, 0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01,
+  0x03, 0x6c, 0x65, 0x74, 0x00, 0x01, 0x01, 0x01, 0x03, 0x6e, 0x00, 0x01,
+  0x01, 0x03, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x00, 0x01, 0x03, 0x6c,
+  0x73, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x01, 0x01, 0x03, 0x61, 0x72, 0x72, 0x00, 0x01, 0x01, 0x03, 0x6d, 0x6b,
+  0x61, 0x72, 0x72, 0x61, 0x79, 0x00, 0x01, 0x03, 0x6e, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x69,
+  0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x70, 0x72, 0x6f, 0x67,
+  0x6e, 0x00, 0x01, 0x01, 0x03, 0x6c, 0x6f, 0x6f, 0x70, 0x66, 0x6f, 0x72,
+  0x65, 0x61, 0x63, 0x68, 0x00, 0x01, 0x03, 0x65, 0x00, 0x01, 0x03, 0x6c,
+  0x73, 0x00, 0x01, 0x01, 0x03, 0x70, 0x72, 0x6f, 0x67, 0x6e, 0x00, 0x01,
+  0x01, 0x03, 0x73, 0x65, 0x74, 0x69, 0x78, 0x00, 0x01, 0x03, 0x61, 0x72,
+  0x72, 0x00, 0x01, 0x03, 0x69, 0x00, 0x01, 0x03, 0x65, 0x00, 0x03, 0x6e,
+  0x69, 0x6c, 0x00, 0x01, 0x01, 0x03, 0x73, 0x65, 0x74, 0x71, 0x00, 0x01,
+  0x03, 0x69, 0x00, 0x01, 0x01, 0x03, 0x2b, 0x00, 0x01, 0x03, 0x69, 0x00,
+  0x01, 0x05, 0x00, 0x00, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03,
+  0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x03, 0x6e, 0x69,
+  0x6c, 0x00, 0x01, 0x03, 0x61, 0x72, 0x72, 0x00, 0x03, 0x6e, 0x69, 0x6c,
+  0x00, 0x03, 0x6e, 0x69, 0x6c, 0x00, 0x01, 0x03, 0x6e, 0x69, 0x6c, 0x00,
+  0x03, 0x6e, 0x69, 0x6c, 0x00
+};
+static const unsigned int dyn_lib_env_len = 5825;
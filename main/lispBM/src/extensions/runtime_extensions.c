@@ -69,6 +69,86 @@ lbm_value ext_show_trapped_error(lbm_value *args, lbm_uint argn) {
   return ENC_SYM_TRUE;
 }
 
+lbm_value ext_stack_usage(lbm_value *args, lbm_uint argn) {
+  lbm_cid cid = lbm_get_current_cid();
+  if (argn == 1 && lbm_is_number(args[0])) {
+    cid = lbm_dec_as_i32(args[0]);
+  } else if (argn != 0) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint max_used = 0;
+  lbm_uint size = 0;
+  if (!lbm_get_stack_usage(cid, &max_used, &size)) {
+    return ENC_SYM_NIL;
+  }
+  return lbm_heap_allocate_list_init(2,
+                                     lbm_enc_u(max_used),
+                                     lbm_enc_u(size));
+}
+
+lbm_value ext_set_define_optimization(lbm_value *args, lbm_uint argn) {
+  LBM_CHECK_ARGN(1);
+  lbm_set_define_optimization(!lbm_is_symbol_nil(args[0]));
+  return ENC_SYM_TRUE;
+}
+
+#ifdef LBM_EXTENSION_STATS
+// (name calls total-time max-time histogram), with the histogram
+// ending at the last non-empty bucket.
+static lbm_value ext_stats_entry(lbm_uint ix, lbm_extension_stats_t *s) {
+  int last = LBM_EXTENSION_STATS_BUCKETS - 1;
+  while (last > 0 && s->hist[last] == 0) last --;
+  lbm_value hist = ENC_SYM_NIL;
+  for (int i = last; i >= 0; i --) {
+    lbm_value n = lbm_enc_u32(s->hist[i]);
+    if (lbm_is_symbol_merror(n)) return n;
+    hist = lbm_cons(n, hist);
+    if (lbm_is_symbol_merror(hist)) return hist;
+  }
+  lbm_value calls = lbm_enc_u32(s->calls);
+  lbm_value total = lbm_enc_u64(s->total_time);
+  lbm_value max = lbm_enc_u32(s->max_time);
+  if (lbm_is_symbol_merror(calls) ||
+      lbm_is_symbol_merror(total) ||
+      lbm_is_symbol_merror(max)) {
+    return ENC_SYM_MERROR;
+  }
+  return lbm_heap_allocate_list_init(5,
+                                     lbm_enc_sym(EXTENSION_SYMBOLS_START + ix),
+                                     calls,
+                                     total,
+                                     max,
+                                     hist);
+}
+
+lbm_value ext_ext_stats(lbm_value *args, lbm_uint argn) {
+  if (argn == 1) {
+    if (!lbm_is_extension(args[0])) return ENC_SYM_TERROR;
+    lbm_uint ix = lbm_dec_sym(args[0]) - EXTENSION_SYMBOLS_START;
+    return ext_stats_entry(ix, lbm_get_extension_stats(ix));
+  } else if (argn != 0) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_value res = ENC_SYM_NIL;
+  for (lbm_uint i = lbm_get_num_extensions(); i > 0; i --) {
+    lbm_extension_stats_t *s = lbm_get_extension_stats(i - 1);
+    if (s->calls == 0) continue;
+    lbm_value e = ext_stats_entry(i - 1, s);
+    if (lbm_is_symbol_merror(e)) return e;
+    res = lbm_cons(e, res);
+    if (lbm_is_symbol_merror(res)) return res;
+  }
+  return res;
+}
+
+lbm_value ext_ext_stats_reset(lbm_value *args, lbm_uint argn) {
+  (void)args;
+  (void)argn;
+  lbm_reset_extension_stats();
+  return ENC_SYM_TRUE;
+}
+#endif
+
 #ifdef FULL_RTS_LIB
 lbm_value ext_memory_num_free(lbm_value *args, lbm_uint argn) {
   (void)args;
@@ -146,7 +226,9 @@ lbm_value ext_lbm_heap_state(lbm_value *args, lbm_uint argn) {
 
 lbm_value ext_env_get(lbm_value *args, lbm_uint argn) {
   if (argn == 1 && lbm_is_number(args[0])) {
-    lbm_uint ix = lbm_dec_as_u32(args[0]) & GLOBAL_ENV_MASK;
+    lbm_uint ix = lbm_dec_as_u32(args[0]) & (lbm_get_global_env_num_roots() - 1);
+    // Values still in the image must not end up in user code.
+    if (!lbm_global_env_unflatten_bucket(ix)) return ENC_SYM_MERROR;
     return lbm_get_global_env()[ix];
   }
   return ENC_SYM_TERROR;
@@ -161,9 +243,10 @@ lbm_value ext_local_env_get(lbm_value *args, lbm_uint argn) {
 
 lbm_value ext_env_set(lbm_value *args, lbm_uint argn) {
   if (argn == 2 && lbm_is_number(args[0])) {
-    lbm_uint ix = lbm_dec_as_u32(args[0]) & GLOBAL_ENV_MASK;
+    lbm_uint ix = lbm_dec_as_u32(args[0]) & (lbm_get_global_env_num_roots() - 1);
     lbm_value *glob_env = lbm_get_global_env();
     glob_env[ix] = args[1];
+    lbm_global_env_mark_all_dirty();
     return ENC_SYM_TRUE;
   }
   return ENC_SYM_NIL;
@@ -192,6 +275,7 @@ lbm_value ext_set_gc_stack_size(lbm_value *args, lbm_uint argn) {
         lbm_free(lbm_heap_state.gc_stack.data);
         lbm_heap_state.gc_stack.data = new_stack;
         lbm_heap_state.gc_stack.size = n;
+        lbm_heap_state.gc_stack.max_size = n;
         lbm_heap_state.gc_stack.sp = 0;  // should already be 0
         return ENC_SYM_TRUE;
       }
@@ -302,6 +386,10 @@ void lbm_runtime_extensions_init(void) {
 #if defined(LBM_USE_EXT_MAILBOX_GET) || defined(FULL_RTS_LIB)
     lbm_add_extension("mailbox-get", ext_mailbox_get);
 #endif
+#ifdef LBM_EXTENSION_STATS
+    lbm_add_extension("ext-stats", ext_ext_stats);
+    lbm_add_extension("ext-stats-reset", ext_ext_stats_reset);
+#endif
 #ifndef FULL_RTS_LIB
     lbm_add_extension("set-eval-quota", ext_eval_set_quota);
     lbm_add_extension("hide-trapped-error", ext_hide_trapped_error);
@@ -311,6 +399,8 @@ void lbm_runtime_extensions_init(void) {
     lbm_add_extension("set-eval-quota", ext_eval_set_quota);
     lbm_add_extension("hide-trapped-error", ext_hide_trapped_error);
     lbm_add_extension("show-trapped-error", ext_show_trapped_error);
+    lbm_add_extension("set-define-optimization", ext_set_define_optimization);
+    lbm_add_extension("stack-usage", ext_stack_usage);
     lbm_add_extension("mem-num-free", ext_memory_num_free);
     lbm_add_extension("mem-longest-free", ext_memory_longest_free);
     lbm_add_extension("mem-size", ext_memory_size);
@@ -24,6 +24,7 @@
 #include "lbm_c_interop.h"
 #include "eval_cps.h"
 #include "print.h"
+#include "lbm_custom_type.h"
 
 #include <ctype.h>
 
@@ -41,8 +42,6 @@
 #define MAX(a,b) (((a)>(b))?(a):(b))
 #endif
 
-static char print_val_buffer[256];
-
 static lbm_uint sym_left;
 static lbm_uint sym_case_insensitive;
 
@@ -270,14 +269,18 @@ static lbm_value ext_str_part(lbm_value *args, lbm_uint argn) {
   }
 }
 
-static bool char_in(char c, char *delim, unsigned int max_ix) {
-  char *d = delim;
-  unsigned int i = 0;
-  while (i < max_ix && *d != '\0' ) {
-    if (c == *d) return true;
-    d++; i++;
+// Set of delimiter characters, one bit per byte value.
+static void delim_set_init(uint8_t *set, const char *delim, size_t n) {
+  memset(set, 0, 32);
+  for (size_t i = 0; i < n; i ++) {
+    uint8_t c = (uint8_t)delim[i];
+    set[c >> 3] |= (uint8_t)(1 << (c & 7));
   }
-  return false;
+}
+
+static inline bool delim_set_has(const uint8_t *set, char c) {
+  uint8_t u = (uint8_t)c;
+  return (set[u >> 3] >> (u & 7)) & 1;
 }
 
 static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
@@ -324,31 +327,35 @@ static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
   } else if (dec_str_size(args[1], &delim, &delim_arr_size)) {
     lbm_value res = ENC_SYM_NIL;
 
+    uint8_t delim_set[32];
+    delim_set_init(delim_set, delim, strlen_max(delim, delim_arr_size));
+
+    // Stop at the end of the array. Protection against abuse
+    // with byte-arrays.
+    unsigned int len = (unsigned int)strlen_max(str, str_arr_size);
     unsigned int i_start = 0;
     unsigned int i_end = 0;
 
-    // Abort when larger that array size. Protection against abuse
-    // with byte-arrays.
     while (i_end < str_arr_size) {
 
-      while (str[i_end] != '\0' && !char_in(str[i_end], delim, delim_arr_size)) {
+      while (i_end < len && !delim_set_has(delim_set, str[i_end])) {
         i_end ++;
       }
 
-      unsigned int len = i_end - i_start;
+      unsigned int tok_len = i_end - i_start;
       char *s = &str[i_start];
       lbm_value tok;
-      if (lbm_create_array(&tok, len + 1)) {
+      if (lbm_create_array(&tok, tok_len + 1)) {
         lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(tok);
-        memcpy(arr->data, s, len);
-        ((char*)(arr->data))[len] = '\0';
+        memcpy(arr->data, s, tok_len);
+        ((char*)(arr->data))[tok_len] = '\0';
         res = lbm_cons(tok, res);
         if (res == ENC_SYM_MERROR) return res;
       } else {
         return ENC_SYM_MERROR;
       }
 
-      if (str[i_end] == '\0') break;
+      if (i_end >= len) break;
       i_start = i_end + 1;
       i_end = i_end + 1;
 
@@ -358,7 +365,69 @@ static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
   return ENC_SYM_TERROR;
 }
 
-// Todo: Clean this up for 64bit
+// Needles at least this long are searched for with a skip table.
+#define STR_SEARCH_SKIP_MIN 8
+
+// Horspool skip table. Skips are capped at 255, a shorter skip than
+// possible is still correct.
+static void str_search_init(uint8_t *skip, const char *needle, size_t n) {
+  memset(skip, (int)MIN(n, 255), 256);
+  for (size_t i = 0; i + 1 < n; i ++) {
+    skip[(uint8_t)needle[i]] = (uint8_t)MIN(n - 1 - i, 255);
+  }
+}
+
+// First occurrence of needle (n > 0) in hay or NULL. Short needles are
+// found with memchr on their first character.
+static const char *str_search(const char *hay, size_t hay_len, const char *needle, size_t n, const uint8_t *skip) {
+  if (n > hay_len) return NULL;
+  size_t last = hay_len - n;
+  if (n < STR_SEARCH_SKIP_MIN) {
+    size_t i = 0;
+    while (i <= last) {
+      const char *p = memchr(hay + i, needle[0], last - i + 1);
+      if (!p) return NULL;
+      if (memcmp(p, needle, n) == 0) return p;
+      i = (size_t)(p - hay) + 1;
+    }
+    return NULL;
+  }
+  char end = needle[n - 1];
+  size_t i = 0;
+  while (i <= last) {
+    char c = hay[i + n - 1];
+    if (c == end && memcmp(hay + i, needle, n - 1) == 0) return hay + i;
+    i += skip[(uint8_t)c];
+  }
+  return NULL;
+}
+
+// Grow an allocation of old_size bytes from lbm_memory to new_size
+// bytes, in place if the memory after it is free. Returns the possibly
+// moved data or NULL if out of memory, leaving data unchanged.
+static char *str_buf_grow(char *data, size_t old_size, size_t new_size) {
+  lbm_uint words = (lbm_uint)((new_size + sizeof(lbm_uint) - 1) / sizeof(lbm_uint));
+  if (data && lbm_memory_extend((lbm_uint*)data, words)) {
+    return data;
+  }
+  char *new_data = lbm_malloc(new_size);
+  if (new_data && data) {
+    memcpy(new_data, data, old_size);
+    lbm_free(data);
+  }
+  return new_data;
+}
+
+static void str_buf_shrink(char *data, size_t size) {
+  lbm_uint words = (lbm_uint)((size + sizeof(lbm_uint) - 1) / sizeof(lbm_uint));
+  lbm_memory_shrink((lbm_uint*)data, words);
+}
+
+// The result is sized in one allocation. When the replacement is not
+// longer than what it replaces the result fits in the size of the
+// original and is written in a single pass, otherwise the matches are
+// counted first. Growing the buffer as it fills would instead risk a
+// failed allocation and a GC and retry of the whole extension.
 static lbm_value ext_str_replace(lbm_value *args, lbm_uint argn) {
   if (argn != 2 && argn != 3) {
     lbm_set_error_reason((char*)lbm_error_str_num_args);
@@ -366,13 +435,13 @@ static lbm_value ext_str_replace(lbm_value *args, lbm_uint argn) {
   }
 
   size_t orig_arr_size = 0;
-  char *orig = NULL; // lbm_dec_str(args[0]);
+  char *orig = NULL;
   if (!dec_str_size(args[0], &orig, &orig_arr_size)) {
     return ENC_SYM_TERROR;
   }
 
   size_t rep_arr_size = 0;
-  char *rep = NULL; //lbm_dec_str(args[1]);
+  char *rep = NULL;
   if (!dec_str_size(args[1], &rep, &rep_arr_size)) {
     return ENC_SYM_TERROR;
   }
@@ -385,51 +454,52 @@ static lbm_value ext_str_replace(lbm_value *args, lbm_uint argn) {
     }
   }
 
-  // See https://stackoverflow.com/questions/779875/what-function-is-to-replace-a-substring-from-a-string-in-c
-  //char *result; // the return string
-  char *ins;    // the next insert point
-  char *tmp;    // varies
-  size_t len_rep;  // length of rep (the string to remove)
-  size_t len_with; // length of with (the string to replace rep with)
-  //size_t len_front; // distance between rep and end of last rep
-  int count;    // number of replacements
-
-  len_rep = strlen_max(rep, rep_arr_size);
+  size_t len_rep = strlen_max(rep, rep_arr_size);
   if (len_rep == 0) {
-    return args[0]; // empty rep causes infinite loop during count
+    return args[0];
   }
+  size_t len_with = strlen_max(with, with_arr_size);
+  size_t len_orig = strlen_max(orig, orig_arr_size);
 
-  len_with = strlen_max(with,with_arr_size);
-
-  // count the number of replacements needed
-  ins = orig;
-  for (count = 0; (tmp = strstr(ins, rep)); ++count) {
-    ins = tmp + len_rep;
+  uint8_t skip[256];
+  if (len_rep >= STR_SEARCH_SKIP_MIN) {
+    str_search_init(skip, rep, len_rep);
   }
 
-  size_t len_res = strlen_max(orig, orig_arr_size) + (len_with - len_rep) * (unsigned int)count + 1;
-  lbm_value lbm_res;
-  if (lbm_create_array(&lbm_res, len_res)) {
-    lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(lbm_res);
-    tmp = (char*)arr->data;
-  } else {
-    return ENC_SYM_MERROR;
+  size_t cap = len_orig + 1;
+  if (len_with > len_rep) {
+    size_t n = 0;
+    const char *p = orig;
+    const char *end = orig + len_orig;
+    while ((p = str_search(p, (size_t)(end - p), rep, len_rep, skip))) {
+      n ++;
+      p += len_rep;
+    }
+    cap += n * (len_with - len_rep);
   }
+  char *res = lbm_malloc(cap);
+  if (!res) return ENC_SYM_MERROR;
 
-  // first time through the loop, all the variable are set correctly
-  // from here on,
-  //    tmp points to the end of the result string
-  //    ins points to the next occurrence of rep in orig
-  //    orig points to the remainder of orig after "end of rep"
-  while (count--) {
-    ins = strstr(orig, rep);
-    size_t len_front = (size_t)ins - (size_t)orig;
-    tmp = strncpy(tmp, orig, len_front) + len_front;
-    tmp = strncpy(tmp, with, len_with) + len_with;
-    orig += len_front + len_rep; // move to next "end of rep"
+  size_t len = 0;
+  size_t pos = 0;
+  while (true) {
+    const char *match = str_search(orig + pos, len_orig - pos, rep, len_rep, skip);
+    size_t front = match ? (size_t)(match - (orig + pos)) : len_orig - pos;
+    memcpy(res + len, orig + pos, front);
+    len += front;
+    if (!match) break;
+    memcpy(res + len, with, len_with);
+    len += len_with;
+    pos += front + len_rep;
   }
-  strcpy(tmp, orig);
+  res[len] = '\0';
+  str_buf_shrink(res, len + 1);
 
+  lbm_value lbm_res;
+  if (!lbm_lift_array(&lbm_res, res, len + 1)) {
+    lbm_free(res);
+    return ENC_SYM_MERROR;
+  }
   return lbm_res;
 }
 
@@ -503,54 +573,65 @@ static lbm_value ext_str_cmp(lbm_value *args, lbm_uint argn) {
   }
 }
 
-// TODO: This is very similar to ext-print. Maybe they can share code.
-static lbm_value to_str(char *delimiter, lbm_value *args, lbm_uint argn) {
-  const int str_len = 300;
-  char *str = lbm_malloc((lbm_uint)str_len);
-  if (!str) {
-    return ENC_SYM_MERROR;
-  }
+// No string can be longer than lbm_memory. Printing a longer, or
+// cyclic, value fails at this length.
+static lbm_uint to_str_max_len(void) {
+  return lbm_memory_num_words() * sizeof(lbm_uint);
+}
 
-  int str_ofs = 0;
+static bool to_str_count(const char *data, unsigned int len, void *arg) {
+  (void) data;
+  *(lbm_uint*)arg += len;
+  return true;
+}
 
-  for (lbm_uint i = 0; i < argn; i ++) {
-    lbm_value t = args[i];
-    int max = str_len - str_ofs - 1;
+static bool to_str_copy(const char *data, unsigned int len, void *arg) {
+  char **dst = (char**)arg;
+  memcpy(*dst, data, len);
+  *dst += len;
+  return true;
+}
 
-    char *arr_str;
-    int chars = 0;
+// The values are printed twice, first to get the size of the result and
+// then into the result array. Nothing is truncated.
+static lbm_value to_str(char *delimiter, lbm_value *args, lbm_uint argn) {
+  size_t delim_len = strlen(delimiter);
+  lbm_uint len = 0;
+  lbm_uint max_len = to_str_max_len();
 
-    if (lbm_value_is_printable_string(t, &arr_str)) {
-      if (str_ofs == 0) {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s", arr_str);
-      } else {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s%s", delimiter, arr_str);
-      }
-    } else {
-      lbm_print_value(print_val_buffer, 256, t);
-      if (str_ofs == 0) {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s", print_val_buffer);
-      } else {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s%s", delimiter, print_val_buffer);
-      }
+  for (lbm_uint i = 0; i < argn; i ++) {
+    char *arr_str;
+    if (i > 0) len += delim_len;
+    if (lbm_value_is_printable_string(args[i], &arr_str)) {
+      len += strlen(arr_str);
+    } else if (lbm_print_value_stream(args[i], max_len, to_str_count, &len) < 0) {
+      return ENC_SYM_EERROR;
     }
-    if (chars >= max) {
-      str_ofs += max;
-    } else {
-      str_ofs += chars;
-      }
   }
 
   lbm_value res;
-  if (lbm_create_array(&res, (lbm_uint)str_ofs + 1)) {
-    lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(res);
-    strncpy((char*)arr->data, str, (unsigned int)str_ofs + 1);
-    lbm_free(str);
-    return res;
-  } else {
-    lbm_free(str);
+  if (!lbm_create_array(&res, len + 1)) {
     return ENC_SYM_MERROR;
   }
+  lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(res);
+  char *dst = (char*)arr->data;
+
+  for (lbm_uint i = 0; i < argn; i ++) {
+    char *arr_str;
+    if (i > 0) {
+      memcpy(dst, delimiter, delim_len);
+      dst += delim_len;
+    }
+    if (lbm_value_is_printable_string(args[i], &arr_str)) {
+      size_t n = strlen(arr_str);
+      memcpy(dst, arr_str, n);
+      dst += n;
+    } else {
+      lbm_print_value_stream(args[i], max_len, to_str_copy, &dst);
+    }
+  }
+  *dst = 0;
+  return res;
 }
 
 static lbm_value ext_to_str(lbm_value *args, lbm_uint argn) {
@@ -755,6 +836,185 @@ static lbm_value ext_str_find(lbm_value *args, lbm_uint argn) {
   }
 }
 
+// String builders.
+//
+// A string builder is a custom value holding the text in an lbm_memory
+// buffer followed by a zero. The size of the buffer is the capacity. It
+// grows in place when the memory after it is free and is otherwise moved
+// to an allocation of at least twice the size. Freezing shrinks the
+// buffer to the text and hands it out as the result. Being opaque, the
+// length and the buffer cannot be changed from lisp.
+
+#define SB_DEFAULT_CAPACITY 64
+
+static const char *str_builder_desc = "String-Builder";
+
+typedef struct {
+  char *buf;
+  lbm_uint len;
+  lbm_uint size;
+} str_builder_t;
+
+static bool str_builder_destructor(lbm_uint value) {
+  str_builder_t *sb = (str_builder_t*)value;
+  if (sb->buf) lbm_free(sb->buf);
+  lbm_free(sb);
+  return true;
+}
+
+static str_builder_t *str_builder_dec(lbm_value v) {
+  if (!lbm_is_custom(v) ||
+      lbm_get_custom_descriptor(v) != str_builder_desc) {
+    return NULL;
+  }
+  return (str_builder_t*)lbm_get_custom_value(v);
+}
+
+// Decimal text of an integer of type i, as to-str prints it.
+static unsigned int str_builder_int(lbm_int v, char *buf) {
+  char tmp[24];
+  unsigned int n = 0;
+  lbm_uint u = v < 0 ? (lbm_uint)0 - (lbm_uint)v : (lbm_uint)v;
+  do {
+    tmp[n++] = (char)('0' + (u % 10));
+    u /= 10;
+  } while (u > 0);
+  unsigned int len = 0;
+  if (v < 0) buf[len++] = '-';
+  while (n > 0) buf[len++] = tmp[--n];
+  return len;
+}
+
+// Make room for n more characters and the terminating zero.
+static bool str_builder_reserve(str_builder_t *sb, lbm_uint n) {
+  lbm_uint need = sb->len + n + 1;
+  if (need <= sb->size) return true;
+  lbm_uint cap = sb->buf ? MAX(need, sb->size * 2) : MAX(need, SB_DEFAULT_CAPACITY);
+  char *grown = str_buf_grow(sb->buf, sb->size, cap);
+  if (!grown) return false;
+  sb->buf = grown;
+  sb->size = cap;
+  return true;
+}
+
+// signature: (mk-str-builder [capacity]) -> str-builder
+static lbm_value ext_mk_str_builder(lbm_value *args, lbm_uint argn) {
+  lbm_uint cap = 0;
+  if (argn == 1 && lbm_is_number(args[0])) {
+    cap = lbm_dec_as_u32(args[0]);
+  } else if (argn != 0) {
+    return ENC_SYM_TERROR;
+  }
+  str_builder_t *sb = lbm_malloc(sizeof(str_builder_t));
+  if (!sb) {
+    return ENC_SYM_MERROR;
+  }
+  sb->buf = NULL;
+  sb->len = 0;
+  sb->size = 0;
+  lbm_value res;
+  if ((cap > 0 && !str_builder_reserve(sb, cap)) ||
+      !lbm_custom_type_create((lbm_uint)sb, str_builder_destructor, str_builder_desc, &res)) {
+    str_builder_destructor((lbm_uint)sb);
+    return ENC_SYM_MERROR;
+  }
+  return res;
+}
+
+// signature: (str-builder-append sb val ...) -> sb
+// Strings are appended as they are, chars as a single character and
+// other values as to-str prints them. Nothing is appended if there is
+// not enough memory for all of the values.
+static lbm_value ext_str_builder_append(lbm_value *args, lbm_uint argn) {
+  if (argn < 1) {
+    lbm_set_error_reason((char*)lbm_error_str_num_args);
+    return ENC_SYM_EERROR;
+  }
+  str_builder_t *sb = str_builder_dec(args[0]);
+  if (!sb) {
+    lbm_set_error_suspect(args[0]);
+    return ENC_SYM_TERROR;
+  }
+
+  lbm_uint n = 0;
+  lbm_uint max_len = to_str_max_len();
+  for (lbm_uint i = 1; i < argn; i ++) {
+    char *str;
+    size_t size;
+    if (dec_str_size(args[i], &str, &size)) {
+      n += strlen_max(str, size);
+    } else if (lbm_type_of(args[i]) == LBM_TYPE_CHAR) {
+      n += 1;
+    } else if (lbm_type_of(args[i]) == LBM_TYPE_I) {
+      char buf[24];
+      n += str_builder_int(lbm_dec_i(args[i]), buf);
+    } else if (lbm_print_value_stream(args[i], max_len, to_str_count, &n) < 0) {
+      return ENC_SYM_EERROR;
+    }
+  }
+  if (!str_builder_reserve(sb, n)) {
+    return ENC_SYM_MERROR;
+  }
+
+  char *dst = sb->buf + sb->len;
+  for (lbm_uint i = 1; i < argn; i ++) {
+    char *str;
+    size_t size;
+    if (dec_str_size(args[i], &str, &size)) {
+      size_t str_len = strlen_max(str, size);
+      memcpy(dst, str, str_len);
+      dst += str_len;
+    } else if (lbm_type_of(args[i]) == LBM_TYPE_CHAR) {
+      *dst++ = (char)lbm_dec_char(args[i]);
+    } else if (lbm_type_of(args[i]) == LBM_TYPE_I) {
+      dst += str_builder_int(lbm_dec_i(args[i]), dst);
+    } else {
+      lbm_print_value_stream(args[i], max_len, to_str_copy, &dst);
+    }
+  }
+  *dst = '\0';
+  sb->len += n;
+  return args[0];
+}
+
+// signature: (str-builder-len sb) -> int
+static lbm_value ext_str_builder_len(lbm_value *args, lbm_uint argn) {
+  LBM_CHECK_ARGN(1);
+  str_builder_t *sb = str_builder_dec(args[0]);
+  if (!sb) {
+    lbm_set_error_suspect(args[0]);
+    return ENC_SYM_TERROR;
+  }
+  return lbm_enc_i((lbm_int)sb->len);
+}
+
+// signature: (str-builder-freeze sb) -> str
+// The builder is empty afterwards and can be reused.
+static lbm_value ext_str_builder_freeze(lbm_value *args, lbm_uint argn) {
+  LBM_CHECK_ARGN(1);
+  str_builder_t *sb = str_builder_dec(args[0]);
+  if (!sb) {
+    lbm_set_error_suspect(args[0]);
+    return ENC_SYM_TERROR;
+  }
+  lbm_value res;
+  if (!sb->buf) {
+    if (!lbm_create_array(&res, 1)) {
+      return ENC_SYM_MERROR;
+    }
+    return res;
+  }
+  str_buf_shrink(sb->buf, sb->len + 1);
+  sb->size = sb->len + 1;
+  if (!lbm_lift_array(&res, sb->buf, sb->size)) {
+    return ENC_SYM_MERROR;
+  }
+  sb->buf = NULL;
+  sb->len = 0;
+  sb->size = 0;
+  return res;
+}
+
 void lbm_string_extensions_init(void) {
 
   lbm_add_symbol_const("left", &sym_left);
@@ -775,4 +1035,8 @@ void lbm_string_extensions_init(void) {
   lbm_add_extension("str-len", ext_str_len);
   lbm_add_extension("str-replicate", ext_str_replicate);
   lbm_add_extension("str-find", ext_str_find);
+  lbm_add_extension("mk-str-builder", ext_mk_str_builder);
+  lbm_add_extension("str-builder-append", ext_str_builder_append);
+  lbm_add_extension("str-builder-len", ext_str_builder_len);
+  lbm_add_extension("str-builder-freeze", ext_str_builder_freeze);
 }
@@ -726,26 +726,23 @@ static lbm_value fundamental_append(lbm_value *args, lbm_uint nargs, eval_contex
 
 static lbm_value fundamental_undefine(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   (void) ctx;
-  lbm_value *global_env = lbm_get_global_env();
   if (nargs == 1 && lbm_is_symbol(args[0])) {
     lbm_value key = args[0];
-    lbm_uint ix_key = lbm_dec_sym(key) & GLOBAL_ENV_MASK;
-    lbm_value env = global_env[ix_key];
-    lbm_value res = lbm_env_drop_binding(env, key);
+    lbm_value *bucket = lbm_global_env_bucket(key);
+    lbm_value res = lbm_env_drop_binding(*bucket, key);
     if (res == ENC_SYM_NOT_FOUND) {
       return ENC_SYM_NIL;
     }
-    global_env[ix_key] = res;
+    *bucket = res;
     return ENC_SYM_TRUE;
   } else if (nargs == 1 && lbm_is_cons(args[0])) {
     lbm_value curr = args[0];
     while (lbm_type_of(curr) == LBM_TYPE_CONS) {
       lbm_value key = lbm_car(curr);
-      lbm_uint ix_key = lbm_dec_sym(key) & GLOBAL_ENV_MASK;
-      lbm_value env = global_env[ix_key];
-      lbm_value res = lbm_env_drop_binding(env, key);
+      lbm_value *bucket = lbm_global_env_bucket(key);
+      lbm_value res = lbm_env_drop_binding(*bucket, key);
       if (res != ENC_SYM_NOT_FOUND) {
-        global_env[ix_key] = res;
+        *bucket = res;
       }
       curr = lbm_cdr(curr);
     }
@@ -1567,3 +1564,5 @@ const fundamental_fun fundamental_table[] =
    fundamental_is_constant,
    fundamental_member
   };
+
+const lbm_uint fundamental_table_size = sizeof(fundamental_table) / sizeof(fundamental_table[0]);
@@ -182,10 +182,7 @@ int lbm_define(char *symbol, lbm_value value) {
     if (lbm_get_eval_state() == EVAL_CPS_STATE_PAUSED) {
       if (lbm_get_symbol_by_name(symbol, &sym_id) ||
           lbm_add_symbol_const_base(symbol, &sym_id, false)) {
-        lbm_uint ix_key = sym_id & GLOBAL_ENV_MASK;
-        lbm_value *glob_env = lbm_get_global_env();
-        glob_env[ix_key] = lbm_env_set(glob_env[ix_key], lbm_enc_sym(sym_id), value);
-        res = 1;
+        res = !lbm_is_symbol_merror(lbm_global_env_set(lbm_enc_sym(sym_id), value));
       }
     }
   }
@@ -197,12 +194,11 @@ int lbm_undefine(char *symbol) {
   int res = 0;
   if (symbol && lbm_get_symbol_by_name(symbol, &sym_id)) {
 
-    lbm_value *glob_env = lbm_get_global_env();
-    lbm_uint ix_key = sym_id & GLOBAL_ENV_MASK;
-    lbm_value new_env = lbm_env_drop_binding(glob_env[ix_key], lbm_enc_sym(sym_id));
+    lbm_value *bucket = lbm_global_env_bucket(lbm_enc_sym(sym_id));
+    lbm_value new_env = lbm_env_drop_binding(*bucket, lbm_enc_sym(sym_id));
 
     if (new_env != ENC_SYM_NOT_FOUND) {
-      glob_env[ix_key] = new_env;
+      *bucket = new_env;
       res = 1;
     }
   }
@@ -252,7 +248,8 @@ int lbm_create_array(lbm_value *value, lbm_uint num_elt) {
 void lbm_clear_env(void) {
 
   lbm_value *env = lbm_get_global_env();
-  for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+  lbm_uint n_roots = lbm_get_global_env_num_roots();
+  for (lbm_uint i = 0; i < n_roots; i ++) {
     env[i] = ENC_SYM_NIL;
   }
   lbm_perform_gc();
@@ -261,7 +258,8 @@ void lbm_clear_env(void) {
 // Evaluator should be paused when running this.
 // Running gc will reclaim the fv storage.
 bool lbm_flatten_env(int index, lbm_uint** data, lbm_uint *size) {
-  if (index < 0 || index >= GLOBAL_ENV_ROOTS) return false;
+  if (index < 0 || (lbm_uint)index >= lbm_get_global_env_num_roots()) return false;
+  if (!lbm_global_env_unflatten_bucket((lbm_uint)index)) return false;
   lbm_value *env = lbm_get_global_env();
 
   lbm_value fv = flatten_value(env[index]);
@@ -30,6 +30,10 @@ int lbm_channel_peek(lbm_char_channel_t *chan, unsigned int n, char *res) {
   return chan->peek(chan, n, res);
 }
 
+int lbm_channel_peek_span(lbm_char_channel_t *chan, const char **data, unsigned int *len) {
+  return chan->peek_span(chan, data, len);
+}
+
 bool lbm_channel_read(lbm_char_channel_t *chan, char *res) {
   return chan->read(chan, res);
 }
@@ -136,6 +140,27 @@ int buffered_peek(lbm_char_channel_t *chan, unsigned int n, char *res) {
   return ret;
 }
 
+// The span ends where the written data ends or where the buffer wraps
+// around. The writer never overwrites unread data so the span stays
+// valid after the lock is released.
+int buffered_peek_span(lbm_char_channel_t *chan, const char **data, unsigned int *len) {
+  lbm_buffered_channel_state_t *st = (lbm_buffered_channel_state_t*)chan->state;
+  int ret;
+  mutex_lock(&st->lock);
+  unsigned int end = st->write_pos >= st->read_pos ? st->write_pos : TOKENIZER_BUFFER_SIZE;
+  *data = st->buffer + st->read_pos;
+  *len = end - st->read_pos;
+  if (*len > 0) {
+    ret = CHANNEL_SUCCESS;
+  } else if (!buffered_more(chan)) {
+    ret = CHANNEL_END;
+  } else {
+    ret = CHANNEL_MORE;
+  }
+  mutex_unlock(&st->lock);
+  return ret;
+}
+
 bool buffered_channel_is_empty(lbm_char_channel_t *chan) {
   lbm_buffered_channel_state_t *st = (lbm_buffered_channel_state_t*)chan->state;
   if (st->read_pos == st->write_pos) {
@@ -174,14 +199,26 @@ bool buffered_read(lbm_char_channel_t *chan, char *res) {
 }
 
 bool buffered_drop(lbm_char_channel_t *chan, unsigned int n) {
-  bool r = true;
-  char c;
-
-  for (unsigned int i = 0; i < n; i ++) {
-    r = buffered_read(chan, &c);
-    if (r == false) break;
+  lbm_buffered_channel_state_t *st = (lbm_buffered_channel_state_t*)chan->state;
+  char *buffer = st->buffer;
+  mutex_lock(&st->lock);
+  unsigned int read_pos = st->read_pos;
+  unsigned int row = st->row;
+  unsigned int column = st->column;
+  while (n > 0 && read_pos != st->write_pos) {
+    column ++;
+    if (buffer[read_pos] == '\n') {
+      column = 1;
+      row ++;
+    }
+    read_pos = (read_pos + 1) % TOKENIZER_BUFFER_SIZE;
+    n --;
   }
-  return r;
+  st->read_pos = read_pos;
+  st->row = row;
+  st->column = column;
+  mutex_unlock(&st->lock);
+  return n == 0;
 }
 
 int buffered_write(lbm_char_channel_t *chan, char c) {
@@ -238,6 +275,7 @@ void lbm_create_buffered_char_channel(lbm_buffered_channel_state_t *st,
   chan->state = st;
   chan->more = buffered_more;
   chan->peek = buffered_peek;
+  chan->peek_span = buffered_peek_span;
   chan->read = buffered_read;
   chan->drop = buffered_drop;
   chan->comment = buffered_comment;
@@ -295,6 +333,17 @@ int string_peek(lbm_char_channel_t *chan, unsigned int n, char *res) {
   return CHANNEL_END;
 }
 
+int string_peek_span(lbm_char_channel_t *chan, const char **data, unsigned int *len) {
+  lbm_string_channel_state_t *st = (lbm_string_channel_state_t*)chan->state;
+  if (st->read_pos < st->length) {
+    *data = st->str + st->read_pos;
+    *len = st->length - st->read_pos;
+    return CHANNEL_SUCCESS;
+  }
+  *len = 0;
+  return CHANNEL_END;
+}
+
 bool string_channel_is_empty(lbm_char_channel_t *chan) {
   lbm_string_channel_state_t *st = (lbm_string_channel_state_t*)chan->state;
   if (st->read_pos == st->length) {
@@ -333,16 +382,28 @@ bool string_read(lbm_char_channel_t *chan, char *res) {
 }
 
 bool string_drop(lbm_char_channel_t *chan, unsigned int n) {
-  bool r = true;
-  char c;
-
-  if (n > 0) {
-    do {
-      r = string_read(chan, &c);
-      n--;
-    } while (n > 0 && r);
+  lbm_string_channel_state_t *st = (lbm_string_channel_state_t*)chan->state;
+  char *str = st->str;
+  unsigned int avail = st->length - st->read_pos;
+  unsigned int k = n < avail ? n : avail;
+  unsigned int row = st->row;
+  unsigned int column = st->column;
+  for (unsigned int i = st->read_pos; i < st->read_pos + k; i ++) {
+    if (str[i] == '\n') {
+      row ++;
+      column = 1;
+    } else if (str[i] == 0) {
+      st->more = false;
+    } else {
+      column ++;
+    }
   }
-  return r;
+  st->read_pos += k;
+  st->row = row;
+  st->column = column;
+  // Reading past the end marks the channel as finished.
+  if (n > k) st->more = false;
+  return true;
 }
 
 int string_write(lbm_char_channel_t *chan, char c) {
@@ -395,6 +456,7 @@ void lbm_create_string_char_channel(lbm_string_channel_state_t *st,
   chan->state = st;
   chan->more = string_more;
   chan->peek = string_peek;
+  chan->peek_span = string_peek_span;
   chan->read = string_read;
   chan->drop = string_drop;
   chan->comment = string_comment;
@@ -427,6 +489,7 @@ void lbm_create_string_char_channel_size(lbm_string_channel_state_t *st,
   chan->state = st;
   chan->more = string_more;
   chan->peek = string_peek;
+  chan->peek_span = string_peek_span;
   chan->read = string_read;
   chan->drop = string_drop;
   chan->comment = string_comment;
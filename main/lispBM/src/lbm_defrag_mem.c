@@ -23,13 +23,29 @@ static inline lbm_uint bs2ws(lbm_uint bs) {
   return bs % sizeof(lbm_uint) == 0 ? bs / sizeof(lbm_uint) : (bs / sizeof(lbm_uint)) + 1;
 }
 
-#define DEFRAG_MEM_HEADER_SIZE 2
+// Number of free ranges a defrag mem keeps track of in its header.
+#ifndef LBM_DEFRAG_MEM_HOLES
+#define LBM_DEFRAG_MEM_HOLES 8
+#endif
+
+// Default number of bytes an allocation may move to compact the pool
+// when none of the tracked free ranges fits. 0 disables it.
+#ifndef LBM_DEFRAG_MEM_COMPACT_STEP
+#define LBM_DEFRAG_MEM_COMPACT_STEP 1024
+#endif
+
+#define DEFRAG_MEM_HEADER_SIZE (4 + 2 * LBM_DEFRAG_MEM_HOLES)
 #define DEFRAG_MEM_HEADER_BYTES  (DEFRAG_MEM_HEADER_SIZE*sizeof(lbm_uint))
 #define DEFRAG_MEM_DATA(X) &(X)[DEFRAG_MEM_HEADER_SIZE];
 // length and flags.
 // Currently only one flag that tells if we should do a compaction before allocation.
 #define DEFRAG_MEM_SIZE(X) X[0]
 #define DEFRAG_MEM_FLAGS(X) X[1]
+// Where the next compaction step starts.
+#define DEFRAG_MEM_CURSOR(X) X[2]
+// Free ranges as (start, size) pairs in words, smallest first.
+#define DEFRAG_MEM_NUM_HOLES(X) X[3]
+#define DEFRAG_MEM_HOLES(X) (&(X)[4])
 
 // TODO: We can move the GC index to the end (or elsewhere) of an array to save space in these
 //       headers in the case of ByteArrays.
@@ -39,6 +55,105 @@ static inline lbm_uint bs2ws(lbm_uint bs) {
 #define DEFRAG_ALLOC_CELLPTR(X) X[2]
 #define DEFRAG_ALLOC_ARRAY_HEADER_SIZE 3
 
+static lbm_uint compact_step_bytes = LBM_DEFRAG_MEM_COMPACT_STEP;
+
+void lbm_defrag_mem_set_compact_step(lbm_uint nbytes) {
+  compact_step_bytes = nbytes;
+}
+
+static inline lbm_uint alloc_words(lbm_uint *allocation) {
+  return bs2ws(DEFRAG_ALLOC_SIZE(allocation)) + DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
+}
+
+// The index of free ranges.
+//
+// Every range in the index is free, but not all free space is in the
+// index. GC frees an allocation without knowing what defrag mem it is
+// in, so space freed by GC is found when the index is rebuilt by
+// scanning the pool. That happens when no range in the index fits an
+// allocation. When full, the index keeps the largest ranges.
+
+static void index_remove(lbm_uint *defrag_mem, lbm_uint ix) {
+  lbm_uint *holes = DEFRAG_MEM_HOLES(defrag_mem);
+  lbm_uint n = DEFRAG_MEM_NUM_HOLES(defrag_mem);
+  for (lbm_uint i = ix; i + 1 < n; i ++) {
+    holes[2 * i] = holes[2 * (i + 1)];
+    holes[2 * i + 1] = holes[2 * (i + 1) + 1];
+  }
+  DEFRAG_MEM_NUM_HOLES(defrag_mem) = n - 1;
+}
+
+static void index_insert(lbm_uint *defrag_mem, lbm_uint start, lbm_uint size) {
+  lbm_uint *holes = DEFRAG_MEM_HOLES(defrag_mem);
+  if (DEFRAG_MEM_NUM_HOLES(defrag_mem) == LBM_DEFRAG_MEM_HOLES) {
+    if (size <= holes[1]) return;
+    index_remove(defrag_mem, 0);
+  }
+  lbm_uint i = DEFRAG_MEM_NUM_HOLES(defrag_mem);
+  while (i > 0 && holes[2 * (i - 1) + 1] > size) {
+    holes[2 * i] = holes[2 * (i - 1)];
+    holes[2 * i + 1] = holes[2 * (i - 1) + 1];
+    i --;
+  }
+  holes[2 * i] = start;
+  holes[2 * i + 1] = size;
+  DEFRAG_MEM_NUM_HOLES(defrag_mem) ++;
+}
+
+static void index_rebuild(lbm_uint *defrag_mem) {
+  lbm_uint mem_size = DEFRAG_MEM_SIZE(defrag_mem);
+  lbm_uint *mem_data = DEFRAG_MEM_DATA(defrag_mem);
+  DEFRAG_MEM_NUM_HOLES(defrag_mem) = 0;
+  for (lbm_uint i = 0; i < mem_size;) {
+    if (mem_data[i] != 0) {
+      i += alloc_words(&mem_data[i]);
+    } else {
+      lbm_uint start = i;
+      while (i < mem_size && mem_data[i] == 0) i ++;
+      index_insert(defrag_mem, start, i - start);
+    }
+  }
+}
+
+// Take words from the smallest range in the index that fits.
+static bool index_take(lbm_uint *defrag_mem, lbm_uint words, lbm_uint *start) {
+  lbm_uint *holes = DEFRAG_MEM_HOLES(defrag_mem);
+  lbm_uint n = DEFRAG_MEM_NUM_HOLES(defrag_mem);
+  for (lbm_uint i = 0; i < n; i ++) {
+    if (holes[2 * i + 1] >= words) {
+      *start = holes[2 * i];
+      holes[2 * i] += words;
+      holes[2 * i + 1] -= words;
+      if (holes[2 * i + 1] == 0) {
+        index_remove(defrag_mem, i);
+      } else {
+        while (i > 0 && holes[2 * (i - 1) + 1] > holes[2 * i + 1]) {
+          lbm_uint s = holes[2 * i];
+          lbm_uint z = holes[2 * i + 1];
+          holes[2 * i] = holes[2 * (i - 1)];
+          holes[2 * i + 1] = holes[2 * (i - 1) + 1];
+          holes[2 * (i - 1)] = s;
+          holes[2 * (i - 1) + 1] = z;
+          i --;
+        }
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// Move the allocation at source to target and update the cell that
+// refers to it. The words of source that are not overwritten are cleared.
+static void move_allocation(lbm_uint *target, lbm_uint *source, lbm_uint words) {
+  lbm_uint move_dist = (lbm_uint)(source - target);
+  memmove(target, source, words * sizeof(lbm_uint));
+  memset(&target[words], 0, move_dist * sizeof(lbm_uint));
+  DEFRAG_ALLOC_DATA(target) = (lbm_uint)&target[DEFRAG_ALLOC_ARRAY_HEADER_SIZE];
+  lbm_value cell = DEFRAG_ALLOC_CELLPTR(target);
+  lbm_set_car(cell,(lbm_uint)target);
+}
+
 lbm_value lbm_defrag_mem_create(lbm_uint nbytes) {
   lbm_value res = ENC_SYM_TERROR;
   lbm_uint nwords = bs2ws(nbytes); // multiple of 4.
@@ -49,6 +164,7 @@ lbm_value lbm_defrag_mem_create(lbm_uint nbytes) {
       memset((uint8_t*)data , 0, DEFRAG_MEM_HEADER_BYTES + nwords*sizeof(lbm_uint));
       data[0] = nwords;
       data[1] = 0;      //flags
+      index_insert(data, 0, nwords);
       lbm_value cell = lbm_heap_allocate_cell(LBM_TYPE_DEFRAG_MEM, (lbm_uint)data, ENC_SYM_DEFRAG_MEM_TYPE);
       if (cell == ENC_SYM_MERROR) {
         lbm_free(data);
@@ -92,11 +208,9 @@ void lbm_defrag_mem_destroy(lbm_uint *defrag_mem) {
     lbm_uint a = defrag_data[i];
     if (a != 0) {
       lbm_uint *allocation = &defrag_data[i];
-      lbm_uint alloc_words =
-        DEFRAG_ALLOC_ARRAY_HEADER_SIZE +
-        bs2ws(DEFRAG_ALLOC_SIZE(allocation));
+      lbm_uint words = alloc_words(allocation);
       free_defrag_allocation(allocation);
-      i += alloc_words;
+      i += words;
     }
     else i ++;
   }
@@ -114,45 +228,68 @@ static void lbm_defrag_mem_defrag(lbm_uint *defrag_mem, lbm_uint bytes) {
   for (lbm_uint i = 0; i < mem_size; ) {
     // check if there is an allocation here
     if (mem_data[i] != 0) {
-      lbm_uint *source = &mem_data[i];
-      lbm_uint *target = &mem_data[hole_start];
-      lbm_uint alloc_bytes = DEFRAG_ALLOC_SIZE(source);
-      lbm_uint alloc_words = bs2ws(alloc_bytes);
+      lbm_uint words = alloc_words(&mem_data[i]);
       // move allocation into hole
       if (hole_start == i) {
-        i += alloc_words + DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
+        i += words;
         hole_start = i;
       } else {
         lbm_uint move_dist = i - hole_start;
         if (move_dist >= until_size) break;
-        lbm_uint clear_ix = (hole_start + alloc_words + DEFRAG_ALLOC_ARRAY_HEADER_SIZE);
-        memmove(target, source, (alloc_words + DEFRAG_ALLOC_ARRAY_HEADER_SIZE) * sizeof(lbm_uint));
-        memset(&mem_data[clear_ix],0, move_dist* sizeof(lbm_uint));
-        DEFRAG_ALLOC_DATA(target) = (lbm_uint)&target[DEFRAG_ALLOC_ARRAY_HEADER_SIZE];
-        lbm_value cell = DEFRAG_ALLOC_CELLPTR(target);
-
-        lbm_set_car(cell,(lbm_uint)target);
+        move_allocation(&mem_data[hole_start], &mem_data[i], words);
         // move home and i forwards.
         // i can move to the original end of allocation.
-        hole_start += alloc_words +  DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
-        i += alloc_words +  DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
+        hole_start += words;
+        i += words;
       }
     } else {
       // no allocation hole remains but i increments.
       i ++;
     }
   }
+  DEFRAG_MEM_CURSOR(defrag_mem) = 0;
+  DEFRAG_MEM_NUM_HOLES(defrag_mem) = 0;
+}
+
+// Compact the pool by moving allocations at most max_words in total,
+// starting where the previous step stopped. An allocation larger than
+// max_words is never moved by a step and the free space before it is
+// left for lbm_defrag_mem_defrag. Clears the index.
+static void lbm_defrag_mem_compact_step(lbm_uint *defrag_mem, lbm_uint max_words) {
+  lbm_uint mem_size = DEFRAG_MEM_SIZE(defrag_mem);
+  lbm_uint *mem_data = DEFRAG_MEM_DATA(defrag_mem);
+  lbm_uint i = DEFRAG_MEM_CURSOR(defrag_mem);
+  lbm_uint hole_start = i;
+  lbm_uint moved = 0;
+
+  while (i < mem_size) {
+    if (mem_data[i] == 0) {
+      i ++;
+      continue;
+    }
+    lbm_uint words = alloc_words(&mem_data[i]);
+    if (hole_start == i || words > max_words) {
+      i += words;
+      hole_start = i;
+    } else {
+      if (moved + words > max_words) break;
+      move_allocation(&mem_data[hole_start], &mem_data[i], words);
+      moved += words;
+      hole_start += words;
+      i += words;
+    }
+  }
+  DEFRAG_MEM_CURSOR(defrag_mem) = i < mem_size ? hole_start : 0;
+  DEFRAG_MEM_NUM_HOLES(defrag_mem) = 0;
 }
 
 // Allocate an array from the defragable pool
 // these arrays must be recognizable by GC so that
 // gc can free them by performing a call into the defrag_mem api.
 // At the same time they need to be just bytearrays..
-// Allocation must always scan from start.
-//
-
-#define INIT 0
-#define FREE_LEN 1
+// Allocation takes the smallest free range in the index that fits.
+// If none fits, a compaction step is done and the index is rebuilt
+// from a scan of the pool.
 
 // An array allocated in defragmem has the following layout inside of the defrag mem
 //
@@ -167,48 +304,27 @@ lbm_value lbm_defrag_mem_alloc_internal(lbm_uint *defrag_mem, lbm_uint bytes, lb
     return cell;
   }
 
-  lbm_uint mem_size = DEFRAG_MEM_SIZE(defrag_mem);
   lbm_uint *mem_data = DEFRAG_MEM_DATA(defrag_mem);
 
   lbm_uint num_words = bs2ws(bytes);
-  lbm_uint alloc_words = num_words +  DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
+  lbm_uint words = num_words +  DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
 
-  uint8_t state = INIT;
-  lbm_uint free_words = 0;
   lbm_uint free_start = 0;
-  bool alloc_found = false;
   lbm_value res = ENC_SYM_MERROR;
 
-  for (lbm_uint i = 0; i < mem_size;) {
-    switch(state) {
-    case INIT:
-      if (mem_data[i] == 0) {
-        free_start = i;
-        free_words = 1;
-        state = FREE_LEN;
-        i++;
-      } else {
-        // jump to next spot
-        i += bs2ws(mem_data[i]) + DEFRAG_ALLOC_ARRAY_HEADER_SIZE;
-      }
-      break;
-    case FREE_LEN:
-      if (mem_data[i] == 0) {
-        free_words ++;
-        if (free_words >= alloc_words) {
-          alloc_found = true;
-        } else {
-          i ++;
-        }
-      } else {
-        state = INIT;
-        i++;
-      }
-      break;
+  bool alloc_found = index_take(defrag_mem, words, &free_start);
+  if (!alloc_found) {
+    if (compact_step_bytes > 0) {
+      lbm_defrag_mem_compact_step(defrag_mem, bs2ws(compact_step_bytes));
     }
-    if (alloc_found) break;
+    index_rebuild(defrag_mem);
+    alloc_found = index_take(defrag_mem, words, &free_start);
   }
   if (alloc_found) {
+    lbm_uint cursor = DEFRAG_MEM_CURSOR(defrag_mem);
+    if (free_start < cursor && cursor < free_start + words) {
+      DEFRAG_MEM_CURSOR(defrag_mem) = free_start;
+    }
     lbm_uint *allocation = (lbm_uint*)&mem_data[free_start];
     DEFRAG_ALLOC_SIZE(allocation) = bytes;
     DEFRAG_ALLOC_DATA(allocation) = (lbm_uint)&allocation[DEFRAG_ALLOC_ARRAY_HEADER_SIZE]; //data starts after back_ptr
@@ -254,6 +254,12 @@ int lbm_get_max_flatten_depth(void) {
   return flatten_maximum_depth;
 }
 
+static void (*unflatten_array_callback)(lbm_value) = NULL;
+
+void lbm_set_unflatten_array_callback(void (*fptr)(lbm_value)) {
+  unflatten_array_callback = fptr;
+}
+
 static void flatten_error(jmp_buf jb, int val) {
   longjmp(jb, val);
 }
@@ -299,15 +305,28 @@ static int flatten_value_size_internal(jmp_buf jb, lbm_value v, int depth, bool
 
   switch (t) {
   case LBM_TYPE_CONS: {
+    // The spine of a list is walked iteratively, see flatten_value_internal.
     int res = 0;
-    int s1 = flatten_value_size_internal(jb,lbm_car(v), depth + 1, image);
-    if (s1 > 0) {
-      int s2 = flatten_value_size_internal(jb,lbm_cdr(v), depth + 1, image);
-      if (s2 > 0) {
-        res = (1 + s1 + s2);
+    lbm_value slow = v;
+    lbm_uint power = 1;
+    lbm_uint lam = 0;
+    while (lbm_is_cons(v) && !(image && (v & LBM_PTR_TO_CONSTANT_BIT))) {
+      int s1 = flatten_value_size_internal(jb,lbm_car(v), depth + 1, image);
+      if (s1 <= 0) return 0;
+      res += 1 + s1;
+      v = lbm_cdr(v);
+      if (v == slow) {
+        flatten_error(jb, FLATTEN_VALUE_ERROR_CIRCULAR);
+      }
+      if (++lam == power) {
+        slow = v;
+        power <<= 1;
+        lam = 0;
       }
     }
-    return res;
+    int s2 = flatten_value_size_internal(jb,v, depth + 1, image);
+    if (s2 <= 0) return 0;
+    return res + s2;
   }
   case LBM_TYPE_LISPARRAY: {
     int sum = 4 + 1; // sizeof(uint32_t) + 1;
@@ -371,7 +390,174 @@ int flatten_value_size(lbm_value v, bool image) {
   return flatten_value_size_internal(jb, v, 0, image);
 }
 
-int flatten_value_c(lbm_flat_value_t *fv, lbm_value v) {
+// Make room for n more bytes. Buffers that are not growable are left as
+// they are and the f_* writers will report that the buffer is too small.
+static bool flatten_reserve(lbm_flat_value_t *fv, lbm_uint n, bool grow) {
+  if (!grow || fv->buf_pos + n <= fv->buf_size) return true;
+  lbm_uint new_size = fv->buf_size * 2;
+  if (new_size < fv->buf_pos + n) new_size = fv->buf_pos + n;
+  lbm_uint new_words = (new_size + sizeof(lbm_uint) - 1) / sizeof(lbm_uint);
+  if (lbm_memory_extend((lbm_uint*)fv->buf, new_words)) {
+    fv->buf_size = new_words * sizeof(lbm_uint);
+    return true;
+  }
+  uint8_t *data = lbm_malloc(new_size);
+  if (!data) return false;
+  memcpy(data, fv->buf, fv->buf_pos);
+  lbm_free(fv->buf);
+  fv->buf = data;
+  fv->buf_size = new_size;
+  return true;
+}
+
+#ifndef LBM64
+#define FLAT_INT_SIZE  (1 + 4)
+#else
+#define FLAT_INT_SIZE  (1 + 8)
+#endif
+
+#define FLATTEN_RESERVE(n) if (!flatten_reserve(fv, (n), grow)) return FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY
+
+// ------------------------------------------------------------
+// Sharing preserving flatten
+//
+// Nodes (conses, lisp arrays and byte arrays) that are reachable along
+// more than one path are found in a first pass and collected in an open
+// addressing hash table of [node, state] pairs. While writing, the
+// first occurrence of a shared node is preceded by S_SHARED_LOCAL,
+// which implicitly numbers it, and later occurrences are written as
+// S_REF_LOCAL with that number.
+
+#define SHARING_SEEN   ((lbm_uint)-1)
+#define SHARING_SHARED ((lbm_uint)-2)
+
+#define SHARING_INITIAL_SIZE 64
+
+typedef struct {
+  lbm_uint *table;
+  lbm_uint size; // number of [node, state] slots, power of two.
+  lbm_uint num;
+  uint32_t num_shared;
+  uint32_t next_id;
+} flatten_sharing_t;
+
+static bool sharing_tracked(lbm_value v) {
+  return lbm_is_cons(v) || lbm_is_lisp_array_r(v) || lbm_is_array_r(v);
+}
+
+static lbm_uint *sharing_slot(lbm_uint *table, lbm_uint size, lbm_value v) {
+  lbm_uint i = (lbm_uint)(((v >> 2) * 2654435761u) & (size - 1));
+  while (table[2*i] != 0 && table[2*i] != v) {
+    i = (i + 1) & (size - 1);
+  }
+  return &table[2*i];
+}
+
+static bool sharing_init(flatten_sharing_t *sh) {
+  sh->table = lbm_malloc(2 * SHARING_INITIAL_SIZE * sizeof(lbm_uint));
+  if (!sh->table) return false;
+  memset(sh->table, 0, 2 * SHARING_INITIAL_SIZE * sizeof(lbm_uint));
+  sh->size = SHARING_INITIAL_SIZE;
+  sh->num = 0;
+  sh->num_shared = 0;
+  sh->next_id = 0;
+  return true;
+}
+
+static bool sharing_grow(flatten_sharing_t *sh) {
+  lbm_uint new_size = sh->size * 2;
+  lbm_uint *t = lbm_malloc(2 * new_size * sizeof(lbm_uint));
+  if (!t) return false;
+  memset(t, 0, 2 * new_size * sizeof(lbm_uint));
+  for (lbm_uint i = 0; i < sh->size; i ++) {
+    if (sh->table[2*i]) {
+      lbm_uint *e = sharing_slot(t, new_size, sh->table[2*i]);
+      e[0] = sh->table[2*i];
+      e[1] = sh->table[2*i+1];
+    }
+  }
+  lbm_free(sh->table);
+  sh->table = t;
+  sh->size = new_size;
+  return true;
+}
+
+// Returns 1 if v is visited for the first time and 0 if it has
+// been seen before, in which case it is now known to be shared.
+static int sharing_visit(flatten_sharing_t *sh, lbm_value v) {
+  if (2 * (sh->num + 1) > sh->size && !sharing_grow(sh)) {
+    return FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY;
+  }
+  lbm_uint *e = sharing_slot(sh->table, sh->size, v);
+  if (e[0] == 0) {
+    e[0] = v;
+    e[1] = SHARING_SEEN;
+    sh->num ++;
+    return 1;
+  }
+  if (e[1] == SHARING_SEEN) {
+    e[1] = SHARING_SHARED;
+    sh->num_shared ++;
+  }
+  return 0;
+}
+
+static int flatten_find_shared(flatten_sharing_t *sh, lbm_value v, int depth) {
+  if (depth > flatten_maximum_depth) {
+    return FLATTEN_VALUE_ERROR_MAXIMUM_DEPTH;
+  }
+  // Walk the spine of lists iteratively.
+  while (sharing_tracked(v)) {
+    int r = sharing_visit(sh, v);
+    if (r <= 0) return r; // error or already visited.
+    if (lbm_is_cons(v)) {
+      r = flatten_find_shared(sh, lbm_car(v), depth + 1);
+      if (r != FLATTEN_VALUE_OK) return r;
+      v = lbm_cdr(v);
+    } else if (lbm_is_lisp_array_r(v)) {
+      lbm_array_header_t *header = (lbm_array_header_t*)lbm_car(v);
+      lbm_value *arrdata = (lbm_value*)header->data;
+      lbm_uint size = header->size / sizeof(lbm_value);
+      for (lbm_uint i = 0; i < size; i ++) {
+        r = flatten_find_shared(sh, arrdata[i], depth + 1);
+        if (r != FLATTEN_VALUE_OK) return r;
+      }
+      break;
+    } else {
+      break;
+    }
+  }
+  return FLATTEN_VALUE_OK;
+}
+
+// Emits the sharing tag for v if v is shared.
+// Returns 1 if v was written as a reference and nothing more
+// should be written for it.
+static int flatten_shared_tag(lbm_flat_value_t *fv, flatten_sharing_t *sh, lbm_value v, bool grow) {
+  lbm_uint *e = sharing_slot(sh->table, sh->size, v);
+  if (e[0] != v || e[1] == SHARING_SEEN) return 0;
+  if (e[1] == SHARING_SHARED) {
+    FLATTEN_RESERVE(1);
+    e[1] = sh->next_id ++;
+    return write_byte(fv, S_SHARED_LOCAL) ? 0 : FLATTEN_VALUE_ERROR_BUFFER_TOO_SMALL;
+  }
+  FLATTEN_RESERVE(1 + 4);
+  if (write_byte(fv, S_REF_LOCAL) && write_word(fv, (uint32_t)e[1])) {
+    return 1;
+  }
+  return FLATTEN_VALUE_ERROR_BUFFER_TOO_SMALL;
+}
+
+static int flatten_value_internal(lbm_flat_value_t *fv, lbm_value v, int depth, bool grow, flatten_sharing_t *sh) {
+  if (depth > flatten_maximum_depth) {
+    return FLATTEN_VALUE_ERROR_MAXIMUM_DEPTH;
+  }
+
+  if (sh && sharing_tracked(v)) {
+    int r = flatten_shared_tag(fv, sh, v, grow);
+    if (r < 0) return r;
+    if (r == 1) return FLATTEN_VALUE_OK;
+  }
 
   lbm_uint t = lbm_type_of(v);
   if (t >= LBM_POINTER_TYPE_FIRST && t < LBM_POINTER_TYPE_LAST) {
@@ -381,26 +567,47 @@ int flatten_value_c(lbm_flat_value_t *fv, lbm_value v) {
 
   switch (t) {
   case LBM_TYPE_CONS: {
-    bool res = true;
-    res = res && f_cons(fv);
-    if (res) {
-      int fv_r = flatten_value_c(fv, lbm_car(v));
-      if (fv_r == FLATTEN_VALUE_OK) {
-        fv_r = flatten_value_c(fv, lbm_cdr(v));
+    // Only the car recurses, the spine of a list is walked iteratively so
+    // that long lists do not count towards the maximum depth.
+    // Cycles along the cdr are caught by Brent's cycle detection, or
+    // written as references when preserving sharing.
+    lbm_value slow = v;
+    lbm_uint power = 1;
+    lbm_uint lam = 0;
+    while (lbm_is_cons(v)) {
+      FLATTEN_RESERVE(1);
+      if (!f_cons(fv)) return FLATTEN_VALUE_ERROR_BUFFER_TOO_SMALL;
+      int fv_r = flatten_value_internal(fv, lbm_car(v), depth + 1, grow, sh);
+      if (fv_r != FLATTEN_VALUE_OK) return fv_r;
+      v = lbm_cdr(v);
+      if (sh) {
+        if (lbm_is_cons(v)) {
+          fv_r = flatten_shared_tag(fv, sh, v, grow);
+          if (fv_r < 0) return fv_r;
+          if (fv_r == 1) return FLATTEN_VALUE_OK;
+        }
+        continue;
+      }
+      if (v == slow) return FLATTEN_VALUE_ERROR_CIRCULAR;
+      if (++lam == power) {
+        slow = v;
+        power <<= 1;
+        lam = 0;
       }
-      return fv_r;
     }
-  }break;
+    return flatten_value_internal(fv, v, depth + 1, grow, sh);
+  }
   case LBM_TYPE_LISPARRAY: {
     lbm_array_header_t *header = (lbm_array_header_t*)lbm_car(v);
     if (header) {
       lbm_value *arrdata = (lbm_value*)header->data;
       // always exact multiple of sizeof(lbm_value)
       uint32_t size = (uint32_t)(header->size / sizeof(lbm_value));
+      FLATTEN_RESERVE(1 + 4);
       if (!f_lisp_array(fv, size)) return FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY;
       int fv_r = FLATTEN_VALUE_OK;
       for (lbm_uint i = 0; i < size; i ++ ) {
-        fv_r =  flatten_value_c(fv, arrdata[i]);
+        fv_r = flatten_value_internal(fv, arrdata[i], depth + 1, grow, sh);
         if (fv_r != FLATTEN_VALUE_OK) {
           break;
         }
@@ -411,52 +618,64 @@ int flatten_value_c(lbm_flat_value_t *fv, lbm_value v) {
     }
   } break;
   case LBM_TYPE_BYTE:
+    FLATTEN_RESERVE(1 + 1);
     if (f_b(fv, (uint8_t)lbm_dec_as_char(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_U:
+    FLATTEN_RESERVE(FLAT_INT_SIZE);
     if (f_u(fv, lbm_dec_u(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_I:
+    FLATTEN_RESERVE(FLAT_INT_SIZE);
     if (f_i(fv, lbm_dec_i(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_U32:
+    FLATTEN_RESERVE(1 + 4);
     if (f_u32(fv, lbm_dec_as_u32(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_I32:
+    FLATTEN_RESERVE(1 + 4);
     if (f_i32(fv, lbm_dec_as_i32(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_U64:
+    FLATTEN_RESERVE(1 + 8);
     if (f_u64(fv, lbm_dec_as_u64(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_I64:
+    FLATTEN_RESERVE(1 + 8);
     if (f_i64(fv, lbm_dec_as_i64(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_FLOAT:
+    FLATTEN_RESERVE(1 + 4);
     if (f_float(fv, lbm_dec_as_float(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_DOUBLE:
+    FLATTEN_RESERVE(1 + 8);
     if (f_double(fv, lbm_dec_as_double(v))) {
       return FLATTEN_VALUE_OK;
     }
     break;
   case LBM_TYPE_SYMBOL: {
     char *sym_str = (char*)lbm_get_name_by_symbol(lbm_dec_sym(v));
+    if (sym_str) {
+      FLATTEN_RESERVE(1 + strlen(sym_str) + 1);
+    }
     if (f_sym_string(fv, sym_str)) {
       return FLATTEN_VALUE_OK;
     }
@@ -465,6 +684,7 @@ int flatten_value_c(lbm_flat_value_t *fv, lbm_value v) {
     lbm_int s = lbm_heap_array_get_size(v);
     const uint8_t *d = lbm_heap_array_get_data_ro(v);
     if (s > 0 && d != NULL) {
+      FLATTEN_RESERVE(1 + 4 + (lbm_uint)s);
       if (f_lbm_array(fv, (uint32_t)s, (uint8_t*)d)) {
         return FLATTEN_VALUE_OK;
       }
@@ -478,6 +698,10 @@ int flatten_value_c(lbm_flat_value_t *fv, lbm_value v) {
   return FLATTEN_VALUE_ERROR_BUFFER_TOO_SMALL;
 }
 
+int flatten_value_c(lbm_flat_value_t *fv, lbm_value v) {
+  return flatten_value_internal(fv, v, 0, false, NULL);
+}
+
 lbm_value handle_flatten_error(int err_val) {
   switch (err_val) {
   case FLATTEN_VALUE_ERROR_CANNOT_BE_FLATTENED:
@@ -495,7 +719,60 @@ lbm_value handle_flatten_error(int err_val) {
   return ENC_SYM_NIL;
 }
 
-lbm_value flatten_value(lbm_value v) {
+// Single pass flatten into a buffer that is grown as needed and
+// shrunk to size when done.
+static int flatten_value_growable(lbm_flat_value_t *fv, lbm_value v, flatten_sharing_t *sh) {
+  fv->buf = lbm_malloc(FLATTEN_VALUE_INITIAL_SIZE);
+  if (!fv->buf) return FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY;
+  fv->buf_size = FLATTEN_VALUE_INITIAL_SIZE;
+  fv->buf_pos = 0;
+  int r = FLATTEN_VALUE_OK;
+  if (sh) {
+    // Header: number of shared nodes.
+    if (!write_byte(fv, S_SHARING_HEADER) ||
+        !write_word(fv, sh->num_shared)) {
+      r = FLATTEN_VALUE_ERROR_BUFFER_TOO_SMALL;
+    }
+  }
+  if (r == FLATTEN_VALUE_OK) {
+    r = flatten_value_internal(fv, v, 0, true, sh);
+  }
+  if (r == FLATTEN_VALUE_OK) {
+    lbm_finish_flatten(fv);
+  } else {
+    lbm_free(fv->buf);
+  }
+  return r;
+}
+
+// Size pass followed by a write into an exactly sized buffer.
+static int flatten_value_exact(lbm_flat_value_t *fv, lbm_value v) {
+  int required_mem = flatten_value_size(v, false);
+  if (required_mem <= 0) return required_mem;
+  if (!lbm_start_flatten(fv, (lbm_uint)required_mem)) {
+    return FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY;
+  }
+  int r = flatten_value_c(fv, v);
+  if (r != FLATTEN_VALUE_OK) {
+    lbm_free(fv->buf);
+  }
+  return r;
+}
+
+// Flatten preserving sharing and cycles. Values without any shared
+// nodes are written in the plain encoding.
+static int flatten_value_shared(lbm_flat_value_t *fv, lbm_value v) {
+  flatten_sharing_t sh;
+  if (!sharing_init(&sh)) return FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY;
+  int r = flatten_find_shared(&sh, v, 0);
+  if (r == FLATTEN_VALUE_OK) {
+    r = flatten_value_growable(fv, v, sh.num_shared ? &sh : NULL);
+  }
+  lbm_free(sh.table);
+  return r;
+}
+
+static lbm_value flatten_value_to_array(lbm_value v, bool sharing) {
 
   lbm_value array_cell = lbm_heap_allocate_cell(LBM_TYPE_CONS, ENC_SYM_NIL, ENC_SYM_ARRAY_TYPE);
 
@@ -503,42 +780,44 @@ lbm_value flatten_value(lbm_value v) {
     return array_cell;
   }
 
-  lbm_flat_value_t fv;
-
-  lbm_array_header_t *array = NULL;
-  int required_mem = flatten_value_size(v, false);
-  if (required_mem > 0) {
-    array = (lbm_array_header_t *)lbm_malloc(sizeof(lbm_array_header_t));
-    if (array == NULL) {
-      lbm_set_car_and_cdr(array_cell, ENC_SYM_NIL, ENC_SYM_NIL);
-      return ENC_SYM_MERROR;
-    }
-
-    bool r = lbm_start_flatten(&fv, (lbm_uint)required_mem);
-    if (!r) {
-      lbm_free(array);
-      lbm_set_car_and_cdr(array_cell, ENC_SYM_NIL, ENC_SYM_NIL);
-      return ENC_SYM_MERROR;
-    }
+  lbm_array_header_t *array = (lbm_array_header_t *)lbm_malloc(sizeof(lbm_array_header_t));
+  if (array == NULL) {
+    lbm_set_car_and_cdr(array_cell, ENC_SYM_NIL, ENC_SYM_NIL);
+    return ENC_SYM_MERROR;
+  }
 
-    if (flatten_value_c(&fv, v) == FLATTEN_VALUE_OK) {
-      // it would be wasteful to run finish_flatten here.
-      r = true;
-    } else {
-      r = false;
-    }
+  lbm_flat_value_t fv;
+  int r;
+  if (sharing) {
+    r = flatten_value_shared(&fv, v);
+  } else {
+    r = flatten_value_growable(&fv, v, NULL);
+  }
+  if (r == FLATTEN_VALUE_ERROR_NOT_ENOUGH_MEMORY && !sharing) {
+    // Growing needs the old and the new buffer at the same time,
+    // an exactly sized buffer may still fit.
+    r = flatten_value_exact(&fv, v);
+  }
 
-    if (r)  {
-      // lift flat_value
-      array->data = (lbm_uint*)fv.buf;
-      array->size = fv.buf_size;
-      lbm_set_car(array_cell, (lbm_uint)array);
-      array_cell = lbm_set_ptr_type(array_cell, LBM_TYPE_ARRAY);
-      return array_cell;
-    }
+  if (r == FLATTEN_VALUE_OK) {
+    // lift flat_value
+    array->data = (lbm_uint*)fv.buf;
+    array->size = fv.buf_pos;
+    lbm_set_car(array_cell, (lbm_uint)array);
+    array_cell = lbm_set_ptr_type(array_cell, LBM_TYPE_ARRAY);
+    return array_cell;
   }
+  lbm_free(array);
   lbm_set_car_and_cdr(array_cell, ENC_SYM_NIL, ENC_SYM_NIL);
-  return handle_flatten_error(required_mem);
+  return handle_flatten_error(r);
+}
+
+lbm_value flatten_value(lbm_value v) {
+  return flatten_value_to_array(v, false);
+}
+
+lbm_value flatten_value_sharing(lbm_value v) {
+  return flatten_value_to_array(v, true);
 }
 
 // ------------------------------------------------------------
@@ -862,8 +1141,13 @@ static int lbm_unflatten_value_atom(lbm_flat_value_t *v, lbm_value *res) {
 //    tmp =  [| a0 a1 ... an val |];  val = tmp; curr = p; continue backwards
 //
 
-static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map, lbm_flat_value_t *v, lbm_value *res) {
+// local_map entry of a shared node that has not been read yet. Never
+// a value that unflatten can produce.
+#define LOCAL_MAP_UNSET lbm_enc_cons_ptr(LBM_PTR_NULL)
+
+static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map, uint32_t num_local, lbm_flat_value_t *v, lbm_value *res) {
   bool done = false;
+  uint32_t next_local = 0;
   lbm_value val0;
   lbm_value curr = lbm_enc_cons_ptr(LBM_PTR_NULL);
 #if DEBUG
@@ -897,6 +1181,10 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
       } else {
         return UNFLATTEN_SHARING_TABLE_REQUIRED;
       }
+    } else if (v->buf[v->buf_pos] == S_SHARED_LOCAL) {
+      v->buf_pos++;
+      if (next_local >= num_local) return UNFLATTEN_MALFORMED;
+      set_ix = (int32_t)next_local++;
     }
 
     bool is_leaf = true;
@@ -927,6 +1215,7 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
         if (size > 0 && v->buf_pos + (size * 2) > v->buf_size) return UNFLATTEN_MALFORMED;
         lbm_value array;
         lbm_heap_allocate_lisp_array(&array, size);
+        if (lbm_is_symbol_merror(array)) return UNFLATTEN_GC_RETRY;
         lbm_array_header_extended_t *header = (lbm_array_header_extended_t*)lbm_car(array);
         if (size == 0) {
           unflattened = array;
@@ -934,7 +1223,6 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
         } else {
           is_leaf = false;
           lbm_value *arrdata = (lbm_value*)header->data;
-          if (lbm_is_symbol_merror(array)) return UNFLATTEN_GC_RETRY;
           header->index = 0;
           arrdata[size-1] = curr; // backptr
           curr = array;
@@ -945,6 +1233,19 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
       }
     } else if (v->buf[v->buf_pos] == 0) {
       return UNFLATTEN_MALFORMED;
+    } else if (v->buf[v->buf_pos] == S_REF_LOCAL) {
+      v->buf_pos++;
+      uint32_t ix;
+      // Only nodes that exist can be referred to. A cons or an array
+      // exists from when its cell is allocated, as it is filled in in
+      // place, which is what allows refs back to it from inside (cycles).
+      // An atom exists once it has been read. A ref cannot itself be
+      // the shared node.
+      if (set_ix >= 0 ||
+          !extract_word(v, &ix) ||
+          ix >= next_local ||
+          target_map[ix] == LOCAL_MAP_UNSET) return UNFLATTEN_MALFORMED;
+      unflattened = target_map[ix];
     } else if (v->buf[v->buf_pos] == S_REF) {
       v->buf_pos++;
       if (st && target_map) {
@@ -987,12 +1288,12 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
       lbm_print_value(buf,256, unflattened);
       printf("atom: %s\n", buf);
 #endif
-      if (set_ix >= 0) {
-        target_map[set_ix] = unflattened;
-      }
       if (e_val != UNFLATTEN_OK) {
         return e_val;
       }
+      if (set_ix >= 0) {
+        target_map[set_ix] = unflattened;
+      }
     }
 
     if (is_leaf) {
@@ -1007,6 +1308,7 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
             lbm_value prev = arrdata[arrlen-1];
             header->index = 0;
             arrdata[arrlen-1] = val0;
+            if (unflatten_array_callback) unflatten_array_callback(curr);
             val0 = curr;
             curr = prev;
           } else {
@@ -1041,6 +1343,13 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
   return UNFLATTEN_OK;
 }
 
+// Marks the local_map entries of nodes that have not been read yet.
+static void local_map_clear(lbm_uint *local_map, uint32_t num_local) {
+  for (uint32_t i = 0; i < num_local; i ++) {
+    local_map[i] = LOCAL_MAP_UNSET;
+  }
+}
+
 /* lbm_unflatten_value_nostack, does not backtrack
    upon error to swap pointer to the correct direction
    and to remove the LBM_PTR_NULL tag.
@@ -1049,17 +1358,41 @@ static int lbm_unflatten_value_nostack(sharing_table *st, lbm_uint *target_map,
    So really only reverse pointers and the NIL tag could be
    potential problems.
 */
-bool lbm_unflatten_value(lbm_flat_value_t *v, lbm_value *res) {
+static bool unflatten_value(lbm_flat_value_t *v, lbm_value *res, bool gc) {
   bool b = false;
 #ifdef LBM_ALWAYS_GC
-  lbm_perform_gc();
+  if (gc) lbm_perform_gc();
 #endif
-  int r = lbm_unflatten_value_nostack(NULL,NULL, v,res);
-  if (r == UNFLATTEN_GC_RETRY) {
-    lbm_perform_gc();
-    v->buf_pos = 0;
-    r = lbm_unflatten_value_nostack(NULL,NULL,v,res);
+  uint32_t num_local = 0;
+  lbm_uint *local_map = NULL;
+  int r = UNFLATTEN_OK;
+  if (v->buf_pos < v->buf_size &&
+      v->buf[v->buf_pos] == S_SHARING_HEADER) {
+    v->buf_pos ++;
+    // Every shared node takes up at least one byte of the buffer.
+    if (!extract_word(v, &num_local) || num_local > v->buf_size) {
+      r = UNFLATTEN_MALFORMED;
+    } else if (num_local > 0) {
+      local_map = lbm_malloc(num_local * sizeof(lbm_uint));
+      if (!local_map && gc) {
+        lbm_perform_gc();
+        local_map = lbm_malloc(num_local * sizeof(lbm_uint));
+      }
+      if (!local_map) r = UNFLATTEN_GC_RETRY;
+    }
+  }
+  if (r == UNFLATTEN_OK) {
+    lbm_uint start_pos = v->buf_pos;
+    local_map_clear(local_map, num_local);
+    r = lbm_unflatten_value_nostack(NULL, local_map, num_local, v, res);
+    if (r == UNFLATTEN_GC_RETRY && gc) {
+      lbm_perform_gc();
+      v->buf_pos = start_pos;
+      local_map_clear(local_map, num_local);
+      r = lbm_unflatten_value_nostack(NULL, local_map, num_local, v, res);
+    }
   }
+  if (local_map) lbm_free(local_map);
   switch(r) {
   case UNFLATTEN_OK:
     b = true;
@@ -1078,16 +1411,24 @@ bool lbm_unflatten_value(lbm_flat_value_t *v, lbm_value *res) {
   return b;
 }
 
+bool lbm_unflatten_value(lbm_flat_value_t *v, lbm_value *res) {
+  return unflatten_value(v, res, true);
+}
+
+bool lbm_unflatten_value_no_gc(lbm_flat_value_t *v, lbm_value *res) {
+  return unflatten_value(v, res, false);
+}
+
 bool lbm_unflatten_value_sharing(sharing_table *st, lbm_uint *target_map, lbm_flat_value_t *v, lbm_value *res) {
   bool b = false;
 #ifdef LBM_ALWAYS_GC
   lbm_perform_gc();
 #endif
-  int r = lbm_unflatten_value_nostack(st,target_map, v,res);
+  int r = lbm_unflatten_value_nostack(st,target_map,0,v,res);
   if (r == UNFLATTEN_GC_RETRY) {
     lbm_perform_gc();
     v->buf_pos = 0;
-    r = lbm_unflatten_value_nostack(st,target_map,v,res);
+    r = lbm_unflatten_value_nostack(st,target_map,0,v,res);
   }
   switch(r) {
   case UNFLATTEN_OK:
@@ -1106,3 +1447,64 @@ bool lbm_unflatten_value_sharing(sharing_table *st, lbm_uint *target_map, lbm_fl
   // 2: unflatten called from event processing -> event processor frees buffer.
   return b;
 }
+
+// Walk the tags of a flat value without building anything.
+// Returns false if the value contains image sharing tags (S_SHARED,
+// S_REF), tags that are unknown or if it is malformed.
+bool lbm_flat_value_is_self_contained(lbm_flat_value_t *v) {
+  lbm_uint pos = v->buf_pos;
+  lbm_uint pending = 1; // values left to walk past.
+  while (pending > 0) {
+    if (pos >= v->buf_size) return false;
+    uint8_t tag = v->buf[pos++];
+    lbm_uint skip = 0;
+    pending --;
+    switch (tag) {
+    case S_CONS:
+      pending += 2;
+      break;
+    case S_LBM_LISP_ARRAY: {
+      if (pos + 4 > v->buf_size) return false;
+      uint32_t n = (uint32_t)v->buf[pos] << 24 | (uint32_t)v->buf[pos+1] << 16 |
+                   (uint32_t)v->buf[pos+2] << 8 | (uint32_t)v->buf[pos+3];
+      pending += n;
+      skip = 4;
+    } break;
+    case S_LBM_ARRAY: {
+      if (pos + 4 > v->buf_size) return false;
+      uint32_t n = (uint32_t)v->buf[pos] << 24 | (uint32_t)v->buf[pos+1] << 16 |
+                   (uint32_t)v->buf[pos+2] << 8 | (uint32_t)v->buf[pos+3];
+      skip = 4 + (lbm_uint)n;
+    } break;
+    case S_SYM_STRING:
+      while (pos < v->buf_size && v->buf[pos] != 0) pos ++;
+      skip = 1;
+      break;
+    case S_BYTE_VALUE:
+      skip = 1;
+      break;
+    case S_I28_VALUE: // fall through
+    case S_U28_VALUE:
+    case S_FLOAT_VALUE:
+    case S_I32_VALUE:
+    case S_U32_VALUE:
+      skip = 4;
+      break;
+    case S_I56_VALUE: // fall through
+    case S_U56_VALUE:
+    case S_DOUBLE_VALUE:
+    case S_I64_VALUE:
+    case S_U64_VALUE:
+      skip = 8;
+      break;
+    case S_SYM_VALUE: // fall through
+    case S_CONSTANT_REF:
+      skip = sizeof(lbm_uint);
+      break;
+    default:
+      return false;
+    }
+    pos += skip;
+  }
+  return pos <= v->buf_size;
+}
@@ -181,6 +181,7 @@
 #define EXTENSION_TABLE   (uint32_t)0x08    // [ 0x08 | NUM | EXT ...]
 #define VERSION_ENTRY     (uint32_t)0x09    // [ 0x09 | size | string ]
 #define SHARING_TABLE     (uint32_t)0x10    // [ 0x10 | n    | n-entries}
+#define BINDING_REMOVED   (uint32_t)0x11    // [ 0x11 | key ]
 // Size is in number of 32bit words, even on 64 bit images.
 
 // To be able to work on an image incrementally (even though it is not recommended)
@@ -669,7 +670,7 @@ static int detect_shared(lbm_value v, bool shared, void *acc) {
   return TRAV_FUN_SUBTREE_PROCEED;
 }
 
-sharing_table lbm_image_sharing(void) {
+sharing_table lbm_image_sharing(bool incremental) {
   lbm_value *env = lbm_get_global_env();
 
   sharing_table st;
@@ -681,12 +682,14 @@ sharing_table lbm_image_sharing(void) {
                     // index is now correct for starting to write sharing table rows.
 
   if (env) {
-    for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+    lbm_uint n_roots = lbm_get_global_env_num_roots();
+    for (lbm_uint i = 0; i < n_roots; i ++) {
       lbm_value curr = env[i];
       while(lbm_is_cons(curr)) {
         //        lbm_value name_field = lbm_caar(curr);
         lbm_value val_field  = lbm_cdr(lbm_car(curr));
-        if (!lbm_is_constant(val_field)) {
+        if (!lbm_is_constant(val_field) &&
+            (!incremental || lbm_global_env_is_dirty(lbm_caar(curr)))) {
           lbm_ptr_rev_trav(detect_shared, val_field, &st);
         }
         curr = lbm_cdr(curr);
@@ -952,19 +955,136 @@ void print_sharing_table(sharing_table *st) {
 #endif
 
 // ////////////////////////////////////////////////////////////
+// Bindings that are left in the image at boot
 //
-bool lbm_image_save_global_env(void) {
+// A BINDING_FLAT that holds a structure (list or array) and no
+// sharing tags is not unflattened by lbm_image_boot. The key is
+// instead bound to (ENC_SYM_IMAGE_BINDING . ix) where ix is the image
+// index of the size field of the entry. The first global lookup of
+// the key unflattens the value from the image and updates the binding.
+
+// on 64 bit           | on 32 bit
+// ix     -> size      | ix     -> size
+// ix - 1 -> key_high  | ix - 1 -> key
+// ix - 2 -> key_low   |
+#ifdef LBM64
+#define BINDING_FLAT_KEY_WORDS 2
+#else
+#define BINDING_FLAT_KEY_WORDS 1
+#endif
+
+static void image_binding_flat_value(int32_t ix, lbm_flat_value_t *fv) {
+  int32_t s = (int32_t)read_u32(ix);
+  int32_t pos = ix - BINDING_FLAT_KEY_WORDS - 1 - s;
+  fv->buf = (uint8_t*)(image_address + pos);
+  fv->buf_size = (uint32_t)s * sizeof(lbm_uint); // GEQ to actual buf
+  fv->buf_pos = 0;
+}
+
+static lbm_uint image_binding_key(int32_t ix) {
+#ifdef LBM64
+  return read_u64(ix - 2);
+#else
+  return read_u32(ix - 1);
+#endif
+}
+
+static int32_t image_binding_ix(lbm_value key, lbm_value v) {
+  lbm_value ix_val = lbm_cdr(v);
+  if (!image_address || !lbm_is_number(ix_val)) return -1;
+  int32_t ix = (int32_t)lbm_dec_as_u32(ix_val);
+  // Check that the image still holds this binding.
+  if (ix <= BINDING_FLAT_KEY_WORDS ||
+      ix >= (int32_t)image_size - 1 ||
+      read_u32(ix + 1) != BINDING_FLAT ||
+      image_binding_key(ix) != key) {
+    return -1;
+  }
+  return ix;
+}
+
+bool lbm_image_is_binding(lbm_value v) {
+  return lbm_is_cons(v) && lbm_car(v) == ENC_SYM_IMAGE_BINDING;
+}
+
+lbm_value lbm_image_binding_value(lbm_value key, lbm_value v) {
+  int32_t ix = image_binding_ix(key, v);
+  if (ix < 0) return ENC_SYM_EERROR;
+  lbm_flat_value_t fv;
+  image_binding_flat_value(ix, &fv);
+  lbm_value res;
+  lbm_unflatten_value_no_gc(&fv, &res);
+  return res;
+}
+
+// Copy a binding that was never unflattened back into the image.
+static bool image_save_binding(lbm_value key, lbm_value v) {
+  int32_t ix = image_binding_ix(key, v);
+  if (ix < 0) return false;
+  int32_t s = (int32_t)read_u32(ix);
+  int32_t src = ix - BINDING_FLAT_KEY_WORDS - 1 - s;
+  if ((write_index - s) <= (int32_t)image_const_heap.next) {
+    return false;
+  }
+  bool r = write_u32(BINDING_FLAT, &write_index, DOWNWARDS);
+  r = r && write_u32((uint32_t)s, &write_index, DOWNWARDS);
+  r = r && write_lbm_value(key, &write_index, DOWNWARDS);
+  int32_t dst = write_index - s;
+  for (int32_t i = 0; i < s && r; i ++) {
+    r = write_u32(read_u32(src + i), &dst, UPWARDS);
+  }
+  write_index = write_index - s - 1;
+  return r;
+}
 
-  sharing_table st = lbm_image_sharing();
+// ////////////////////////////////////////////////////////////
+//
+static bool image_env_has_dirty(void) {
+  lbm_value *env = lbm_get_global_env();
+  lbm_uint n_roots = lbm_get_global_env_num_roots();
+  for (lbm_uint i = 0; i < n_roots; i ++) {
+    lbm_value curr = env[i];
+    while (lbm_is_cons(curr)) {
+      if (lbm_global_env_is_dirty(lbm_caar(curr))) return true;
+      curr = lbm_cdr(curr);
+    }
+  }
+  return false;
+}
+
+static bool image_save_removed(void);
+
+// An incremental save only writes the bindings that changed since the
+// last save or boot. Boot restores bindings in image order, so the new
+// entries replace the old ones. Values saved in different rounds do not
+// share structure with each other. Bindings that were removed get a
+// BINDING_REMOVED entry so that boot does not bring them back.
+static bool image_save_global_env(bool incremental) {
+
+  bool removed = lbm_global_env_has_removed();
+  if (incremental && !removed && !image_env_has_dirty()) {
+    return true;
+  }
+  sharing_table st = lbm_image_sharing(incremental);
   lbm_value *env = lbm_get_global_env();
   if (env) {
-    for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+    lbm_uint n_roots = lbm_get_global_env_num_roots();
+    for (lbm_uint i = 0; i < n_roots; i ++) {
       lbm_value curr = env[i];
       while(lbm_is_cons(curr)) {
         lbm_value name_field = lbm_caar(curr);
         lbm_value val_field  = lbm_cdr(lbm_car(curr));
 
-        if (lbm_is_constant(val_field)) {
+        if (incremental && !lbm_global_env_is_dirty(name_field)) {
+          // Unchanged, the binding in the image is still valid.
+          curr = lbm_cdr(curr);
+          continue;
+        }
+        if (lbm_image_is_binding(val_field)) {
+          if (!image_save_binding(name_field, val_field)) {
+            return false;
+          }
+        } else if (lbm_is_constant(val_field)) {
           write_u32(BINDING_CONST, &write_index, DOWNWARDS);
           write_lbm_value(name_field, &write_index, DOWNWARDS);
           write_lbm_value(val_field, &write_index, DOWNWARDS);
@@ -1011,11 +1131,140 @@ bool lbm_image_save_global_env(void) {
     printf("Sharing table:\n");
     print_sharing_table(&st);
 #endif
+    if (removed && !image_save_removed()) {
+      return false;
+    }
+    lbm_global_env_clear_dirty();
     return true;
   }
   return false;
 }
 
+bool lbm_image_save_global_env(void) {
+  return image_save_global_env(false);
+}
+
+bool lbm_image_save_global_env_incremental(void) {
+  return image_save_global_env(true);
+}
+
+// Number of 32bit words taken up by the image entry with its tag at ix.
+// 0 if there is no entry at ix.
+static int32_t image_entry_words(int32_t ix) {
+  int32_t w = (int32_t)(sizeof(lbm_uint) / 4);
+  switch (read_u32(ix)) {
+  case IMAGE_INITIALIZED: return 1;
+  case VERSION_ENTRY:     return 2 + (int32_t)read_u32(ix - 1);
+  case CONSTANT_HEAP_IX:  return 2;
+  case BINDING_CONST:     return 1 + 2 * w;
+  case BINDING_FLAT:      return 3 + BINDING_FLAT_KEY_WORDS + (int32_t)read_u32(ix - 1);
+  case SYMBOL_ENTRY:      return 1 + 3 * w;
+  case SYMBOL_LINK_ENTRY: return 1 + 4 * w;
+  case EXTENSION_TABLE:   return 2 + (int32_t)read_u32(ix - 1) * 2 * w;
+  case SHARING_TABLE:     return 2 + (int32_t)read_u32(ix - 1) * SHARING_TABLE_ENTRY_SIZE;
+  case BINDING_REMOVED:   return 1 + w;
+  default: return 0;
+  }
+}
+
+static bool image_entry_is_binding(int32_t ix) {
+  uint32_t tag = read_u32(ix);
+  return tag == BINDING_CONST || tag == BINDING_FLAT;
+}
+
+// BINDING_CONST and BINDING_REMOVED have the key right after the tag.
+static lbm_uint image_entry_key(int32_t ix) {
+  return read_u32(ix) == BINDING_FLAT ? image_binding_key(ix - 1) : image_binding_key(ix);
+}
+
+// True if a later binding or BINDING_REMOVED entry for key follows the
+// entry at ix.
+static bool image_key_has_later_entry(int32_t ix, lbm_uint key) {
+  int32_t pos = ix - image_entry_words(ix);
+  while (pos > write_index) {
+    int32_t n = image_entry_words(pos);
+    if (n <= 0) break;
+    if ((image_entry_is_binding(pos) || read_u32(pos) == BINDING_REMOVED) &&
+        image_entry_key(pos) == key) {
+      return true;
+    }
+    pos -= n;
+  }
+  return false;
+}
+
+static bool env_has_binding(lbm_value key) {
+  lbm_value curr = *lbm_global_env_bucket(key);
+  while (lbm_is_cons(curr)) {
+    if (lbm_caar(curr) == key) return true;
+    curr = lbm_cdr(curr);
+  }
+  return false;
+}
+
+// An entry is dead if boot replaces it with a later entry of the same
+// kind or if it binds a key that is no longer bound. BINDING_REMOVED
+// entries are only needed to hide earlier entries, which a full
+// rewrite does not have.
+static bool image_entry_is_dead(int32_t ix) {
+  uint32_t tag = read_u32(ix);
+  if (tag == BINDING_REMOVED) return true;
+  bool binding = image_entry_is_binding(ix);
+  if (!binding && tag != CONSTANT_HEAP_IX && tag != EXTENSION_TABLE) {
+    return false;
+  }
+  if (binding) {
+    lbm_uint key = image_entry_key(ix);
+    return !env_has_binding(key) || image_key_has_later_entry(ix, key);
+  }
+  int32_t pos = ix - image_entry_words(ix);
+  while (pos > write_index) {
+    int32_t n = image_entry_words(pos);
+    if (n <= 0) break;
+    if (read_u32(pos) == tag) return true;
+    pos -= n;
+  }
+  return false;
+}
+
+// Write a BINDING_REMOVED entry for every key that the image binds but
+// that is no longer bound. Entries are visited oldest first and a key
+// that already has a later entry, including one written here, is
+// skipped, so each removed key gets one entry.
+static bool image_save_removed(void) {
+  int32_t pos = (int32_t)image_size - 1;
+  while (pos > write_index) {
+    int32_t n = image_entry_words(pos);
+    if (n <= 0) break;
+    if (image_entry_is_binding(pos)) {
+      lbm_uint key = image_entry_key(pos);
+      if (!env_has_binding(key) && !image_key_has_later_entry(pos, key)) {
+        if (write_index - (int32_t)(1 + sizeof(lbm_uint) / 4) <= (int32_t)image_const_heap.next) {
+          return false;
+        }
+        if (!write_u32(BINDING_REMOVED, &write_index, DOWNWARDS) ||
+            !write_lbm_value(key, &write_index, DOWNWARDS)) {
+          return false;
+        }
+      }
+    }
+    pos -= n;
+  }
+  return true;
+}
+
+uint32_t lbm_image_reclaimable(void) {
+  uint32_t words = 0;
+  int32_t pos = (int32_t)image_size - 1;
+  while (pos > write_index) {
+    int32_t n = image_entry_words(pos);
+    if (n <= 0) break;
+    if (image_entry_is_dead(pos)) words += (uint32_t)n;
+    pos -= n;
+  }
+  return words * 4;
+}
+
 // The extension table is created at system startup.
 // Extensions can also be added dynamically.
 // Dynamically added extensions have names starting with "ext-"
@@ -1171,15 +1420,9 @@ bool lbm_image_boot(void) {
       lbm_uint bind_val = read_u32(pos-1);
       pos -= 2;
 #endif
-      lbm_uint ix_key  = lbm_dec_sym(bind_key) & GLOBAL_ENV_MASK;
-      lbm_value *global_env = lbm_get_global_env();
-      lbm_uint orig_env = global_env[ix_key];
-      lbm_value new_env = lbm_env_set(orig_env,bind_key,bind_val);
-
-      if (lbm_is_symbol(new_env)) {
+      if (lbm_is_symbol_merror(lbm_global_env_set(bind_key,bind_val))) {
         return false;
       }
-      global_env[ix_key] = new_env;
     } break;
     case BINDING_FLAT: {
       // on 64 bit           | on 32 bit
@@ -1187,6 +1430,7 @@ bool lbm_image_boot(void) {
       // pos - 1 -> key_high | pos - 1 -> key
       // pos - 2 -> key_low
       //
+      int32_t size_ix = pos;
       int32_t s = (int32_t)read_u32(pos);
       // size in 32 or 64 bit words.
 #ifdef LBM64
@@ -1199,11 +1443,19 @@ bool lbm_image_boot(void) {
 
       pos -= s;
       lbm_flat_value_t fv;
-      fv.buf = (uint8_t*)(image_address + pos);
-      fv.buf_size = (uint32_t)s * sizeof(lbm_uint); // GEQ to actual buf
-      fv.buf_pos = 0;
+      image_binding_flat_value(size_ix, &fv);
       lbm_value unflattened;
-      if (target_map) {
+      uint8_t tag = fv.buf[0];
+      if ((tag == S_CONS || tag == S_LBM_LISP_ARRAY || tag == S_LBM_ARRAY) &&
+          lbm_flat_value_is_self_contained(&fv)) {
+        // Structures are unflattened on first lookup. Atoms are
+        // no larger than the binding placeholder.
+        unflattened = lbm_cons(ENC_SYM_IMAGE_BINDING, lbm_enc_u((lbm_uint)size_ix));
+        if (lbm_is_symbol_merror(unflattened)) {
+          lbm_perform_gc();
+          unflattened = lbm_cons(ENC_SYM_IMAGE_BINDING, lbm_enc_u((lbm_uint)size_ix));
+        }
+      } else if (target_map) {
         if (!lbm_unflatten_value_sharing(&st, target_map, &fv, &unflattened)) {
           return false;
         }
@@ -1238,15 +1490,9 @@ bool lbm_image_boot(void) {
           lbm_unflatten_value(&fv, &unflattened);
         }
       }
-      lbm_uint ix_key  = lbm_dec_sym(bind_key) & GLOBAL_ENV_MASK;
-      lbm_value *global_env = lbm_get_global_env();
-      lbm_uint orig_env = global_env[ix_key];
-      lbm_value new_env = lbm_env_set(orig_env,bind_key,unflattened);
-
-      if (lbm_is_symbol(new_env)) {
+      if (lbm_is_symbol_merror(lbm_global_env_set(bind_key,unflattened))) {
         return false;
       }
-      global_env[ix_key] = new_env;
       pos --;
     } break;
     case SYMBOL_ENTRY: {
@@ -1341,10 +1587,32 @@ bool lbm_image_boot(void) {
       lbm_extensions_set_next((lbm_uint)i);
       image_has_extensions = true;
     } break;
+    case BINDING_REMOVED: {
+      // on 64 bit           | on 32 bit
+      // pos     -> key_high | pos     -> key
+      // pos - 1 -> key_low  |
+#ifdef LBM64
+      lbm_uint key = read_u64(pos-1);
+      pos -= 2;
+#else
+      lbm_uint key = read_u32(pos);
+      pos -= 1;
+#endif
+      lbm_value *bucket = lbm_global_env_bucket(key);
+      lbm_value res = lbm_env_drop_binding(*bucket, key);
+      if (res != ENC_SYM_NOT_FOUND) {
+        *bucket = res;
+      }
+    } break;
     case SHARING_TABLE: {
       st.start = pos +1;
       uint32_t num = read_u32(pos); pos --;
       st.num = (int32_t)num;
+      // Each incremental save starts a new table.
+      if (target_map) {
+        lbm_free(target_map);
+        target_map = NULL;
+      }
       if (num > 0) {
         target_map = lbm_malloc(num * sizeof(lbm_uint));
         if (!target_map ) {
@@ -1366,5 +1634,6 @@ bool lbm_image_boot(void) {
   }
  done_loading_image:
   if (target_map) lbm_free(target_map);
+  lbm_global_env_clear_dirty();
   return true;
 }
@@ -435,6 +435,52 @@ int lbm_memory_shrink(lbm_uint *ptr, lbm_uint n) {
   return 1;
 }
 
+int lbm_memory_extend(lbm_uint *ptr, lbm_uint n) {
+  if (!lbm_memory_ptr_inside(ptr) || n == 0) return 0;
+
+  lbm_uint ix = address_to_bitmap_ix(ptr);
+
+  mutex_lock(&lbm_mem_mutex);
+  lbm_uint end_ix = ix;
+  if (status(ix) != START_END) {
+    if (status(ix) != START) {
+      mutex_unlock(&lbm_mem_mutex);
+      return 0; // ptr does not point to the start of an allocated range.
+    }
+    end_ix = ix + 1;
+    while (end_ix < memory_size && status(end_ix) != END) end_ix ++;
+  }
+
+  lbm_uint old_n = end_ix - ix + 1;
+  if (n <= old_n) {
+    mutex_unlock(&lbm_mem_mutex);
+    return (n == old_n);
+  }
+  lbm_uint extra = n - old_n;
+  if (ix + n > memory_size ||
+      memory_num_free < extra ||
+      memory_num_free - extra < memory_reserve_level) {
+    mutex_unlock(&lbm_mem_mutex);
+    return 0;
+  }
+  // Directly after an END, words are free until the next START.
+  for (lbm_uint i = end_ix + 1; i < ix + n; i ++) {
+    if (status(i) != FREE_OR_USED) {
+      mutex_unlock(&lbm_mem_mutex);
+      return 0;
+    }
+  }
+  if (end_ix == ix) {
+    set_status(ix, START);
+  } else {
+    set_status(end_ix, FREE_OR_USED);
+  }
+  set_status(ix + n - 1, END);
+  memory_num_free -= extra;
+  mutex_unlock(&lbm_mem_mutex);
+  return 1;
+}
+
 int lbm_memory_ptr_inside(lbm_uint *ptr) {
   return ((lbm_uint)ptr >= (lbm_uint)memory &&
           (lbm_uint)ptr < (lbm_uint)memory + (memory_size * sizeof(lbm_uint)));
@@ -25,10 +25,25 @@ extern eval_context_t *ctx_running;
 extern mutex_t qmutex;
 extern bool    qmutex_initialized;
 extern volatile bool lbm_system_sleeping;
+extern const lbm_uint lbm_cont_prof_return;
 
 static lbm_prof_t *prof_data;
 static lbm_uint    prof_data_num;
 
+static lbm_prof_fun_t   *prof_fun_data = NULL;
+static lbm_uint          prof_fun_data_num = 0;
+static lbm_prof_stack_t *prof_stack_data = NULL;
+static lbm_uint          prof_stack_data_num = 0;
+
+// A sample of the call stack is taken by the evaluator between two
+// steps, when the stack of the running context is consistent.
+volatile bool lbm_prof_calls_pending = false;
+static lbm_cid   prof_pending_cid = -1;
+static lbm_value prof_pending_ext = ENC_SYM_NIL;
+
+// Bounds the time spent looking for caller frames in one sample.
+#define PROF_MAX_SCAN 256
+
 #define TRUNC_SIZE(N) (((N) > LBM_PROF_MAX_NAME_SIZE -1) ? LBM_PROF_MAX_NAME_SIZE-1 : N)
 
 bool lbm_prof_init(lbm_prof_t *prof_data_buf,
@@ -50,6 +65,100 @@ bool lbm_prof_init(lbm_prof_t *prof_data_buf,
   return false;
 }
 
+void lbm_prof_init_functions(lbm_prof_fun_t   *fun_buf,
+                             lbm_uint          fun_buf_num,
+                             lbm_prof_stack_t *stack_buf,
+                             lbm_uint          stack_buf_num) {
+  prof_fun_data = fun_buf;
+  prof_fun_data_num = fun_buf ? fun_buf_num : 0;
+  prof_stack_data = stack_buf;
+  prof_stack_data_num = stack_buf ? stack_buf_num : 0;
+  for (lbm_uint i = 0; i < prof_fun_data_num; i ++) {
+    prof_fun_data[i].sym = ENC_SYM_NIL;
+    prof_fun_data[i].self = 0;
+    prof_fun_data[i].total = 0;
+  }
+  for (lbm_uint i = 0; i < prof_stack_data_num; i ++) {
+    prof_stack_data[i].depth = 0;
+    prof_stack_data[i].count = 0;
+  }
+}
+
+// Collects the innermost frames of ctx. The frames of the call
+// tracking in the evaluator are [caller, name, PROF_RETURN].
+static lbm_uint prof_frames(eval_context_t *ctx, lbm_value ext, lbm_value *frames) {
+  lbm_uint n = 0;
+  if (ext != ENC_SYM_NIL) {
+    frames[n++] = ext;
+  }
+  frames[n++] = ctx->prof_fun;
+
+  lbm_uint *k = ctx->K.data;
+  lbm_uint sp = ctx->K.sp;
+  lbm_uint stop = sp > PROF_MAX_SCAN ? sp - PROF_MAX_SCAN : 0;
+  bool top = true;
+  for (lbm_uint i = sp; i > stop + 2 && n < LBM_PROF_MAX_DEPTH; i --) {
+    if (k[i-1] == lbm_cont_prof_return) {
+      // A frame whose function has not yet started, because its
+      // arguments are being evaluated, belongs to the caller.
+      // Code that is not inside a named function, such as the top
+      // level, has no name and is left out as a caller.
+      if ((!top || k[i-2] == ctx->prof_fun) &&
+          k[i-3] != ENC_SYM_NIL) {
+        frames[n++] = k[i-3];
+      }
+      top = false;
+      i -= 2;
+    }
+  }
+  return n;
+}
+
+static void prof_add_function(lbm_value sym, bool self) {
+  for (lbm_uint i = 0; i < prof_fun_data_num; i ++) {
+    if (prof_fun_data[i].total == 0) {
+      prof_fun_data[i].sym = sym;
+    }
+    if (prof_fun_data[i].sym == sym) {
+      prof_fun_data[i].total ++;
+      if (self) prof_fun_data[i].self ++;
+      return;
+    }
+  }
+}
+
+static void prof_add_stack(lbm_value *frames, lbm_uint depth) {
+  for (lbm_uint i = 0; i < prof_stack_data_num; i ++) {
+    lbm_prof_stack_t *s = &prof_stack_data[i];
+    if (s->count == 0) {
+      memcpy(s->frames, frames, depth * sizeof(lbm_value));
+      s->depth = depth;
+    }
+    if (s->depth == depth &&
+        memcmp(s->frames, frames, depth * sizeof(lbm_value)) == 0) {
+      s->count ++;
+      return;
+    }
+  }
+}
+
+void lbm_prof_sample_calls(eval_context_t *ctx) {
+  lbm_prof_calls_pending = false;
+  // The context that was sampled may have been switched out.
+  if (ctx->id != prof_pending_cid) return;
+  lbm_value frames[LBM_PROF_MAX_DEPTH];
+  lbm_uint depth = prof_frames(ctx, prof_pending_ext, frames);
+  for (lbm_uint i = 0; i < depth; i ++) {
+    bool seen = false;
+    for (lbm_uint j = 0; j < i; j ++) {
+      if (frames[j] == frames[i]) seen = true;
+    }
+    // Recursive functions are counted once per sample.
+    if (!seen) prof_add_function(frames[i], i == 0);
+  }
+  prof_add_stack(frames, depth);
+}
+
 lbm_uint lbm_prof_get_num_samples(void) {
   return num_samples;
 }
@@ -78,6 +187,14 @@ void lbm_prof_sample(void) {
       doing_gc = true;
     }
     if (name) name_len = strlen(name) + 1;
+    // An extension that is running holds up the evaluator, so it is
+    // recorded now and the rest of the stack on the next step.
+    if ((prof_fun_data_num > 0 || prof_stack_data_num > 0) &&
+        !lbm_prof_calls_pending) {
+      prof_pending_cid = id;
+      prof_pending_ext = curr->prof_ext;
+      lbm_prof_calls_pending = true;
+    }
     for (lbm_uint i = 0; i < prof_data_num; i ++) {
       if (prof_data[i].cid == -1) {
         // add new sample:
@@ -20,6 +20,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <lbm_types.h>
 #include <lbm_custom_type.h>
 
@@ -39,7 +40,7 @@
 #define CONTINUE_ARRAY 8
 #define END_ARRAY      9
 
-static lbm_stack_t print_stack = { NULL, 0, 0};
+static lbm_stack_t print_stack = { .data = NULL, .sp = 0, .size = 0, .max_size = 0 };
 static bool print_has_stack = false;
 
 const char *failed_str = "Error: print failed\n";
@@ -110,16 +111,73 @@ int lbm_print_init(lbm_uint print_stack_size) {
 #define EMIT_FAILED -1
 #define EMIT_OK      0
 
-static int print_emit_string(lbm_char_channel_t *chan, char* str) {
-  if (str == NULL) return EMIT_FAILED;
-  while (*str != 0) {
-    int r = lbm_channel_write(chan, *str);
-    str++;
-    if (r != CHANNEL_SUCCESS) return EMIT_FAILED;
+// State of the channel that lbm_print_value_stream prints into.
+typedef struct {
+  char buf[LBM_PRINT_CHUNK_SIZE];
+  unsigned int pos;
+  int total;
+  lbm_uint max_len;
+  lbm_print_emit_fun emit;
+  void *arg;
+  bool stopped; // emit returned false or max_len was reached, nothing more is emitted.
+} print_chunk_state_t;
+
+static bool print_chunk_flush(print_chunk_state_t *st) {
+  if (st->stopped) return false;
+  if (st->pos == 0) return true;
+  lbm_uint room = st->max_len - (lbm_uint)st->total;
+  if (st->pos > room) {
+    // Emit what fits and stop, the value is too long or cyclic.
+    if (room > 0) st->emit(st->buf, (unsigned int)room, st->arg);
+    st->total += (int)room;
+    st->stopped = true;
+    return false;
+  }
+  st->stopped = !st->emit(st->buf, st->pos, st->arg);
+  st->total += (int)st->pos;
+  st->pos = 0;
+  return !st->stopped;
+}
+
+static int print_chunk_write(lbm_char_channel_t *chan, char c) {
+  print_chunk_state_t *st = (print_chunk_state_t*)chan->state;
+  if (st->stopped) return CHANNEL_FULL;
+  st->buf[st->pos++] = c;
+  if (st->pos == LBM_PRINT_CHUNK_SIZE && !print_chunk_flush(st)) {
+    return CHANNEL_FULL;
+  }
+  return CHANNEL_SUCCESS;
+}
+
+// Emit n characters. Copied in bulk when printing in chunks.
+static int print_emit_span(lbm_char_channel_t *chan, const char *str, unsigned int n) {
+  if (chan->write == print_chunk_write) {
+    print_chunk_state_t *st = (print_chunk_state_t*)chan->state;
+    if (st->stopped) return EMIT_FAILED;
+    while (n > 0) {
+      unsigned int k = LBM_PRINT_CHUNK_SIZE - st->pos;
+      if (k > n) k = n;
+      memcpy(st->buf + st->pos, str, k);
+      st->pos += k;
+      str += k;
+      n -= k;
+      if (st->pos == LBM_PRINT_CHUNK_SIZE && !print_chunk_flush(st)) {
+        return EMIT_FAILED;
+      }
+    }
+    return EMIT_OK;
+  }
+  for (unsigned int i = 0; i < n; i ++) {
+    if (lbm_channel_write(chan, str[i]) != CHANNEL_SUCCESS) return EMIT_FAILED;
   }
   return EMIT_OK;
 }
 
+static int print_emit_string(lbm_char_channel_t *chan, char* str) {
+  if (str == NULL) return EMIT_FAILED;
+  return print_emit_span(chan, str, (unsigned int)strlen(str));
+}
+
 static int print_emit_char(lbm_char_channel_t *chan, char c) {
 
   int r = lbm_channel_write(chan, c);
@@ -127,6 +185,9 @@ static int print_emit_char(lbm_char_channel_t *chan, char c) {
   return EMIT_OK;
 }
 
+static bool print_needs_escape(char c) {
+  return c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t';
+}
 
 static int emit_escape(lbm_char_channel_t *chan, char c) {
   switch(c) {
@@ -140,11 +201,20 @@ static int emit_escape(lbm_char_channel_t *chan, char c) {
   }
 }
 
+// Runs of characters that need no escaping are emitted as spans.
 static int print_emit_string_value(lbm_char_channel_t *chan, char* str) {
   if (str == NULL) return EMIT_FAILED;
   while (*str != 0) {
-    int r = emit_escape(chan, *str++);
-    if (r != EMIT_OK) return r;
+    char *run = str;
+    while (*str != 0 && !print_needs_escape(*str)) str++;
+    if (str > run) {
+      int r = print_emit_span(chan, run, (unsigned int)(str - run));
+      if (r != EMIT_OK) return r;
+    }
+    if (*str != 0) {
+      int r = emit_escape(chan, *str++);
+      if (r != EMIT_OK) return r;
+    }
   }
   return EMIT_OK;
 }
@@ -237,25 +307,26 @@ static int print_emit_channel(lbm_char_channel_t *chan, lbm_value v) {
 }
 
 static int print_emit_array_data(lbm_char_channel_t *chan, lbm_array_header_t *array) {
-
-  int r = print_emit_char(chan, '[');
-
-  if (r == EMIT_OK) {
-
-    for (unsigned int i = 0; i < array->size; i ++) {
-
-      char *c_data = (char*)array->data;
-      r = print_emit_byte(chan, (uint8_t)c_data[i], false);
-
-      if (r == EMIT_OK && i != array->size - 1) {
-        r = print_emit_char(chan, ' ');
-      }
+  // Bytes are formatted into buf and emitted as spans.
+  char buf[64];
+  unsigned int n = 0;
+  uint8_t *data = (uint8_t*)array->data;
+
+  buf[n++] = '[';
+  for (unsigned int i = 0; i < array->size; i ++) {
+    uint8_t b = data[i];
+    if (b >= 100) buf[n++] = (char)('0' + b / 100);
+    if (b >= 10) buf[n++] = (char)('0' + (b / 10) % 10);
+    buf[n++] = (char)('0' + b % 10);
+    if (i != array->size - 1) buf[n++] = ' ';
+    if (n > sizeof(buf) - 5) {
+      int r = print_emit_span(chan, buf, n);
+      if (r != EMIT_OK) return r;
+      n = 0;
     }
-
-    if (r != EMIT_OK) return r;
-    return print_emit_char(chan, ']');
   }
-  return r;
+  buf[n++] = ']';
+  return print_emit_span(chan, buf, n);
 }
 
 static int print_emit_bytearray(lbm_char_channel_t *chan, lbm_value v) {
@@ -511,3 +582,25 @@ int lbm_print_value(char *buf, unsigned int len, lbm_value v) {
     return 1;
   return 0;
 }
+
+int lbm_print_value_stream(lbm_value v, lbm_uint max_len, lbm_print_emit_fun emit, void *arg) {
+  print_chunk_state_t st;
+  st.pos = 0;
+  st.total = 0;
+  st.max_len = max_len < INT_MAX ? max_len : INT_MAX;
+  st.emit = emit;
+  st.arg = arg;
+  st.stopped = false;
+
+  // Only write is used by the printer.
+  lbm_char_channel_t chan;
+  memset(&chan, 0, sizeof(chan));
+  chan.state = &st;
+  chan.write = print_chunk_write;
+
+  if (lbm_print_internal(&chan, v) == EMIT_OK &&
+      print_chunk_flush(&st)) {
+    return st.total;
+  }
+  return -1;
+}
@@ -30,22 +30,50 @@
 #endif
 
 int lbm_stack_allocate(lbm_stack_t *s, lbm_uint stack_size) {
+  return lbm_stack_allocate_growable(s, stack_size, stack_size);
+}
+
+int lbm_stack_allocate_growable(lbm_stack_t *s, lbm_uint stack_size, lbm_uint max_size) {
   int r = 0;
   s->data = lbm_memory_allocate(stack_size);
   if (s->data) {
     memset(s->data, STACK_UNUSED_BYTE, stack_size * sizeof(lbm_uint));
     s->sp = 0;
     s->size = stack_size;
+    s->max_size = max_size < stack_size ? stack_size : max_size;
     r = 1;
   }
   return r;
 }
 
+int lbm_stack_grow(lbm_stack_t *s, lbm_uint min_size) {
+  if (min_size <= s->size) return 1;
+  if (min_size > s->max_size) return 0;
+  lbm_uint new_size = s->size * 2;
+  if (new_size < min_size) new_size = min_size;
+  if (new_size > s->max_size) new_size = s->max_size;
+  lbm_uint *data = lbm_memory_allocate(new_size);
+  if (!data && new_size > min_size) {
+    new_size = min_size;
+    data = lbm_memory_allocate(new_size);
+  }
+  if (!data) return 0;
+  // The whole old stack is copied, not just up to sp, so that
+  // lbm_get_max_stack still sees the high-water mark.
+  memcpy(data, s->data, s->size * sizeof(lbm_uint));
+  memset(data + s->size, STACK_UNUSED_BYTE, (new_size - s->size) * sizeof(lbm_uint));
+  lbm_memory_free(s->data);
+  s->data = data;
+  s->size = new_size;
+  return 1;
+}
+
 int lbm_stack_create(lbm_stack_t *s, lbm_uint* data, lbm_uint stack_size) {
   s->data = data;
   memset(s->data, STACK_UNUSED_BYTE, stack_size * sizeof(lbm_uint));
   s->sp = 0;
   s->size = stack_size;
+  s->max_size = stack_size;
   return 1;
 }
 
@@ -112,6 +112,7 @@ special_sym const special_symbols[] =  {
   {"$channel"        , SYM_CHANNEL_TYPE},
   {"$recovered"      , SYM_RECOVERED},
   {"$placeholder"    , SYM_PLACEHOLDER},
+  {"$image-binding"  , SYM_IMAGE_BINDING},
   {"$custom"         , SYM_CUSTOM_TYPE},
   {"$array"          , SYM_LISPARRAY_TYPE},
   {"$nonsense"       , SYM_NONSENSE},
@@ -265,9 +266,42 @@ static lbm_uint symbol_table_size_list_flash = 0;
 static lbm_uint symbol_table_size_strings = 0;
 static lbm_uint symbol_table_size_strings_flash = 0;
 
+// Name -> id lookup cache.
+// The reader resolves every symbol token by name and a full lookup
+// walks the special symbols, the extension table and the symlist.
+// Only successful lookups are cached. Names are only ever added
+// to the tables after a failed lookup, so an entry can only go stale
+// when the tables are reset, an extension is removed or a symbol is
+// added without checking for an existing entry.
+#ifndef LBM_SYMBOL_CACHE_SIZE
+#define LBM_SYMBOL_CACHE_SIZE 64
+#endif
+
+typedef struct {
+  const char *name;
+  lbm_uint id;
+} symbol_cache_entry_t;
+
+static symbol_cache_entry_t symbol_cache[LBM_SYMBOL_CACHE_SIZE];
+
+static inline lbm_uint symbol_cache_ix(const char *name) {
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  while (*name) {
+    h ^= (uint8_t)*name++;
+    h *= 16777619u;
+  }
+  return h % LBM_SYMBOL_CACHE_SIZE;
+}
+
+void lbm_symrepr_clear_cache(void) {
+  memset(symbol_cache, 0, sizeof(symbol_cache));
+}
+
 // When rebooting an image...
 void lbm_symrepr_set_symlist(lbm_uint *ls) {
   symlist = ls;
+  lbm_symrepr_clear_cache();
 }
 
 
@@ -286,6 +320,7 @@ bool lbm_symrepr_init(void) {
   symbol_table_size_list_flash = 0;
   symbol_table_size_strings = 0;
   symbol_table_size_strings_flash = 0;
+  lbm_symrepr_clear_cache();
   return true;
 }
 
@@ -354,18 +389,27 @@ lbm_uint *lbm_get_symbol_list_entry_by_name(char *name) {
 // Lookup symbol id given symbol name
 int lbm_get_symbol_by_name(char *name, lbm_uint* id) {
   int res = 0;
+  lbm_uint cache_ix = symbol_cache_ix(name);
+  symbol_cache_entry_t *ce = &symbol_cache[cache_ix];
+  if (ce->name && str_eq(name, (char *)ce->name)) {
+    *id = ce->id;
+    return 1;
+  }
   // loop through special symbols
   for (unsigned int i = 0; i < NUM_SPECIAL_SYMBOLS; i ++) {
     if (str_eq(name, (char *)special_symbols[i].name)) {
       *id = special_symbols[i].id;
+      ce->name = special_symbols[i].name;
       res = 1; goto get_symbol_by_name_done;
     }
    }
 
   // loop through extensions
-  for (unsigned int i = 0; i < lbm_get_max_extensions(); i ++) {
+  lbm_uint num_ext = lbm_get_max_extensions();
+  for (unsigned int i = 0; i < num_ext; i ++) {
     if (extension_table[i].name && str_eq(name, extension_table[i].name)) {
       *id = EXTENSION_SYMBOLS_START + i;
+      ce->name = extension_table[i].name;
       res = 1; goto get_symbol_by_name_done;
     }
   }
@@ -375,11 +419,13 @@ int lbm_get_symbol_by_name(char *name, lbm_uint* id) {
     char *str = (char*)curr[NAME];
     if (str_eq(name, str)) {
       *id = curr[ID];
+      ce->name = str;
       res = 1; goto get_symbol_by_name_done;
     }
     curr = (lbm_uint*)curr[NEXT];
   }
  get_symbol_by_name_done:
+  if (res) ce->id = *id;
   return res;
 }
 
@@ -462,6 +508,7 @@ int lbm_add_symbol_const_base(char *name, lbm_uint* id, bool link) {
   if (new_symlist) {
     symlist = new_symlist;
     *id = next_symbol_id ++;
+    lbm_symrepr_clear_cache();
     res = 1;
   }
   return res;
@@ -106,7 +106,29 @@ const matcher type_qual_table[NUM_TYPE_QUALIFIERS] = {
   {"b"  , TOKTYPEBYTE, 1}
 };
 
-static int tok_match_fixed_size_tokens(lbm_char_channel_t *chan, const matcher *m, unsigned int start_pos, unsigned int num, uint32_t *res) {
+// A window onto the characters at the head of a channel that can be
+// read without going through the channel interface. Characters past the
+// end of the window are peeked at through the channel as usual.
+typedef struct {
+  const char *data;
+  unsigned int len;
+} tok_span_t;
+
+static inline void tok_span_init(lbm_char_channel_t *chan, tok_span_t *span) {
+  if (lbm_channel_peek_span(chan, &span->data, &span->len) != CHANNEL_SUCCESS) {
+    span->len = 0;
+  }
+}
+
+static inline int tok_peek(lbm_char_channel_t *chan, tok_span_t *span, unsigned int n, char *res) {
+  if (n < span->len) {
+    *res = span->data[n];
+    return CHANNEL_SUCCESS;
+  }
+  return lbm_channel_peek(chan, n, res);
+}
+
+static int tok_match_fixed_size_tokens(lbm_char_channel_t *chan, tok_span_t *span, const matcher *m, unsigned int start_pos, unsigned int num, uint32_t *res) {
 
   for (unsigned int i = 0; i < num; i ++) {
     uint32_t tok_len = m[i].len;
@@ -114,7 +136,7 @@ static int tok_match_fixed_size_tokens(lbm_char_channel_t *chan, const matcher *
     char c;
     int char_pos;
     for (char_pos = 0; char_pos < (int)tok_len; char_pos ++) {
-      int r = lbm_channel_peek(chan,(unsigned int)char_pos + start_pos, &c);
+      int r = tok_peek(chan, span, (unsigned int)char_pos + start_pos, &c);
       if (r == CHANNEL_SUCCESS) {
         if (c != match_str[char_pos]) break;
       } else if (r == CHANNEL_MORE ) {
@@ -133,7 +155,13 @@ static int tok_match_fixed_size_tokens(lbm_char_channel_t *chan, const matcher *
 }
 
 int tok_syntax(lbm_char_channel_t *chan, uint32_t *res) {
-  return tok_match_fixed_size_tokens(chan, fixed_size_tokens, 0, NUM_FIXED_SIZE_TOKENS, res);
+  tok_span_t span;
+  tok_span_init(chan, &span);
+  // No fixed size token starts with a digit.
+  if (span.len > 0 && span.data[0] >= '0' && span.data[0] <= '9') {
+    return TOKENIZER_NO_TOKEN;
+  }
+  return tok_match_fixed_size_tokens(chan, &span, fixed_size_tokens, 0, NUM_FIXED_SIZE_TOKENS, res);
 }
 
 static bool alpha_char(char c) {
@@ -174,18 +202,19 @@ int tok_symbol(lbm_char_channel_t *chan) {
   char c;
   int r = 0;
 
-  r = lbm_channel_peek(chan, 0, &c);
+  tok_span_t span;
+  tok_span_init(chan, &span);
+  r = tok_peek(chan, &span, 0, &c);
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   if (r == CHANNEL_END)  return TOKENIZER_NO_TOKEN;
   if (r == CHANNEL_SUCCESS && !symchar0(c)) {
     return TOKENIZER_NO_TOKEN;
   }
-  memset(tokpar_sym_str,0,TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH+1);
   tokpar_sym_str[0] = (c >= 'A' && c <= 'Z') ? c + 32 : c; // locale independent ASCII only tolower.
 
   int len = 1;
 
-  r = lbm_channel_peek(chan,(unsigned int)len, &c);
+  r = tok_peek(chan, &span, (unsigned int)len, &c);
   while (r == CHANNEL_SUCCESS && symchar(c)) {
     c = (c >= 'A' && c <= 'Z') ? c + 32 : c; // locale independent ASCII only tolower.
     if (len < TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH) {
@@ -194,7 +223,7 @@ int tok_symbol(lbm_char_channel_t *chan) {
       return TOKENIZER_SYMBOL_ERROR;
     }
     len ++;
-    r = lbm_channel_peek(chan,(unsigned int)len, &c);
+    r = tok_peek(chan, &span, (unsigned int)len, &c);
   }
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   tokpar_sym_str[len] = 0;
@@ -209,17 +238,17 @@ int tok_string(lbm_char_channel_t *chan, unsigned int *string_len) {
   int r = 0;
   bool encode = false;
 
-  r = lbm_channel_peek(chan,0,&c);
+  tok_span_t span;
+  tok_span_init(chan, &span);
+  r = tok_peek(chan, &span, 0,&c);
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   else if (r == CHANNEL_END) return TOKENIZER_NO_TOKEN;
 
   if (c != '\"') return TOKENIZER_NO_TOKEN;;
   n++;
 
-  memset(tokpar_sym_str,0,TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH+1);
-
   // read string into buffer
-  r = lbm_channel_peek(chan,n,&c);
+  r = tok_peek(chan, &span, n,&c);
   while (r == CHANNEL_SUCCESS && (c != '\"' || encode) &&
 	 len < TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH) {
     if (c == '\\' && !encode) {
@@ -239,12 +268,13 @@ int tok_string(lbm_char_channel_t *chan, unsigned int *string_len) {
       encode = false;
     }
     n ++;
-    r = lbm_channel_peek(chan, n, &c);
+    r = tok_peek(chan, &span, n, &c);
   }
 
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   if (c != '\"') return TOKENIZER_STRING_ERROR;
 
+  tokpar_sym_str[len] = 0;
   *string_len = len;
   n ++;
   return (int)n;
@@ -255,24 +285,26 @@ int tok_char(lbm_char_channel_t *chan, char *res) {
   char c;
   int r;
 
-  r = lbm_channel_peek(chan, 0, &c);
+  tok_span_t span;
+  tok_span_init(chan, &span);
+  r = tok_peek(chan, &span, 0, &c);
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   if (r == CHANNEL_END)  return TOKENIZER_NO_TOKEN;
 
   if (c != '\\') return TOKENIZER_NO_TOKEN;
 
-  r = lbm_channel_peek(chan, 1, &c);
+  r = tok_peek(chan, &span, 1, &c);
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   if (r == CHANNEL_END)  return TOKENIZER_NO_TOKEN;
 
   if (c != '#') return TOKENIZER_NO_TOKEN;
 
-  r = lbm_channel_peek(chan, 2, &c);
+  r = tok_peek(chan, &span, 2, &c);
   if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   if (r == CHANNEL_END)  return TOKENIZER_NO_TOKEN;
 
   if (c == '\\') {
-    r = lbm_channel_peek(chan, 3, &c);
+    r = tok_peek(chan, &span, 3, &c);
     if (r == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
     if (r == CHANNEL_END)  return TOKENIZER_NO_TOKEN;
     
@@ -291,78 +323,138 @@ int tok_char(lbm_char_channel_t *chan, char *res) {
 
 #define TD_BUF_SIZE 128
 
-#define FBUF_ADD(X,N) if ((N) < TD_BUF_SIZE) { fbuf[(N)] = (X); N++; } else goto tok_double_no_tok;
+// Powers of ten that are exact in a float.
+static const float tok_pow10f[11] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// Significant digits kept in the mantissa.
+#define TD_MAX_DIGITS 19
+
+typedef struct {
+  uint64_t mant;  // Value is mant * 10^exp10.
+  int digits;     // Significant digits in mant.
+  int exp10;
+  bool exact;     // false if nonzero digits did not fit in mant.
+} tok_decimal_t;
+
+// Scan digits from position n and accumulate them into d. Returns the
+// channel status of the last peek, c is the last character peeked.
+static int tok_decimal_digits(lbm_char_channel_t *chan, tok_span_t *span, unsigned int *n,
+                              tok_decimal_t *d, bool fraction, char *c) {
+  while (true) {
+    if (*n < span->len) {
+      *c = span->data[*n];
+    } else {
+      int res = lbm_channel_peek(chan, *n, c);
+      if (res != CHANNEL_SUCCESS) return res;
+    }
+    if (*c < '0' || *c > '9') return CHANNEL_SUCCESS;
+    if (d->digits < TD_MAX_DIGITS) {
+      d->mant = d->mant * 10 + (uint64_t)(*c - '0');
+      if (d->mant > 0) d->digits ++;
+      if (fraction) d->exp10 --;
+    } else {
+      if (!fraction) d->exp10 ++;
+      if (*c != '0') d->exact = false;
+    }
+    (*n) ++;
+  }
+}
+
+// A mantissa below 2^24 and a power of ten up to 10^10 are both exact
+// in a float, so a single multiplication or division rounds correctly.
+// Anything else goes through strtof/strtod.
+static double tok_decimal_value(lbm_char_channel_t *chan, tok_span_t *span, unsigned int n,
+                                tok_decimal_t *d, int exp, bool negative, uint32_t type) {
+  int e = d->exp10 + exp;
+  if (type == TOKTYPEF32 && d->exact && d->mant < (1 << 24) && e >= -10 && e <= 10) {
+    float f = (float)d->mant;
+    if (e < 0) {
+      f = f / tok_pow10f[-e];
+    } else {
+      f = f * tok_pow10f[e];
+    }
+    return (double)(negative ? -f : f);
+  }
+  char fbuf[TD_BUF_SIZE];
+  for (unsigned int i = 0; i < n; i ++) {
+    tok_peek(chan, span, i, &fbuf[i]);
+  }
+  fbuf[n] = 0;
+  if (type == TOKTYPEF32) {
+    return (double)strtof(fbuf, NULL);
+  }
+  return strtod(fbuf, NULL);
+}
+
 int tok_double(lbm_char_channel_t *chan, token_float *result) {
 
   unsigned int n = 0;
-  char fbuf[TD_BUF_SIZE];
   char c;
-  bool valid_num = false;
   int res;
+  int exp = 0;
+  tok_decimal_t d = {0, 0, 0, true};
 
-  memset(fbuf, 0, TD_BUF_SIZE);
+  tok_span_t span;
+  tok_span_init(chan, &span);
 
   result->type = TOKTYPEF32;
   result->negative = false;
 
-  res = lbm_channel_peek(chan, n, &c);
+  res = tok_peek(chan, &span, n, &c);
   if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   else if (res == CHANNEL_END) return TOKENIZER_NO_TOKEN;
   if (c == '-') {
-    FBUF_ADD('-', n);
+    n++;
     result->negative = true;
   }
 
-  res = lbm_channel_peek(chan, n, &c);
+  res = tok_decimal_digits(chan, &span, &n, &d, false, &c);
   if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   else if (res == CHANNEL_END) return TOKENIZER_NO_TOKEN;
-  while (c >= '0' && c <= '9') {
-    FBUF_ADD(c, n);
-    res = lbm_channel_peek(chan, n, &c);
-    if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
-    if (res == CHANNEL_END) break;
-  }
 
   if (c == '.') {
-    FBUF_ADD(c, n);
+    n++;
   }
   else return TOKENIZER_NO_TOKEN;
 
-  res = lbm_channel_peek(chan,n, &c);
+  res = tok_peek(chan, &span, n, &c);
   if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
   else if (res == CHANNEL_END) return TOKENIZER_NO_TOKEN;
   if (!(c >= '0' && c <= '9')) return TOKENIZER_NO_TOKEN;
 
-  while (c >= '0' && c <= '9') {
-    FBUF_ADD(c, n);
-    res = lbm_channel_peek(chan, n, &c);
-    if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
-    if (res == CHANNEL_END) break;
-  }
+  res = tok_decimal_digits(chan, &span, &n, &d, true, &c);
+  if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
 
   if (c == 'e') {
-    FBUF_ADD(c, n);
-    res = lbm_channel_peek(chan,n, &c);
+    n++;
+    res = tok_peek(chan, &span, n, &c);
     if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
     else if (res == CHANNEL_END) return TOKENIZER_NO_TOKEN;
     if (!((c >= '0' && c <= '9') || c == '-')) return TOKENIZER_NO_TOKEN;
 
+    bool exp_negative = false;
     if (c == '-') {
-      FBUF_ADD(c, n);
+      exp_negative = true;
+      n++;
     }
-    res = lbm_channel_peek(chan,n, &c);
+    res = tok_peek(chan, &span, n, &c);
     if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
     else if (res == CHANNEL_END) return TOKENIZER_NO_TOKEN;
     while ((c >= '0' && c <= '9')) {
-      FBUF_ADD(c,n);
-      res = lbm_channel_peek(chan, n, &c);
+      if (exp < 100000) exp = (exp * 10) + (c - '0');
+      n++;
+      res = tok_peek(chan, &span, n, &c);
       if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
       if (res == CHANNEL_END) break;
     }
+    if (exp_negative) exp = -exp;
   }
+  if (n >= TD_BUF_SIZE) return TOKENIZER_NO_TOKEN;
 
   uint32_t tok_res;
-  int type_len = tok_match_fixed_size_tokens(chan, type_qual_table, n, NUM_TYPE_QUALIFIERS, &tok_res);
+  int type_len = tok_match_fixed_size_tokens(chan, &span, type_qual_table, n, NUM_TYPE_QUALIFIERS, &tok_res);
 
   if (type_len == TOKENIZER_NEED_MORE) return type_len;
   if (type_len == TOKENIZER_NO_TOKEN) {
@@ -371,16 +463,8 @@ int tok_double(lbm_char_channel_t *chan, token_float *result) {
     result->type = tok_res;
   }
 
-  if ((result->negative && n > 1) ||
-      (!result->negative && n > 0)) valid_num = true;
-
-  if(valid_num) {
-    result->value = (double)strtod(fbuf,NULL);
-    return (int)n + type_len;
-  }
-
- tok_double_no_tok:
-  return TOKENIZER_NO_TOKEN;
+  result->value = tok_decimal_value(chan, &span, n, &d, exp, result->negative, result->type);
+  return (int)n + type_len;
 }
 
 bool tok_clean_whitespace(lbm_char_channel_t *chan) {
@@ -393,6 +477,20 @@ bool tok_clean_whitespace(lbm_char_channel_t *chan) {
 
     if (lbm_channel_comment(chan)) {
       while (true) {
+        // Drop the comment up to the newline, a span at a time.
+        tok_span_t span;
+        tok_span_init(chan, &span);
+        if (span.len > 0) {
+          unsigned int n = 0;
+          while (n < span.len && span.data[n] != '\n') n ++;
+          if (n < span.len) {
+            lbm_channel_drop(chan, n + 1);
+            lbm_channel_set_comment(chan, false);
+            break;
+          }
+          lbm_channel_drop(chan, n);
+          continue;
+        }
         r = lbm_channel_peek(chan, 0, &c);
         if (r == CHANNEL_END) {
           lbm_channel_set_comment(chan, false);
@@ -411,6 +509,14 @@ bool tok_clean_whitespace(lbm_char_channel_t *chan) {
     }
 
     do {
+      tok_span_t span;
+      tok_span_init(chan, &span);
+      unsigned int n = 0;
+      while (n < span.len && isspace(span.data[n])) n ++;
+      if (n > 0) {
+        lbm_channel_drop(chan, n);
+        continue;
+      }
       r = lbm_channel_peek(chan, 0, &c);
       if (r == CHANNEL_MORE) {
         return false;
@@ -439,9 +545,11 @@ int tok_integer(lbm_char_channel_t *chan, token_int *result) {
   char c;
   int res;
 
+  tok_span_t span;
+  tok_span_init(chan, &span);
   result->type = TOKTYPEI;
   result-> negative = false;
-  res = lbm_channel_peek(chan, 0, &c);
+  res = tok_peek(chan, &span, 0, &c);
   if (res == CHANNEL_MORE) {
     return TOKENIZER_NEED_MORE;
   } else if (res == CHANNEL_END) {
@@ -453,9 +561,9 @@ int tok_integer(lbm_char_channel_t *chan, token_int *result) {
   }
 
   bool hex = false;
-  res = lbm_channel_peek(chan, n, &c);
+  res = tok_peek(chan, &span, n, &c);
   if (res == CHANNEL_SUCCESS && c == '0') {
-    res = lbm_channel_peek(chan, n + 1, &c);
+    res = tok_peek(chan, &span, n + 1, &c);
     if ( res == CHANNEL_SUCCESS && (c == 'x' || c == 'X')) {
       hex = true;
     } else if (res == CHANNEL_MORE) {
@@ -468,7 +576,7 @@ int tok_integer(lbm_char_channel_t *chan, token_int *result) {
   if (hex) {
     n += 2;
 
-    res = lbm_channel_peek(chan,n, &c);
+    res = tok_peek(chan, &span, n, &c);
 
     if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
     else if (res == CHANNEL_END) return TOKENIZER_NO_TOKEN;
@@ -486,18 +594,22 @@ int tok_integer(lbm_char_channel_t *chan, token_int *result) {
       }
       acc = (acc * 0x10) + val;
       n++;
-      res = lbm_channel_peek(chan, n, &c);
+      res = tok_peek(chan, &span, n, &c);
       if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
       if (res == CHANNEL_END) break;
 
     }
   } else {
-    res = lbm_channel_peek(chan, n, &c);
+    while (n < span.len && span.data[n] >= '0' && span.data[n] <= '9') {
+      acc = (acc*10) + (uint32_t)(span.data[n] - '0');
+      n++;
+    }
+    res = tok_peek(chan, &span, n, &c);
     if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
-    while (c >= '0' && c <= '9') {
+    while (res == CHANNEL_SUCCESS && c >= '0' && c <= '9') {
       acc = (acc*10) + (uint32_t)(c - '0');
       n++;
-      res = lbm_channel_peek(chan, n, &c);
+      res = tok_peek(chan, &span, n, &c);
       if (res == CHANNEL_MORE) return TOKENIZER_NEED_MORE;
       if (res == CHANNEL_END)  break;
     }
@@ -506,7 +618,7 @@ int tok_integer(lbm_char_channel_t *chan, token_int *result) {
   if (n == 0 || (hex && n == 2)) return TOKENIZER_NO_TOKEN;
 
   uint32_t tok_res;
-  int type_len = tok_match_fixed_size_tokens(chan, type_qual_table, n, NUM_TYPE_QUALIFIERS, &tok_res);
+  int type_len = tok_match_fixed_size_tokens(chan, &span, type_qual_table, n, NUM_TYPE_QUALIFIERS, &tok_res);
 
   if (type_len == TOKENIZER_NEED_MORE) return type_len;
   if (type_len != TOKENIZER_NO_TOKEN) {
@@ -522,3 +634,32 @@ int tok_integer(lbm_char_channel_t *chan, token_int *result) {
   }
   return TOKENIZER_NO_TOKEN;
 }
+
+unsigned int tok_bytearray_elements(lbm_char_channel_t *chan, uint8_t *data, unsigned int max) {
+  tok_span_t span;
+  tok_span_init(chan, &span);
+  unsigned int pos = 0;
+  unsigned int used = 0;
+  unsigned int num = 0;
+  while (num < max) {
+    while (pos < span.len && isspace((unsigned char)span.data[pos])) pos ++;
+    unsigned int start = pos;
+    uint32_t acc = 0;
+    while (pos < span.len && pos - start < 9 &&
+           span.data[pos] >= '0' && span.data[pos] <= '9') {
+      acc = (acc * 10) + (uint32_t)(span.data[pos] - '0');
+      pos ++;
+    }
+    // The number must be followed by a delimiter within the span,
+    // anything else is left to the tokenizer.
+    if (pos == start || pos >= span.len) break;
+    char c = span.data[pos];
+    if (!isspace((unsigned char)c) && c != ']') break;
+    data[num++] = (uint8_t)acc;
+    used = pos;
+  }
+  if (used > 0) {
+    lbm_channel_drop(chan, used);
+  }
+  return num;
+}
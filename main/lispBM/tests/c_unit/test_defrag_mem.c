@@ -0,0 +1,211 @@
+#define _GNU_SOURCE // MAP_ANON
+#define _POSIX_C_SOURCE 200809L // nanosleep?
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+
+#include "lispbm.h"
+#include "lbm_defrag_mem.h"
+
+#include "init/start_lispbm.c"
+
+// Starts lispbm with the evaluator paused so that no GC runs while
+// the tests use defrag mem directly.
+static int test_init(void) {
+  if (!start_lispbm_for_tests()) return 0;
+  int timeout = 0;
+  while (lbm_get_eval_state() != EVAL_CPS_STATE_PAUSED && timeout < 1000) {
+    lbm_pause_eval();
+    sleep_callback(1000);
+    timeout++;
+  }
+  return lbm_get_eval_state() == EVAL_CPS_STATE_PAUSED;
+}
+
+static uint32_t rand_state = 12345;
+
+static uint32_t next_rand(void) {
+  rand_state = rand_state * 1103515245u + 12345u;
+  return rand_state >> 8;
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Frees an allocation the way GC does and clears the cell referring to it.
+static void free_allocation(lbm_value arr) {
+  lbm_defrag_mem_free((lbm_uint*)lbm_car(arr));
+  lbm_set_car_and_cdr(lbm_set_ptr_type(arr, LBM_TYPE_CONS), ENC_SYM_NIL, ENC_SYM_NIL);
+}
+
+static lbm_uint *dm_create(lbm_uint nbytes) {
+  lbm_value dm = lbm_defrag_mem_create(nbytes);
+  if (lbm_is_symbol(dm)) return NULL;
+  return (lbm_uint*)lbm_car(dm);
+}
+
+// Allocates like dm-alloc does, with a second try when the first fails.
+static lbm_value dm_alloc(lbm_uint *dm, lbm_uint nbytes) {
+  lbm_value res = lbm_defrag_mem_alloc(dm, nbytes);
+  if (lbm_is_symbol_merror(res)) {
+    res = lbm_defrag_mem_alloc(dm, nbytes);
+  }
+  return res;
+}
+
+static bool check_data(lbm_value arr, lbm_uint size, uint8_t pattern) {
+  lbm_array_header_t *header = lbm_dec_array_r(arr);
+  if (!header || header->size != size) return false;
+  uint8_t *data = (uint8_t*)header->data;
+  for (lbm_uint i = 0; i < size; i ++) {
+    if (data[i] != (uint8_t)(pattern + i)) return false;
+  }
+  return true;
+}
+
+static void fill_data(lbm_value arr, uint8_t pattern) {
+  lbm_array_header_t *header = lbm_dec_array_r(arr);
+  uint8_t *data = (uint8_t*)header->data;
+  for (lbm_uint i = 0; i < header->size; i ++) {
+    data[i] = (uint8_t)(pattern + i);
+  }
+}
+
+// Fill a defrag mem with small arrays, free every other one and
+// allocate something larger than any of the holes.
+static int test_defrag_mem_fragmented(lbm_uint compact_step) {
+  if (!test_init()) return 0;
+  lbm_defrag_mem_set_compact_step(compact_step);
+
+  lbm_uint *dm = dm_create(1024);
+  if (!dm) return 0;
+
+  lbm_value arrs[256];
+  int n = 0;
+  while (n < 256) {
+    lbm_value a = lbm_defrag_mem_alloc(dm, 8);
+    if (lbm_is_symbol_merror(a)) break;
+    fill_data(a, (uint8_t)n);
+    arrs[n++] = a;
+  }
+  if (n < 8) return 0;
+  for (int i = 0; i < n; i += 2) {
+    free_allocation(arrs[i]);
+  }
+
+  lbm_value big = lbm_defrag_mem_alloc(dm, 24);
+  if (lbm_is_symbol_merror(big)) return 0;
+  fill_data(big, 7);
+
+  for (int i = 1; i < n; i += 2) {
+    if (!check_data(arrs[i], 8, (uint8_t)i)) return 0;
+  }
+  return check_data(big, 24, 7);
+}
+
+#define STRESS_OPS 2500
+#define STRESS_MAX_LIVE 64
+#define STRESS_POOL_BYTES 4096
+#define STRESS_MAX_ALLOC 192
+#define HISTOGRAM_BUCKETS 24
+
+typedef struct {
+  lbm_value arr;
+  lbm_uint size;
+  uint8_t pattern;
+} live_t;
+
+// Random allocations and frees. The contents of every live array are
+// checked after each operation and the latency of each allocation is
+// counted in a histogram of powers of two nanoseconds.
+static int test_defrag_mem_stress(lbm_uint compact_step) {
+  if (!test_init()) return 0;
+  lbm_defrag_mem_set_compact_step(compact_step);
+
+  lbm_uint *dm = dm_create(STRESS_POOL_BYTES);
+  if (!dm) return 0;
+
+  live_t live[STRESS_MAX_LIVE];
+  int num_live = 0;
+  unsigned int histogram[HISTOGRAM_BUCKETS] = {0};
+  uint64_t max_ns = 0;
+  unsigned int failed = 0;
+
+  for (int op = 0; op < STRESS_OPS; op ++) {
+    bool do_alloc = num_live == 0 || (num_live < STRESS_MAX_LIVE && next_rand() % 100 < 55);
+    if (do_alloc) {
+      lbm_uint size = 1 + next_rand() % STRESS_MAX_ALLOC;
+      uint64_t t0 = now_ns();
+      lbm_value a = dm_alloc(dm, size);
+      uint64_t dt = now_ns() - t0;
+      int bucket = 0;
+      while (bucket < HISTOGRAM_BUCKETS - 1 && (dt >> (bucket + 1)) > 0) bucket ++;
+      histogram[bucket] ++;
+      if (dt > max_ns) max_ns = dt;
+      if (lbm_is_symbol_merror(a)) {
+        // Full, make room instead.
+        failed ++;
+        int victim = (int)(next_rand() % (uint32_t)num_live);
+        free_allocation(live[victim].arr);
+        live[victim] = live[--num_live];
+      } else {
+        uint8_t pattern = (uint8_t)next_rand();
+        fill_data(a, pattern);
+        live[num_live].arr = a;
+        live[num_live].size = size;
+        live[num_live].pattern = pattern;
+        num_live ++;
+      }
+    } else {
+      int victim = (int)(next_rand() % (uint32_t)num_live);
+      free_allocation(live[victim].arr);
+      live[victim] = live[--num_live];
+    }
+    for (int i = 0; i < num_live; i ++) {
+      if (!check_data(live[i].arr, live[i].size, live[i].pattern)) {
+        printf("Corrupted array after operation %d\n", op);
+        return 0;
+      }
+    }
+  }
+
+  printf("compact step %u: %u failed allocations, max %u ns\n",
+         (unsigned int)compact_step, failed, (unsigned int)max_ns);
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i ++) {
+    if (histogram[i]) {
+      printf("  %8u ns: %u\n", 1u << i, histogram[i]);
+    }
+  }
+  return 1;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int total_tests = 0;
+
+  total_tests++; if (test_defrag_mem_fragmented(0)) tests_passed++;
+  total_tests++; if (test_defrag_mem_fragmented(1024)) tests_passed++;
+  total_tests++; if (test_defrag_mem_stress(0)) tests_passed++;
+  total_tests++; if (test_defrag_mem_stress(64)) tests_passed++;
+  total_tests++; if (test_defrag_mem_stress(1024)) tests_passed++;
+
+  kill_eval_after_tests();
+
+  if (tests_passed == total_tests) {
+    printf("SUCCESS\n");
+    return 0;
+  } else {
+    printf("FAILED: %d/%d tests passed\n", tests_passed, total_tests);
+    return 1;
+  }
+}
@@ -732,7 +732,7 @@ int test_lbm_flatten_env(void) {
   bool result2 = lbm_flatten_env(-1, &data, &size);
   
   // Test 3: Try with index too large
-  bool result3 = lbm_flatten_env(GLOBAL_ENV_ROOTS, &data, &size);
+  bool result3 = lbm_flatten_env((int)lbm_get_global_env_num_roots(), &data, &size);
   
   // Test 4: Try with NULL pointers - these should cause segfaults, so skip them
   // bool result4 = lbm_flatten_env(0, NULL, &size);
@@ -599,6 +599,60 @@ int test_unflatten_malicious_lisp_array(void) {
   return 1; // Good - failed as expected or returned safe value
 }
 
+// Test unflatten with a shared node that is a reference to itself.
+// The local map slot of the node is never set, so the reference must
+// be rejected rather than read whatever was left in lbm_memory.
+int test_unflatten_ref_to_unset_local(void) {
+  if (!test_init()) return 0;
+
+  // Leave a recognizable pattern in the memory the local map gets.
+  lbm_uint num_free = lbm_memory_longest_free();
+  uint8_t *junk = (uint8_t*)lbm_malloc(num_free * sizeof(lbm_uint));
+  if (!junk) return 0;
+  memset(junk, 0x41, num_free * sizeof(lbm_uint));
+  lbm_free(junk);
+
+  uint8_t self_ref_data[] = {
+    S_SHARING_HEADER, 0x00, 0x00, 0x00, 0x01, // One shared node
+    S_SHARED_LOCAL,                           // Node 0 is...
+    S_REF_LOCAL, 0x00, 0x00, 0x00, 0x00       // ...a reference to node 0
+  };
+
+  lbm_flat_value_t fv;
+  fv.buf = self_ref_data;
+  fv.buf_size = sizeof(self_ref_data);
+  fv.buf_pos = 0;
+
+  lbm_value result;
+  if (lbm_unflatten_value(&fv, &result) || result != ENC_SYM_EERROR) return 0;
+
+  // A reference to a node that has only been numbered.
+  uint8_t unset_ref_data[] = {
+    S_SHARING_HEADER, 0x00, 0x00, 0x00, 0x02,
+    S_CONS,
+    S_SHARED_LOCAL, S_REF_LOCAL, 0x00, 0x00, 0x00, 0x00,
+    S_SYM_VALUE, 0x00, 0x00, 0x00, 0x00 // Not reached
+  };
+  fv.buf = unset_ref_data;
+  fv.buf_size = sizeof(unset_ref_data);
+  fv.buf_pos = 0;
+  if (lbm_unflatten_value(&fv, &result) || result != ENC_SYM_EERROR) return 0;
+
+  // References back to an enclosing node (a cycle) are fine.
+  lbm_value c = lbm_cons(lbm_enc_i(1), ENC_SYM_NIL);
+  if (lbm_is_symbol_merror(c)) return 0;
+  lbm_set_cdr(c, c);
+  lbm_value flat = flatten_value_sharing(c);
+  lbm_array_header_t *header = lbm_dec_array_r(flat);
+  if (!header) return 0;
+  fv.buf = (uint8_t*)header->data;
+  fv.buf_size = header->size;
+  fv.buf_pos = 0;
+  return lbm_unflatten_value(&fv, &result) &&
+         lbm_is_cons(result) &&
+         lbm_cdr(result) == result;
+}
+
 // Test unflatten with S_SYM_STRING that has extremely long claimed length
 int test_unflatten_symbol_string_long_scan(void) {
   if (!test_init()) return 0;
@@ -970,6 +1024,7 @@ int main(void) {
   total_tests++; if (test_flatten_each_type_barely_too_small()) tests_passed++;
   total_tests++; if (test_unflatten_malicious_symbol_string()) tests_passed++;
   total_tests++; if (test_unflatten_malicious_lisp_array()) tests_passed++;
+  total_tests++; if (test_unflatten_ref_to_unset_local()) tests_passed++;
   total_tests++; if (test_unflatten_symbol_string_long_scan()) tests_passed++;
   total_tests++; if (test_flatten_lisp_array_small_buffer()) tests_passed++;
   total_tests++; if (test_flatten_progressive_buffer_sizes()) tests_passed++;
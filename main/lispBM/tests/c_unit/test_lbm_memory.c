@@ -247,6 +247,46 @@ int test_memory_shrink_invalid() {
   return 1;
 }
 
+int test_memory_extend() {
+  if (!setup_memory()) return 0;
+
+  lbm_uint *ptr = lbm_memory_allocate(1);
+  if (!ptr) return 0;
+  lbm_uint free_before = lbm_memory_num_free();
+
+  if (!lbm_memory_extend(ptr, 5)) return 0;
+  if (lbm_memory_num_free() != free_before - 4) return 0;
+  if (!lbm_memory_extend(ptr, 10)) return 0;
+  if (lbm_memory_num_free() != free_before - 9) return 0;
+
+  // The next allocation ends up after the extended range.
+  lbm_uint *ptr2 = lbm_memory_allocate(2);
+  if (!ptr2 || ptr2 != ptr + 10) return 0;
+
+  // Cannot extend into ptr2.
+  if (lbm_memory_extend(ptr, 11)) return 0;
+  if (lbm_memory_extend(ptr, 5)) return 0;
+
+  if (!lbm_memory_free(ptr)) return 0;
+  if (lbm_memory_num_free() != free_before + 1 - 2) return 0;
+  return 1;
+}
+
+int test_memory_extend_invalid() {
+  if (!setup_memory()) return 0;
+
+  lbm_uint *ptr = lbm_memory_allocate(5);
+  if (!ptr) return 0;
+
+  if (lbm_memory_extend(ptr, 0)) return 0;
+  if (lbm_memory_extend(ptr + 1, 10)) return 0;
+  if (lbm_memory_extend(ptr, lbm_memory_num_words() + 1)) return 0;
+
+  lbm_uint external_memory[10];
+  if (lbm_memory_extend(external_memory, 5)) return 0;
+  return 1;
+}
+
 int test_memory_longest_free() {
   if (!setup_memory()) return 0;
 
@@ -972,6 +1012,8 @@ int main(void) {
   total_tests++; if (test_memory_shrink()) tests_passed++;
   total_tests++; if (test_memory_shrink_single_word()) tests_passed++;
   total_tests++; if (test_memory_shrink_invalid()) tests_passed++;
+  total_tests++; if (test_memory_extend()) tests_passed++;
+  total_tests++; if (test_memory_extend_invalid()) tests_passed++;
   total_tests++; if (test_memory_longest_free()) tests_passed++;
   total_tests++; if (test_memory_longest_free_uninitialized()) tests_passed++;
   total_tests++; if (test_memory_maximum_used()) tests_passed++;
@@ -152,6 +152,63 @@ int test_lbm_prof_measure2(void) {
   return 0;
 }
 
+int test_lbm_prof_functions(void) {
+  lbm_prof_t prof_data_buf[100];
+  lbm_prof_fun_t fun_buf[16];
+  lbm_prof_stack_t stack_buf[16];
+
+  if (!start_lispbm_for_tests()) return 0;
+
+  if (!lbm_prof_init(prof_data_buf, 100)) return 0;
+  lbm_prof_init_functions(fun_buf, 16, stack_buf, 16);
+  lbm_set_call_tracking(true);
+
+  char *prog1 = "(define g (lambda (n) (if (= n 0) 0 (+ 1 (g (- n 1)))))) (define f (lambda () {(g 3) (f)})) (spawn f)";
+  lbm_string_channel_state_t st1;
+  lbm_char_channel_t chan1;
+  lbm_create_string_char_channel(&st1, &chan1, prog1);
+  lbm_cid cid1 = lbm_load_and_eval_program(&chan1, "thread-1");
+
+  if (cid1 < 0) return 0;
+
+  for (int i = 0; i < 1000; i ++) {
+    lbm_prof_sample();
+    sleep_callback(1000);
+  }
+
+  lbm_set_call_tracking(false);
+  lbm_prof_init_functions(NULL, 0, NULL, 0);
+
+  lbm_uint g_id;
+  lbm_uint f_id;
+  if (!lbm_get_symbol_by_name("g", &g_id)) return 0;
+  if (!lbm_get_symbol_by_name("f", &f_id)) return 0;
+
+  lbm_uint g_self = 0;
+  lbm_uint f_total = 0;
+  for (int i = 0; i < 16; i ++) {
+    if (fun_buf[i].total == 0) continue;
+    if (fun_buf[i].sym == lbm_enc_sym(g_id)) g_self = fun_buf[i].self;
+    if (fun_buf[i].sym == lbm_enc_sym(f_id)) f_total = fun_buf[i].total;
+  }
+
+  bool has_stack = false;
+  for (int i = 0; i < 16; i ++) {
+    if (stack_buf[i].count > 0 &&
+        stack_buf[i].depth >= 2 &&
+        stack_buf[i].frames[0] == lbm_enc_sym(g_id)) {
+      has_stack = true;
+    }
+  }
+
+  printf("g self: %d\n", (int)g_self);
+  printf("f total: %d\n", (int)f_total);
+
+  // g is called from f, so f is on the stack whenever g is.
+  if (g_self > 0 && f_total >= g_self && has_stack) return 1;
+  return 0;
+}
+
 int main(void) {
   int tests_passed = 0;
   int total_tests = 0;
@@ -160,6 +217,7 @@ int main(void) {
   total_tests++; if (test_lbm_prof_sample_100()) tests_passed++;
   total_tests++; if (test_lbm_prof_measure()) tests_passed++;
   total_tests++; if (test_lbm_prof_measure2()) tests_passed++;
+  total_tests++; if (test_lbm_prof_functions()) tests_passed++;
   
   if (tests_passed == total_tests) {
     printf("SUCCESS\n");
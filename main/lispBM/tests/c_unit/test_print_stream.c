@@ -0,0 +1,197 @@
+#define _GNU_SOURCE // MAP_ANON
+#define _POSIX_C_SOURCE 200809L // nanosleep?
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+
+#include "lispbm.h"
+#include "print.h"
+
+#include "init/start_lispbm.c"
+
+static int test_init(void) {
+  return start_lispbm_for_tests();
+}
+
+#define OUTPUT_SIZE (200 * 1024)
+
+// Collects the streamed chunks into one buffer.
+typedef struct {
+  char *buf;
+  unsigned int pos;
+  unsigned int chunks;
+  unsigned int max_chunks; // stop after this many chunks, 0 for no limit.
+  bool chunk_too_large;
+} collect_t;
+
+static bool collect(const char *data, unsigned int len, void *arg) {
+  collect_t *c = (collect_t*)arg;
+  if (len > LBM_PRINT_CHUNK_SIZE) c->chunk_too_large = true;
+  if (c->pos + len < OUTPUT_SIZE) {
+    memcpy(c->buf + c->pos, data, len);
+  }
+  c->pos += len;
+  c->chunks ++;
+  return c->max_chunks == 0 || c->chunks < c->max_chunks;
+}
+
+// Streams v and checks that the output is the same as from lbm_print_value.
+static int stream_matches_print_value(lbm_value v, unsigned int min_size, const char *what) {
+  char *expected = malloc(OUTPUT_SIZE);
+  char *streamed = malloc(OUTPUT_SIZE);
+  if (!expected || !streamed) {
+    free(expected);
+    free(streamed);
+    return 0;
+  }
+  int ok = 0;
+  collect_t c = {streamed, 0, 0, 0, false};
+
+  if (lbm_print_value(expected, OUTPUT_SIZE, v)) {
+    clock_t t0 = clock();
+    int n = lbm_print_value_stream(v, OUTPUT_SIZE, collect, &c);
+    double secs = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    if (secs > 0) {
+      printf("%s: %d bytes at %.1f MB/s\n", what, n, ((double)n / (1024 * 1024)) / secs);
+    }
+    ok = (n >= 0 &&
+          (unsigned int)n == c.pos &&
+          c.pos >= min_size &&
+          c.pos == strlen(expected) &&
+          !c.chunk_too_large &&
+          memcmp(expected, streamed, c.pos) == 0);
+  }
+  free(expected);
+  free(streamed);
+  return ok;
+}
+
+int test_print_stream_small(void) {
+  if (!test_init()) return 0;
+
+  lbm_value pair = lbm_cons(lbm_enc_i(1), lbm_enc_i(2));
+  lbm_value str;
+  if (!lbm_create_array(&str, 4)) return 0;
+  memcpy(lbm_dec_array_rw(str)->data, "a\"b", 4);
+  lbm_value ls = lbm_cons(pair, lbm_cons(str, ENC_SYM_NIL));
+  if (lbm_is_symbol_merror(ls)) return 0;
+
+  char buf[64];
+  collect_t c = {buf, 0, 0, 0, false};
+  int n = lbm_print_value_stream(ls, sizeof(buf), collect, &c);
+  buf[c.pos] = 0;
+  return n == 16 && c.chunks == 1 && strcmp(buf, "((1 . 2) \"a\\\"b\")") == 0;
+}
+
+// A list of more than 100 KB of printed strings that need escaping.
+int test_print_stream_large_strings(void) {
+  if (!test_init()) return 0;
+
+  const char *part = "some text with \"quotes\" and a backslash \\ ";
+  char str[128];
+  str[0] = 0;
+  while (strlen(str) + strlen(part) < sizeof(str)) {
+    strcat(str, part);
+  }
+  lbm_value s;
+  if (!lbm_create_array(&s, (lbm_uint)strlen(str) + 1)) return 0;
+  memcpy(lbm_dec_array_rw(s)->data, str, strlen(str) + 1);
+
+  lbm_value ls = ENC_SYM_NIL;
+  for (int i = 0; i < 1200; i ++) {
+    ls = lbm_cons(s, ls);
+    if (lbm_is_symbol_merror(ls)) return 0;
+  }
+  return stream_matches_print_value(ls, 100 * 1024, "strings");
+}
+
+// A list of byte arrays that prints to more than 100 KB.
+int test_print_stream_large_byte_arrays(void) {
+  if (!test_init()) return 0;
+
+  lbm_value arr;
+  if (!lbm_create_array(&arr, 5000)) return 0;
+  uint8_t *data = (uint8_t*)lbm_dec_array_rw(arr)->data;
+  for (int i = 0; i < 5000; i ++) {
+    data[i] = (uint8_t)(i * 7);
+  }
+  lbm_value ls = ENC_SYM_NIL;
+  for (int i = 0; i < 6; i ++) {
+    ls = lbm_cons(arr, ls);
+    if (lbm_is_symbol_merror(ls)) return 0;
+  }
+  return stream_matches_print_value(ls, 100 * 1024, "byte arrays");
+}
+
+// A list of numbers as long as the heap allows.
+int test_print_stream_large_numbers(void) {
+  if (!test_init()) return 0;
+
+  lbm_value ls = ENC_SYM_NIL;
+  for (int i = 0; i < 3000; i ++) {
+    ls = lbm_cons(lbm_enc_i(i * 12345), ls);
+    if (lbm_is_symbol_merror(ls)) return 0;
+  }
+  return stream_matches_print_value(ls, 16 * 1024, "numbers");
+}
+
+int test_print_stream_stop(void) {
+  if (!test_init()) return 0;
+
+  lbm_value arr;
+  if (!lbm_create_array(&arr, 1000)) return 0;
+  memset(lbm_dec_array_rw(arr)->data, 1, 1000);
+
+  char *buf = malloc(OUTPUT_SIZE);
+  if (!buf) return 0;
+  collect_t c = {buf, 0, 0, 2, false};
+  int n = lbm_print_value_stream(arr, OUTPUT_SIZE, collect, &c);
+  free(buf);
+  return n < 0 && c.chunks == 2;
+}
+
+// A cyclic list prints up to max_len characters and then fails.
+int test_print_stream_cyclic(void) {
+  if (!test_init()) return 0;
+
+  lbm_value ls = lbm_cons(lbm_enc_i(1), lbm_cons(lbm_enc_i(2), ENC_SYM_NIL));
+  if (lbm_is_symbol_merror(ls)) return 0;
+  lbm_set_cdr(lbm_cdr(ls), ls);
+
+  char *buf = malloc(OUTPUT_SIZE);
+  if (!buf) return 0;
+  collect_t c = {buf, 0, 0, 0, false};
+  int n = lbm_print_value_stream(ls, 1000, collect, &c);
+  bool ok = n < 0 && c.pos == 1000 && memcmp(buf, "(1 2 1 2 ", 9) == 0;
+  free(buf);
+  return ok;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int total_tests = 0;
+
+  total_tests++; if (test_print_stream_small()) tests_passed++;
+  total_tests++; if (test_print_stream_large_strings()) tests_passed++;
+  total_tests++; if (test_print_stream_large_byte_arrays()) tests_passed++;
+  total_tests++; if (test_print_stream_large_numbers()) tests_passed++;
+  total_tests++; if (test_print_stream_stop()) tests_passed++;
+  total_tests++; if (test_print_stream_cyclic()) tests_passed++;
+
+  kill_eval_after_tests();
+
+  if (tests_passed == total_tests) {
+    printf("SUCCESS\n");
+    return 0;
+  } else {
+    printf("FAILED: %d/%d tests passed\n", tests_passed, total_tests);
+    return 1;
+  }
+}
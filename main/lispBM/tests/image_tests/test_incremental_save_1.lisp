@@ -0,0 +1,41 @@
+;; An incremental save only appends the bindings that changed since the
+;; last save. Boot lets the later entries replace the earlier ones.
+
+(define keep (list 1 2 3))
+(define changed (list 1 2 3))
+(define set-me 1)
+(define arr [1 2 3])
+
+(defun main () {
+       (if (and (eq keep (list 1 2 3))
+                (eq changed (list "a" "b"))
+                (= set-me 10)
+                (= (bufget-u8 arr 1) 2)
+                (eq added '(4 5))
+                (= r0 0)
+                (> r1 0)
+                (= r1 r2)
+                (> r3 r1))
+           (print "SUCCESS")
+         (print "FAILURE"))
+       })
+
+(image-save)
+(define r0 (image-reclaimable))
+
+(define changed (list "a" "b"))
+(setq set-me 10)
+(define added '(4 5))
+(image-save-incremental)
+(define r1 (image-reclaimable))
+
+;; Nothing changed since the last save.
+(image-save-incremental)
+(define r2 (image-reclaimable))
+
+;; A full save replaces every binding.
+(image-save)
+(define r3 (image-reclaimable))
+(image-save-incremental)
+
+(fwrite-image (fopen "image.lbm" "w"))
@@ -0,0 +1,37 @@
+;; Bindings undefined after a save must not come back at boot. The
+;; saves write an entry that removes them from the restored environment.
+
+(define keep (list 1 2 3))
+(define drop-a (list 1 2 3))
+(define drop-b 10)
+(define drop-c (list 4 5))
+(define redefined 1)
+
+(defun main () {
+       (if (and (eq keep (list 1 2 3))
+                (eq (trap drop-a) '(exit-error variable_not_bound))
+                (eq (trap drop-b) '(exit-error variable_not_bound))
+                (eq (trap drop-c) '(exit-error variable_not_bound))
+                (= redefined 2))
+           (print "SUCCESS")
+         (print "FAILURE"))
+       })
+
+(image-save)
+
+(undefine 'drop-a)
+(undefine 'drop-b)
+(undefine 'redefined)
+(image-save-incremental)
+
+(define redefined 2)
+(image-save-incremental)
+
+;; drop-c has two entries in the image when it is removed.
+(define drop-c (list 6 7))
+(image-save-incremental)
+(undefine 'drop-c)
+(image-save-incremental)
+(image-save)
+
+(fwrite-image (fopen "image.lbm" "w"))
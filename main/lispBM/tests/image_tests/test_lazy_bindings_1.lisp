@@ -0,0 +1,29 @@
+;; Lists and arrays are unflattened from the image on first lookup.
+;; Bindings that are set, or undefined, before they are looked up
+;; must not come back from the image.
+
+(define ls (list 1 2 (list 3 4) "apa"))
+(define arr (list-to-array (list 1 2.5 'bepa)))
+(define barr [1 2 3])
+(define num 42)
+(defun f (x) (+ x 1))
+(define set-me (list 1 2 3))
+(define drop-me (list 1 2 3))
+
+(defun main () {
+       (setq set-me 10)
+       (undefine 'drop-me)
+       (setix ls 0 100)
+       (if (and (eq ls (list 100 2 (list 3 4) "apa"))
+                (eq (ix arr 2) 'bepa)
+                (= (bufget-u8 barr 2) 3)
+                (= num 42)
+                (= (f 1) 2)
+                (= set-me 10)
+                (eq (trap drop-me) '(exit-error variable_not_bound)))
+           (print "SUCCESS")
+         (print "FAILURE"))
+       })
+
+(image-save)
+(fwrite-image (fopen "image.lbm" "w"))
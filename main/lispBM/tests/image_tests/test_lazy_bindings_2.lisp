@@ -0,0 +1,34 @@
+;; Values that are still in the image are not visible through env-get
+;; and move-to-flash copies the value rather than the reference to it.
+
+(define ls (list 1 2 (list 3 4) "apa"))
+(define arr (list-to-array (list 1 2.5 'bepa)))
+(define to-flash (list 5 6 7))
+
+(defun in-image (v)
+  (and (eq (type-of v) type-list)
+       (eq (type-of (car v)) type-symbol)
+       (eq (sym2str (car v)) "$image-binding")))
+
+(defun env-ok (i)
+  (cond ((= i 256) t)
+        ((any-in-image (env-get i)) nil)
+        (t (env-ok (+ i 1)))))
+
+(defun any-in-image (bucket)
+  (if (eq bucket nil) nil
+    (or (in-image (cdr (car bucket)))
+        (any-in-image (cdr bucket)))))
+
+(defun main () {
+       (move-to-flash to-flash)
+       (if (and (env-ok 0)
+                (eq ls (list 1 2 (list 3 4) "apa"))
+                (eq (ix arr 2) 'bepa)
+                (eq to-flash (list 5 6 7)))
+           (print "SUCCESS")
+         (print "FAILURE"))
+       })
+
+(image-save)
+(fwrite-image (fopen "image.lbm" "w"))
@@ -0,0 +1,22 @@
+;; Enough globals for the global environment to grow before the image
+;; is saved and again while it is restored.
+
+(defun name (i) (str2sym (str-join (list "glob" (to-str i)))))
+
+(loop ((i 0)) (< i 300)
+      (progn
+        (eval (list 'define (name i) (list 'list i)))
+        (setq i (+ i 1))))
+
+(defun all-bound (i)
+  (cond ((= i 300) t)
+        ((eq (eval (name i)) (list i)) (all-bound (+ i 1)))
+        (t nil)))
+
+(defun main ()
+  (if (and (all-bound 0) (eq glob299 '(299)))
+      (print "SUCCESS")
+      (print "FAILURE")))
+
+(image-save)
+(fwrite-image (fopen "image.lbm" "w"))
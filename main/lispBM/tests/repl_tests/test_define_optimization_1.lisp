@@ -0,0 +1,47 @@
+;; Definitions read with and without define optimization must compute
+;; the same results.
+
+(define my-unless (macro (c e) `(if ,c nil ,e)))
+(define twice (macro (x) `(+ ,x ,x)))
+
+(define f-plain (lambda (x) (my-unless (= x 0) (twice (* x (* 2 3.5))))))
+(define g-plain (lambda (x) (let ((twice (lambda (y) (* y 100)))) (twice x))))
+(define h-plain (lambda (x) (list '(+ 1 2) (+ 1 2) (shl 1 4) x)))
+(define m-plain (lambda (x) (match x ((+ 1 2) 'sum) (_ (bitwise-and 255 (+ 256 x))))))
+
+(set-define-optimization t)
+
+(define f-opt (lambda (x) (my-unless (= x 0) (twice (* x (* 2 3.5))))))
+(define g-opt (lambda (x) (let ((twice (lambda (y) (* y 100)))) (twice x))))
+(define h-opt (lambda (x) (list '(+ 1 2) (+ 1 2) (shl 1 4) x)))
+(define m-opt (lambda (x) (match x ((+ 1 2) 'sum) (_ (bitwise-and 255 (+ 256 x))))))
+
+(set-define-optimization nil)
+
+(define same (lambda (p o xs)
+  (if (eq xs nil) t
+    (and (eq (p (car xs)) (o (car xs)))
+         (same p o (cdr xs))))))
+
+(define xs (list 0 1 2 -3 10))
+
+(define r1 (same f-plain f-opt xs))
+(define r2 (same g-plain g-opt xs))
+(define r3 (same h-plain h-opt xs))
+(define r4 (and (eq (m-plain '(+ 1 2)) 'sum)
+                (eq (m-opt '(+ 1 2)) 'sum)
+                (same m-plain m-opt xs)))
+
+;; Macros are expanded and constants folded in the stored body.
+(define r5 (eq (ix f-opt 2) '(if (= x 0) nil (+ (* x 7.0) (* x 7.0)))))
+;; Local bindings shadow macros, quoted data is left alone.
+(define r6 (eq (ix g-opt 2) (ix g-plain 2)))
+(define r7 (eq (ix h-opt 2) '(list '(+ 1 2) 3 16 x)))
+
+;; The result is an ordinary value that survives flatten.
+(define f-copy (unflatten (flatten f-opt)))
+(define r8 (eq (f-copy 2) (f-plain 2)))
+
+(if (and r1 r2 r3 r4 r5 r6 r7 r8)
+    (print "SUCCESS")
+    (print "FAILURE"))
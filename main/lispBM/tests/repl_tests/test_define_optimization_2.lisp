@@ -0,0 +1,25 @@
+;; A macro that cannot be expanded at definition time is left as is,
+;; and a macro that expands into itself is expanded at run time.
+
+(define needs-local (macro (x) `(+ ,x ,local-offset)))
+(define repeat-while (macro (c b) `(if ,c (progn ,b (repeat-while ,c ,b)) nil)))
+
+(set-define-optimization t)
+
+(define f (lambda (x) (if (> x 0) (needs-local x) (car 1))))
+(define count-down (lambda (n) { (var acc 0) (repeat-while (> n 0) { (setq acc (+ acc n)) (setq n (- n 1)) }) acc }))
+(define g (lambda (x) (/ x 0)))
+
+(set-define-optimization nil)
+
+(define local-offset 10)
+
+(define r1 (= (f 1) 11))
+(define r2 (eq (trap (f 0)) '(exit-error type_error)))
+(define r3 (= (count-down 10) 55))
+(define r4 (eq (trap (g 1)) '(exit-error division_by_zero)))
+(define r5 (eq (car (ix (ix count-down 2) 2)) 'repeat-while))
+
+(if (and r1 r2 r3 r4 r5)
+    (print "SUCCESS")
+    (print "FAILURE"))
@@ -0,0 +1,28 @@
+
+(ext-stats-reset)
+
+(define r1 (eq (ext-stats 'str-join) '(str-join 0u32 0u64 0u32 (0u32))))
+
+(loopfor i 0 (< i 100) (+ i 1)
+         (str-join '("a" "b")))
+
+(define s (ext-stats 'str-join))
+(define hist (ix s 4))
+
+(define r2 (and (eq (ix s 0) 'str-join)
+                (= (ix s 1) 100)
+                (>= (ix s 2) (ix s 3))
+                (= (apply + hist) 100)))
+
+;; Every extension that was called is listed.
+(define r3 (and (assoc (ext-stats) 'str-join)
+                (not (assoc (ext-stats) 'str-split))))
+
+(define r4 (eq (trap (ext-stats 'no-such-extension)) '(exit-error type_error)))
+
+(ext-stats-reset)
+(define r5 (= (ix (ext-stats 'str-join) 1) 0))
+
+(if (and r1 r2 r3 r4 r5)
+    (print "SUCCESS")
+    (print "FAILURE"))
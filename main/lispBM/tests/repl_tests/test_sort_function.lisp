@@ -35,14 +35,17 @@
 (define sort_test12 (eq (trap (sort t '(1 2 3))) '(exit-error eval_error)))
 
 ; sort with invalid list arguments
-(define sort_test13 (eq (trap (sort < "not-list")) '(exit-error type_error)))
+; a string is a byte array and is sorted including its terminating zero
+(define sort_test13 (eq (sort < "cba") [0 97 98 99]))
 (define sort_test14 (eq (trap (sort < 42)) '(exit-error type_error)))
 (define sort_test15 (eq (trap (sort < 'symbol)) '(exit-error type_error)))
 (define sort_test16 (eq (trap (sort < t)) '(exit-error type_error)))
 
-; sort with arrays (should fail)
-(define sort_test17 (eq (trap (sort < [1 3 2])) '(exit-error type_error)))
-(define sort_test18 (eq (trap (sort < [| 1 3 2 |])) '(exit-error type_error)))
+; sort with arrays returns a sorted copy
+(define sort_arr [1 3 2])
+(define sort_larr [| 1 3 2 |])
+(define sort_test17 (and (eq (sort < sort_arr) [1 2 3]) (eq sort_arr [1 3 2])))
+(define sort_test18 (and (eq (sort < sort_larr) [| 1 2 3 |]) (eq sort_larr [| 1 3 2 |])))
 
 ; sort with mixed types (should work if comparator handles it)
 (define mixed_cmp (lambda (x y) (< (to-i x) (to-i y))))
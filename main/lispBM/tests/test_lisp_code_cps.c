@@ -33,6 +33,8 @@
 #include "extensions/runtime_extensions.h"
 #include "extensions/random_extensions.h"
 #include "extensions/set_extensions.h"
+#include "extensions/bytecode_extensions.h"
+#include "extensions/hashmap_extensions.h"
 #include "extensions/mutex_extensions.h"
 #include "extensions/lbm_dyn_lib.h"
 #include "lbm_channel.h"
@@ -299,6 +301,27 @@ LBM_EXTENSION(ext_event_array, args, argn) {
   return res;
 }
 
+// Hands a buffer of n bytes, filled with 0, 1, 2, ..., to the event
+// handler without flattening it.
+LBM_EXTENSION(ext_event_owned_array, args, argn) {
+  lbm_value res = ENC_SYM_EERROR;
+  if (argn == 2 && lbm_is_symbol(args[0]) && lbm_is_number(args[1])) {
+    lbm_uint n = lbm_dec_as_u32(args[1]);
+    uint8_t *buf = lbm_malloc(n);
+    if (!buf) return ENC_SYM_MERROR;
+    for (lbm_uint i = 0; i < n; i ++) {
+      buf[i] = (uint8_t)i;
+    }
+    if (lbm_event_array(args[0], buf, n)) {
+      res = ENC_SYM_TRUE;
+    } else {
+      lbm_free(buf);
+      res = ENC_SYM_NIL;
+    }
+  }
+  return res;
+}
+
 LBM_EXTENSION(ext_block, args, argn) {
   (void) args;
   (void) argn;
@@ -322,6 +345,26 @@ LBM_EXTENSION(ext_unblock, args, argn) {
   return res;
 }
 
+LBM_EXTENSION(ext_unblock_owned_array, args, argn) {
+  lbm_value res = ENC_SYM_EERROR;
+  if (argn == 2 && lbm_is_number(args[0]) && lbm_is_number(args[1])) {
+    lbm_cid c = lbm_dec_as_i32(args[0]);
+    lbm_uint n = lbm_dec_as_u32(args[1]);
+    uint8_t *buf = lbm_malloc(n);
+    if (!buf) return ENC_SYM_MERROR;
+    for (lbm_uint i = 0; i < n; i ++) {
+      buf[i] = (uint8_t)i;
+    }
+    if (lbm_unblock_ctx_array(c, buf, n)) {
+      res = ENC_SYM_TRUE;
+    } else {
+      lbm_free(buf);
+      res = ENC_SYM_NIL;
+    }
+  }
+  return res;
+}
+
 LBM_EXTENSION(ext_block_rmbr, args, argn) {
   (void) args;
   (void) argn;
@@ -438,6 +481,20 @@ LBM_EXTENSION(ext_flatten_depth, args, argn) {
   return res;
 }
 
+// Source string of a dynamic library definition, used to compare the
+// precompiled library against the source.
+LBM_EXTENSION(ext_dyn_lib_src, args, argn) {
+  lbm_value res = ENC_SYM_NIL;
+  const char *code;
+  if (argn == 1 && lbm_is_symbol(args[0]) &&
+      lbm_dyn_lib_find(lbm_get_name_by_symbol(lbm_dec_sym(args[0])), &code)) {
+    if (!lbm_share_array_const(&res, (char*)code, strlen(code) + 1)) {
+      return ENC_SYM_MERROR;
+    }
+  }
+  return res;
+}
+
 int main(int argc, char **argv) {
 
   int res = 0;
@@ -596,6 +653,8 @@ int main(int argc, char **argv) {
   lbm_random_extensions_init();
   lbm_mutex_extensions_init();
   lbm_set_extensions_init();
+  lbm_bytecode_extensions_init();
+  lbm_hashmap_extensions_init();
   lbm_dyn_lib_init();
 
   lbm_add_extension("ext-even", ext_even);
@@ -605,8 +664,10 @@ int main(int argc, char **argv) {
   lbm_add_extension("event-float", ext_event_float);
   lbm_add_extension("event-list-of-float", ext_event_list_of_float);
   lbm_add_extension("event-array", ext_event_array);
+  lbm_add_extension("event-owned-array", ext_event_owned_array);
   lbm_add_extension("block", ext_block);
   lbm_add_extension("unblock", ext_unblock);
+  lbm_add_extension("unblock-owned-array", ext_unblock_owned_array);
   lbm_add_extension("block-rmbr", ext_block_rmbr);
 
   lbm_add_extension("unblock-rmbr", ext_unblock_rmbr);
@@ -615,6 +676,7 @@ int main(int argc, char **argv) {
   lbm_add_extension("check", ext_check);
   lbm_add_extension("load-inc-i", ext_load_inc_i);
   lbm_add_extension("flatten-depth", ext_flatten_depth);
+  lbm_add_extension("dyn-lib-src", ext_dyn_lib_src);
 
   if (lbm_get_num_extensions() < lbm_get_max_extensions()) {
     printf("Extensions loaded successfully\n");
@@ -0,0 +1,14 @@
+
+
+(defun proc1 (pid)
+  (progn
+    (send pid (list 'got (block)))))
+
+
+(def id (spawn proc1 (self)))
+(sleep 0.1) ;; give proc1 time to start up and block
+(unblock-owned-array id 16)
+
+(check (recv
+        ((got (? arr)) (and (= (buflen arr) 16)
+                            (= (bufget-u8 arr 15) 15)))))
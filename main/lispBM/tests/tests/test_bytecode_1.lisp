@@ -0,0 +1,15 @@
+
+(defun fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))
+
+(define fib-i fib)
+
+(define fib (bytecode-compile fib))
+
+(defun cnt (x) (if (= x 0) 'done (cnt (- x 1))))
+
+(define cnt (bytecode-compile cnt))
+
+(check (and (bytecode-compiled? fib)
+            (not (bytecode-compiled? fib-i))
+            (= (fib 15) (fib-i 15))
+            (eq (cnt 100000) 'done)))
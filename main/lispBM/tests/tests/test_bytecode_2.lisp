@@ -0,0 +1,24 @@
+
+(defun sum (n)
+  (let ((s 0))
+    (progn
+      (loop ((i 0)) (< i n)
+            (progn
+              (setq s (+ s i))
+              (setq i (+ i 1))))
+      s)))
+
+(defun sign (x) (cond ((< x 0) 'neg) ((= x 0) 'zero) (t 'pos)))
+
+(defun small (x) (and (> x 0) (or (< x 5) 'big)))
+
+(define sum (bytecode-compile sum))
+(define sign (bytecode-compile sign))
+(define small (bytecode-compile small))
+
+(check (and (bytecode-compiled? sum)
+            (bytecode-compiled? sign)
+            (bytecode-compiled? small)
+            (= (sum 100) 4950)
+            (eq (map sign '(-1 0 1)) '(neg zero pos))
+            (eq (map small '(-1 3 7)) '(nil t big))))
@@ -0,0 +1,21 @@
+
+;; Lists, mixed number types and calls between compiled functions.
+
+(defun sum-list (l) (if (eq l nil) 0 (+ (car l) (sum-list (cdr l)))))
+
+(defun add-mixed (x) (+ x 1.5 2u32))
+
+(defun mk (a b) (list a b (cons a b) '(1 2) "str"))
+
+(define sum-list (bytecode-compile sum-list))
+(define add-mixed (bytecode-compile add-mixed))
+(define mk (bytecode-compile mk))
+
+(defun twice (x) (+ (add-mixed x) (add-mixed x)))
+(define twice (bytecode-compile twice))
+
+(check (and (bytecode-compiled? twice)
+            (= (sum-list (range 100)) 4950)
+            (= (add-mixed 1) 4.5)
+            (= (twice 1) 9.0)
+            (eq (mk 1 2) '(1 2 (1 . 2) (1 2) "str"))))
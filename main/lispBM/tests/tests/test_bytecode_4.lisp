@@ -0,0 +1,17 @@
+
+;; Closures outside the subset are returned unchanged and
+;; errors inside compiled code are reported as usual.
+
+(defun w (x) (sleep x))
+
+(defun mk-adder (x) (lambda (y) (+ x y)))
+
+(defun bad (x) (+ x 'a))
+
+(define bad (bytecode-compile bad))
+
+(check (and (not (bytecode-compiled? (bytecode-compile w)))
+            (not (bytecode-compiled? (bytecode-compile mk-adder)))
+            (eq (trap (bytecode-compile 1)) '(exit-error type_error))
+            (bytecode-compiled? bad)
+            (eq (trap (bad 1)) '(exit-error type_error))))
@@ -0,0 +1,34 @@
+
+;; Compiled code keeps working when a global it calls is redefined
+;; as a closure that is not compiled: the evaluator applies the call
+;; and the VM continues with its result.
+
+(defun g (x) (+ x 1))
+(define g (bytecode-compile g))
+
+(defun f (x) (* 2 (g x)))
+(define f (bytecode-compile f))
+
+(defun h (x) (progn (setq x (+ x 1)) (list x (g x))))
+(define h (bytecode-compile h))
+
+(define before (list (f 1) (h 1)))
+
+;; Not compiled, and cannot be.
+(defun g (x) ((lambda (y) (+ y 10)) x))
+
+(define after (list (f 1) (h 1) (bytecode-compiled? g)))
+
+(undefine 'g)
+
+;; A cond clause without an expression is an error in the evaluator,
+;; so it is not compiled.
+(defun c1 (x) (cond ((= x 0)) (t 1)))
+
+(check (and (bytecode-compiled? f)
+            (bytecode-compiled? h)
+            (eq before '(4 (2 3)))
+            (eq after '(22 (2 12) nil))
+            (eq (trap (f 1)) '(exit-error variable_not_bound))
+            (not (bytecode-compiled? (bytecode-compile c1)))
+            (eq (trap (c1 0)) '(exit-error eval_error))))
@@ -0,0 +1,77 @@
+
+;; Extension calls in compiled code, and compiled loops that yield to
+;; other threads.
+
+(defun parity (x) (if (ext-even x) 'even 'odd))
+(define parity (bytecode-compile parity))
+
+;; Allocates in every iteration and keeps at most 50 cells, so the VM
+;; has to collect garbage on small heaps.
+(defun build (n)
+  (let ((acc nil))
+    (progn
+      (loop ((i 0)) (< i n)
+            (progn
+              (setq acc (if (= (mod i 50) 0) nil (cons (ext-even i) acc)))
+              (setq i (+ i 1))))
+      (length acc))))
+(define build (bytecode-compile build))
+
+(define ticks 0)
+(define stop nil)
+
+(defun ticker ()
+  (if stop 'done
+    (progn (setq ticks (+ ticks 1))
+           (ticker))))
+
+;; Returns how often the ticker ran during the loop.
+(defun spin (n)
+  (let ((t0 ticks))
+    (progn
+      (loop ((i 0)) (< i n) (setq i (+ i 1)))
+      (- ticks t0))))
+(define spin (bytecode-compile spin))
+
+(defun fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))
+(define fib (bytecode-compile fib))
+
+;; g is redefined as a closure that is not compiled after h has been
+;; compiled. h calls it through the evaluator after ext-even.
+(defun g (x) (+ x 1))
+(define g (bytecode-compile g))
+(defun h (x) (if (ext-even x) (g x) 0))
+(define h (bytecode-compile h))
+(defun g (x) ((lambda (y) (+ y 10)) x))
+
+;; Deeper than the VM has frames for, so calls past the last frame
+;; are applied by the evaluator after ext-even has run.
+(defun deep (n) (if (= n 0) 0 (progn (ext-even n) (+ 1 (deep (- n 1))))))
+(define deep (bytecode-compile deep))
+
+;; The evaluator applies block, so the context blocks until unblock.
+(defun blk () (if (block) 'woke 'no))
+(define blk (bytecode-compile blk))
+
+(define r1 (and (bytecode-compiled? parity)
+                (bytecode-compiled? build)
+                (bytecode-compiled? spin)
+                (bytecode-compiled? fib)
+                (bytecode-compiled? h)
+                (bytecode-compiled? deep)
+                (bytecode-compiled? blk)))
+(define r2 (eq (list (parity 1) (parity 2)) '(odd even)))
+(define r3 (= (build 1000) 49))
+(define r4 (= (fib 15) 610))
+(define r5 (and (= (h 1) 0) (= (h 2) 12) (= (deep 100) 100)))
+
+(spawn ticker)
+(define r6 (> (spin 20000) 0))
+(setq stop t)
+
+(define blk-id (spawn (fn (pid) (send pid (blk))) (self)))
+(sleep 0.1)
+(unblock blk-id)
+(define r7 (eq (recv ((? x) x)) 'woke))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
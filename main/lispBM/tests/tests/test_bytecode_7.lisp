@@ -0,0 +1,38 @@
+
+;; Code arrays built by hand cannot move the VM stack outside of the
+;; frame, they fail with eval_error.
+
+(define consts (list-to-array '(nil)))
+
+;; Header (params slots depth) followed by the code, as a byte array.
+(defun mk-code (l)
+  (let ((b (bufcreate (length l))))
+    (progn
+      (loop ((i 0)) (< i (length l))
+            (progn (bufset-u8 b i (ix l i))
+                   (setq i (+ i 1))))
+      b)))
+
+(defun run (code)
+  (trap (bytecode-run code consts)))
+
+;; Header (0 0 1), 2001 nil and ret.
+(defun mk-nils ()
+  (let ((b (bufcreate 2005)))
+    (progn
+      (bufset-u8 b 2 1)
+      (loop ((i 3)) (< i 2004)
+            (progn (bufset-u8 b i 1)
+                   (setq i (+ i 1))))
+      (bufset-u8 b 2004 21)
+      b)))
+
+(check (and (eq (run (mk-nils)) '(exit-error eval_error))
+            ;; pop, add and ret on an empty stack
+            (eq (run (mk-code '(0 0 1 7 21))) '(exit-error eval_error))
+            (eq (run (mk-code '(0 0 1 1 13 21))) '(exit-error eval_error))
+            (eq (run (mk-code '(0 0 0 21))) '(exit-error eval_error))
+            ;; 5, ret
+            (eq (run (mk-code '(0 0 1 2 5 21))) '(exit-ok 5))
+            (eq (trap (bytecode-resume (list-to-array '(nil 1 1 2 3 4))))
+                '(exit-error type_error))))
@@ -0,0 +1,28 @@
+
+;; Enough globals to make the global environment grow from 32 to 128
+;; buckets, while still fitting in a 512 cell heap.
+
+(define n 150)
+
+(defun name (i) (str2sym (str-join (list "glob" (to-str i)))))
+
+(loop ((i 0)) (< i n)
+      (progn
+        (eval (list 'define (name i) i))
+        (setq i (+ i 1))))
+
+(defun all-bound (i)
+  (cond ((= i n) t)
+        ((= (eval (name i)) i) (all-bound (+ i 1)))
+        (t nil)))
+
+(define r1 (all-bound 0))
+
+(undefine (name 7))
+(setq glob8 800)
+
+(define r2 (eq (trap glob7) '(exit-error variable_not_bound)))
+(define r3 (= glob8 800))
+(define r4 (= glob149 149))
+
+(check (and r1 r2 r3 r4))
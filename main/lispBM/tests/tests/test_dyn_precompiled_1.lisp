@@ -0,0 +1,39 @@
+
+;; The precompiled dynamic library must bind the same values as
+;; reading and evaluating the source of each definition.
+;; defun, iota, zip, foldl and foldr are provided by the test loader
+;; and are not taken from the library.
+
+(define names '(defunret defmacro
+                loopfor loopwhile looprange loopforeach loopwhile-thd
+                str-merge zipwith filter
+                str-cmp-asc str-cmp-dsc second third abs
+                list-to-array array-to-list array?))
+
+;; Each definition is dropped again after the comparison, so that
+;; the test fits in a small heap. Later uses load it again.
+(define same-as-source
+  (lambda (name)
+    (let ((pre (eval name)))
+      (progn
+        (undefine name)
+        (eval nil (read (dyn-lib-src name)))
+        (let ((same (eq pre (eval name))))
+          (progn
+            (undefine name)
+            same))))))
+
+(define check-all
+  (lambda (ns)
+    (if (eq ns nil) t
+      (and (same-as-source (car ns)) (check-all (cdr ns))))))
+
+(define r1 (check-all names))
+
+(define r2 (and (eq (filter (lambda (x) (> x 1)) '(1 2 3)) '(2 3))
+                (eq (zipwith + '(1 2) '(3 4)) '(4 6))
+                (eq (str-merge "a" "b") "ab")
+                (= (abs -3) 3)
+                (eq (array-to-list (list-to-array '(1 2 3))) '(1 2 3))))
+
+(check (and r1 r2))
@@ -0,0 +1,27 @@
+
+(event-register-handler (self))
+
+(define mem-before (mem-num-free))
+
+(spawn (fn ()
+           (event-owned-array 'apa 100)))
+
+(define r1 (recv (((? x) . (? arr))
+                  (and (eq x 'apa)
+                       (= (buflen arr) 100)
+                       (= (bufget-u8 arr 0) 0)
+                       (= (bufget-u8 arr 99) 99)))))
+
+(spawn (fn ()
+           (event-owned-array nil 300)))
+
+(define r2 (recv ((? arr)
+                  (and (eq (type-of arr) type-array)
+                       (= (buflen arr) 300)
+                       (= (bufget-u8 arr 299) 43)))))
+
+(define arr nil)
+(gc)
+(define r3 (= (mem-num-free) mem-before))
+
+(check (and r1 r2 r3))
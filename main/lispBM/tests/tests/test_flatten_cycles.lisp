@@ -0,0 +1,25 @@
+
+;; Cycle along the cdr.
+(define c (list 1 2 3))
+(setcdr (cdr (cdr c)) c)
+(define uc (unflatten (flatten c t)))
+(define r1 (and (= (ix uc 0) 1) (= (ix uc 3) 1) (= (ix uc 5) 3)))
+(setcar uc 'x)
+(define r2 (eq (ix uc 3) 'x))
+
+;; Cycle through the car.
+(define a (list 'a 'b))
+(setcar (cdr a) a)
+(define ua (unflatten (flatten a t)))
+(define r3 (eq (car (car (cdr (car (cdr ua))))) 'a))
+
+;; Array containing itself.
+(define arr [| 1 2 |])
+(setix arr 0 arr)
+(define uarr (unflatten (flatten arr t)))
+(define r4 (= (ix (ix (ix uarr 0) 0) 1) 2))
+
+;; Cycles are still an error in the plain encoding.
+(define r5 (eq '(exit-error eval_error) (trap (flatten c))))
+
+(check (and r1 r2 r3 r4 r5))
@@ -0,0 +1,26 @@
+
+;; Only nesting counts towards the maximum flatten depth, so a list
+;; much longer than the limit still flattens.
+(flatten-depth 20)
+
+(define ls (unflatten (flatten (range 100))))
+
+(define r1 (and (= (length ls) 100) (= (ix ls 99) 99)))
+
+(define nested (list (range 100) (list-to-array (list 1.5 "apa")) (quote bepa)))
+
+(define r2 (eq (unflatten (flatten nested)) nested))
+
+(define c (list 1 2 3))
+(setcdr (cdr (cdr c)) c)
+
+(define r3 (eq '(exit-error eval_error) (trap (flatten c))))
+
+;; Nesting deeper than the limit does not.
+(define deep (lambda (n acc)
+  (if (= n 0) acc
+    (deep (- n 1) (list acc)))))
+
+(define r4 (eq '(exit-error eval_error) (trap (flatten (deep 30 1)))))
+
+(check (and r1 r2 r3 r4))
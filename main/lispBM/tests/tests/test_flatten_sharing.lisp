@@ -0,0 +1,25 @@
+
+;; Shared substructure is written once and is shared after unflatten.
+(define s '(1 2 3))
+(define d (list s s (list s)))
+
+(define u (unflatten (flatten d t)))
+
+(define r1 (and (eq u d)
+                (< (buflen (flatten d t)) (buflen (flatten d)))))
+
+(setcar (ix u 0) 10)
+(define r2 (eq u '((10 2 3) (10 2 3) ((10 2 3)))))
+
+;; Shared byte arrays.
+(define ba [1 2 3])
+(define ub (unflatten (flatten (list ba ba) t)))
+(bufset-u8 (ix ub 0) 0 9)
+(define r3 (= (bufget-u8 (ix ub 1) 0) 9))
+
+;; Values without sharing round trip as with the plain encoding.
+(define v (list 1 2.5 "hej" [| 1 2 |] 'apa))
+(define r4 (and (eq (unflatten (flatten v t)) v)
+                (= (buflen (flatten v t)) (buflen (flatten v)))))
+
+(check (and r1 r2 r3 r4))
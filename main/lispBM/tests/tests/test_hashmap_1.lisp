@@ -0,0 +1,25 @@
+(define m (mk-hashmap))
+
+(hashmap-set m 'a 1)
+(hashmap-set m 'b 2)
+(hashmap-set m "apa" 3)
+(hashmap-set m 10 4)
+(hashmap-set m 'a 5)
+
+(define r1 (eq (hashmap-get m 'a) 5))
+(define r2 (eq (hashmap-get m 'b) 2))
+(define r3 (eq (hashmap-get m "apa") 3))
+(define r4 (eq (hashmap-get m 10) 4))
+(define r5 (eq (hashmap-get m 'c) nil))
+(define r6 (eq (hashmap-get m 'c 'none) 'none))
+(define r7 (= (hash-count m) 4))
+
+(hash-del m 'b)
+
+(define r8 (and (not (hash-has m 'b))
+                (hash-has m 'a)
+                (= (hash-count m) 3)))
+
+(define r9 (= (length (hashmap-to-list m)) 3))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9))
@@ -0,0 +1,23 @@
+(define m (mk-hashmap 4))
+
+(define fill (lambda (n)
+  (if (= n 0) t
+    (progn (hashmap-set m n (* n n))
+           (fill (- n 1))))))
+
+(define all-there (lambda (n)
+  (if (= n 0) t
+    (if (eq (hashmap-get m n) (* n n))
+        (all-there (- n 1))
+      nil))))
+
+(fill 100)
+
+(gc)
+
+(define r1 (all-there 100))
+(define r2 (= (hash-count m) 100))
+(define r3 (= (length (hash-keys m)) 100))
+(define r4 (eq (hashmap-get m 101) nil))
+
+(check (and r1 r2 r3 r4))
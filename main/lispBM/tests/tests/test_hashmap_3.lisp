@@ -0,0 +1,27 @@
+(define m (mk-hashmap))
+
+(hashmap-set m 1u32 'u32)
+(hashmap-set m 2i32 'i32)
+(hashmap-set m 3u64 'u64)
+(hashmap-set m 4i64 'i64)
+(hashmap-set m 1.5 'float)
+(hashmap-set m 2.5f64 'double)
+(hashmap-set m 0.0 'zero)
+(hashmap-set m \#a 'char)
+
+(define r1 (and (eq (hashmap-get m 1u32) 'u32)
+                (eq (hashmap-get m 2i32) 'i32)
+                (eq (hashmap-get m 3u64) 'u64)
+                (eq (hashmap-get m 4i64) 'i64)
+                (eq (hashmap-get m 1.5) 'float)
+                (eq (hashmap-get m 2.5f64) 'double)
+                (eq (hashmap-get m \#a) 'char)))
+
+;; -0.0 is equal to 0.0 and must hash the same.
+(define r2 (eq (hashmap-get m -0.0) 'zero))
+
+;; Keys that cannot be hashed are a type error.
+(define r3 (eq (trap (hashmap-set m '(1 2) 'list)) '(exit-error type_error)))
+(define r4 (eq (trap (hashmap-get 'not-a-map 1)) '(exit-error type_error)))
+
+(check (and r1 r2 r3 r4))
@@ -0,0 +1,18 @@
+(define m (mk-hashmap))
+
+(hashmap-set m 'apa 1)
+(hashmap-set m 'bepa '(1 2 3))
+(hashmap-set m "cepa" [1 2 3])
+
+(define m2 (unflatten (flatten m)))
+
+(define r1 (eq (hashmap-get m2 'apa) 1))
+(define r2 (eq (hashmap-get m2 'bepa) '(1 2 3)))
+(define r3 (eq (hashmap-get m2 "cepa") [1 2 3]))
+(define r4 (= (hash-count m2) 3))
+
+;; The copy is independent of the original.
+(hashmap-set m2 'apa 2)
+(define r5 (eq (hashmap-get m 'apa) 1))
+
+(check (and r1 r2 r3 r4 r5))
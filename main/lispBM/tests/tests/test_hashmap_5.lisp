@@ -0,0 +1,25 @@
+
+;; Symbol keys are hashed by id, and ids can differ in the runtime that
+;; unflattens a map. Moving every bucket to the next index stands in for
+;; changed ids: unflatten puts each entry back where its key hashes to.
+
+(define keys '(a b c d e f))
+(define m (mk-hashmap 4))
+(loop ((ks keys)) ks
+      (progn (hashmap-set m (car ks) (car ks))
+             (setq ks (cdr ks))))
+
+(define bs (ix m 2))
+(define b0 (ix bs 0))
+(setix bs 0 (ix bs 1))
+(setix bs 1 (ix bs 2))
+(setix bs 2 (ix bs 3))
+(setix bs 3 b0)
+
+(define found (lambda (hm) (map (lambda (k) (eq (hashmap-get hm k) k)) keys)))
+
+(define m2 (unflatten (flatten m)))
+
+(check (and (not (eq (found m) '(t t t t t t)))
+            (eq (found m2) '(t t t t t t))
+            (= (hash-count m2) 6)))
@@ -0,0 +1,20 @@
+(define s (mk-hashset))
+
+(hashset-insert s 'a)
+(hashset-insert s 'b)
+(hashset-insert s 'a)
+(hashset-insert s 42)
+
+(define r1 (= (hash-count s) 3))
+(define r2 (and (hash-has s 'a) (hash-has s 'b) (hash-has s 42)))
+(define r3 (not (hash-has s 'c)))
+
+(hash-del s 'a)
+
+(define r4 (and (not (hash-has s 'a)) (= (hash-count s) 2)))
+(define r5 (= (length (hash-keys s)) 2))
+
+;; A set is not a map.
+(define r6 (eq (trap (hashmap-set s 'x 1)) '(exit-error type_error)))
+
+(check (and r1 r2 r3 r4 r5 r6))
@@ -0,0 +1,11 @@
+(define a (read "[1 2 300 0x10 5b 255 ; a comment\n 7\t8\n]"))
+
+(check (and (= (buflen a) 8)
+            (= (bufget-u8 a 2) 44)
+            (= (bufget-u8 a 3) 16)
+            (= (bufget-u8 a 4) 5)
+            (= (bufget-u8 a 5) 255)
+            (= (bufget-u8 a 6) 7)
+            (= (bufget-u8 a 7) 8)
+            (eq (read "[ 1 2 3 ]") [1 2 3])
+            (eq (read "[]") [])))
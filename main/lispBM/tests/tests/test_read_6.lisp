@@ -0,0 +1,9 @@
+;; 1.0000000596046448 is just above the midpoint between 1.0 and the
+;; next f32. Rounding it through f64 first would give 1.0.
+(check (and (eq 1.0000000596046448 1.0000001)
+            (not (eq 1.0000000596046448 1.0))
+            (eq 0.1 (to-float 0.1f64))
+            (eq 1.5e-3 (to-float 1.5e-3f64))
+            (eq 123456789.123 123456792.0)
+            (= 0.1f64 (/ 1.0f64 10.0f64))
+            (eq (read "1.25e2") 125.0)))
@@ -0,0 +1,9 @@
+
+(define a [| 5 3 9 1 1 8 2 7 6 4 0 12 11 10 |])
+
+(check (and (eq (sort < a) [| 0 1 1 2 3 4 5 6 7 8 9 10 11 12 |])
+            (eq (sort > a) [| 12 11 10 9 8 7 6 5 4 3 2 1 1 0 |])
+            (eq (sort (lambda (x y) (< x y)) a) (sort < a))
+            (eq a [| 5 3 9 1 1 8 2 7 6 4 0 12 11 10 |])
+            (eq (sort < [||]) [||])
+            (eq (sort < [| 1 |]) [| 1 |])))
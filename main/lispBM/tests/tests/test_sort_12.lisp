@@ -0,0 +1,14 @@
+
+;; Equal keys keep their order with a non-strict comparator, the same
+;; for lists and arrays and with insertion sorted runs and merges.
+(define ls '((1 . a) (0 . b) (1 . c) (0 . d) (2 . e) (1 . f) (0 . g)
+             (3 . h) (1 . i) (0 . j) (2 . k) (0 . l)))
+
+(define le (lambda (x y) (<= (car x) (car y))))
+(define lt (lambda (x y) (< (car x) (car y))))
+
+(check (and (eq (sort le (list-to-array ls)) (list-to-array (sort le ls)))
+            (eq (sort lt (list-to-array ls)) (list-to-array (sort lt ls)))
+            (eq (sort le ls) '((0 . b) (0 . d) (0 . g) (0 . j) (0 . l)
+                               (1 . a) (1 . c) (1 . f) (1 . i)
+                               (2 . e) (2 . k) (3 . h)))))
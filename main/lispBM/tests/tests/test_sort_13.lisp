@@ -0,0 +1,6 @@
+
+(define b [5 3 9 1 200 8 2 7 6 4 0 12 11 10])
+
+(check (and (eq (sort < b) [0 1 2 3 4 5 6 7 8 9 10 11 12 200])
+            (eq (sort (lambda (x y) (> x y)) b) [200 12 11 10 9 8 7 6 5 4 3 2 1 0])
+            (eq b [5 3 9 1 200 8 2 7 6 4 0 12 11 10])))
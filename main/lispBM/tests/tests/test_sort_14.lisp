@@ -0,0 +1,9 @@
+
+(define strs [| "pear" "apple" "fig" "banana" "cherry" "kiwi" "plum" "lime" "date" "grape" |])
+
+(check (and (eq (sort str-cmp-asc strs)
+                [| "apple" "banana" "cherry" "date" "fig" "grape" "kiwi" "lime" "pear" "plum" |])
+            (eq (sort str-cmp-dsc (array-to-list strs))
+                (reverse (array-to-list (sort str-cmp-asc strs))))
+            (eq (sort (lambda (x y) (< (str-cmp x y) 0)) strs) (sort str-cmp-asc strs))
+            (eq (merge str-cmp-asc '("a" "c") '("b" "d")) '("a" "b" "c" "d"))))
@@ -0,0 +1,22 @@
+
+;; The comparator allocates and collects garbage while an array sort
+;; is in progress.
+(define arr (list-to-array (map (lambda (i) (list (mod (* i 37) 101) i)) (range 60))))
+
+(defun cmp (x y)
+  {
+  (gc)
+  (<= (car (list (car x))) (car y))
+  })
+
+(define s (sort cmp arr))
+
+(define sorted-p
+  (lambda (i)
+    (if (>= i 59)
+        t
+      (and (<= (car (ix s i)) (car (ix s (+ i 1)))) (sorted-p (+ i 1))))))
+
+(check (and (sorted-p 0)
+            (eq (sort cmp arr) s)
+            (= (length (array-to-list s)) 60)))
@@ -0,0 +1,10 @@
+
+(define ls (map (lambda (i) (mod (* i 7919) 1000)) (range 100)))
+
+(check (and (eq (sort < ls) (sort (lambda (x y) (< x y)) ls))
+            (eq (sort >= ls) (sort (lambda (x y) (>= x y)) ls))
+            (eq (array-to-list (sort < (list-to-array ls))) (sort < ls))
+            (eq (merge < '(1 3 5 7) '(2 4 6)) '(1 2 3 4 5 6 7))
+            (eq (trap (sort < '(1 a 2))) '(exit-error type_error))
+            (eq (trap (sort < [| 1 a 2 |])) '(exit-error type_error))
+            (eq (sort < "cba") [0 97 98 99])))
@@ -0,0 +1,13 @@
+
+;; Whether a byte array is sorted depends only on its type. A zero
+;; byte is sorted like any other byte.
+
+(define buf (bufcreate 3))
+(bufset-u8 buf 0 99)
+(bufset-u8 buf 1 98)
+
+(check (and (eq (sort < [99 98 0]) [0 98 99])
+            (eq (sort < [99 98 1]) [1 98 99])
+            (eq (sort < buf) [0 98 99])
+            (eq (sort > "ab") [98 97 0])
+            (eq buf [99 98 0])))
@@ -0,0 +1,81 @@
+;; 100 threads, started with small stacks, recurse to depths between
+;; 0 and 19. Stacks grow on demand so the deep threads get large
+;; stacks while the shallow ones stay small. Five threads run at a
+;; time, a new one is spawned whenever one finishes. Each thread
+;; reports its stack size at its deepest point, and the total stack
+;; memory of all 100 threads is compared to fixed stacks large enough
+;; for the deepest thread.
+
+(set-mailbox-size 16)
+
+(define parent (self))
+(define init-size 64)
+(define num-threads 100)
+(define window 5)
+
+(define dive (lambda (n)
+  (if (= n 0)
+      { (send parent (list 'ready (stack-usage))) 0 }
+    (+ 1 (dive (- n 1))))))
+
+(define worker (lambda (d)
+  (send parent (list 'done d (dive d)))))
+
+(define depth (lambda (i) (mod (* i 37) 20)))
+
+(define num-ready 0)
+(define total-size 0)
+(define max-size 0)
+(define min-size 100000)
+(define sizes-ok t)
+(define results-ok t)
+
+(define spawn-next (lambda (i)
+  (if (< i num-threads)
+      { (spawn init-size worker (depth i)) (+ i 1) }
+    i)))
+
+(define spawn-n (lambda (i n)
+  (if (= n 0) i
+    (spawn-n (spawn-next i) (- n 1)))))
+
+;; Collect a ready and a done message for every thread, and spawn the
+;; next thread whenever one is done.
+(define collect (lambda (next left)
+  (if (= left 0) t
+    (recv ((ready ((? used) (? size)))
+           {
+           (setq num-ready (+ num-ready 1))
+           (setq total-size (+ total-size size))
+           (if (> size max-size) (setq max-size size))
+           (if (< size min-size) (setq min-size size))
+           (if (> used size) (setq sizes-ok nil))
+           (collect next left)
+           })
+          ((done (? d) (? r))
+           {
+           (if (not (= d r)) (setq results-ok nil))
+           (collect (spawn-next next) (- left 1))
+           })))))
+
+;; Wait for the last threads to terminate and release their memory.
+(define wait-free (lambda (n mem-before)
+  (if (and (> n 0) (< (mem-num-free) mem-before))
+      { (yield 1000) (wait-free (- n 1) mem-before) }
+    t)))
+
+(define mem-before (mem-num-free))
+
+(collect (spawn-n 0 window) num-threads)
+(wait-free 100 mem-before)
+
+(check (and (= num-ready num-threads)
+            results-ok
+            sizes-ok
+            ;; Shallow threads kept smaller stacks than deep ones.
+            (< min-size max-size)
+            ;; The total stack memory of all threads is below what fixed
+            ;; stacks large enough for the deepest thread would need.
+            (< total-size (* num-threads max-size))
+            ;; All memory is returned.
+            (>= (mem-num-free) mem-before)))
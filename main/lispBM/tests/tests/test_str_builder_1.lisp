@@ -0,0 +1,17 @@
+(define sb (mk-str-builder))
+
+(str-builder-append sb "abc" \#, 12 \#, -5 ",ok\n")
+
+(define r1 (= (str-builder-len sb) 13))
+
+(str-builder-append sb 'sym " " 1.5f32 " " '(1 2))
+
+(define r2 (eq (str-builder-freeze sb) "abc,12,-5,ok\nsym 1.500000f32 (1 2)"))
+
+(define r3 (= (str-builder-len sb) 0))
+
+(define r4 (eq (str-builder-freeze sb) ""))
+
+(define r5 (eq (str-builder-freeze (str-builder-append (mk-str-builder 2) "a" "bcdef" 0)) "abcdef0"))
+
+(check (and r1 r2 r3 r4 r5))
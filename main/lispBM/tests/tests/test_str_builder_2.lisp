@@ -0,0 +1,17 @@
+(define lines 200)
+
+(define build-join (lambda ()
+  (str-join (map (lambda (i) (to-str-delim "," i (* i 3) "ok")) (range lines)) "\n")))
+
+(define build-builder (lambda ()
+  (let ((sb (mk-str-builder)))
+    {
+    (loopfor i 0 (< i lines) (+ i 1)
+             {
+             (if (> i 0) (str-builder-append sb "\n"))
+             (str-builder-append sb i \#, (* i 3) ",ok")
+             })
+    (str-builder-freeze sb)
+    })))
+
+(check (eq (build-join) (build-builder)))
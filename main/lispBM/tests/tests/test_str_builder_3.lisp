@@ -0,0 +1,16 @@
+(define r1 (eq (trap (str-builder-append "abc" "d")) '(exit-error type_error)))
+
+(define r2 (eq (trap (str-builder-len [1 2 3])) '(exit-error type_error)))
+
+(define r3 (eq (trap (mk-str-builder 'a)) '(exit-error type_error)))
+
+;; A builder cannot be forged or changed as an array.
+(define r4 (eq (trap (str-builder-freeze (list-to-array (list 'str-builder 1000 "ab")))) '(exit-error type_error)))
+
+(define sb (str-builder-append (mk-str-builder) "ab"))
+
+(define r5 (eq (trap (setix sb 1 5000)) '(exit-error type_error)))
+
+(define r6 (eq (str-builder-freeze sb) "ab"))
+
+(check (and r1 r2 r3 r4 r5 r6))
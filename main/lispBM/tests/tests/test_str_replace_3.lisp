@@ -0,0 +1,21 @@
+(define r1 (eq (str-replace "a,b,,c," "," ", ") "a, b, , c, "))
+
+(define r2 (eq (str-replace "aaa" "a" "bb") "bbbbbb"))
+
+(define r3 (eq (str-replace "a--b--c" "--") "abc"))
+
+(define r4 (eq (str-replace "abc" "x" "yyy") "abc"))
+
+(define r5 (eq (str-replace "" "a" "b") ""))
+
+(define r6 (eq (str-replace "abc" "" "x") "abc"))
+
+(define r7 (eq (str-replace "one needle-in-a-haystack and another needle-in-a-haystack"
+                            "needle-in-a-haystack" "pin")
+               "one pin and another pin"))
+
+(define r8 (eq (str-replace "xxneedle-in-a-hayneedle-in-a-haystackx"
+                            "needle-in-a-haystack" "-")
+               "xxneedle-in-a-hay-x"))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
@@ -0,0 +1,13 @@
+(define r1 (eq (str-split "a b\tc\nd" " \t\n") (list "a" "b" "c" "d")))
+
+(define r2 (eq (str-split "" ",") (list "")))
+
+(define r3 (eq (str-split "abc" ",") (list "abc")))
+
+(define r4 (eq (str-split [97 255 98 0] [255 0]) (list "a" "b")))
+
+(define r5 (eq (str-split "abcdefg" 7) (list "abcdefg")))
+
+(define r6 (eq (str-split "abcdefg" 10) (list "abcdefg")))
+
+(check (and r1 r2 r3 r4 r5 r6))
@@ -0,0 +1,14 @@
+(define c (list 1 2 3))
+(setcdr (cdr (cdr c)) c)
+
+(define r1 (eq (trap (to-str c)) '(exit-error eval_error)))
+
+(define r2 (eq (trap (to-str-delim "," 1 c)) '(exit-error eval_error)))
+
+(define r3 (eq (trap (str-builder-append (mk-str-builder) c)) '(exit-error eval_error)))
+
+(setcdr (cdr (cdr c)) nil)
+
+(define r4 (eq (to-str c) "(1 2 3)"))
+
+(check (and r1 r2 r3 r4))
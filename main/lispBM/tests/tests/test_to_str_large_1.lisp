@@ -0,0 +1,7 @@
+;; to-str output is not limited in size.
+
+(define ls (map (lambda (i) (* i 100003)) (range 150)))
+(define s (to-str ls))
+
+(check (and (> (str-len s) 1000)
+            (eq (read s) ls)))
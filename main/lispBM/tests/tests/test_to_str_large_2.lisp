@@ -0,0 +1,14 @@
+;; Long strings with characters that need escaping and long byte arrays.
+
+(define part "a \"quoted\" part\\with\tescapes\n")
+(define strs (map (lambda (x) part) (range 20)))
+(define bytes (bufcreate 300))
+(loopfor i 0 (< i 300) (+ i 1) (bufset-u8 bytes i (mod (* i 7) 256)))
+
+(define s1 (to-str strs))
+(define s2 (to-str bytes))
+
+(check (and (eq (read s1) strs)
+            (eq (read s2) bytes)
+            (> (str-len s2) 900)
+            (eq (to-str-delim "," 1 strs bytes) (str-merge "1," s1 "," s2))))
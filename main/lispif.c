@@ -38,12 +38,14 @@
 #define GC_STACK_SIZE			160
 #define PRINT_STACK_SIZE		128
 #ifndef EXTENSION_STORAGE_SIZE
-#define EXTENSION_STORAGE_SIZE	350
+#define EXTENSION_STORAGE_SIZE	364
 #endif
 #ifndef USER_EXTENSION_STORAGE_SIZE
 #define USER_EXTENSION_STORAGE_SIZE 0
 #endif
 #define PROF_DATA_NUM			30
+#define PROF_FUN_NUM			32
+#define PROF_STACK_NUM			32
 #define EXT_LOAD_CALLBACK_LEN	10
 
 static size_t heap_size = 0;
@@ -78,6 +80,8 @@ static int restart_cnt = 0;
 static esp_timer_handle_t prof_timer;
 static void prof_timer_callback(void* arg);
 static lbm_prof_t prof_data[PROF_DATA_NUM];
+static lbm_prof_fun_t prof_fun_data[PROF_FUN_NUM];
+static lbm_prof_stack_t prof_stack_data[PROF_STACK_NUM];
 static volatile bool prof_running = false;
 const esp_timer_create_args_t periodic_timer_args = {
 		.callback = &prof_timer_callback,
@@ -163,6 +167,7 @@ static void print_ctx_info(eval_context_t *ctx, void *arg1, void *arg2) {
 
 	commands_printf_lisp("Stack SP: %u",  ctx->K.sp);
 	commands_printf_lisp("Stack SP max: %u", lbm_get_max_stack(&ctx->K));
+	commands_printf_lisp("Stack size: %u", ctx->K.size);
 	commands_printf_lisp("Result%s: %s", print_ret ? "" : " (trunc)", output);
 }
 
@@ -180,6 +185,32 @@ static void prof_timer_callback(void* arg) {
 	lbm_prof_sample();
 }
 
+static void prof_init(void) {
+	lbm_prof_init(prof_data, PROF_DATA_NUM);
+	lbm_prof_init_functions(prof_fun_data, PROF_FUN_NUM, prof_stack_data, PROF_STACK_NUM);
+	lbm_set_call_tracking(true);
+}
+
+static void prof_stop(void) {
+	prof_running = false;
+	esp_timer_stop(prof_timer);
+	lbm_set_call_tracking(false);
+}
+
+#ifdef LBM_EXTENSION_STATS
+static uint32_t ext_stats_clock_us(void) {
+	return (uint32_t)esp_timer_get_time();
+}
+#endif
+
+static const char *prof_sym_name(lbm_value sym) {
+	if (sym == ENC_SYM_NIL) {
+		return "<anon>";
+	}
+	const char *name = lbm_get_name_by_symbol(lbm_dec_sym(sym));
+	return name ? name : "<unknown>";
+}
+
 static bool pause_eval(uint32_t num_free, uint32_t timeout_ms) {
 	if (!lisp_thd_running) {
 		return false;
@@ -282,7 +313,7 @@ void lispif_process_cmd(unsigned char *data, unsigned int len,
 
 		if (pause_eval(0, 2000)) {
 			lbm_value *glob_env = lbm_get_global_env();
-			for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+			for (int i = 0; i < (int)lbm_get_global_env_num_roots(); i ++) {
 				if (ind > 300) {
 					break;
 				}
@@ -317,6 +348,62 @@ void lispif_process_cmd(unsigned char *data, unsigned int len,
 		mempools_free_packet_buffer(send_buffer_global);
 	} break;
 
+	case COMM_LISP_GET_PROF: {
+		// data[0]: 0 = samples per function, 1 = sampled call stacks
+		uint8_t what = len > 0 ? data[0] : 0;
+
+		uint8_t *send_buffer_global = mempools_get_packet_buffer();
+		int32_t ind = 0;
+
+		send_buffer_global[ind++] = packet_id;
+		send_buffer_global[ind++] = what;
+		send_buffer_global[ind++] = prof_running;
+		buffer_append_uint32(send_buffer_global, lbm_prof_get_num_samples(), &ind);
+		buffer_append_uint32(send_buffer_global, lbm_prof_get_num_system_samples(), &ind);
+		buffer_append_uint32(send_buffer_global, lbm_prof_get_num_sleep_samples(), &ind);
+
+		if (what == 0) {
+			// Entries: name, self samples, total samples
+			for (int i = 0; i < PROF_FUN_NUM; i++) {
+				if (prof_fun_data[i].total == 0) {
+					continue;
+				}
+				const char *name = prof_sym_name(prof_fun_data[i].sym);
+				if (ind + (int32_t)strlen(name) + 9 > 400) {
+					break;
+				}
+				strcpy((char*)(send_buffer_global + ind), name);
+				ind += strlen(name) + 1;
+				buffer_append_uint32(send_buffer_global, prof_fun_data[i].self, &ind);
+				buffer_append_uint32(send_buffer_global, prof_fun_data[i].total, &ind);
+			}
+		} else {
+			// Entries: samples, depth, names from the innermost frame
+			for (int i = 0; i < PROF_STACK_NUM; i++) {
+				if (prof_stack_data[i].count == 0) {
+					break;
+				}
+				int32_t size = 5;
+				for (lbm_uint j = 0; j < prof_stack_data[i].depth; j++) {
+					size += strlen(prof_sym_name(prof_stack_data[i].frames[j])) + 1;
+				}
+				if (ind + size > 400) {
+					break;
+				}
+				buffer_append_uint32(send_buffer_global, prof_stack_data[i].count, &ind);
+				send_buffer_global[ind++] = prof_stack_data[i].depth;
+				for (lbm_uint j = 0; j < prof_stack_data[i].depth; j++) {
+					const char *name = prof_sym_name(prof_stack_data[i].frames[j]);
+					strcpy((char*)(send_buffer_global + ind), name);
+					ind += strlen(name) + 1;
+				}
+			}
+		}
+
+		reply_func(send_buffer_global, ind);
+		mempools_free_packet_buffer(send_buffer_global);
+	} break;
+
 	case COMM_LISP_REPL_CMD: {
 		if (UTILS_AGE_S(repl_time) <= 0.5) {
 			return;
@@ -349,6 +436,14 @@ void lispif_process_cmd(unsigned char *data, unsigned int len,
 				commands_printf_lisp(
 						":prof report\n"
 						"  Print profiler report");
+				commands_printf_lisp(
+						":prof flame\n"
+						"  Print sampled call stacks in folded format for flame graphs");
+#ifdef LBM_EXTENSION_STATS
+				commands_printf_lisp(
+						":extstats [reset]\n"
+						"  Print or clear call counts and times of extensions");
+#endif
 				commands_printf_lisp(
 						":env\n"
 						"  Print current environment and variables");
@@ -414,10 +509,10 @@ void lispif_process_cmd(unsigned char *data, unsigned int len,
 				commands_printf_lisp("Num sectors erased: %d\n", stats.erased_sector_num);
 			} else if (strncmp(str, ":prof start", 11) == 0) {
 				if (prof_running) {
-					lbm_prof_init(prof_data, PROF_DATA_NUM);
+					prof_init();
 					commands_printf_lisp("Profiler restarted\n");
 				} else {
-					lbm_prof_init(prof_data, PROF_DATA_NUM);
+					prof_init();
 					prof_running = true;
 					esp_timer_create(&periodic_timer_args, &prof_timer);
 					// Use a period that isn't a multiple if the eval thread periods
@@ -426,8 +521,7 @@ void lispif_process_cmd(unsigned char *data, unsigned int len,
 				}
 			} else if (strncmp(str, ":prof stop", 10) == 0) {
 				if (prof_running) {
-					prof_running = false;
-					esp_timer_stop(prof_timer);
+					prof_stop();
 				}
 				commands_printf_lisp("Profiler stopped. Issue command ':prof report' for statistics\n");
 			} else if (strncmp(str, ":prof report", 12) == 0) {
@@ -451,17 +545,104 @@ void lispif_process_cmd(unsigned char *data, unsigned int len,
 				commands_printf_lisp("System:\t%u\t%f%%\n", num_system, (double)(100.0 * ((float)num_system / (float)tot_samples)));
 				commands_printf_lisp("Sleep:\t%u\t%f%%\n", num_sleep, (double)(100.0 * ((float)num_sleep / (float)tot_samples)));
 				commands_printf_lisp("Total:\t%u samples\n", tot_samples);
+
+				if (tot_samples > 0) {
+					bool printed[PROF_FUN_NUM] = {false};
+					commands_printf_lisp("Function\tSelf\t%%Self\tTotal\t%%Total");
+					for (int n = 0; n < PROF_FUN_NUM; n++) {
+						int best = -1;
+						for (int i = 0; i < PROF_FUN_NUM; i++) {
+							if (prof_fun_data[i].total == 0 || printed[i]) {
+								continue;
+							}
+							if (best < 0 || prof_fun_data[i].self > prof_fun_data[best].self) {
+								best = i;
+							}
+						}
+						if (best < 0) {
+							break;
+						}
+						printed[best] = true;
+						commands_printf_lisp("%s\t%u\t%.3f\t%u\t%.3f",
+								prof_sym_name(prof_fun_data[best].sym),
+								prof_fun_data[best].self,
+								(double)(100.0 * ((float)prof_fun_data[best].self) / (float)tot_samples),
+								prof_fun_data[best].total,
+								(double)(100.0 * ((float)prof_fun_data[best].total) / (float)tot_samples));
+					}
+				}
+			} else if (strncmp(str, ":prof flame", 11) == 0) {
+				char line[128];
+				for (int i = 0; i < PROF_STACK_NUM; i++) {
+					if (prof_stack_data[i].count == 0) {
+						break;
+					}
+					size_t pos = 0;
+					line[0] = '\0';
+					for (lbm_uint j = prof_stack_data[i].depth; j > 0 && pos < sizeof(line); j--) {
+						int n = snprintf(line + pos, sizeof(line) - pos, "%s%s",
+								prof_sym_name(prof_stack_data[i].frames[j - 1]),
+								j > 1 ? ";" : "");
+						if (n < 0) {
+							break;
+						}
+						pos += (size_t)n;
+					}
+					commands_printf_lisp("%s %u", line, prof_stack_data[i].count);
+				}
+#ifdef LBM_EXTENSION_STATS
+			} else if (strncmp(str, ":extstats reset", 15) == 0) {
+				lbm_reset_extension_stats();
+				commands_printf_lisp("Extension statistics cleared\n");
+			} else if (strncmp(str, ":extstats", 9) == 0) {
+				commands_printf_lisp("Extension\tCalls\tTotal\tMax\tMean\tHistogram (us, log2 buckets)");
+				for (lbm_uint i = 0; i < lbm_get_num_extensions(); i++) {
+					lbm_extension_stats_t *s = lbm_get_extension_stats(i);
+					if (s->calls == 0) {
+						continue;
+					}
+					char hist[128];
+					size_t pos = 0;
+					hist[0] = '\0';
+					int last = LBM_EXTENSION_STATS_BUCKETS - 1;
+					while (last > 0 && s->hist[last] == 0) {
+						last--;
+					}
+					for (int b = 0; b <= last && pos < sizeof(hist); b++) {
+						int n = snprintf(hist + pos, sizeof(hist) - pos, "%s%u", b ? " " : "", (unsigned int)s->hist[b]);
+						if (n < 0) {
+							break;
+						}
+						pos += (size_t)n;
+					}
+					commands_printf_lisp("%s\t%u\t%llu\t%u\t%.1f\t%s",
+							extension_table[i].name,
+							(unsigned int)s->calls,
+							(unsigned long long)s->total_time,
+							(unsigned int)s->max_time,
+							(double)s->total_time / (double)s->calls,
+							hist);
+				}
+#endif
 			} else if (strncmp(str, ":env", 4) == 0) {
 				if (pause_eval(0, 1000)) {
 					lbm_value *glob_env = lbm_get_global_env();
 					char output[128];
-					for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
+					for (int i = 0; i < (int)lbm_get_global_env_num_roots(); i ++) {
+						lbm_global_env_unflatten_bucket(i);
 						lbm_value curr = glob_env[i];
 						while (lbm_type_of(curr) == LBM_TYPE_CONS) {
-							lbm_print_value(output, sizeof(output), lbm_car(curr));
+							lbm_value binding = lbm_car(curr);
 							curr = lbm_cdr(curr);
 
-							commands_printf_lisp("  %s", output);
+							if (lbm_image_is_binding(lbm_cdr(binding))) {
+								// No room on the heap for the value
+								lbm_print_value(output, sizeof(output), lbm_car(binding));
+								commands_printf_lisp("  (%s . (in image))", output);
+							} else {
+								lbm_print_value(output, sizeof(output), binding);
+								commands_printf_lisp("  %s", output);
+							}
 						}
 					}
 				}
@@ -766,8 +947,7 @@ bool lispif_restart(bool print, bool load_code, bool load_imports) {
 	string_tok_valid = false;
 
 	if (prof_running) {
-		prof_running = false;
-		esp_timer_stop(prof_timer);
+		prof_stop();
 	}
 
 	char *code_data = (char*)flash_helper_code_data_ptr(CODE_IND_LISP);
@@ -809,6 +989,9 @@ bool lispif_restart(bool print, bool load_code, bool load_imports) {
 			lbm_set_usleep_callback(sleep_callback);
 			lbm_set_printf_callback(commands_printf_lisp);
 			lbm_set_ctx_done_callback(done_callback);
+#ifdef LBM_EXTENSION_STATS
+			lbm_set_extension_stats_clock(ext_stats_clock_us);
+#endif
 
 			lbm_image_init((uint32_t*)image_ptr, image_len, image_write);
 
@@ -885,14 +1068,26 @@ bool lispif_restart(bool print, bool load_code, bool load_imports) {
 						int32_t offset = buffer_get_int32((uint8_t*)code_data, &ind);
 						int32_t len = buffer_get_int32((uint8_t*)code_data, &ind);
 
+						// Leave bindings that already share this data alone so
+						// they are not marked dirty and saved to the image again.
+						lbm_uint sym;
 						lbm_value val;
+						if (lbm_get_symbol_by_name(name, &sym) &&
+								lbm_global_env_lookup(&val, lbm_enc_sym(sym))) {
+							lbm_array_header_t *arr = lbm_dec_array_r(val);
+							if (arr && arr->data == (lbm_uint*)(code_data + offset) &&
+									arr->size == (lbm_uint)len) {
+								continue;
+							}
+						}
+
 						if (lbm_share_array_const(&val, code_data + offset, len)) {
 							lbm_define(name, val);
 						}
 					}
 				}
 
-				lbm_image_save_global_env();
+				lbm_image_save_global_env_incremental();
 			}
 		}
 
@@ -36,6 +36,8 @@
 #include "extensions/mutex_extensions.h"
 #include "extensions/lbm_dyn_lib.h"
 #include "extensions/ttf_extensions.h"
+#include "extensions/bytecode_extensions.h"
+#include "extensions/hashmap_extensions.h"
 #include "lispif_disp_extensions.h"
 #include "lispif_wifi_extensions.h"
 #include "lispif_ble_extensions.h"
@@ -89,6 +91,7 @@
 #include "sdmmc_cmd.h"
 #include "esp_vfs.h"
 #include "lowzip.h"
+#include "lowdeflate.h"
 #include "aes/esp_aes.h"
 
 #include <math.h>
@@ -360,13 +363,12 @@ static bool compare_symbol(lbm_uint sym, lbm_uint *comp) {
 	return *comp == sym;
 }
 
-static bool start_flatten_with_gc(lbm_flat_value_t *v, size_t buffer_size) {
+// Request a GC and wait for it to run, for at most a few ticks. The
+// evaluator task cannot wait for its own GC, so there this returns false
+// right away.
+static bool wait_for_gc(void) {
 	if (lispif_is_eval_task()) {
-		return lbm_start_flatten(v, buffer_size);
-	}
-
-	if (lbm_start_flatten(v, buffer_size)) {
-		return true;
+		return false;
 	}
 
 	int timeout = 3;
@@ -378,7 +380,26 @@ static bool start_flatten_with_gc(lbm_flat_value_t *v, size_t buffer_size) {
 		timeout--;
 	}
 
-	return lbm_start_flatten(v, buffer_size);
+	return true;
+}
+
+static bool start_flatten_with_gc(lbm_flat_value_t *v, size_t buffer_size) {
+	if (lbm_start_flatten(v, buffer_size)) {
+		return true;
+	}
+
+	return wait_for_gc() && lbm_start_flatten(v, buffer_size);
+}
+
+// Allocate a buffer to be lifted into a byte array by the evaluator, e.g.
+// for lbm_event_array or lbm_unblock_ctx_array.
+static uint8_t *malloc_reserve_with_gc(size_t size) {
+	uint8_t *buf = lbm_malloc_reserve(size);
+	if (!buf && wait_for_gc()) {
+		buf = lbm_malloc_reserve(size);
+	}
+
+	return buf;
 }
 
 static bool is_symbol_true_false(lbm_value v) {
@@ -1176,8 +1197,30 @@ static lbm_value ext_sysinfo(lbm_value *args, lbm_uint argn) {
 	return res;
 }
 
+typedef struct {
+	lbm_cid id;
+	uint8_t can_id;
+	unsigned int len;
+	uint8_t data[];
+} can_cmd_win_args;
+
+static void can_cmd_win_task(void *arg) {
+	int restart_cnt = lispif_get_restart_cnt();
+	can_cmd_win_args *a = (can_cmd_win_args*)arg;
+
+	bool res = comm_can_send_buffer_win(a->can_id, a->data, a->len, 2);
+
+	if (restart_cnt == lispif_get_restart_cnt()) {
+		lbm_cid id = a->id;
+		lbm_free(a);
+		lbm_unblock_ctx_unboxed(id, res ? ENC_SYM_TRUE : ENC_SYM_NIL);
+	}
+
+	vTaskDelete(NULL);
+}
+
 static lbm_value ext_can_cmd(lbm_value *args, lbm_uint argn) {
-	LBM_CHECK_ARGN(2);
+	LBM_CHECK_ARGN_RANGE(2, 3);
 
 	if (!lbm_is_number(args[0])) {
 		lbm_set_error_reason((char*)lbm_error_str_incorrect_arg);
@@ -1201,6 +1244,29 @@ static lbm_value ext_can_cmd(lbm_value *args, lbm_uint argn) {
 		return ENC_SYM_EERROR;
 	}
 
+	if (argn >= 3 && lbm_is_symbol_true(args[2])) {
+		// The windowed send waits for acks, so it runs in its own task with
+		// its own copy of the data while the context is blocked.
+		can_cmd_win_args *a = lbm_malloc(sizeof(can_cmd_win_args) + array->size + 1);
+		if (!a) {
+			return ENC_SYM_MERROR;
+		}
+
+		a->id = lbm_get_current_cid();
+		a->can_id = id;
+		a->len = array->size + 1;
+		a->data[0] = COMM_LISP_REPL_CMD;
+		memcpy(a->data + 1, array->data, array->size);
+
+		if (xTaskCreatePinnedToCore(can_cmd_win_task, "CAN Cmd", 2048, a, 7, NULL, tskNO_AFFINITY) != pdPASS) {
+			lbm_free(a);
+			return ENC_SYM_MERROR;
+		}
+
+		lbm_block_ctx_from_extension();
+		return ENC_SYM_TRUE;
+	}
+
 	uint8_t *send_buf = mempools_get_lbm_packet_buffer();
 	send_buf[0] = COMM_LISP_REPL_CMD;
 	memcpy(send_buf + 1, array->data, array->size);
@@ -1980,6 +2046,7 @@ lbm_value ext_lbm_set_gc_stack_size(lbm_value *args, lbm_uint argn) {
 				lbm_free(lbm_heap_state.gc_stack.data);
 				lbm_heap_state.gc_stack.data = new_stack;
 				lbm_heap_state.gc_stack.size = n;
+				lbm_heap_state.gc_stack.max_size = n;
 				lbm_heap_state.gc_stack.sp = 0;
 				return ENC_SYM_TRUE;
 			}
@@ -3038,8 +3105,12 @@ static lbm_value ext_buf_resize(lbm_value *args, lbm_uint argn) {
 
 // Logging
 
+// (log-start can-id field-num rate-hz append-time append-gnss optBinary)
 static lbm_value ext_log_start(lbm_value *args, lbm_uint argn) {
-	LBM_CHECK_ARGN(5);
+	if (argn != 5 && argn != 6) {
+		lbm_set_error_reason((char*)lbm_error_str_num_args);
+		return ENC_SYM_EERROR;
+	}
 
 	if (!lbm_is_number(args[0]) ||
 			!lbm_is_number(args[1]) ||
@@ -3049,13 +3120,22 @@ static lbm_value ext_log_start(lbm_value *args, lbm_uint argn) {
 		return ENC_SYM_EERROR;
 	}
 
+	bool binary = false;
+	if (argn == 6) {
+		if (!is_symbol_true_false(args[5])) {
+			return ENC_SYM_EERROR;
+		}
+		binary = lbm_is_symbol_true(args[5]);
+	}
+
 	log_comm_start(
 			lbm_dec_as_i32(args[0]),
 			lbm_dec_as_i32(args[1]),
 			lbm_dec_as_float(args[2]),
 			lbm_is_symbol_true(args[3]),
 			lbm_is_symbol_true(args[4]),
-			lbm_is_symbol_true(args[4]));
+			lbm_is_symbol_true(args[4]),
+			binary);
 
 	return ENC_SYM_TRUE;
 }
@@ -3211,6 +3291,60 @@ static lbm_value ext_log_send_f64(lbm_value *args, lbm_uint argn) {
 	return log_send_fxx(true, args, argn);
 }
 
+// (log-send-packed can-id field-start values optF16Scale)
+// values is a list where nil entries are left out of the record.
+static lbm_value ext_log_send_packed(lbm_value *args, lbm_uint argn) {
+	if (argn != 3 && argn != 4) {
+		lbm_set_error_reason((char*)lbm_error_str_num_args);
+		return ENC_SYM_EERROR;
+	}
+
+	if (!lbm_is_number(args[0]) || !lbm_is_number(args[1]) || !lbm_is_list(args[2])) {
+		return ENC_SYM_TERROR;
+	}
+
+	float f16_scale = 0.0;
+	if (argn == 4) {
+		if (!lbm_is_number(args[3])) {
+			return ENC_SYM_TERROR;
+		}
+		f16_scale = lbm_dec_as_float(args[3]);
+	}
+
+	float values[LOG_PACKED_MAX_FIELDS];
+	bool present[LOG_PACKED_MAX_FIELDS];
+	int num = 0;
+
+	lbm_value curr = args[2];
+	while (lbm_is_cons(curr)) {
+		if (num >= LOG_PACKED_MAX_FIELDS) {
+			return ENC_SYM_EERROR;
+		}
+
+		lbm_value val = lbm_car(curr);
+		if (lbm_is_number(val)) {
+			values[num] = lbm_dec_as_float(val);
+			present[num] = true;
+		} else if (lbm_is_symbol_nil(val)) {
+			values[num] = 0.0;
+			present[num] = false;
+		} else {
+			return ENC_SYM_TERROR;
+		}
+
+		num++;
+		curr = lbm_cdr(curr);
+	}
+
+	if (num == 0) {
+		return ENC_SYM_EERROR;
+	}
+
+	log_comm_send_packed(lbm_dec_as_i32(args[0]), lbm_dec_as_i32(args[1]), values, present, num, f16_scale);
+
+	return ENC_SYM_TRUE;
+}
+
 // GNSS
 
 static lbm_value ext_gnss_lat_lon(lbm_value *args, lbm_uint argn) {
@@ -5871,6 +6005,273 @@ static lbm_value ext_zip_ls(lbm_value *args, lbm_uint argn) {
 	return r;
 }
 
+typedef struct {
+	lbm_cid id;
+	lowdeflate_state *st;
+	FILE *f_in;
+	const unsigned char *buf_in;
+	unsigned int len_in;
+	FILE *f_out;
+	unsigned char *buf_out;
+	unsigned int buf_out_size;
+	unsigned int buf_out_len;
+	bool write_error;
+	bool is_zip;
+	char name[256];
+	unsigned char chunk[512];
+} deflate_args;
+
+static void deflate_write(void *udata, const unsigned char *data, unsigned int len) {
+	deflate_args *a = (deflate_args*)udata;
+
+	if (a->f_out) {
+		if (fwrite(data, 1, len, a->f_out) != len) {
+			a->write_error = true;
+		}
+	} else if ((a->buf_out_len + len) <= a->buf_out_size) {
+		memcpy(a->buf_out + a->buf_out_len, data, len);
+		a->buf_out_len += len;
+	} else {
+		a->write_error = true;
+	}
+}
+
+// Compress the input in chunks and wrap it in a single entry zip archive or a
+// gzip member. The zip local header is written with zero CRC and sizes first
+// and rewritten at the end, so file outputs must be seekable.
+static bool deflate_run(deflate_args *a) {
+	unsigned char hdr[LOWDEFLATE_ZIP_CDIRFILE_LENGTH + sizeof(a->name)];
+	unsigned int start = a->f_out ? (unsigned int)ftell(a->f_out) : 0;
+	unsigned int hdr_len;
+
+	if (a->is_zip) {
+		hdr_len = lowdeflate_zip_local_header(hdr, a->name, NULL);
+	} else {
+		hdr_len = lowdeflate_gzip_header(hdr);
+	}
+	deflate_write(a, hdr, hdr_len);
+
+	lowdeflate_init(a->st);
+	if (a->st->have_error) {
+		return false;
+	}
+
+	if (a->f_in) {
+		for (;;) {
+			size_t got = fread(a->chunk, 1, sizeof(a->chunk), a->f_in);
+			if (got == 0) {
+				break;
+			}
+			lowdeflate_write(a->st, a->chunk, got);
+		}
+	} else {
+		for (unsigned int pos = 0;pos < a->len_in;pos += sizeof(a->chunk)) {
+			unsigned int len = a->len_in - pos;
+			if (len > sizeof(a->chunk)) {
+				len = sizeof(a->chunk);
+			}
+			lowdeflate_write(a->st, a->buf_in + pos, len);
+		}
+	}
+
+	lowdeflate_finish(a->st);
+
+	if (a->is_zip) {
+		unsigned int cdir_offset = start + hdr_len + a->st->total_out;
+		unsigned int cdir_len = lowdeflate_zip_central_header(hdr, a->name, a->st, start);
+		deflate_write(a, hdr, cdir_len);
+		deflate_write(a, hdr, lowdeflate_zip_end(hdr, 1, cdir_len, cdir_offset));
+
+		lowdeflate_zip_local_header(hdr, a->name, a->st);
+		if (a->f_out) {
+			if (fseek(a->f_out, start, SEEK_SET) != 0 ||
+					fwrite(hdr, 1, hdr_len, a->f_out) != hdr_len ||
+					fseek(a->f_out, 0, SEEK_END) != 0) {
+				a->write_error = true;
+			}
+		} else if (a->buf_out_size >= hdr_len) {
+			memcpy(a->buf_out, hdr, hdr_len);
+		}
+	} else {
+		deflate_write(a, hdr, lowdeflate_gzip_trailer(a->st, hdr));
+	}
+
+	return !a->write_error;
+}
+
+static void deflate_free(deflate_args *a) {
+	if (a->st) {
+		lbm_free(a->st->work);
+	}
+	lbm_free(a->st);
+	lbm_free(a->buf_out);
+	lbm_free(a);
+}
+
+static void deflate_task(void *arg) {
+	deflate_args *a = (deflate_args*)arg;
+
+	// Use restart counter to tell if LBM has been restarted while this thread
+	// was running.
+	int restart_cnt = lispif_get_restart_cnt();
+
+	bool ok = deflate_run(a);
+	fsync(fileno(a->f_out));
+
+	if (restart_cnt == lispif_get_restart_cnt()) {
+		lbm_cid id = a->id;
+		deflate_free(a);
+		lbm_unblock_ctx_unboxed(id, ok ? ENC_SYM_TRUE : ENC_SYM_NIL);
+	}
+
+	vTaskDelete(NULL);
+}
+
+// Shared by zip and gzip. The optional arguments are optOutputFile and
+// optWindowSize, where a nil output file returns the result as a byte array.
+static lbm_value deflate_common(lbm_value input, lbm_value *opt, lbm_uint optn, const char *name) {
+	FILE *f_in = NULL;
+	lbm_array_header_t *arr_in = NULL;
+	if (lbm_is_number(input)) {
+		f_in = file_from_arg(input);
+		if (!f_in) {
+			lbm_set_error_reason((char*)str_f_not_open);
+			return ENC_SYM_EERROR;
+		}
+	} else if (lbm_is_array_r(input)) {
+		arr_in = (lbm_array_header_t *)lbm_car(input);
+	} else {
+		return ENC_SYM_TERROR;
+	}
+
+	FILE *f_out = NULL;
+	if (optn >= 1 && !lbm_is_symbol_nil(opt[0])) {
+		if (!lbm_is_number(opt[0])) {
+			return ENC_SYM_TERROR;
+		}
+		f_out = file_from_arg(opt[0]);
+		if (!f_out) {
+			lbm_set_error_reason((char*)str_f_not_open);
+			return ENC_SYM_EERROR;
+		}
+	}
+
+	unsigned int window_bits = LOWDEFLATE_WINDOW_BITS_DEFAULT;
+	if (optn >= 2) {
+		if (!lbm_is_number(opt[1])) {
+			return ENC_SYM_TERROR;
+		}
+		unsigned int window = lbm_dec_as_u32(opt[1]);
+		for (window_bits = LOWDEFLATE_WINDOW_BITS_MIN;window_bits < LOWDEFLATE_WINDOW_BITS_MAX;window_bits++) {
+			if ((1U << window_bits) >= window) {
+				break;
+			}
+		}
+	}
+
+	unsigned int len_in = 0;
+	if (f_in) {
+		fseek(f_in, 0, SEEK_END);
+		len_in = ftell(f_in);
+		fseek(f_in, 0, SEEK_SET);
+	} else {
+		len_in = arr_in->size;
+	}
+
+	deflate_args *a = lbm_malloc(sizeof(deflate_args));
+	if (!a) {
+		return ENC_SYM_MERROR;
+	}
+	memset(a, 0, sizeof(deflate_args));
+
+	a->st = lbm_malloc(sizeof(lowdeflate_state));
+	if (!a->st) {
+		deflate_free(a);
+		return ENC_SYM_MERROR;
+	}
+	memset(a->st, 0, sizeof(lowdeflate_state));
+
+	a->st->work = lbm_malloc(LOWDEFLATE_WORK_SIZE(window_bits));
+	if (!a->st->work) {
+		deflate_free(a);
+		return ENC_SYM_MERROR;
+	}
+
+	a->st->udata = a;
+	a->st->write_callback = deflate_write;
+	a->st->window_bits = window_bits;
+	a->st->dynamic_huffman = 1;
+
+	a->f_in = f_in;
+	a->buf_in = arr_in ? (unsigned char*)arr_in->data : NULL;
+	a->len_in = len_in;
+	a->f_out = f_out;
+	a->is_zip = name != NULL;
+	if (name) {
+		strncpy(a->name, name, sizeof(a->name) - 1);
+	}
+
+	if (f_out) {
+		if (f_in) {
+			// File to file can take a while, so do it in a separate task
+			// and keep the evaluator running meanwhile.
+			a->id = lbm_get_current_cid();
+			xTaskCreatePinnedToCore(deflate_task, "Deflate", 3072, a, 5, NULL, tskNO_AFFINITY);
+			lbm_block_ctx_from_extension();
+			return ENC_SYM_TRUE;
+		}
+
+		bool ok = deflate_run(a);
+		fsync(fileno(f_out));
+		deflate_free(a);
+		return ok ? ENC_SYM_TRUE : ENC_SYM_NIL;
+	}
+
+	a->buf_out_size = LOWDEFLATE_BOUND(len_in) + 2 * LOWDEFLATE_ZIP_CDIRFILE_LENGTH +
+			LOWDEFLATE_ZIP_EOCDIR_LENGTH + 2 * strlen(a->name);
+	a->buf_out = lbm_malloc(a->buf_out_size);
+	if (!a->buf_out) {
+		deflate_free(a);
+		return ENC_SYM_MERROR;
+	}
+
+	lbm_value res = ENC_SYM_NIL;
+	if (deflate_run(a)) {
+		if (!lbm_create_array(&res, a->buf_out_len)) {
+			res = ENC_SYM_MERROR;
+		} else {
+			lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(res);
+			memcpy(arr->data, a->buf_out, a->buf_out_len);
+		}
+	}
+
+	deflate_free(a);
+	return res;
+}
+
+// (zip input nameInZip optOutputFile optWindowSize)
+static lbm_value ext_zip(lbm_value *args, lbm_uint argn) {
+	if (argn < 2 || argn > 4) {
+		return ENC_SYM_TERROR;
+	}
+
+	char *name = lbm_dec_str(args[1]);
+	if (!name) {
+		return ENC_SYM_TERROR;
+	}
+
+	return deflate_common(args[0], args + 2, argn - 2, name);
+}
+
+// (gzip input optOutputFile optWindowSize)
+static lbm_value ext_gzip(lbm_value *args, lbm_uint argn) {
+	if (argn < 1 || argn > 3) {
+		return ENC_SYM_TERROR;
+	}
+
+	return deflate_common(args[0], args + 1, argn - 1, NULL);
+}
+
 // Connection checks
 
 static lbm_value ext_connected_wifi(lbm_value *args, lbm_uint argn) {
@@ -6604,6 +7005,7 @@ void lispif_load_vesc_extensions(bool main_found) {
 		lbm_add_extension("log-config-field", ext_log_config_field);
 		lbm_add_extension("log-send-f32", ext_log_send_f32);
 		lbm_add_extension("log-send-f64", ext_log_send_f64);
+		lbm_add_extension("log-send-packed", ext_log_send_packed);
 
 		// GNSS
 		lbm_add_extension("gnss-lat-lon", ext_gnss_lat_lon);
@@ -6703,6 +7105,8 @@ void lispif_load_vesc_extensions(bool main_found) {
 		// Compression
 		lbm_add_extension("unzip", ext_unzip);
 		lbm_add_extension("zip-ls", ext_zip_ls);
+		lbm_add_extension("zip", ext_zip);
+		lbm_add_extension("gzip", ext_gzip);
 
 		// Connection checks
 		lbm_add_extension("connected-wifi", ext_connected_wifi);
@@ -6741,6 +7145,8 @@ void lispif_load_vesc_extensions(bool main_found) {
 		lbm_dyn_lib_init();
 		lbm_array_extensions_init();
 		lbm_string_extensions_init();
+		lbm_bytecode_extensions_init();
+		lbm_hashmap_extensions_init();
 	}
 
 	lbm_set_dynamic_load_callback(dynamic_loader);
@@ -6849,23 +7255,18 @@ void lispif_process_custom_app_data(unsigned char *data, unsigned int len) {
 		return;
 	}
 
-	lbm_flat_value_t v;
-	if (start_flatten_with_gc(&v, 30 + len)) {
-		if (recv_data_cid < 0) {
-			f_cons(&v);
-			f_sym(&v, sym_event_data_rx);
-		}
-		f_lbm_array(&v, len, data);
-		lbm_finish_flatten(&v);
+	uint8_t *buf = malloc_reserve_with_gc(len > 0 ? len : 1);
+	if (buf) {
+		memcpy(buf, data, len);
 
 		if (recv_data_cid >= 0) {
-			if (!lbm_unblock_ctx(recv_data_cid, &v)) {
-				lbm_free(v.buf);
+			if (!lbm_unblock_ctx_array(recv_data_cid, buf, len)) {
+				lbm_free(buf);
 			}
 			recv_data_cid = -1;
 		} else {
-			if (!lbm_event(&v)) {
-				lbm_free(v.buf);
+			if (!lbm_event_array(lbm_enc_sym(sym_event_data_rx), buf, len)) {
+				lbm_free(buf);
 			}
 		}
 	}
@@ -6883,15 +7284,14 @@ void lispif_process_rmsg(int slot, unsigned char *data, unsigned int len) {
 		return;
 	}
 
-	lbm_flat_value_t v;
-	if (start_flatten_with_gc(&v, 10 + len)) {
-		f_lbm_array(&v, len, data);
-		lbm_finish_flatten(&v);
+	uint8_t *buf = malloc_reserve_with_gc(len > 0 ? len : 1);
+	if (buf) {
+		memcpy(buf, data, len);
 
-		if (lbm_unblock_ctx(rmsg_slots[slot].cid, &v)) {
+		if (lbm_unblock_ctx_array(rmsg_slots[slot].cid, buf, len)) {
 			rmsg_slots[slot].cid = -1;
 		} else {
-			lbm_free(v.buf);
+			lbm_free(buf);
 		}
 	}
 
@@ -18,6 +18,7 @@
  */
 
 #include "log.h"
+#include "log_comm.h"
 #include "conf_general.h"
 #include "nmea.h"
 
@@ -47,6 +48,24 @@ typedef struct {
 } log_header;
 
 #define LOG_MAX_FIELDS		120
+#define LOG_SPECIAL_FIELDS	7
+#define LOG_BIN_BUF_SIZE	4096
+
+/*
+ * Binary log format (converted to CSV by tools/log_bin_to_csv.py)
+ *
+ * Header:
+ *   "VLOGBIN" and a version byte (1), then uint16 field count followed by
+ *   each field as key\0 name\0 unit\0 precision is_relative is_timestamp
+ *   is_f64.
+ *
+ * Records:
+ *   A bitmap of (field count + 7) / 8 bytes with one bit per field, MSB
+ *   first, set if the field was updated. Then the values of the updated
+ *   fields, float32 or float64 depending on is_f64, in the same big-endian
+ *   encoding as buffer_append_float32_auto/buffer_append_float64_auto.
+ */
+#define LOG_BIN_VERSION		1
 
 char *file_basepath = "/sdcard/";
 
@@ -70,6 +89,13 @@ static volatile float m_rate_hz = 10.0;
 static volatile bool m_append_time = false;
 static volatile bool m_append_gnss = false;
 static volatile bool m_append_gnss_time = false;
+static volatile bool m_binary = false;
+
+// Binary mode state, only used from log_task
+static uint8_t *m_bin_buf = 0;
+static int32_t m_bin_len = 0;
+static log_header *m_bin_fields[LOG_MAX_FIELDS + LOG_SPECIAL_FIELDS];
+static int m_bin_field_num = 0;
 
 static void print_header(log_header *h, FILE *file) {
 	fprintf(file, "%s:%s:%s:%d:%d:%d",
@@ -77,6 +103,101 @@ static void print_header(log_header *h, FILE *file) {
 			h->precision, h->is_relative, h->is_timestamp);
 }
 
+static bool bin_is_f64(log_header *h) {
+	return h->is_timestamp || h->precision > 5;
+}
+
+static void bin_flush(FILE *file) {
+	if (m_bin_len > 0) {
+		fwrite(m_bin_buf, 1, m_bin_len, file);
+		m_bin_len = 0;
+	}
+}
+
+// Make room for len bytes in the write buffer. Writes only go to the file
+// in full buffer chunks, which keeps the number of FAT operations low.
+// Returns true if the buffer was written.
+static bool bin_reserve(FILE *file, int len) {
+	if ((m_bin_len + len) > LOG_BIN_BUF_SIZE) {
+		bin_flush(file);
+		return true;
+	}
+
+	return false;
+}
+
+static void bin_append_str(const char *str) {
+	size_t len = strlen(str) + 1;
+	memcpy(m_bin_buf + m_bin_len, str, len);
+	m_bin_len += len;
+}
+
+static void bin_write_header(FILE *file) {
+	m_bin_field_num = 0;
+	for (int i = 0;i < m_field_num;i++) {
+		m_bin_fields[m_bin_field_num++] = (log_header*)&m_headers[i];
+	}
+
+	if (m_append_time) {
+		m_bin_fields[m_bin_field_num++] = &m_header_ts;
+	}
+
+	if (m_append_gnss_time) {
+		m_bin_fields[m_bin_field_num++] = &m_header_ts_gnss;
+	}
+
+	if (m_append_gnss) {
+		m_bin_fields[m_bin_field_num++] = &m_header_lat;
+		m_bin_fields[m_bin_field_num++] = &m_header_lon;
+		m_bin_fields[m_bin_field_num++] = &m_header_alt;
+		m_bin_fields[m_bin_field_num++] = &m_header_hacc;
+		m_bin_fields[m_bin_field_num++] = &m_header_hvel;
+	}
+
+	bin_append_str("VLOGBIN");
+	m_bin_len--; // No null termination for the magic
+	m_bin_buf[m_bin_len++] = LOG_BIN_VERSION;
+	buffer_append_uint16(m_bin_buf, m_bin_field_num, &m_bin_len);
+
+	for (int i = 0;i < m_bin_field_num;i++) {
+		log_header *h = m_bin_fields[i];
+		bin_reserve(file, sizeof(h->key) + sizeof(h->name) + sizeof(h->unit) + 4);
+		bin_append_str(h->key);
+		bin_append_str(h->name);
+		bin_append_str(h->unit);
+		m_bin_buf[m_bin_len++] = h->precision;
+		m_bin_buf[m_bin_len++] = h->is_relative;
+		m_bin_buf[m_bin_len++] = h->is_timestamp;
+		m_bin_buf[m_bin_len++] = bin_is_f64(h);
+	}
+}
+
+static bool bin_write_record(FILE *file) {
+	int bitmap_len = (m_bin_field_num + 7) / 8;
+	bool flushed = bin_reserve(file, bitmap_len + m_bin_field_num * 8);
+
+	uint8_t *bitmap = m_bin_buf + m_bin_len;
+	memset(bitmap, 0, bitmap_len);
+	m_bin_len += bitmap_len;
+
+	for (int i = 0;i < m_bin_field_num;i++) {
+		log_header *h = m_bin_fields[i];
+		if (!h->updated) {
+			continue;
+		}
+
+		bitmap[i / 8] |= 0x80 >> (i % 8);
+		if (bin_is_f64(h)) {
+			buffer_append_float64_auto(m_bin_buf, h->value, &m_bin_len);
+		} else {
+			buffer_append_float32_auto(m_bin_buf, (float)h->value, &m_bin_len);
+		}
+		h->updated = false;
+	}
+
+	return flushed;
+}
+
 static void log_task(void *arg) {
 	FILE *f_log = 0;
 	int gga_cnt_last = 0;
@@ -143,23 +264,43 @@ static void log_task(void *arg) {
 				}
 				closedir(dir);
 
+				const char *ext = m_binary ? "bin" : "csv";
 				if (date_valid) {
 					sprintf(
 						path,
-						"%slog_can/log_%03d_%02d-%02d-%02d_%02d-%02d-%02d.csv",
+						"%slog_can/log_%03d_%02d-%02d-%02d_%02d-%02d-%02d.%s",
 						file_basepath, highest_index + 1, s->rmc.yy, s->rmc.mo,
-						s->rmc.dd, s->rmc.hh, s->rmc.mm, s->rmc.ss
+						s->rmc.dd, s->rmc.hh, s->rmc.mm, s->rmc.ss, ext
 					);
 				} else {
 					sprintf(
-						path, "%slog_can/log_%03d.csv", file_basepath,
-						highest_index + 1
+						path, "%slog_can/log_%03d.%s", file_basepath,
+						highest_index + 1, ext
 					);
 				}
-				f_log = fopen(path, "w");
+
+				if (m_binary) {
+					m_bin_buf = malloc(LOG_BIN_BUF_SIZE);
+					m_bin_len = 0;
+					if (m_bin_buf) {
+						f_log = fopen(path, "w");
+						if (!f_log) {
+							free(m_bin_buf);
+							m_bin_buf = 0;
+						}
+					}
+				} else {
+					f_log = fopen(path, "w");
+				}
 			}
 
-			if (f_log) {
+			if (f_log && m_bin_buf) {
+				// To get the first sample
+				gga_updated = true;
+				rmc_updated = true;
+
+				bin_write_header(f_log);
+			} else if (f_log) {
 				// To get the first sample
 				gga_updated = true;
 				rmc_updated = true;
@@ -210,11 +351,42 @@ static void log_task(void *arg) {
 		}
 
 		if (m_field_num <= 0 && f_log) {
+			if (m_bin_buf) {
+				bin_flush(f_log);
+				free(m_bin_buf);
+				m_bin_buf = 0;
+			}
 			fclose(f_log);
 			f_log = 0;
 		}
 
-		if (f_log) {
+		if (f_log && m_bin_buf) {
+			m_header_ts.value = (double)utils_ms_today() / 1000.0;
+			m_header_ts.updated = true;
+
+			m_header_ts_gnss.value = (double)s->gga.ms_today / 1000.0;
+			m_header_lat.value = s->gga.lat;
+			m_header_lon.value = s->gga.lon;
+			m_header_alt.value = s->gga.height;
+			m_header_hacc.value = s->gga.h_dop * 4.0;
+			m_header_ts_gnss.updated = gga_updated;
+			m_header_lat.updated = gga_updated;
+			m_header_lon.updated = gga_updated;
+			m_header_alt.updated = gga_updated;
+			m_header_hacc.updated = gga_updated;
+
+			m_header_hvel.value = s->rmc.speed * 3.6;
+			m_header_hvel.updated = rmc_updated;
+
+			bool flushed = bin_write_record(f_log);
+
+			// Only sync right after a buffer write, so that the task is not
+			// stalled more than once per buffer.
+			if (flushed && UTILS_AGE_S(tick_last_fsync) > 2.0) {
+				tick_last_fsync = xTaskGetTickCount();
+				fsync(fileno(f_log));
+			}
+		} else if (f_log) {
 			for (int i = 0;i < m_field_num;i++) {
 				log_header *h = (log_header*)&m_headers[i];
 				if (h->updated) {
@@ -474,6 +646,11 @@ bool log_init(void) {
 	return true;
 }
 
+static void set_packed_field(int field_ind, float value) {
+	m_headers[field_ind].value = value;
+	m_headers[field_ind].updated = true;
+}
+
 void log_process_packet(unsigned char *data, unsigned int len) {
 	COMM_PACKET_ID packet_id = data[0];
 	data++;
@@ -495,6 +672,12 @@ void log_process_packet(unsigned char *data, unsigned int len) {
 		m_append_time = data[ind++];
 		m_append_gnss = data[ind++];
 		m_append_gnss_time = data[ind++];
+
+		// Optional, older senders do not include it
+		m_binary = false;
+		if ((unsigned int)ind < len) {
+			m_binary = data[ind++];
+		}
 	} break;
 
 	case COMM_LOG_STOP: {
@@ -553,6 +736,10 @@ void log_process_packet(unsigned char *data, unsigned int len) {
 		}
 	} break;
 
+	case COMM_LOG_DATA_PACKED:
+		log_comm_unpack_fields(data, len, LOG_MAX_FIELDS, set_packed_field);
+		break;
+
 	default:
 		break;
 	}
@@ -32,7 +32,8 @@ void log_comm_start(
 		float rate_hz,
 		bool append_time,
 		bool append_gnss,
-		bool append_gnss_time) {
+		bool append_gnss_time,
+		bool binary) {
 
 	int32_t ind = 0;
 	uint8_t buffer[20];
@@ -43,6 +44,7 @@ void log_comm_start(
 	buffer[ind++] = append_time;
 	buffer[ind++] = append_gnss;
 	buffer[ind++] = append_gnss_time;
+	buffer[ind++] = binary;
 
 	log_comm_send(can_id, buffer, ind);
 }
@@ -88,6 +90,148 @@ void log_comm_config_field(
 	mempools_free_packet_buffer(buffer);
 }
 
+/**
+ * Encode a packed multi-field record into buffer, which must hold at least
+ * 24 + num * 4 bytes.
+ *
+ * values/present: num entries for the fields starting at field_start. Fields
+ * with present[i] false are left out. present may be NULL to include all.
+ *
+ * f16_scale: Send values as scaled int16 when > 0, otherwise as float32.
+ *
+ * Returns the encoded length or -1 if num is out of range.
+ */
+int log_comm_pack_fields(
+		uint8_t *buffer,
+		int field_start,
+		const float *values,
+		const bool *present,
+		int num,
+		float f16_scale) {
+
+	if (num <= 0 || num > LOG_PACKED_MAX_FIELDS) {
+		return -1;
+	}
+
+	int32_t ind = 0;
+	bool f16 = f16_scale > 0.0;
+
+	buffer[ind++] = COMM_LOG_DATA_PACKED;
+	buffer_append_int16(buffer, field_start, &ind);
+	buffer[ind++] = f16 ? LOG_PACKED_FLAG_F16 : 0;
+	if (f16) {
+		buffer_append_float32_auto(buffer, f16_scale, &ind);
+	}
+
+	int bitmap_len = (num + 7) / 8;
+	buffer[ind++] = bitmap_len;
+	uint8_t *bitmap = buffer + ind;
+	memset(bitmap, 0, bitmap_len);
+	ind += bitmap_len;
+
+	for (int i = 0;i < num;i++) {
+		if (present && !present[i]) {
+			continue;
+		}
+
+		bitmap[i / 8] |= 0x80 >> (i % 8);
+		if (f16) {
+			buffer_append_float16(buffer, values[i], f16_scale, &ind);
+		} else {
+			buffer_append_float32_auto(buffer, values[i], &ind);
+		}
+	}
+
+	return ind;
+}
+
+/**
+ * Decode a packed record as encoded by log_comm_pack_fields. data starts
+ * after the COMM_LOG_DATA_PACKED byte.
+ *
+ * field_num: Fields from this index on are ignored.
+ *
+ * set_field: Called with the index and the value of every included field.
+ *
+ * Returns false if the record is malformed or truncated. The fields before
+ * the error have been passed to set_field then.
+ */
+bool log_comm_unpack_fields(
+		const uint8_t *data,
+		unsigned int len,
+		int field_num,
+		log_comm_field_func set_field) {
+
+	// Field index, flags and bitmap length
+	if (len < 4) {
+		return false;
+	}
+
+	int32_t ind = 0;
+	int field_ind = buffer_get_int16(data, &ind);
+	uint8_t flags = data[ind++];
+
+	if (field_ind < 0) {
+		return false;
+	}
+
+	bool f16 = flags & LOG_PACKED_FLAG_F16;
+	float scale = 1.0;
+	if (f16) {
+		if (len < 8) {
+			return false;
+		}
+
+		scale = buffer_get_float32_auto(data, &ind);
+		if (!(scale > 0.0)) {
+			return false;
+		}
+	}
+
+	int bitmap_len = data[ind++];
+	if ((unsigned int)(ind + bitmap_len) > len) {
+		return false;
+	}
+
+	const uint8_t *bitmap = data + ind;
+	ind += bitmap_len;
+
+	int val_len = f16 ? 2 : 4;
+	for (int i = 0;i < bitmap_len * 8 && field_ind < field_num;i++, field_ind++) {
+		if (!(bitmap[i / 8] & (0x80 >> (i % 8)))) {
+			continue;
+		}
+
+		if ((unsigned int)(ind + val_len) > len) {
+			return false;
+		}
+
+		if (f16) {
+			set_field(field_ind, buffer_get_float16(data, scale, &ind));
+		} else {
+			set_field(field_ind, buffer_get_float32_auto(data, &ind));
+		}
+	}
+
+	return true;
+}
+
+void log_comm_send_packed(
+		int can_id,
+		int field_start,
+		const float *values,
+		const bool *present,
+		int num,
+		float f16_scale) {
+
+	uint8_t *buffer = mempools_get_packet_buffer();
+	int len = log_comm_pack_fields(buffer, field_start, values, present, num, f16_scale);
+	if (len > 0) {
+		log_comm_send(can_id, buffer, len);
+	}
+	mempools_free_packet_buffer(buffer);
+}
+
 void log_comm_send(int can_id, uint8_t *data, unsigned int len) {
 	if (can_id >= 0 && can_id < 255) {
 		comm_can_send_buffer(can_id, data, len, 0);
@@ -23,6 +23,21 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/*
+ * COMM_LOG_DATA_PACKED layout:
+ *   int16 first field index
+ *   uint8 flags
+ *   float32_auto scale (only with LOG_PACKED_FLAG_F16)
+ *   uint8 bitmap length, followed by the bitmap. Bit i (MSB first) is set
+ *   if field (first + i) is included.
+ *   The included values in order, as float32_auto or, with
+ *   LOG_PACKED_FLAG_F16, as buffer_append_float16 with the scale above.
+ */
+#define LOG_PACKED_FLAG_F16			0x01
+#define LOG_PACKED_MAX_FIELDS		120
+
+typedef void (*log_comm_field_func)(int field_ind, float value);
+
 // Functions
 void log_comm_start(
 		int can_id,
@@ -30,7 +45,8 @@ void log_comm_start(
 		float rate_hz,
 		bool append_time,
 		bool append_gnss,
-		bool append_gnss_time);
+		bool append_gnss_time,
+		bool binary);
 void log_comm_stop(int can_id);
 void log_comm_config_field(
 		int can_id,
@@ -41,6 +57,25 @@ void log_comm_config_field(
 		int precision,
 		bool is_relative,
 		bool is_timestamp);
+int log_comm_pack_fields(
+		uint8_t *buffer,
+		int field_start,
+		const float *values,
+		const bool *present,
+		int num,
+		float f16_scale);
+bool log_comm_unpack_fields(
+		const uint8_t *data,
+		unsigned int len,
+		int field_num,
+		log_comm_field_func set_field);
+void log_comm_send_packed(
+		int can_id,
+		int field_start,
+		const float *values,
+		const bool *present,
+		int num,
+		float f16_scale);
 void log_comm_send(int can_id, uint8_t *data, unsigned int len);
 
 #endif /* COMM_LOG_COMM_H_ */
@@ -0,0 +1,810 @@
+/*
+ *  Lowdeflate -- memory-optimized streaming deflate compressor, the
+ *  counterpart of the lowzip inflater.
+ *
+ *  About the algorithm
+ *  ===================
+ *
+ *  The compressor keeps a sliding history window of 1-4kB (configurable)
+ *  plus an equally sized lookahead area.  Matches are found with a hash of
+ *  the next three bytes and chains of earlier positions with the same hash,
+ *  following at most 'max_chain' links.  Parsing is greedy, like the fast
+ *  zlib levels; lazy matching would gain a few percent on text at a
+ *  noticeable speed cost.
+ *
+ *  Literals and matches are buffered as 3-byte symbols.  When the symbol
+ *  buffer is full (or the stream ends) a block is emitted as whichever of
+ *  stored, static Huffman or dynamic Huffman is smallest.  Stored blocks are
+ *  only possible while the block input is still in the window.
+ *
+ *  All memory is provided by the caller: the state structure and a work
+ *  area sized with LOWDEFLATE_WORK_SIZE().  Output is pushed through a
+ *  write callback in chunks of up to 64 bytes.
+ *
+ *  https://www.ietf.org/rfc/rfc1951.txt
+ *  https://www.ietf.org/rfc/rfc1952.txt
+ *
+ *  Type assumptions
+ *  ================
+ *
+ *    - sizeof(char) == 1
+ *    - sizeof(short) == 2
+ *    - sizeof(int) >= 4
+ */
+
+#include <string.h>  /* memset(), memcpy(), memmove(), strlen() */
+#include "lowdeflate.h"
+
+#define LOWDEFLATE_MIN_MATCH      3
+#define LOWDEFLATE_MAX_MATCH      258
+#define LOWDEFLATE_MIN_LOOKAHEAD  (LOWDEFLATE_MAX_MATCH + LOWDEFLATE_MIN_MATCH + 1)
+#define LOWDEFLATE_DEFAULT_CHAIN  32
+#define LOWDEFLATE_NICE_MATCH     128
+#define LOWDEFLATE_MAX_BITS       15
+#define LOWDEFLATE_MAX_BL_BITS    7
+#define LOWDEFLATE_END_BLOCK      256
+
+#define LOWDEFLATE_HASH_SIZE      (1U << LOWDEFLATE_HASH_BITS)
+
+static const unsigned char lowdeflate_len_bits[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const unsigned short lowdeflate_len_base[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const unsigned char lowdeflate_dist_bits[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static const unsigned short lowdeflate_dist_base[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const unsigned char lowdeflate_codelen_order[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/* Nibble-wise CRC-32 table, reflected polynomial 0xedb88320. */
+static const unsigned int lowdeflate_crc_table[16] = {
+	0x00000000UL, 0x1db71064UL, 0x3b6e20c8UL, 0x26d930acUL,
+	0x76dc4190UL, 0x6b6b51f4UL, 0x4db26158UL, 0x5005713cUL,
+	0xedb88320UL, 0xf00f9344UL, 0xd6d6a3e8UL, 0xcb61b38cUL,
+	0x9b64c2b0UL, 0x86d3d2d4UL, 0xa00ae278UL, 0xbdbdf21cUL
+};
+
+/*
+ *  Output
+ */
+
+static void lowdeflate_flush_out(lowdeflate_state *st) {
+	if (st->out_len > 0) {
+		st->write_callback(st->udata, st->out, st->out_len);
+		st->total_out += st->out_len;
+		st->out_len = 0;
+	}
+}
+
+static void lowdeflate_put_byte(lowdeflate_state *st, unsigned char b) {
+	st->out[st->out_len++] = b;
+	if (st->out_len == sizeof(st->out)) {
+		lowdeflate_flush_out(st);
+	}
+}
+
+/* Append 'nbits' bits (at most 16) of 'value', least significant first. */
+static void lowdeflate_put_bits(lowdeflate_state *st, unsigned int value, unsigned int nbits) {
+	st->bitbuf |= value << st->bitcount;
+	st->bitcount += nbits;
+	while (st->bitcount >= 8) {
+		lowdeflate_put_byte(st, (unsigned char) (st->bitbuf & 0xffU));
+		st->bitbuf >>= 8;
+		st->bitcount -= 8;
+	}
+}
+
+static void lowdeflate_align_byte(lowdeflate_state *st) {
+	if (st->bitcount > 0) {
+		lowdeflate_put_byte(st, (unsigned char) (st->bitbuf & 0xffU));
+	}
+	st->bitbuf = 0;
+	st->bitcount = 0;
+}
+
+/*
+ *  Symbol helpers
+ */
+
+static unsigned int lowdeflate_len_code(unsigned int len) {
+	unsigned int c = 28;
+	while (lowdeflate_len_base[c] > len) {
+		c--;
+	}
+	return c;
+}
+
+static unsigned int lowdeflate_dist_code(unsigned int dist) {
+	unsigned int c = 29;
+	while (lowdeflate_dist_base[c] > dist) {
+		c--;
+	}
+	return c;
+}
+
+static void lowdeflate_record(lowdeflate_state *st, unsigned int dist, unsigned int lc) {
+	unsigned char *p = st->syms + 3 * st->sym_count;
+
+	p[0] = (unsigned char) (dist & 0xffU);
+	p[1] = (unsigned char) (dist >> 8);
+	p[2] = (unsigned char) lc;
+	st->sym_count++;
+
+	if (dist == 0) {
+		st->lit_freq[lc]++;
+	} else {
+		st->lit_freq[257 + lowdeflate_len_code(lc + LOWDEFLATE_MIN_MATCH)]++;
+		st->dist_freq[lowdeflate_dist_code(dist)]++;
+	}
+}
+
+/*
+ *  Huffman code construction
+ */
+
+/* Compute code lengths limited to 'max_bits' for symbols with non-zero
+ * frequency.  Uses the two-queue method on leaves sorted by weight; when
+ * the resulting tree is too deep the weights are halved and the tree is
+ * rebuilt, which converges quickly and is much simpler than package-merge.
+ * A single used symbol gets a sibling so that the code is always complete.
+ */
+static void lowdeflate_build_lengths(lowdeflate_state *st, const unsigned short *freq,
+		unsigned int n, unsigned char *lens, unsigned int max_bits) {
+	unsigned int shift = 0;
+	unsigned int cnt;
+	unsigned int i, j;
+
+	for (;;) {
+		unsigned int leaf, queue, next;
+		unsigned int max_len;
+
+		memset((void *) lens, 0, n);
+
+		/* Insertion sort of the used symbols by (scaled) weight. */
+		cnt = 0;
+		for (i = 0; i < n; i++) {
+			unsigned int w;
+
+			if (freq[i] == 0) {
+				continue;
+			}
+			w = ((unsigned int) freq[i] >> shift) | 1U;
+			j = cnt;
+			while (j > 0 && st->weight[j - 1] > w) {
+				st->weight[j] = st->weight[j - 1];
+				st->order[j] = st->order[j - 1];
+				j--;
+			}
+			st->weight[j] = w;
+			st->order[j] = (unsigned short) i;
+			cnt++;
+		}
+
+		if (cnt == 0) {
+			lens[0] = 1;
+			lens[1] = 1;
+			return;
+		}
+		if (cnt == 1) {
+			lens[st->order[0]] = 1;
+			lens[st->order[0] == 0 ? 1 : 0] = 1;
+			return;
+		}
+
+		/* Merge the two lightest nodes until one remains.  Internal nodes
+		 * are created with non-decreasing weights, so the front of each
+		 * queue is its minimum.
+		 */
+		leaf = 0;
+		queue = cnt;
+		next = cnt;
+		while (next < 2 * cnt - 1) {
+			unsigned int k;
+			unsigned int pick[2];
+
+			for (k = 0; k < 2; k++) {
+				if (leaf < cnt && (queue >= next || st->weight[leaf] <= st->weight[queue])) {
+					pick[k] = leaf++;
+				} else {
+					pick[k] = queue++;
+				}
+			}
+			st->weight[next] = st->weight[pick[0]] + st->weight[pick[1]];
+			st->parent[pick[0]] = (unsigned short) next;
+			st->parent[pick[1]] = (unsigned short) next;
+			next++;
+		}
+
+		/* Parents always have a larger index than their children, so a
+		 * single downwards pass turns weights into depths.
+		 */
+		st->weight[2 * cnt - 2] = 0;
+		max_len = 0;
+		for (i = 2 * cnt - 2; i-- > 0;) {
+			st->weight[i] = st->weight[st->parent[i]] + 1;
+			if (i < cnt && st->weight[i] > max_len) {
+				max_len = st->weight[i];
+			}
+		}
+
+		if (max_len <= max_bits) {
+			for (i = 0; i < cnt; i++) {
+				lens[st->order[i]] = (unsigned char) st->weight[i];
+			}
+			return;
+		}
+
+		shift++;
+	}
+}
+
+/* Assign canonical codes to the lengths, stored bit reversed so that they
+ * can be emitted least significant bit first.
+ */
+static void lowdeflate_gen_codes(const unsigned char *lens, unsigned int n, unsigned short *codes) {
+	unsigned short bl_count[LOWDEFLATE_MAX_BITS + 1];
+	unsigned short next_code[LOWDEFLATE_MAX_BITS + 1];
+	unsigned int code = 0;
+	unsigned int i, b;
+
+	memset((void *) bl_count, 0, sizeof(bl_count));
+	for (i = 0; i < n; i++) {
+		bl_count[lens[i]]++;
+	}
+	bl_count[0] = 0;
+	for (b = 1; b <= LOWDEFLATE_MAX_BITS; b++) {
+		code = (code + bl_count[b - 1]) << 1;
+		next_code[b] = (unsigned short) code;
+	}
+
+	for (i = 0; i < n; i++) {
+		unsigned int len = lens[i];
+		unsigned int c, r;
+
+		if (len == 0) {
+			codes[i] = 0;
+			continue;
+		}
+		c = next_code[len]++;
+		r = 0;
+		for (b = 0; b < len; b++) {
+			r = (r << 1) | (c & 1U);
+			c >>= 1;
+		}
+		codes[i] = (unsigned short) r;
+	}
+}
+
+static void lowdeflate_static_lengths(lowdeflate_state *st) {
+	unsigned int i;
+
+	for (i = 0; i < 288; i++) {
+		st->lit_len[i] = (unsigned char) (i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8)));
+	}
+	for (i = 0; i < 30; i++) {
+		st->dist_len[i] = 5;
+	}
+}
+
+/* Bit cost of the block symbols with the current code lengths. */
+static unsigned int lowdeflate_body_cost(lowdeflate_state *st) {
+	unsigned int cost = 0;
+	unsigned int i;
+
+	for (i = 0; i < 286; i++) {
+		cost += (unsigned int) st->lit_freq[i] * st->lit_len[i];
+		if (i >= 257) {
+			cost += (unsigned int) st->lit_freq[i] * lowdeflate_len_bits[i - 257];
+		}
+	}
+	for (i = 0; i < 30; i++) {
+		cost += (unsigned int) st->dist_freq[i] * (st->dist_len[i] + lowdeflate_dist_bits[i]);
+	}
+	return cost;
+}
+
+/* Build the dynamic trees and the run-length encoded header.  Returns the
+ * header cost in bits; the header layout is left in the state for
+ * lowdeflate_emit_dynamic_header().
+ */
+static unsigned int lowdeflate_build_dynamic(lowdeflate_state *st, unsigned int *p_hlit,
+		unsigned int *p_hdist, unsigned int *p_hclen, unsigned int *p_nrle) {
+	unsigned char all_lens[286 + 30];
+	unsigned int hlit, hdist, hclen, total, nrle;
+	unsigned int i, cost;
+
+	lowdeflate_build_lengths(st, st->lit_freq, 286, st->lit_len, LOWDEFLATE_MAX_BITS);
+	st->lit_len[286] = 0;
+	st->lit_len[287] = 0;
+	lowdeflate_build_lengths(st, st->dist_freq, 30, st->dist_len, LOWDEFLATE_MAX_BITS);
+
+	for (hlit = 286; hlit > 257 && st->lit_len[hlit - 1] == 0; hlit--) {
+	}
+	for (hdist = 30; hdist > 1 && st->dist_len[hdist - 1] == 0; hdist--) {
+	}
+
+	memcpy((void *) all_lens, (const void *) st->lit_len, hlit);
+	memcpy((void *) (all_lens + hlit), (const void *) st->dist_len, hdist);
+	total = hlit + hdist;
+
+	/* Run-length encode with codes 16 (repeat previous 3-6), 17 (zeros
+	 * 3-10) and 18 (zeros 11-138); extra bits are stored in the upper
+	 * bits of each entry.
+	 */
+	memset((void *) st->bl_freq, 0, sizeof(st->bl_freq));
+	nrle = 0;
+	i = 0;
+	while (i < total) {
+		unsigned int len = all_lens[i];
+		unsigned int run = 1;
+
+		while (i + run < total && all_lens[i + run] == len) {
+			run++;
+		}
+
+		if (len == 0 && run >= 3) {
+			unsigned int r = run > 138 ? 138 : run;
+			if (r >= 11) {
+				st->rle[nrle++] = (unsigned short) (18 | ((r - 11) << 5));
+				st->bl_freq[18]++;
+			} else {
+				st->rle[nrle++] = (unsigned short) (17 | ((r - 3) << 5));
+				st->bl_freq[17]++;
+			}
+			i += r;
+		} else if (len != 0 && run >= 4) {
+			unsigned int r = run - 1 > 6 ? 6 : run - 1;
+			st->rle[nrle++] = (unsigned short) len;
+			st->bl_freq[len]++;
+			st->rle[nrle++] = (unsigned short) (16 | ((r - 3) << 5));
+			st->bl_freq[16]++;
+			i += r + 1;
+		} else {
+			st->rle[nrle++] = (unsigned short) len;
+			st->bl_freq[len]++;
+			i++;
+		}
+	}
+
+	lowdeflate_build_lengths(st, st->bl_freq, 19, st->bl_len, LOWDEFLATE_MAX_BL_BITS);
+	for (hclen = 19; hclen > 4 && st->bl_len[lowdeflate_codelen_order[hclen - 1]] == 0; hclen--) {
+	}
+
+	cost = 5 + 5 + 4 + 3 * hclen;
+	for (i = 0; i < nrle; i++) {
+		unsigned int c = st->rle[i] & 0x1fU;
+		cost += st->bl_len[c];
+		cost += (c == 16 ? 2 : (c == 17 ? 3 : (c == 18 ? 7 : 0)));
+	}
+
+	*p_hlit = hlit;
+	*p_hdist = hdist;
+	*p_hclen = hclen;
+	*p_nrle = nrle;
+	return cost;
+}
+
+static void lowdeflate_emit_dynamic_header(lowdeflate_state *st, unsigned int hlit,
+		unsigned int hdist, unsigned int hclen, unsigned int nrle) {
+	unsigned int i;
+
+	lowdeflate_gen_codes(st->bl_len, 19, st->bl_code);
+
+	lowdeflate_put_bits(st, hlit - 257, 5);
+	lowdeflate_put_bits(st, hdist - 1, 5);
+	lowdeflate_put_bits(st, hclen - 4, 4);
+	for (i = 0; i < hclen; i++) {
+		lowdeflate_put_bits(st, st->bl_len[lowdeflate_codelen_order[i]], 3);
+	}
+	for (i = 0; i < nrle; i++) {
+		unsigned int c = st->rle[i] & 0x1fU;
+		unsigned int extra = (unsigned int) st->rle[i] >> 5;
+
+		lowdeflate_put_bits(st, st->bl_code[c], st->bl_len[c]);
+		if (c == 16) {
+			lowdeflate_put_bits(st, extra, 2);
+		} else if (c == 17) {
+			lowdeflate_put_bits(st, extra, 3);
+		} else if (c == 18) {
+			lowdeflate_put_bits(st, extra, 7);
+		}
+	}
+}
+
+static void lowdeflate_emit_symbols(lowdeflate_state *st) {
+	unsigned int i;
+
+	for (i = 0; i < st->sym_count; i++) {
+		const unsigned char *p = st->syms + 3 * i;
+		unsigned int dist = (unsigned int) p[0] | ((unsigned int) p[1] << 8);
+		unsigned int lc = p[2];
+
+		if (dist == 0) {
+			lowdeflate_put_bits(st, st->lit_code[lc], st->lit_len[lc]);
+		} else {
+			unsigned int len = lc + LOWDEFLATE_MIN_MATCH;
+			unsigned int c = lowdeflate_len_code(len);
+			unsigned int d = lowdeflate_dist_code(dist);
+
+			lowdeflate_put_bits(st, st->lit_code[257 + c], st->lit_len[257 + c]);
+			lowdeflate_put_bits(st, len - lowdeflate_len_base[c], lowdeflate_len_bits[c]);
+			lowdeflate_put_bits(st, st->dist_code[d], st->dist_len[d]);
+			lowdeflate_put_bits(st, dist - lowdeflate_dist_base[d], lowdeflate_dist_bits[d]);
+		}
+	}
+
+	lowdeflate_put_bits(st, st->lit_code[LOWDEFLATE_END_BLOCK], st->lit_len[LOWDEFLATE_END_BLOCK]);
+}
+
+/* Emit the pending symbols as one block, choosing the smallest encoding. */
+static void lowdeflate_flush_block(lowdeflate_state *st, int last) {
+	unsigned int stored_len = st->strstart - (unsigned int) st->block_start;
+	unsigned int static_cost, dynamic_cost, stored_cost;
+	unsigned int hlit = 0, hdist = 0, hclen = 0, nrle = 0;
+	unsigned int i;
+
+	st->lit_freq[LOWDEFLATE_END_BLOCK]++;
+
+	lowdeflate_static_lengths(st);
+	static_cost = lowdeflate_body_cost(st);
+
+	/* Stored: header, alignment (assume worst case), LEN/NLEN and data. */
+	stored_cost = 0xffffffffUL;
+	if (st->block_start >= 0 && stored_len <= 65535U) {
+		stored_cost = 7 + 32 + 8 * stored_len;
+	}
+
+	dynamic_cost = 0xffffffffUL;
+	if (st->dynamic_huffman) {
+		dynamic_cost = lowdeflate_build_dynamic(st, &hlit, &hdist, &hclen, &nrle);
+		dynamic_cost += lowdeflate_body_cost(st);
+	}
+
+	if (stored_cost <= static_cost && stored_cost <= dynamic_cost) {
+		lowdeflate_put_bits(st, last ? 1U : 0U, 3);
+		lowdeflate_align_byte(st);
+		lowdeflate_put_byte(st, (unsigned char) (stored_len & 0xffU));
+		lowdeflate_put_byte(st, (unsigned char) (stored_len >> 8));
+		lowdeflate_put_byte(st, (unsigned char) (~stored_len & 0xffU));
+		lowdeflate_put_byte(st, (unsigned char) ((~stored_len >> 8) & 0xffU));
+		for (i = 0; i < stored_len; i++) {
+			lowdeflate_put_byte(st, st->window[st->block_start + (int) i]);
+		}
+	} else if (dynamic_cost < static_cost) {
+		lowdeflate_put_bits(st, (last ? 1U : 0U) | (2U << 1), 3);
+		lowdeflate_emit_dynamic_header(st, hlit, hdist, hclen, nrle);
+		lowdeflate_gen_codes(st->lit_len, 288, st->lit_code);
+		lowdeflate_gen_codes(st->dist_len, 30, st->dist_code);
+		lowdeflate_emit_symbols(st);
+	} else {
+		lowdeflate_static_lengths(st);
+		lowdeflate_gen_codes(st->lit_len, 288, st->lit_code);
+		lowdeflate_gen_codes(st->dist_len, 30, st->dist_code);
+		lowdeflate_put_bits(st, (last ? 1U : 0U) | (1U << 1), 3);
+		lowdeflate_emit_symbols(st);
+	}
+
+	memset((void *) st->lit_freq, 0, sizeof(st->lit_freq));
+	memset((void *) st->dist_freq, 0, sizeof(st->dist_freq));
+	st->sym_count = 0;
+	st->block_start = (int) st->strstart;
+}
+
+/*
+ *  Match finding
+ */
+
+static void lowdeflate_slide(lowdeflate_state *st) {
+	unsigned int wsize = 1U << st->window_bits;
+	unsigned int i;
+
+	memmove((void *) st->window, (const void *) (st->window + wsize), wsize);
+	st->strstart -= wsize;
+	st->block_start -= (int) wsize;
+
+	for (i = 0; i < LOWDEFLATE_HASH_SIZE; i++) {
+		st->head[i] = (unsigned short) (st->head[i] >= wsize ? st->head[i] - wsize : 0);
+	}
+	for (i = 0; i < wsize; i++) {
+		st->prev[i] = (unsigned short) (st->prev[i] >= wsize ? st->prev[i] - wsize : 0);
+	}
+}
+
+/* Multiplicative hash of the three bytes at 'p'. */
+static unsigned int lowdeflate_hash(const unsigned char *p) {
+	unsigned int v = (unsigned int) p[0] | ((unsigned int) p[1] << 8) | ((unsigned int) p[2] << 16);
+	return ((v * 0x9e3779b1UL) & 0xffffffffUL) >> (32 - LOWDEFLATE_HASH_BITS);
+}
+
+static void lowdeflate_insert(lowdeflate_state *st, unsigned int pos) {
+	unsigned int h = lowdeflate_hash(st->window + pos);
+
+	st->prev[pos & ((1U << st->window_bits) - 1)] = st->head[h];
+	st->head[h] = (unsigned short) pos;
+}
+
+/* Find the longest match for the string at strstart, starting from chain
+ * head 'cur'.  Position 0 doubles as the chain terminator, so it is never
+ * matched against.  Returns the match length (0 if none) and its distance.
+ */
+static unsigned int lowdeflate_longest_match(lowdeflate_state *st, unsigned int cur, unsigned int *p_dist) {
+	unsigned int wmask = (1U << st->window_bits) - 1;
+	unsigned int max_dist = wmask + 1 - LOWDEFLATE_MIN_LOOKAHEAD;
+	unsigned int limit = st->strstart > max_dist ? st->strstart - max_dist : 0;
+	unsigned int max_len = st->lookahead < LOWDEFLATE_MAX_MATCH ? st->lookahead : LOWDEFLATE_MAX_MATCH;
+	unsigned int chain = st->max_chain;
+	unsigned int best_len = LOWDEFLATE_MIN_MATCH - 1;
+	const unsigned char *scan = st->window + st->strstart;
+
+	if (max_len < LOWDEFLATE_MIN_MATCH) {
+		return 0;
+	}
+
+	while (cur > limit && chain-- > 0) {
+		const unsigned char *m = st->window + cur;
+
+		if (m[best_len] == scan[best_len] && m[0] == scan[0] && m[1] == scan[1]) {
+			unsigned int len = 2;
+			while (len < max_len && m[len] == scan[len]) {
+				len++;
+			}
+			if (len > best_len) {
+				best_len = len;
+				*p_dist = st->strstart - cur;
+				if (len >= max_len || len >= LOWDEFLATE_NICE_MATCH) {
+					break;
+				}
+			}
+		}
+
+		/* Links older than the window may have been overwritten by
+		 * newer positions; chains must always move backwards.
+		 */
+		if (st->prev[cur & wmask] >= cur) {
+			break;
+		}
+		cur = st->prev[cur & wmask];
+	}
+
+	return best_len >= LOWDEFLATE_MIN_MATCH ? best_len : 0;
+}
+
+/* Consume the lookahead.  Unless finishing, enough lookahead for a maximum
+ * length match is kept in the window for the next call.
+ */
+static void lowdeflate_process(lowdeflate_state *st, int finish) {
+	unsigned int min_lookahead = finish ? 1 : LOWDEFLATE_MIN_LOOKAHEAD;
+
+	while (st->lookahead >= min_lookahead) {
+		unsigned int len = 0;
+		unsigned int dist = 0;
+
+		if (st->lookahead >= LOWDEFLATE_MIN_MATCH) {
+			unsigned int cur = st->head[lowdeflate_hash(st->window + st->strstart)];
+			lowdeflate_insert(st, st->strstart);
+			len = lowdeflate_longest_match(st, cur, &dist);
+		}
+
+		if (len > 0) {
+			unsigned int i;
+
+			lowdeflate_record(st, dist, len - LOWDEFLATE_MIN_MATCH);
+			for (i = 1; i < len; i++) {
+				if (st->lookahead - i >= LOWDEFLATE_MIN_MATCH) {
+					lowdeflate_insert(st, st->strstart + i);
+				}
+			}
+			st->strstart += len;
+			st->lookahead -= len;
+		} else {
+			lowdeflate_record(st, 0, st->window[st->strstart]);
+			st->strstart++;
+			st->lookahead--;
+		}
+
+		if (st->sym_count == LOWDEFLATE_BLOCK_SYMS) {
+			lowdeflate_flush_block(st, 0);
+		}
+	}
+}
+
+/*
+ *  Public API
+ */
+
+/* Initialize the compressor.  The caller fills in udata, write_callback,
+ * window_bits, max_chain, dynamic_huffman and work first.  On an invalid
+ * window size st->have_error is set and nothing will be written.
+ */
+void lowdeflate_init(lowdeflate_state *st) {
+	unsigned int wsize;
+
+	st->have_error = 0;
+	if (st->window_bits < LOWDEFLATE_WINDOW_BITS_MIN ||
+			st->window_bits > LOWDEFLATE_WINDOW_BITS_MAX ||
+			st->work == NULL || st->write_callback == NULL) {
+		st->have_error = 1;
+		return;
+	}
+	if (st->max_chain == 0) {
+		st->max_chain = LOWDEFLATE_DEFAULT_CHAIN;
+	}
+
+	wsize = 1U << st->window_bits;
+	st->prev = (unsigned short *) (void *) st->work;
+	st->head = st->prev + wsize;
+	st->window = (unsigned char *) (st->head + LOWDEFLATE_HASH_SIZE);
+	st->syms = st->window + 2 * wsize;
+
+	memset((void *) st->prev, 0, 2 * wsize);
+	memset((void *) st->head, 0, 2 * LOWDEFLATE_HASH_SIZE);
+
+	st->crc32 = 0;
+	st->total_in = 0;
+	st->total_out = 0;
+	st->strstart = 0;
+	st->lookahead = 0;
+	st->sym_count = 0;
+	st->block_start = 0;
+	st->bitbuf = 0;
+	st->bitcount = 0;
+	st->out_len = 0;
+
+	memset((void *) st->lit_freq, 0, sizeof(st->lit_freq));
+	memset((void *) st->dist_freq, 0, sizeof(st->dist_freq));
+}
+
+/* Compress 'len' bytes.  Can be called any number of times with chunks of
+ * any size; output is produced once enough input has been collected.
+ */
+void lowdeflate_write(lowdeflate_state *st, const unsigned char *data, unsigned int len) {
+	unsigned int wsize = 1U << st->window_bits;
+	unsigned int crc = ~st->crc32;
+	unsigned int i;
+
+	if (st->have_error) {
+		return;
+	}
+
+	for (i = 0; i < len; i++) {
+		crc ^= data[i];
+		crc = (crc >> 4) ^ lowdeflate_crc_table[crc & 0x0fU];
+		crc = (crc >> 4) ^ lowdeflate_crc_table[crc & 0x0fU];
+	}
+	st->crc32 = ~crc;
+	st->total_in += len;
+
+	while (len > 0) {
+		unsigned int end = st->strstart + st->lookahead;
+		unsigned int n;
+
+		if (end == 2 * wsize) {
+			/* Sliding drops the start of the pending block out of the
+			 * window.  If it has few matches, emit it now while it can
+			 * still be stored.
+			 */
+			unsigned int block_len = st->strstart - (unsigned int) st->block_start;
+			if (st->block_start >= 0 && st->block_start < (int) wsize &&
+					block_len < st->sym_count + st->sym_count / 8) {
+				lowdeflate_flush_block(st, 0);
+			}
+			lowdeflate_slide(st);
+			end -= wsize;
+		}
+
+		n = 2 * wsize - end;
+		if (n > len) {
+			n = len;
+		}
+		memcpy((void *) (st->window + end), (const void *) data, n);
+		st->lookahead += n;
+		data += n;
+		len -= n;
+
+		lowdeflate_process(st, 0);
+	}
+}
+
+/* Compress the remaining input and terminate the stream with a final
+ * block.  All output has been passed to the write callback on return.
+ */
+void lowdeflate_finish(lowdeflate_state *st) {
+	if (st->have_error) {
+		return;
+	}
+
+	lowdeflate_process(st, 1);
+	lowdeflate_flush_block(st, 1);
+	lowdeflate_align_byte(st);
+	lowdeflate_flush_out(st);
+}
+
+/*
+ *  Containers
+ */
+
+static void lowdeflate_le16(unsigned char *p, unsigned int v) {
+	p[0] = (unsigned char) (v & 0xffU);
+	p[1] = (unsigned char) ((v >> 8) & 0xffU);
+}
+
+static void lowdeflate_le32(unsigned char *p, unsigned int v) {
+	lowdeflate_le16(p, v & 0xffffU);
+	lowdeflate_le16(p + 2, (v >> 16) & 0xffffU);
+}
+
+unsigned int lowdeflate_gzip_header(unsigned char *buf) {
+	memset((void *) buf, 0, LOWDEFLATE_GZIP_HEADER_LENGTH);
+	buf[0] = 0x1f;
+	buf[1] = 0x8b;
+	buf[2] = 8;     /* CM = deflate */
+	buf[9] = 0xff;  /* OS = unknown */
+	return LOWDEFLATE_GZIP_HEADER_LENGTH;
+}
+
+unsigned int lowdeflate_gzip_trailer(lowdeflate_state *st, unsigned char *buf) {
+	lowdeflate_le32(buf, st->crc32);
+	lowdeflate_le32(buf + 4, st->total_in);
+	return LOWDEFLATE_GZIP_TRAILER_LENGTH;
+}
+
+/* Local file header for 'name'.  With st == NULL the CRC and sizes are
+ * left as zero, to be rewritten once the data is compressed.
+ */
+unsigned int lowdeflate_zip_local_header(unsigned char *buf, const char *name, lowdeflate_state *st) {
+	unsigned int name_len = (unsigned int) strlen(name);
+
+	memset((void *) buf, 0, LOWDEFLATE_ZIP_LOCFILE_LENGTH);
+	lowdeflate_le32(buf, 0x04034b50UL);
+	lowdeflate_le16(buf + 4, 20);   /* version needed */
+	lowdeflate_le16(buf + 8, 8);    /* deflate */
+	if (st) {
+		lowdeflate_le32(buf + 14, st->crc32);
+		lowdeflate_le32(buf + 18, st->total_out);
+		lowdeflate_le32(buf + 22, st->total_in);
+	}
+	lowdeflate_le16(buf + 26, name_len);
+	memcpy((void *) (buf + LOWDEFLATE_ZIP_LOCFILE_LENGTH), (const void *) name, name_len);
+	return LOWDEFLATE_ZIP_LOCFILE_LENGTH + name_len;
+}
+
+unsigned int lowdeflate_zip_central_header(unsigned char *buf, const char *name, lowdeflate_state *st, unsigned int lhdr_offset) {
+	unsigned int name_len = (unsigned int) strlen(name);
+
+	memset((void *) buf, 0, LOWDEFLATE_ZIP_CDIRFILE_LENGTH);
+	lowdeflate_le32(buf, 0x02014b50UL);
+	lowdeflate_le16(buf + 4, 20);   /* version made by */
+	lowdeflate_le16(buf + 6, 20);   /* version needed */
+	lowdeflate_le16(buf + 10, 8);   /* deflate */
+	lowdeflate_le32(buf + 16, st->crc32);
+	lowdeflate_le32(buf + 20, st->total_out);
+	lowdeflate_le32(buf + 24, st->total_in);
+	lowdeflate_le16(buf + 28, name_len);
+	lowdeflate_le32(buf + 42, lhdr_offset);
+	memcpy((void *) (buf + LOWDEFLATE_ZIP_CDIRFILE_LENGTH), (const void *) name, name_len);
+	return LOWDEFLATE_ZIP_CDIRFILE_LENGTH + name_len;
+}
+
+unsigned int lowdeflate_zip_end(unsigned char *buf, unsigned int entries, unsigned int cdir_size, unsigned int cdir_offset) {
+	memset((void *) buf, 0, LOWDEFLATE_ZIP_EOCDIR_LENGTH);
+	lowdeflate_le32(buf, 0x06054b50UL);
+	lowdeflate_le16(buf + 8, entries);
+	lowdeflate_le16(buf + 10, entries);
+	lowdeflate_le32(buf + 12, cdir_size);
+	lowdeflate_le32(buf + 16, cdir_offset);
+	return LOWDEFLATE_ZIP_EOCDIR_LENGTH;
+}
@@ -0,0 +1,131 @@
+#if !defined(LOWDEFLATE_H_INCLUDED)
+#define LOWDEFLATE_H_INCLUDED
+
+/* Supported history window sizes: 1kB, 2kB and 4kB. */
+#define LOWDEFLATE_WINDOW_BITS_MIN      10
+#define LOWDEFLATE_WINDOW_BITS_MAX      12
+#define LOWDEFLATE_WINDOW_BITS_DEFAULT  11
+
+/* Match finder hash table size. */
+#define LOWDEFLATE_HASH_BITS            10
+
+/* Number of literal/match symbols buffered before a block is emitted. */
+#define LOWDEFLATE_BLOCK_SYMS           1536
+
+/* Size of the caller provided work area for a given window size:
+ *   2 << wbits bytes for the chain links (16-bit, one per window position),
+ *   2 << LOWDEFLATE_HASH_BITS bytes for the hash heads,
+ *   2 << wbits bytes for history + lookahead,
+ *   3 * LOWDEFLATE_BLOCK_SYMS bytes for the pending block symbols.
+ * That is 10.5kB for a 1kB window and 22.5kB for a 4kB window.
+ */
+#define LOWDEFLATE_WORK_SIZE(wbits) \
+	((2U << (wbits)) + (2U << LOWDEFLATE_HASH_BITS) + (2U << (wbits)) + 3U * LOWDEFLATE_BLOCK_SYMS)
+
+/* Upper bound of the raw deflate output for 'len' input bytes.  Blocks fall
+ * back to static Huffman codes when the history is no longer available for a
+ * stored block, which is at most 9 bits per input byte plus block overhead.
+ */
+#define LOWDEFLATE_BOUND(len)           ((len) + ((len) >> 3) + ((len) >> 9) + 64U)
+
+/* Sizes of the container headers written by the helpers below. */
+#define LOWDEFLATE_GZIP_HEADER_LENGTH   10
+#define LOWDEFLATE_GZIP_TRAILER_LENGTH  8
+#define LOWDEFLATE_ZIP_LOCFILE_LENGTH   30
+#define LOWDEFLATE_ZIP_CDIRFILE_LENGTH  46
+#define LOWDEFLATE_ZIP_EOCDIR_LENGTH    22
+
+/* Write callback, called with chunks of compressed output. */
+typedef void (*lowdeflate_write_callback)(void *udata, const unsigned char *data, unsigned int len);
+
+/* Lowdeflate state structure, allocated and initialized (partially) by the
+ * caller.  The fields in the first group must be set before calling
+ * lowdeflate_init(); the rest is internal state.
+ */
+typedef struct {
+	/* Userdata for the write callback. */
+	void *udata;
+
+	/* User-provided callback receiving the compressed stream. */
+	lowdeflate_write_callback write_callback;
+
+	/* Window size as log2, LOWDEFLATE_WINDOW_BITS_MIN..MAX. */
+	unsigned int window_bits;
+
+	/* Maximum hash chain length to follow, 0 for default.  Longer chains
+	 * give better compression at the cost of speed.
+	 */
+	unsigned int max_chain;
+
+	/* Non-zero to allow dynamic Huffman blocks.  With zero only static
+	 * Huffman and stored blocks are emitted, which is faster.
+	 */
+	int dynamic_huffman;
+
+	/* Work area of LOWDEFLATE_WORK_SIZE(window_bits) bytes, 16-bit aligned. */
+	unsigned char *work;
+
+	/* Error flag, set on invalid configuration. */
+	int have_error;
+
+	/* Running CRC-32 (ZIP/gzip polynomial) and byte counts. */
+	unsigned int crc32;
+	unsigned int total_in;
+	unsigned int total_out;
+
+	/* Match finder state, pointing into 'work'. */
+	unsigned short *prev;
+	unsigned short *head;
+	unsigned char *window;
+	unsigned char *syms;
+	unsigned int strstart;
+	unsigned int lookahead;
+	unsigned int sym_count;
+	int block_start;
+
+	/* Bit writer and small output buffer. */
+	unsigned int bitbuf;
+	unsigned int bitcount;
+	unsigned int out_len;
+	unsigned char out[64];
+
+	/* Per block symbol statistics and Huffman codes.  The literal/length
+	 * code covers 288 symbols as the static code assigns the two unused
+	 * ones too.
+	 */
+	unsigned short lit_freq[286];
+	unsigned short dist_freq[30];
+	unsigned short bl_freq[19];
+	unsigned short lit_code[288];
+	unsigned short dist_code[30];
+	unsigned short bl_code[19];
+	unsigned char lit_len[288];
+	unsigned char dist_len[30];
+	unsigned char bl_len[19];
+
+	/* Run-length encoded code lengths for the dynamic block header. */
+	unsigned short rle[286 + 30];
+
+	/* Scratch area for Huffman code length construction. */
+	unsigned int weight[2 * 286];
+	unsigned short parent[2 * 286];
+	unsigned short order[286];
+} lowdeflate_state;
+
+/* Raw deflate API */
+extern void lowdeflate_init(lowdeflate_state *st);
+extern void lowdeflate_write(lowdeflate_state *st, const unsigned char *data, unsigned int len);
+extern void lowdeflate_finish(lowdeflate_state *st);
+
+/* Container helpers.  These fill 'buf' and return the number of bytes
+ * written.  ZIP headers need the CRC and sizes, so a streaming writer emits
+ * the local header with zeroes first and rewrites it after
+ * lowdeflate_finish().
+ */
+extern unsigned int lowdeflate_gzip_header(unsigned char *buf);
+extern unsigned int lowdeflate_gzip_trailer(lowdeflate_state *st, unsigned char *buf);
+extern unsigned int lowdeflate_zip_local_header(unsigned char *buf, const char *name, lowdeflate_state *st);
+extern unsigned int lowdeflate_zip_central_header(unsigned char *buf, const char *name, lowdeflate_state *st, unsigned int lhdr_offset);
+extern unsigned int lowdeflate_zip_end(unsigned char *buf, unsigned int entries, unsigned int cdir_size, unsigned int cdir_offset);
+
+#endif  /* LOWDEFLATE_H_INCLUDED */
@@ -0,0 +1,190 @@
+/*
+	Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC firmware.
+
+	The VESC firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "spsc_rb.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Private functions
+static unsigned int count_between(spsc_rb_t *rb, unsigned int head, unsigned int tail);
+static unsigned int advance(spsc_rb_t *rb, unsigned int ind, unsigned int n);
+static void copy_in(spsc_rb_t *rb, unsigned int head, const void *data, unsigned int count);
+static void copy_out(spsc_rb_t *rb, unsigned int tail, void *data, unsigned int count);
+
+void spsc_rb_init(spsc_rb_t *rb, void *buffer, int item_size, int item_count) {
+	rb->data = buffer;
+	rb->item_size = item_size;
+	rb->item_count = item_count;
+	atomic_init(&rb->head, 0);
+	atomic_init(&rb->tail, 0);
+}
+
+void spsc_rb_init_alloc(spsc_rb_t *rb, int item_size, int item_count) {
+	void *buffer = malloc(item_size * item_count);
+	spsc_rb_init(rb, buffer, item_size, item_count);
+}
+
+void spsc_rb_free(spsc_rb_t *rb) {
+	free(rb->data);
+}
+
+void spsc_rb_flush(spsc_rb_t *rb) {
+	unsigned int head = atomic_load_explicit(&rb->head, memory_order_acquire);
+	atomic_store_explicit(&rb->tail, head, memory_order_release);
+}
+
+bool spsc_rb_insert(spsc_rb_t *rb, const void *data) {
+	return spsc_rb_insert_multi(rb, data, 1) == 1;
+}
+
+unsigned int spsc_rb_insert_multi(spsc_rb_t *rb, const void *data, unsigned int count) {
+	unsigned int head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+	unsigned int tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	unsigned int space = rb->item_count - count_between(rb, head, tail);
+
+	if (count > space) {
+		count = space;
+	}
+
+	if (count == 0) {
+		return 0;
+	}
+
+	copy_in(rb, head, data, count);
+	atomic_store_explicit(&rb->head, advance(rb, head, count), memory_order_release);
+
+	return count;
+}
+
+bool spsc_rb_pop(spsc_rb_t *rb, void *data) {
+	return spsc_rb_pop_multi(rb, data, 1) == 1;
+}
+
+unsigned int spsc_rb_pop_multi(spsc_rb_t *rb, void *data, unsigned int count) {
+	unsigned int tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+	unsigned int head = atomic_load_explicit(&rb->head, memory_order_acquire);
+	unsigned int avail = count_between(rb, head, tail);
+
+	if (count > avail) {
+		count = avail;
+	}
+
+	if (count == 0) {
+		return 0;
+	}
+
+	// Null will just advance the tail and discard the data
+	if (data) {
+		copy_out(rb, tail, data, count);
+	}
+
+	atomic_store_explicit(&rb->tail, advance(rb, tail, count), memory_order_release);
+
+	return count;
+}
+
+/**
+ * Get a pointer to the oldest item without removing it. The item stays valid
+ * until it is popped, so it can be processed in place and then dropped with
+ * spsc_rb_pop(rb, 0).
+ *
+ * @return
+ * Pointer to the item, or 0 if the buffer is empty.
+ */
+void *spsc_rb_peek(spsc_rb_t *rb) {
+	unsigned int tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+	unsigned int head = atomic_load_explicit(&rb->head, memory_order_acquire);
+
+	if (head == tail) {
+		return 0;
+	}
+
+	unsigned int pos = tail >= rb->item_count ? tail - rb->item_count : tail;
+	return (char*)rb->data + pos * rb->item_size;
+}
+
+bool spsc_rb_is_full(spsc_rb_t *rb) {
+	return spsc_rb_get_item_count(rb) == rb->item_count;
+}
+
+bool spsc_rb_is_empty(spsc_rb_t *rb) {
+	return spsc_rb_get_item_count(rb) == 0;
+}
+
+unsigned int spsc_rb_get_item_count(spsc_rb_t *rb) {
+	unsigned int head = atomic_load_explicit(&rb->head, memory_order_acquire);
+	unsigned int tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	return count_between(rb, head, tail);
+}
+
+unsigned int spsc_rb_get_free_space(spsc_rb_t *rb) {
+	return rb->item_count - spsc_rb_get_item_count(rb);
+}
+
+// Private function implementations
+
+static unsigned int count_between(spsc_rb_t *rb, unsigned int head, unsigned int tail) {
+	if (head >= tail) {
+		return head - tail;
+	} else {
+		return 2 * rb->item_count - tail + head;
+	}
+}
+
+static unsigned int advance(spsc_rb_t *rb, unsigned int ind, unsigned int n) {
+	ind += n;
+	if (ind >= 2 * rb->item_count) {
+		ind -= 2 * rb->item_count;
+	}
+	return ind;
+}
+
+// Copy count items starting at index head into the buffer. The region wraps
+// at most once, so this is one or two memcpy.
+static void copy_in(spsc_rb_t *rb, unsigned int head, const void *data, unsigned int count) {
+	unsigned int pos = head >= rb->item_count ? head - rb->item_count : head;
+	unsigned int first = rb->item_count - pos;
+
+	if (first > count) {
+		first = count;
+	}
+
+	memcpy((char*)rb->data + pos * rb->item_size, data, first * rb->item_size);
+
+	if (count > first) {
+		memcpy(rb->data, (const char*)data + first * rb->item_size,
+				(count - first) * rb->item_size);
+	}
+}
+
+static void copy_out(spsc_rb_t *rb, unsigned int tail, void *data, unsigned int count) {
+	unsigned int pos = tail >= rb->item_count ? tail - rb->item_count : tail;
+	unsigned int first = rb->item_count - pos;
+
+	if (first > count) {
+		first = count;
+	}
+
+	memcpy(data, (char*)rb->data + pos * rb->item_size, first * rb->item_size);
+
+	if (count > first) {
+		memcpy((char*)data + first * rb->item_size, rb->data,
+				(count - first) * rb->item_size);
+	}
+}
@@ -0,0 +1,63 @@
+/*
+	Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+	This file is part of the VESC firmware.
+
+	The VESC firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The VESC firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef SPSC_RB_H_
+#define SPSC_RB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/*
+ * Lock-free ring buffer for exactly one producer and one consumer, e.g. an ISR
+ * or driver task handing items to a processing task. It has the same API shape
+ * as rb_t, but no mutex: the producer only writes head and the consumer only
+ * writes tail, and the indices are published with release stores and read with
+ * acquire loads. Only plain atomic loads and stores are used, so it also works
+ * on cores without atomic read-modify-write instructions.
+ *
+ * Functions marked (producer) or (consumer) must only be called from that side.
+ * The others can be called from either side and give a snapshot.
+ */
+
+typedef struct {
+	void *data;
+	unsigned int item_size;
+	unsigned int item_count;
+	// Both indices run from 0 to 2 * item_count - 1 so that a full buffer can be
+	// told apart from an empty one without a separate flag.
+	atomic_uint head;
+	atomic_uint tail;
+} spsc_rb_t;
+
+void spsc_rb_init(spsc_rb_t *rb, void *buffer, int item_size, int item_count);
+void spsc_rb_init_alloc(spsc_rb_t *rb, int item_size, int item_count);
+void spsc_rb_free(spsc_rb_t *rb);
+void spsc_rb_flush(spsc_rb_t *rb); // (consumer)
+bool spsc_rb_insert(spsc_rb_t *rb, const void *data); // (producer)
+unsigned int spsc_rb_insert_multi(spsc_rb_t *rb, const void *data, unsigned int count); // (producer)
+bool spsc_rb_pop(spsc_rb_t *rb, void *data); // (consumer)
+unsigned int spsc_rb_pop_multi(spsc_rb_t *rb, void *data, unsigned int count); // (consumer)
+void *spsc_rb_peek(spsc_rb_t *rb); // (consumer)
+bool spsc_rb_is_full(spsc_rb_t *rb);
+bool spsc_rb_is_empty(spsc_rb_t *rb);
+unsigned int spsc_rb_get_item_count(spsc_rb_t *rb);
+unsigned int spsc_rb_get_free_space(spsc_rb_t *rb);
+
+#endif
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Builds and runs the firmware host tests. A test passes when it exits
+# with 0 and prints SUCCESS.
+
+cd "$(dirname "$0")"
+
+echo "BUILDING HOST TESTS"
+make -s all || exit 1
+
+success_count=0
+fail_count=0
+failing_tests=()
+
+for exe in *.exe; do
+    echo "Running: $exe"
+    tmp_file=$(mktemp)
+    ./$exe > $tmp_file 2>&1
+    result=$?
+    cat $tmp_file
+
+    if [ $result -eq 0 ] && grep -q "SUCCESS" $tmp_file; then
+        echo "$exe: PASSED"
+        success_count=$((success_count+1))
+    else
+        echo "$exe: FAILED"
+        failing_tests+=("$exe")
+        fail_count=$((fail_count+1))
+    fi
+    rm -f $tmp_file
+done
+
+echo "Tests passed: $success_count"
+echo "Tests failed: $fail_count"
+
+if [ $fail_count -gt 0 ]; then
+    for t in "${failing_tests[@]}"; do
+        echo "  $t"
+    done
+    exit 1
+fi
+
+exit 0
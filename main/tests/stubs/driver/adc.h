@@ -0,0 +1,6 @@
+#ifndef STUBS_DRIVER_ADC_H_
+#define STUBS_DRIVER_ADC_H_
+
+typedef int adc1_channel_t;
+
+#endif
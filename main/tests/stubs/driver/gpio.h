@@ -0,0 +1,30 @@
+#ifndef STUBS_DRIVER_GPIO_H_
+#define STUBS_DRIVER_GPIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+	GPIO_PULLUP_ONLY,
+	GPIO_PULLDOWN_ONLY,
+	GPIO_PULLUP_PULLDOWN,
+	GPIO_FLOATING,
+} gpio_pull_mode_t;
+
+typedef enum {
+	GPIO_MODE_DISABLE,
+	GPIO_MODE_INPUT,
+	GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio);
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio, gpio_pull_mode_t pull);
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode);
+void esp_rom_gpio_pad_select_gpio(uint32_t gpio);
+void esp_rom_gpio_connect_out_signal(uint32_t gpio, uint32_t signal, bool out_inv, bool oen_inv);
+void esp_rom_gpio_connect_in_signal(uint32_t gpio, uint32_t signal, bool inv);
+
+#endif
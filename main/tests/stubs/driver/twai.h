@@ -0,0 +1,87 @@
+// Host stand-in for the TWAI (CAN) driver. Frames passed to twai_transmit
+// go to the callback set with host_twai_set_tx_callback and twai_receive
+// returns the frames queued with host_twai_inject, see host_stubs.h.
+
+#ifndef STUBS_DRIVER_TWAI_H_
+#define STUBS_DRIVER_TWAI_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+
+typedef enum {
+	TWAI_MODE_NORMAL,
+	TWAI_MODE_NO_ACK,
+	TWAI_MODE_LISTEN_ONLY,
+} twai_mode_t;
+
+typedef enum {
+	TWAI_STATE_STOPPED,
+	TWAI_STATE_RUNNING,
+	TWAI_STATE_BUS_OFF,
+	TWAI_STATE_RECOVERING,
+} twai_state_t;
+
+typedef struct {
+	union {
+		struct {
+			uint32_t extd: 1;
+			uint32_t rtr: 1;
+			uint32_t ss: 1;
+			uint32_t self: 1;
+			uint32_t dlc_non_comp: 1;
+			uint32_t reserved: 27;
+		};
+		uint32_t flags;
+	};
+	uint32_t identifier;
+	uint8_t data_length_code;
+	uint8_t data[8];
+} twai_message_t;
+
+typedef struct {
+	uint32_t kbits;
+} twai_timing_config_t;
+
+typedef struct {
+	uint32_t acceptance_code;
+	uint32_t acceptance_mask;
+	bool single_filter;
+} twai_filter_config_t;
+
+typedef struct {
+	twai_mode_t mode;
+	gpio_num_t tx_io;
+	gpio_num_t rx_io;
+	uint32_t tx_queue_len;
+	uint32_t rx_queue_len;
+} twai_general_config_t;
+
+typedef struct {
+	twai_state_t state;
+} twai_status_info_t;
+
+#define TWAI_TIMING_CONFIG_10KBITS()	{.kbits = 10}
+#define TWAI_TIMING_CONFIG_20KBITS()	{.kbits = 20}
+#define TWAI_TIMING_CONFIG_50KBITS()	{.kbits = 50}
+#define TWAI_TIMING_CONFIG_100KBITS()	{.kbits = 100}
+#define TWAI_TIMING_CONFIG_125KBITS()	{.kbits = 125}
+#define TWAI_TIMING_CONFIG_250KBITS()	{.kbits = 250}
+#define TWAI_TIMING_CONFIG_500KBITS()	{.kbits = 500}
+#define TWAI_TIMING_CONFIG_1MBITS()		{.kbits = 1000}
+#define TWAI_FILTER_CONFIG_ACCEPT_ALL()	{.acceptance_code = 0, .acceptance_mask = 0xFFFFFFFF, .single_filter = true}
+#define TWAI_GENERAL_CONFIG_DEFAULT(tx, rx, op_mode) \
+	{.mode = op_mode, .tx_io = tx, .rx_io = rx, .tx_queue_len = 5, .rx_queue_len = 5}
+
+esp_err_t twai_driver_install(const twai_general_config_t *g_config,
+		const twai_timing_config_t *t_config, const twai_filter_config_t *f_config);
+esp_err_t twai_driver_uninstall(void);
+esp_err_t twai_start(void);
+esp_err_t twai_stop(void);
+esp_err_t twai_transmit(const twai_message_t *message, TickType_t ticks_to_wait);
+esp_err_t twai_receive(twai_message_t *message, TickType_t ticks_to_wait);
+esp_err_t twai_get_status_info(twai_status_info_t *status_info);
+esp_err_t twai_initiate_recovery(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef STUBS_ESP_VFS_FAT_H_
+#define STUBS_ESP_VFS_FAT_H_
+
+#include "esp_err.h"
+
+#endif
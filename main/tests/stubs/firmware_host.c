@@ -0,0 +1,57 @@
+#include <stddef.h>
+
+#include "host_stubs.h"
+#include "main.h"
+#include "commands.h"
+#include "bms.h"
+#include "lispif.h"
+#include "log.h"
+#include "nmea.h"
+#include "ublox.h"
+
+volatile backup_data backup;
+
+static host_packet_cb packet_callback = NULL;
+static nmea_state_t nmea_state;
+
+void host_set_packet_callback(host_packet_cb cb) {
+	packet_callback = cb;
+}
+
+void commands_process_packet(unsigned char *data, unsigned int len, send_func_t reply_func) {
+	if (packet_callback) {
+		packet_callback(data, len, reply_func);
+	}
+}
+
+void commands_send_packet(unsigned char *data, unsigned int len) {
+	(void)data; (void)len;
+}
+
+void commands_send_packet_can_last(unsigned char *data, unsigned int len) {
+	(void)data; (void)len;
+}
+
+void main_store_backup_data(void) {
+}
+
+bool bms_process_can_frame(uint32_t can_id, uint8_t *data8, int len, bool is_ext) {
+	(void)can_id; (void)data8; (void)len; (void)is_ext;
+	return false;
+}
+
+void lispif_process_can(uint32_t can_id, uint8_t *data8, int len, bool is_ext) {
+	(void)can_id; (void)data8; (void)len; (void)is_ext;
+}
+
+void log_process_packet(unsigned char *data, unsigned int len) {
+	(void)data; (void)len;
+}
+
+nmea_state_t *nmea_get_state(void) {
+	return &nmea_state;
+}
+
+bool ublox_init_ok(void) {
+	return false;
+}
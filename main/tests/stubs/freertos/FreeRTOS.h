@@ -0,0 +1,29 @@
+// Host stand-in for the FreeRTOS API used by the firmware modules under
+// test. Tasks are pthreads, semaphores are built on a mutex and a condition
+// variable and one tick is one millisecond of CLOCK_MONOTONIC time.
+
+#ifndef STUBS_FREERTOS_H_
+#define STUBS_FREERTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE						1
+#define pdFALSE						0
+#define pdPASS						pdTRUE
+#define pdFAIL						pdFALSE
+
+#define portMAX_DELAY				0xFFFFFFFFu
+#define configTICK_RATE_HZ			1000
+#define portTICK_PERIOD_MS			(1000 / configTICK_RATE_HZ)
+#define tskNO_AFFINITY				0x7FFFFFFF
+#define configMAX_PRIORITIES		25
+
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef STUBS_FREERTOS_SEMPHR_H_
+#define STUBS_FREERTOS_SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#endif
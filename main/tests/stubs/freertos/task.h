@@ -0,0 +1,16 @@
+#ifndef STUBS_FREERTOS_TASK_H_
+#define STUBS_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t func, const char *name, uint32_t stack,
+		void *arg, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core);
+
+#endif
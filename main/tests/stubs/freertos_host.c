@@ -0,0 +1,143 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+struct host_semaphore {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int count;
+};
+
+typedef struct {
+	pthread_t thread;
+	TaskFunction_t func;
+	void *arg;
+} host_task;
+
+static __thread host_task *current_task = NULL;
+
+static uint64_t now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+TickType_t xTaskGetTickCount(void) {
+	static uint64_t start = 0;
+	if (start == 0) {
+		start = now_ms();
+	}
+	return (TickType_t)(now_ms() - start);
+}
+
+void vTaskDelay(TickType_t ticks) {
+	if (ticks == 0) {
+		sched_yield();
+		return;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = ticks / 1000;
+	ts.tv_nsec = (long)(ticks % 1000) * 1000000;
+	nanosleep(&ts, NULL);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+	// Only deleting the calling task is supported
+	if (task == NULL) {
+		pthread_exit(NULL);
+	}
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return current_task;
+}
+
+static void *task_start(void *arg) {
+	current_task = arg;
+	current_task->func(current_task->arg);
+	return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t func, const char *name, uint32_t stack,
+		void *arg, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core) {
+	(void)name; (void)stack; (void)prio; (void)core;
+
+	host_task *task = malloc(sizeof(host_task));
+	task->func = func;
+	task->arg = arg;
+
+	if (handle) {
+		*handle = task;
+	}
+
+	if (pthread_create(&task->thread, NULL, task_start, task) != 0) {
+		return pdFAIL;
+	}
+	pthread_detach(task->thread);
+	return pdPASS;
+}
+
+static SemaphoreHandle_t sem_create(int count) {
+	SemaphoreHandle_t sem = malloc(sizeof(struct host_semaphore));
+	pthread_mutex_init(&sem->mutex, NULL);
+	pthread_cond_init(&sem->cond, NULL);
+	sem->count = count;
+	return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+	return sem_create(0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+	return sem_create(1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += ticks / 1000;
+	deadline.tv_nsec += (long)(ticks % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&sem->mutex);
+	while (sem->count == 0) {
+		if (ticks == 0) {
+			break;
+		} else if (ticks == portMAX_DELAY) {
+			pthread_cond_wait(&sem->cond, &sem->mutex);
+		} else if (pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline) == ETIMEDOUT) {
+			break;
+		}
+	}
+
+	BaseType_t res = pdFALSE;
+	if (sem->count > 0) {
+		sem->count--;
+		res = pdTRUE;
+	}
+	pthread_mutex_unlock(&sem->mutex);
+	return res;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+	BaseType_t res = pdFALSE;
+	pthread_mutex_lock(&sem->mutex);
+	if (sem->count == 0) {
+		sem->count = 1;
+		res = pdTRUE;
+		pthread_cond_signal(&sem->cond);
+	}
+	pthread_mutex_unlock(&sem->mutex);
+	return res;
+}
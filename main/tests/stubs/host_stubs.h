@@ -0,0 +1,28 @@
+// Hooks into the host stand-ins for the ESP-IDF, FreeRTOS and the firmware
+// modules that are not under test.
+
+#ifndef STUBS_HOST_STUBS_H_
+#define STUBS_HOST_STUBS_H_
+
+#include <stdbool.h>
+#include "driver/twai.h"
+#include "commands.h"
+
+typedef void (*host_twai_tx_cb)(const twai_message_t *msg);
+typedef void (*host_packet_cb)(unsigned char *data, unsigned int len, send_func_t reply_func);
+
+// Called with every frame passed to twai_transmit, from the transmitting
+// thread. NULL drops the frames.
+void host_twai_set_tx_callback(host_twai_tx_cb cb);
+
+// Queues a frame for twai_receive. Blocks while the receive queue is full,
+// which works as back pressure for the senders instead of losing frames.
+// With a bit rate set the frames are also spaced by the time they take on
+// the bus, with one bus shared by all threads that inject frames.
+void host_twai_inject(const twai_message_t *msg);
+void host_twai_set_bitrate(int kbits);
+
+// Called from commands_process_packet.
+void host_set_packet_callback(host_packet_cb cb);
+
+#endif
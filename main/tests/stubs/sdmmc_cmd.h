@@ -0,0 +1,4 @@
+#ifndef STUBS_SDMMC_CMD_H_
+#define STUBS_SDMMC_CMD_H_
+
+#endif
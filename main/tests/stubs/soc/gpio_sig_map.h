@@ -0,0 +1,8 @@
+#ifndef STUBS_SOC_GPIO_SIG_MAP_H_
+#define STUBS_SOC_GPIO_SIG_MAP_H_
+
+#define SIG_GPIO_OUT_IDX			128
+#define TWAI_TX_IDX					74
+#define TWAI_RX_IDX					74
+
+#endif
@@ -0,0 +1,472 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "host_stubs.h"
+#include "comm_can.h"
+#include "buffer.h"
+#include "crc.h"
+#include "main.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Several nodes sending buffers to the same receiver at the same time. The
+// receiver is the real comm_can running on the host TWAI bus at 500 kbit/s.
+// The other nodes are simulated here: windowed senders follow the protocol
+// of comm_can_send_buffer_win and legacy senders send the frames of
+// comm_can_send_buffer. The receiver also sends to itself with the real
+// comm_can_send_buffer_win in one of the runs.
+
+#define RX_ID				1
+#define SENDER_FIRST_ID		10
+#define SENDER_NUM			4
+#define BUFFERS_PER_SENDER	15
+#define BUFFER_LEN_MAX		500
+
+// Same as in comm_can.c
+#define WIN_MODE_START		0x40
+#define WIN_MODE_POLL		0x41
+#define WIN_MODE_ACK		0x44
+#define WIN_MODE_DATA		0x80
+#define WIN_CHUNK_LEN		6
+#define WIN_SIZE			32
+#define WIN_ACK_TIMEOUT_MS	20
+#define WIN_RETRIES			8
+#define WIN_ACK_PENDING		0
+#define WIN_ACK_DONE		1
+#define WIN_ACK_NO_SLOT		2
+#define WIN_SLOT_NUM		4
+
+typedef struct {
+	int id;
+	bool windowed;
+	unsigned int seed;
+	int sent;
+	int acked;
+	uint8_t seq;
+	bool drop_start;
+	bool drop_done;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool ack_ready;
+	uint8_t ack_status;
+	uint8_t ack_next;
+	uint32_t ack_map;
+} sim_sender;
+
+static sim_sender senders[SENDER_NUM];
+static int loss_permille = 0;
+static unsigned int loss_seed = 1;
+static pthread_mutex_t loss_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t rx_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int delivered[256];
+static int delivered_bytes = 0;
+static int corrupted = 0;
+
+static bool frame_lost(void) {
+	pthread_mutex_lock(&loss_mutex);
+	bool lost = (rand_r(&loss_seed) % 1000) < loss_permille;
+	pthread_mutex_unlock(&loss_mutex);
+	return lost;
+}
+
+static void put_frame(uint32_t eid, const uint8_t *data, int len) {
+	twai_message_t msg = {0};
+	msg.extd = 1;
+	msg.identifier = eid;
+	msg.data_length_code = len;
+	memcpy(msg.data, data, len);
+	if (!frame_lost()) {
+		host_twai_inject(&msg);
+	}
+}
+
+// Start frames from WIN_SLOT_NUM other nodes, so that all slots that are
+// free are taken.
+static void start_others(void) {
+	for (int i = 0;i < WIN_SLOT_NUM;i++) {
+		uint8_t frame[8];
+		int32_t ind = 0;
+		frame[ind++] = SENDER_FIRST_ID + SENDER_NUM + i;
+		frame[ind++] = WIN_MODE_START;
+		frame[ind++] = 0;
+		frame[ind++] = 2;
+		buffer_append_uint16(frame, BUFFER_LEN_MAX, &ind);
+		buffer_append_uint16(frame, 0, &ind);
+		put_frame(RX_ID | ((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), frame, ind);
+	}
+}
+
+// Frames sent by the receiver. Acks to the simulated senders are handed to
+// them, frames to the receiver itself are looped back.
+static void bus_tx(const twai_message_t *msg) {
+	int dest = msg->identifier & 0xFF;
+	int cmd = msg->identifier >> 8;
+
+	if (dest == RX_ID) {
+		put_frame(msg->identifier, msg->data, msg->data_length_code);
+		return;
+	}
+
+	int s = dest - SENDER_FIRST_ID;
+	if (s < 0 || s >= SENDER_NUM || cmd != CAN_PACKET_PROCESS_SHORT_BUFFER ||
+			msg->data_length_code < 8 || (msg->data[1] & ~0x03) != WIN_MODE_ACK ||
+			frame_lost()) {
+		return;
+	}
+
+	sim_sender *snd = &senders[s];
+	int32_t ind = 3;
+
+	if (snd->drop_done && (msg->data[1] & 0x03) == WIN_ACK_DONE) {
+		snd->drop_done = false;
+		start_others();
+		return;
+	}
+
+	pthread_mutex_lock(&snd->mutex);
+	if (msg->data[2] == snd->seq) {
+		snd->ack_status = msg->data[1] & 0x03;
+		snd->ack_next = msg->data[ind++];
+		snd->ack_map = buffer_get_uint32(msg->data, &ind);
+		snd->ack_ready = true;
+		pthread_cond_signal(&snd->cond);
+	}
+	pthread_mutex_unlock(&snd->mutex);
+}
+
+// The buffer content is a function of the sender and the sequence number,
+// so that the receiver can check it.
+static int make_buffer(uint8_t *buffer, int sender, int seq) {
+	unsigned int seed = sender * 1000 + seq;
+	int len = 7 + rand_r(&seed) % (BUFFER_LEN_MAX - 6);
+	buffer[0] = sender;
+	buffer[1] = seq;
+	for (int i = 2;i < len;i++) {
+		buffer[i] = rand_r(&seed);
+	}
+	return len;
+}
+
+static void packet_received(unsigned char *data, unsigned int len, send_func_t reply_func) {
+	(void)reply_func;
+	uint8_t expected[BUFFER_LEN_MAX];
+	int exp_len = make_buffer(expected, data[0], data[1]);
+
+	pthread_mutex_lock(&rx_mutex);
+	if ((int)len == exp_len && memcmp(data, expected, len) == 0) {
+		delivered[data[0]]++;
+		delivered_bytes += len;
+	} else {
+		corrupted++;
+	}
+	pthread_mutex_unlock(&rx_mutex);
+}
+
+static bool wait_ack(sim_sender *snd) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_nsec += WIN_ACK_TIMEOUT_MS * 1000000L;
+	deadline.tv_sec += deadline.tv_nsec / 1000000000;
+	deadline.tv_nsec %= 1000000000;
+
+	pthread_mutex_lock(&snd->mutex);
+	while (!snd->ack_ready) {
+		if (pthread_cond_timedwait(&snd->cond, &snd->mutex, &deadline) != 0) {
+			break;
+		}
+	}
+	bool res = snd->ack_ready;
+	pthread_mutex_unlock(&snd->mutex);
+	return res;
+}
+
+static bool send_windowed(sim_sender *snd, uint8_t *data, int len) {
+	int chunks = (len + WIN_CHUNK_LEN - 1) / WIN_CHUNK_LEN;
+	uint16_t crc = crc16(data, len);
+	bool acked[(BUFFER_LEN_MAX + WIN_CHUNK_LEN - 1) / WIN_CHUNK_LEN];
+	uint8_t frame[8];
+	int next = 0;
+	int retries = 0;
+	bool restart = true;
+
+	pthread_mutex_lock(&snd->mutex);
+	snd->seq++;
+	pthread_mutex_unlock(&snd->mutex);
+
+	while (retries <= WIN_RETRIES) {
+		int32_t ind = 0;
+
+		if (restart) {
+			frame[ind++] = snd->id;
+			frame[ind++] = WIN_MODE_START;
+			frame[ind++] = snd->seq;
+			frame[ind++] = 2;
+			buffer_append_uint16(frame, len, &ind);
+			buffer_append_uint16(frame, crc, &ind);
+			if (snd->drop_start) {
+				snd->drop_start = false;
+			} else {
+				put_frame(RX_ID | ((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), frame, ind);
+			}
+			memset(acked, 0, sizeof(acked));
+			next = 0;
+			restart = false;
+		}
+
+		for (int i = next;i < chunks && i < (next + WIN_SIZE);i++) {
+			if (acked[i]) {
+				continue;
+			}
+
+			int offset = i * WIN_CHUNK_LEN;
+			int send_len = len - offset < WIN_CHUNK_LEN ? len - offset : WIN_CHUNK_LEN;
+			frame[0] = snd->id;
+			frame[1] = WIN_MODE_DATA | i;
+			memcpy(frame + 2, data + offset, send_len);
+			put_frame(RX_ID | ((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), frame, send_len + 2);
+		}
+
+		pthread_mutex_lock(&snd->mutex);
+		snd->ack_ready = false;
+		pthread_mutex_unlock(&snd->mutex);
+
+		ind = 0;
+		frame[ind++] = snd->id;
+		frame[ind++] = WIN_MODE_POLL;
+		frame[ind++] = snd->seq;
+		buffer_append_uint16(frame, crc, &ind);
+		put_frame(RX_ID | ((uint32_t)CAN_PACKET_PROCESS_SHORT_BUFFER << 8), frame, ind);
+
+		if (!wait_ack(snd)) {
+			retries++;
+			continue;
+		}
+
+		if (snd->ack_status == WIN_ACK_DONE) {
+			return true;
+		} else if (snd->ack_status == WIN_ACK_NO_SLOT) {
+			restart = true;
+			retries++;
+			continue;
+		} else if (snd->ack_status != WIN_ACK_PENDING) {
+			return false;
+		}
+
+		int ack_next = snd->ack_next;
+		retries = ack_next > next ? 0 : retries + 1;
+		for (int i = next;i < ack_next && i < chunks;i++) {
+			acked[i] = true;
+		}
+		for (int i = 0;i < 32 && (ack_next + i) < chunks;i++) {
+			if (snd->ack_map & (1u << i)) {
+				acked[ack_next + i] = true;
+			}
+		}
+		next = ack_next;
+	}
+
+	return false;
+}
+
+static void send_legacy(sim_sender *snd, uint8_t *data, int len) {
+	uint8_t frame[8];
+	int i = 0;
+
+	for (;i < len && i <= 255;i += 7) {
+		int send_len = len - i < 7 ? len - i : 7;
+		frame[0] = i;
+		memcpy(frame + 1, data + i, send_len);
+		put_frame(RX_ID | ((uint32_t)CAN_PACKET_FILL_RX_BUFFER << 8), frame, send_len + 1);
+	}
+
+	for (;i < len;i += 6) {
+		int send_len = len - i < 6 ? len - i : 6;
+		frame[0] = i >> 8;
+		frame[1] = i & 0xFF;
+		memcpy(frame + 2, data + i, send_len);
+		put_frame(RX_ID | ((uint32_t)CAN_PACKET_FILL_RX_BUFFER_LONG << 8), frame, send_len + 2);
+	}
+
+	uint16_t crc = crc16(data, len);
+	frame[0] = snd->id;
+	frame[1] = 2;
+	frame[2] = len >> 8;
+	frame[3] = len & 0xFF;
+	frame[4] = crc >> 8;
+	frame[5] = crc & 0xFF;
+	put_frame(RX_ID | ((uint32_t)CAN_PACKET_PROCESS_RX_BUFFER << 8), frame, 6);
+}
+
+static void *sender_thread(void *arg) {
+	sim_sender *snd = arg;
+	uint8_t buffer[BUFFER_LEN_MAX];
+
+	for (int seq = 0;seq < BUFFERS_PER_SENDER;seq++) {
+		int len = make_buffer(buffer, snd->id, seq);
+		snd->sent++;
+		if (snd->windowed) {
+			if (send_windowed(snd, buffer, len)) {
+				snd->acked++;
+			}
+		} else {
+			send_legacy(snd, buffer, len);
+		}
+
+		// Desynchronize the senders a bit
+		vTaskDelay(rand_r(&snd->seed) % 3);
+	}
+
+	return NULL;
+}
+
+// Runs sim_num simulated senders and, with local_send, the real
+// comm_can_send_buffer_win at the same time. Returns false if any windowed
+// buffer was not delivered exactly once.
+static bool run(const char *name, int sim_num, bool windowed, bool local_send, int loss) {
+	pthread_t threads[SENDER_NUM];
+	int local_sent = 0;
+	int local_acked = 0;
+
+	loss_permille = loss;
+	memset(delivered, 0, sizeof(delivered));
+	delivered_bytes = 0;
+	corrupted = 0;
+
+	TickType_t start = xTaskGetTickCount();
+
+	for (int i = 0;i < sim_num;i++) {
+		sim_sender *snd = &senders[i];
+		snd->windowed = windowed;
+		snd->sent = 0;
+		snd->acked = 0;
+		snd->seed = i + 1;
+		pthread_create(&threads[i], NULL, sender_thread, snd);
+	}
+
+	if (local_send) {
+		uint8_t buffer[BUFFER_LEN_MAX];
+		for (int seq = 0;seq < BUFFERS_PER_SENDER;seq++) {
+			int len = make_buffer(buffer, RX_ID, seq);
+			local_sent++;
+			if (comm_can_send_buffer_win(RX_ID, buffer, len, 2)) {
+				local_acked++;
+			}
+		}
+	}
+
+	for (int i = 0;i < sim_num;i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	// Let the receiver finish the last buffers
+	vTaskDelay(50);
+
+	TickType_t time = xTaskGetTickCount() - start;
+	int sent = local_sent;
+	int acked = local_acked;
+	int total = delivered[RX_ID];
+	bool ok = corrupted == 0 && delivered[RX_ID] == local_acked && local_acked == local_sent;
+
+	for (int i = 0;i < sim_num;i++) {
+		sim_sender *snd = &senders[i];
+		sent += snd->sent;
+		acked += snd->acked;
+		total += delivered[snd->id];
+		if (windowed && (snd->acked != snd->sent || delivered[snd->id] != snd->sent)) {
+			ok = false;
+		}
+	}
+
+	printf("%-28s %3d/%3d delivered, %3d acked, %d corrupted, %4.1f kB/s\n",
+			name, total, sent, acked, corrupted, (double)delivered_bytes / (double)time);
+
+	return ok;
+}
+
+// The same buffer sent twice has the same crc. The start frame of the second
+// transfer is lost, so the receiver still has the first transfer when it is
+// polled. It must not acknowledge the second transfer before receiving it.
+static bool run_repeated(void) {
+	sim_sender *snd = &senders[0];
+	uint8_t buffer[BUFFER_LEN_MAX];
+	int len = make_buffer(buffer, snd->id, 0);
+
+	loss_permille = 0;
+	memset(delivered, 0, sizeof(delivered));
+	corrupted = 0;
+
+	bool acked_1 = send_windowed(snd, buffer, len);
+	snd->drop_start = true;
+	bool acked_2 = send_windowed(snd, buffer, len);
+	vTaskDelay(50);
+
+	printf("%-28s %3d/%3d delivered, %3d acked, %d corrupted\n", "windowed, repeated buffer",
+			delivered[snd->id], 2, (int)acked_1 + (int)acked_2, corrupted);
+
+	return acked_1 && acked_2 && delivered[snd->id] == 2 && corrupted == 0;
+}
+
+// The WIN_ACK_DONE of a finished transfer is lost and other nodes take all
+// slots before the sender polls again. The sender must get WIN_ACK_DONE
+// again instead of sending the buffer a second time.
+static bool run_lost_done(void) {
+	sim_sender *snd = &senders[0];
+	uint8_t buffer[BUFFER_LEN_MAX];
+	int len = make_buffer(buffer, snd->id, 1);
+
+	loss_permille = 0;
+	memset(delivered, 0, sizeof(delivered));
+	corrupted = 0;
+
+	snd->drop_done = true;
+	bool acked = send_windowed(snd, buffer, len);
+	vTaskDelay(50);
+
+	printf("%-28s %3d/%3d delivered, %3d acked, %d corrupted\n", "windowed, lost done ack",
+			delivered[snd->id], 1, (int)acked, corrupted);
+
+	return acked && delivered[snd->id] == 1 && corrupted == 0;
+}
+
+int main(void) {
+	int tests_passed = 0;
+	int total_tests = 0;
+
+	for (int i = 0;i < SENDER_NUM;i++) {
+		senders[i].id = SENDER_FIRST_ID + i;
+		pthread_mutex_init(&senders[i].mutex, NULL);
+		pthread_cond_init(&senders[i].cond, NULL);
+	}
+
+	backup.config.controller_id = RX_ID;
+	backup.config.can_baud_rate = CAN_BAUD_500K;
+	host_twai_set_bitrate(500);
+	host_twai_set_tx_callback(bus_tx);
+	host_set_packet_callback(packet_received);
+	comm_can_start(0, 0);
+
+	total_tests++; if (run("windowed, 4 senders", 4, true, false, 0)) tests_passed++;
+	total_tests++; if (run("windowed, 4 senders, 1% loss", 4, true, false, 10)) tests_passed++;
+	total_tests++; if (run("windowed, 3 + local, 1% loss", 3, true, true, 10)) tests_passed++;
+	total_tests++; if (run_repeated()) tests_passed++;
+	total_tests++; if (run_lost_done()) tests_passed++;
+
+	// Legacy transfers from several senders collide, only the crc check is
+	// required to hold. Corrupted buffers must never be delivered.
+	total_tests++; if (run("legacy, 4 senders", 4, false, false, 0)) tests_passed++;
+
+	if (tests_passed == total_tests) {
+		printf("SUCCESS\n");
+		return 0;
+	} else {
+		printf("FAILED: %d/%d tests passed\n", tests_passed, total_tests);
+		return 1;
+	}
+}
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "host_stubs.h"
+#include "comm_can.h"
+#include "log_comm.h"
+#include "mempools.h"
+#include "main.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Packed log records: encoded by log_comm, split into CAN frames by
+// comm_can_send_buffer, looped back on the host TWAI bus, reassembled by the
+// comm_can receive task and decoded with log_comm_unpack_fields.
+
+#define CAN_ID			5
+#define FIELD_NUM		LOG_PACKED_MAX_FIELDS
+
+static float field_value[FIELD_NUM];
+static bool field_updated[FIELD_NUM];
+static volatile int records_received = 0;
+static volatile bool record_ok = false;
+static volatile int frames_sent = 0;
+
+static void set_field(int field_ind, float value) {
+	field_value[field_ind] = value;
+	field_updated[field_ind] = true;
+}
+
+static void loopback(const twai_message_t *msg) {
+	frames_sent++;
+	host_twai_inject(msg);
+}
+
+static void packet_received(unsigned char *data, unsigned int len, send_func_t reply_func) {
+	(void)reply_func;
+	if (len > 0 && data[0] == COMM_LOG_DATA_PACKED) {
+		record_ok = log_comm_unpack_fields(data + 1, len - 1, FIELD_NUM, set_field);
+		records_received++;
+	}
+}
+
+static void clear_fields(void) {
+	memset(field_value, 0, sizeof(field_value));
+	memset(field_updated, 0, sizeof(field_updated));
+}
+
+static bool wait_record(int count) {
+	for (int i = 0;i < 1000 && records_received < count;i++) {
+		vTaskDelay(1);
+	}
+	return records_received == count;
+}
+
+// Sends num fields from field_start over CAN and checks what arrives.
+static bool test_record(int field_start, int num, float f16_scale, int present_every) {
+	float values[LOG_PACKED_MAX_FIELDS];
+	bool present[LOG_PACKED_MAX_FIELDS];
+
+	// Within the int16 range of float16
+	double amplitude = f16_scale > 0.0 ? 30000.0 / f16_scale : 300.0;
+	if (amplitude > 300.0) {
+		amplitude = 300.0;
+	}
+
+	for (int i = 0;i < num;i++) {
+		values[i] = (float)(sin(i + field_start) * amplitude);
+		present[i] = present_every == 0 || (i % present_every) != 0;
+	}
+
+	clear_fields();
+	int received = records_received;
+	frames_sent = 0;
+	log_comm_send_packed(CAN_ID, field_start, values, present, num, f16_scale);
+	if (!wait_record(received + 1) || !record_ok) {
+		printf("Record from %d with %d fields not received\n", field_start, num);
+		return false;
+	}
+
+	int present_num = 0;
+	for (int i = 0;i < FIELD_NUM;i++) {
+		int ind = i - field_start;
+		bool expect = ind >= 0 && ind < num && present[ind];
+
+		if (field_updated[i] != expect) {
+			printf("Field %d updated: %d, expected %d\n", i, field_updated[i], expect);
+			return false;
+		}
+
+		if (!expect) {
+			continue;
+		}
+
+		present_num++;
+		float tol = f16_scale > 0.0 ? 1.0 / f16_scale : 0.0;
+		if (fabsf(field_value[i] - values[ind]) > tol) {
+			printf("Field %d: %f, expected %f\n", i, (double)field_value[i], (double)values[ind]);
+			return false;
+		}
+	}
+
+	// A COMM_LOG_DATA_F32 packet per field takes two frames
+	printf("%3d of %3d fields from %3d, %s: %3d frames, %3d with one packet per field\n",
+			present_num, num, field_start, f16_scale > 0.0 ? "float16" : "float32",
+			frames_sent, 2 * present_num);
+
+	return true;
+}
+
+// Malformed records must be rejected without touching other fields.
+static bool test_malformed(void) {
+	float values[16];
+	uint8_t buffer[24 + 16 * 4];
+
+	for (int i = 0;i < 16;i++) {
+		values[i] = (float)i;
+	}
+
+	int len = log_comm_pack_fields(buffer, 3, values, NULL, 16, 0.0);
+	if (len != 1 + 2 + 1 + 1 + 2 + 16 * 4) {
+		return false;
+	}
+
+	// Truncated in the values: the complete ones are set
+	clear_fields();
+	if (log_comm_unpack_fields(buffer + 1, len - 1 - 6, FIELD_NUM, set_field) ||
+			!field_updated[3 + 13] || field_updated[3 + 14]) {
+		return false;
+	}
+
+	// Truncated in the header or the bitmap
+	for (int l = 0;l < 7;l++) {
+		clear_fields();
+		if (log_comm_unpack_fields(buffer + 1, l, FIELD_NUM, set_field)) {
+			return false;
+		}
+		for (int i = 0;i < FIELD_NUM;i++) {
+			if (field_updated[i]) {
+				return false;
+			}
+		}
+	}
+
+	// Fields past field_num are ignored
+	clear_fields();
+	if (!log_comm_unpack_fields(buffer + 1, len - 1, 10, set_field) ||
+			!field_updated[9] || field_updated[10]) {
+		return false;
+	}
+
+	// Negative first index and zero float16 scale
+	uint8_t bad[] = {0xFF, 0xFF, 0x00, 0x01, 0x80, 0, 0, 0, 0};
+	if (log_comm_unpack_fields(bad, sizeof(bad), FIELD_NUM, set_field)) {
+		return false;
+	}
+	uint8_t bad_scale[] = {0x00, 0x00, LOG_PACKED_FLAG_F16, 0, 0, 0, 0, 0x01, 0x80, 0, 0};
+	if (log_comm_unpack_fields(bad_scale, sizeof(bad_scale), FIELD_NUM, set_field)) {
+		return false;
+	}
+
+	// Out of range field counts are not encoded
+	return log_comm_pack_fields(buffer, 0, values, NULL, 0, 0.0) == -1 &&
+			log_comm_pack_fields(buffer, 0, values, NULL, LOG_PACKED_MAX_FIELDS + 1, 0.0) == -1;
+}
+
+int main(void) {
+	int tests_passed = 0;
+	int total_tests = 0;
+
+	backup.config.controller_id = CAN_ID;
+	backup.config.can_baud_rate = CAN_BAUD_500K;
+	mempools_init();
+	host_twai_set_bitrate(500);
+	host_twai_set_tx_callback(loopback);
+	host_set_packet_callback(packet_received);
+	comm_can_start(0, 0);
+
+	total_tests++; if (test_record(0, 1, 0.0, 0)) tests_passed++;
+	total_tests++; if (test_record(10, 30, 0.0, 3)) tests_passed++;
+	total_tests++; if (test_record(10, 30, 100.0, 3)) tests_passed++;
+	total_tests++; if (test_record(0, 20, 0.0, 0)) tests_passed++;
+	total_tests++; if (test_record(0, LOG_PACKED_MAX_FIELDS, 0.0, 0)) tests_passed++;
+	total_tests++; if (test_record(0, LOG_PACKED_MAX_FIELDS, 10.0, 2)) tests_passed++;
+	total_tests++; if (test_record(FIELD_NUM - 9, 9, 1000.0, 0)) tests_passed++;
+	total_tests++; if (test_malformed()) tests_passed++;
+
+	if (tests_passed == total_tests) {
+		printf("SUCCESS\n");
+		return 0;
+	} else {
+		printf("FAILED: %d/%d tests passed\n", tests_passed, total_tests);
+		return 1;
+	}
+}
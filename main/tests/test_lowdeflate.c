@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lowzip/lowdeflate.h"
+#include "lowzip/lowzip.h"
+
+// Round trip: compress with lowdeflate into a one-entry ZIP archive, then
+// extract it with lowzip (which also checks the CRC in the header) and
+// compare with the input.
+
+typedef struct {
+	unsigned char *data;
+	unsigned int len;
+	unsigned int cap;
+	bool overflow;
+} out_buf;
+
+static void write_cb(void *udata, const unsigned char *data, unsigned int len) {
+	out_buf *o = udata;
+	if (o->len + len > o->cap) {
+		o->overflow = true;
+		return;
+	}
+	memcpy(o->data + o->len, data, len);
+	o->len += len;
+}
+
+static unsigned int read_cb(void *udata, unsigned int offset) {
+	out_buf *o = udata;
+	return offset < o->len ? o->data[offset] : 0x100;
+}
+
+static uint32_t rand_state = 1234;
+
+static uint32_t next_rand(void) {
+	rand_state = rand_state * 1103515245u + 12345u;
+	return rand_state >> 8;
+}
+
+static bool roundtrip(const unsigned char *in, unsigned int len,
+		unsigned int window_bits, int dynamic, unsigned int chunk, unsigned int *deflate_len) {
+	static const char *name = "log.csv";
+	unsigned char hdr[LOWDEFLATE_ZIP_CDIRFILE_LENGTH + 64];
+	bool ok = false;
+
+	out_buf o;
+	o.cap = LOWDEFLATE_BOUND(len) + 2 * sizeof(hdr) + LOWDEFLATE_ZIP_EOCDIR_LENGTH;
+	o.data = malloc(o.cap);
+	o.len = 0;
+	o.overflow = false;
+
+	unsigned char *work = malloc(LOWDEFLATE_WORK_SIZE(window_bits));
+	unsigned char *out = malloc(len + 1);
+	lowdeflate_state *st = calloc(1, sizeof(lowdeflate_state));
+	lowzip_state *zs = calloc(1, sizeof(lowzip_state));
+
+	write_cb(&o, hdr, lowdeflate_zip_local_header(hdr, name, NULL));
+
+	st->udata = &o;
+	st->write_callback = write_cb;
+	st->window_bits = window_bits;
+	st->dynamic_huffman = dynamic;
+	st->work = work;
+	lowdeflate_init(st);
+	for (unsigned int i = 0;i < len;i += chunk) {
+		lowdeflate_write(st, in + i, len - i < chunk ? len - i : chunk);
+	}
+	lowdeflate_finish(st);
+	if (st->have_error || o.overflow || st->total_in != len) {
+		goto out;
+	}
+	*deflate_len = st->total_out;
+
+	// The sizes and the CRC are only known now
+	lowdeflate_zip_local_header(o.data, name, st);
+	unsigned int cdir_offset = o.len;
+	write_cb(&o, hdr, lowdeflate_zip_central_header(hdr, name, st, 0));
+	unsigned int cdir_size = o.len - cdir_offset;
+	write_cb(&o, hdr, lowdeflate_zip_end(hdr, 1, cdir_size, cdir_offset));
+	if (o.overflow) {
+		goto out;
+	}
+
+	zs->udata = &o;
+	zs->read_callback = read_cb;
+	zs->zip_length = o.len;
+	lowzip_init_archive(zs);
+	if (zs->have_error) {
+		goto out;
+	}
+
+	lowzip_file *fi = lowzip_locate_file(zs, 0, NULL);
+	if (!fi || fi->uncompressed_size != len || strcmp(fi->filename, name) != 0) {
+		goto out;
+	}
+
+	zs->output_start = out;
+	zs->output_next = out;
+	zs->output_end = out + len;
+	lowzip_get_data(zs);
+
+	ok = !zs->have_error &&
+			(unsigned int)(zs->output_next - out) == len &&
+			memcmp(out, in, len) == 0;
+
+out:
+	free(zs);
+	free(st);
+	free(out);
+	free(work);
+	free(o.data);
+	return ok;
+}
+
+#define INPUT_LEN 60000
+
+typedef enum {
+	INPUT_EMPTY = 0,
+	INPUT_ONE_BYTE,
+	INPUT_ZEROS,
+	INPUT_RANDOM,
+	INPUT_CSV,
+	INPUT_MIXED,
+	INPUT_NUM
+} input_type;
+
+static const char *input_names[INPUT_NUM] = {
+		"empty", "one byte", "zeros", "random", "csv", "mixed"
+};
+
+// Fills in with test data and returns its length.
+static unsigned int make_input(unsigned char *in, input_type type) {
+	unsigned int len = 0;
+
+	switch (type) {
+	case INPUT_EMPTY:
+		break;
+
+	case INPUT_ONE_BYTE:
+		in[len++] = 'x';
+		break;
+
+	case INPUT_ZEROS:
+		memset(in, 0, INPUT_LEN);
+		len = INPUT_LEN;
+		break;
+
+	case INPUT_RANDOM:
+		for (;len < INPUT_LEN;len++) {
+			in[len] = next_rand();
+		}
+		break;
+
+	case INPUT_CSV: {
+		// Something like a log file, which is what the firmware compresses
+		float v = 12.0;
+		int t = 0;
+		len = snprintf((char*)in, INPUT_LEN, "t_ms;v_in;current;temp\n");
+		while (len < INPUT_LEN - 64) {
+			v += (float)((int)(next_rand() % 21) - 10) * 0.01f;
+			len += sprintf((char*)in + len, "%d;%.2f;%.3f;%d\n",
+					t, v, (float)(next_rand() % 5000) * 0.001f, 25 + (int)(next_rand() % 3));
+			t += 10;
+		}
+	} break;
+
+	case INPUT_MIXED:
+		// Random runs and repeats at distances around the window sizes
+		while (len < INPUT_LEN - 300) {
+			unsigned int run = 1 + next_rand() % 200;
+			unsigned int dist = 1 + next_rand() % 5000;
+			if ((next_rand() % 2) && dist <= len) {
+				for (unsigned int i = 0;i < run;i++, len++) {
+					in[len] = in[len - dist];
+				}
+			} else {
+				for (unsigned int i = 0;i < run;i++, len++) {
+					in[len] = next_rand() % 16;
+				}
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return len;
+}
+
+int main(void) {
+	static const unsigned int chunks[] = {1, 7, 512, INPUT_LEN};
+	unsigned char *in = malloc(INPUT_LEN);
+	int tests = 0;
+	int passed = 0;
+
+	for (int type = 0;type < INPUT_NUM;type++) {
+		unsigned int len = make_input(in, type);
+
+		for (unsigned int wbits = LOWDEFLATE_WINDOW_BITS_MIN;wbits <= LOWDEFLATE_WINDOW_BITS_MAX;wbits++) {
+			for (int dynamic = 0;dynamic < 2;dynamic++) {
+				for (unsigned int c = 0;c < sizeof(chunks) / sizeof(chunks[0]);c++) {
+					// Byte by byte is slow, once per input is enough
+					if (chunks[c] == 1 && (wbits != LOWDEFLATE_WINDOW_BITS_MIN || dynamic)) {
+						continue;
+					}
+
+					unsigned int deflate_len = 0;
+					tests++;
+					if (roundtrip(in, len, wbits, dynamic, chunks[c], &deflate_len)) {
+						passed++;
+					} else {
+						printf("FAILED: %s, window bits %u, dynamic %d, chunk %u\n",
+								input_names[type], wbits, dynamic, chunks[c]);
+					}
+
+					if (chunks[c] == 512) {
+						printf("%-8s wbits %u dyn %d: %6u -> %6u bytes\n",
+								input_names[type], wbits, dynamic, len, deflate_len);
+					}
+				}
+			}
+		}
+	}
+
+	free(in);
+
+	if (passed == tests) {
+		printf("SUCCESS\n");
+		return 0;
+	} else {
+		printf("FAILED: %d/%d tests passed\n", passed, tests);
+		return 1;
+	}
+}
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "spsc_rb.h"
+#include "rb.h"
+
+// A producer and a consumer thread pass sequence numbers through the ring
+// buffer. The consumer checks that every item arrives once, in order and
+// not torn. The benchmark compares the throughput with the mutex based
+// rb_t.
+
+#define ITEMS			500000
+#define BENCH_ITEMS		1000000
+#define MULTI_MAX		9
+
+typedef struct {
+	uint32_t seq;
+	uint32_t inv;
+	uint32_t pad;
+} item_t;
+
+typedef struct {
+	spsc_rb_t *rb;
+	bool use_multi;
+	bool use_peek;
+	unsigned int seed;
+	unsigned int full_cnt;
+	bool ok;
+} test_ctx;
+
+static item_t make_item(uint32_t seq) {
+	item_t item;
+	item.seq = seq;
+	item.inv = ~seq;
+	item.pad = seq * 2654435761u;
+	return item;
+}
+
+static bool item_ok(const item_t *item, uint32_t seq) {
+	return item->seq == seq && item->inv == ~seq && item->pad == seq * 2654435761u;
+}
+
+static void *producer(void *arg) {
+	test_ctx *ctx = arg;
+	item_t items[MULTI_MAX];
+	uint32_t seq = 0;
+
+	while (seq < ITEMS) {
+		unsigned int n = 1;
+		if (ctx->use_multi) {
+			n = 1 + rand_r(&ctx->seed) % MULTI_MAX;
+			if (n > ITEMS - seq) {
+				n = ITEMS - seq;
+			}
+		}
+
+		for (unsigned int i = 0;i < n;i++) {
+			items[i] = make_item(seq + i);
+		}
+
+		unsigned int done = n == 1 ?
+				spsc_rb_insert(ctx->rb, items) :
+				spsc_rb_insert_multi(ctx->rb, items, n);
+
+		if (done == 0) {
+			ctx->full_cnt++;
+			sched_yield();
+		}
+
+		seq += done;
+	}
+
+	return NULL;
+}
+
+static void *consumer(void *arg) {
+	test_ctx *ctx = arg;
+	item_t items[MULTI_MAX];
+	uint32_t seq = 0;
+
+	ctx->ok = true;
+
+	while (seq < ITEMS) {
+		unsigned int got = 0;
+
+		if (ctx->use_peek) {
+			item_t *item = spsc_rb_peek(ctx->rb);
+			if (item) {
+				items[0] = *item;
+				spsc_rb_pop(ctx->rb, 0);
+				got = 1;
+			}
+		} else if (ctx->use_multi) {
+			got = spsc_rb_pop_multi(ctx->rb, items, 1 + rand_r(&ctx->seed) % MULTI_MAX);
+		} else {
+			got = spsc_rb_pop(ctx->rb, items);
+		}
+
+		if (got == 0) {
+			sched_yield();
+			continue;
+		}
+
+		for (unsigned int i = 0;i < got;i++) {
+			if (!item_ok(&items[i], seq)) {
+				printf("Item %u: got %u\n", (unsigned int)seq, (unsigned int)items[i].seq);
+				ctx->ok = false;
+				return NULL;
+			}
+			seq++;
+		}
+	}
+
+	return NULL;
+}
+
+static bool test_threads(int item_count, bool use_multi, bool use_peek) {
+	spsc_rb_t rb;
+	spsc_rb_init_alloc(&rb, sizeof(item_t), item_count);
+
+	test_ctx prod = {.rb = &rb, .use_multi = use_multi, .seed = 1};
+	test_ctx cons = {.rb = &rb, .use_multi = use_multi, .use_peek = use_peek, .seed = 2};
+
+	pthread_t t_prod, t_cons;
+	pthread_create(&t_cons, NULL, consumer, &cons);
+	pthread_create(&t_prod, NULL, producer, &prod);
+	pthread_join(t_prod, NULL);
+	pthread_join(t_cons, NULL);
+
+	bool ok = cons.ok && spsc_rb_is_empty(&rb) && spsc_rb_get_free_space(&rb) == (unsigned int)item_count;
+	printf("%2d items, %s, %s: %s, producer saw full %u times\n",
+			item_count, use_multi ? "multi" : "single", use_peek ? "peek" : "pop",
+			ok ? "ok" : "FAILED", prod.full_cnt);
+
+	spsc_rb_free(&rb);
+	return ok;
+}
+
+// Single threaded checks of the counts at the edges.
+static bool test_edges(void) {
+	item_t buffer[5];
+	item_t items[8];
+	spsc_rb_t rb;
+	spsc_rb_init(&rb, buffer, sizeof(item_t), 5);
+
+	for (int round = 0;round < 12;round++) {
+		for (int i = 0;i < 8;i++) {
+			items[i] = make_item(round * 100 + i);
+		}
+
+		if (!spsc_rb_is_empty(&rb) || spsc_rb_peek(&rb) != 0 ||
+				spsc_rb_insert_multi(&rb, items, 8) != 5 ||
+				!spsc_rb_is_full(&rb) || spsc_rb_insert(&rb, items) ||
+				spsc_rb_get_item_count(&rb) != 5) {
+			return false;
+		}
+
+		// Leave round % 5 items behind so that the next round wraps elsewhere
+		item_t out[5];
+		unsigned int pop = 5 - round % 5;
+		if (spsc_rb_pop_multi(&rb, out, pop) != pop) {
+			return false;
+		}
+		for (unsigned int i = 0;i < pop;i++) {
+			if (!item_ok(&out[i], round * 100 + i)) {
+				return false;
+			}
+		}
+
+		spsc_rb_flush(&rb);
+		if (!spsc_rb_is_empty(&rb) || spsc_rb_pop(&rb, out)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static double now_s(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+	bool spsc;
+	spsc_rb_t srb;
+	rb_t rb;
+} bench_ctx;
+
+static void *bench_producer(void *arg) {
+	bench_ctx *ctx = arg;
+	for (uint32_t seq = 0;seq < BENCH_ITEMS;) {
+		item_t item = make_item(seq);
+		bool ok = ctx->spsc ? spsc_rb_insert(&ctx->srb, &item) : rb_insert(&ctx->rb, &item);
+		if (ok) {
+			seq++;
+		} else {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void *bench_consumer(void *arg) {
+	bench_ctx *ctx = arg;
+	for (uint32_t seq = 0;seq < BENCH_ITEMS;) {
+		item_t item;
+		bool ok = ctx->spsc ? spsc_rb_pop(&ctx->srb, &item) : rb_pop(&ctx->rb, &item);
+		if (ok) {
+			seq++;
+		} else {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static double bench(bool spsc) {
+	bench_ctx ctx;
+	ctx.spsc = spsc;
+	spsc_rb_init_alloc(&ctx.srb, sizeof(item_t), 50);
+	rb_init_alloc(&ctx.rb, sizeof(item_t), 50);
+
+	pthread_t t_prod, t_cons;
+	double start = now_s();
+	pthread_create(&t_cons, NULL, bench_consumer, &ctx);
+	pthread_create(&t_prod, NULL, bench_producer, &ctx);
+	pthread_join(t_prod, NULL);
+	pthread_join(t_cons, NULL);
+	double time = now_s() - start;
+
+	spsc_rb_free(&ctx.srb);
+	rb_free(&ctx.rb);
+	return (double)BENCH_ITEMS / time;
+}
+
+int main(void) {
+	int tests_passed = 0;
+	int total_tests = 0;
+
+	total_tests++; if (test_edges()) tests_passed++;
+	total_tests++; if (test_threads(1, false, false)) tests_passed++;
+	total_tests++; if (test_threads(7, false, false)) tests_passed++;
+	total_tests++; if (test_threads(7, false, true)) tests_passed++;
+	total_tests++; if (test_threads(7, true, false)) tests_passed++;
+	total_tests++; if (test_threads(50, true, false)) tests_passed++;
+
+	double rate_spsc = bench(true);
+	double rate_rb = bench(false);
+	printf("Throughput: spsc_rb %.1f M items/s, rb %.1f M items/s\n",
+			rate_spsc * 1e-6, rate_rb * 1e-6);
+
+	if (tests_passed == total_tests) {
+		printf("SUCCESS\n");
+		return 0;
+	} else {
+		printf("FAILED: %d/%d tests passed\n", tests_passed, total_tests);
+		return 1;
+	}
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+# Converts binary logs written by log_task in binary mode (log_xxx.bin) to
+# the same CSV format as the text mode. See the format description in
+# main/log.c.
+
+import struct
+import sys
+
+MAGIC = b"VLOGBIN"
+
+def read_cstr(data, ind):
+    end = data.index(b"\0", ind)
+    return data[ind:end].decode("utf-8", "replace"), end + 1
+
+def get_f32(data, ind):
+    return struct.unpack_from(">f", data, ind)[0], ind + 4
+
+def get_f64(data, ind):
+    # float64_auto is a float32 value followed by its float32 rounding error
+    val, ind = get_f32(data, ind)
+    err, ind = get_f32(data, ind)
+    return val + err, ind
+
+def warn_truncated(rows):
+    sys.stderr.write("Warning: truncated record after %d rows ignored\n" % rows)
+
+def convert(data, out):
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("not a binary log")
+
+    ind = len(MAGIC)
+    version = data[ind]
+    ind += 1
+    if version != 1:
+        raise ValueError("unsupported version %d" % version)
+
+    field_num = struct.unpack_from(">H", data, ind)[0]
+    ind += 2
+
+    fields = []
+    for _ in range(field_num):
+        key, ind = read_cstr(data, ind)
+        name, ind = read_cstr(data, ind)
+        unit, ind = read_cstr(data, ind)
+        precision, is_relative, is_timestamp, is_f64 = struct.unpack_from(">bBBB", data, ind)
+        ind += 4
+        fields.append((key, name, unit, precision, is_relative, is_timestamp, is_f64))
+
+    out.write(";".join("%s:%s:%s:%d:%d:%d" % f[:6] for f in fields) + "\n")
+
+    bitmap_len = (field_num + 7) // 8
+    rows = 0
+    while ind < len(data):
+        if ind + bitmap_len > len(data):
+            warn_truncated(rows)
+            break
+
+        bitmap = data[ind:ind + bitmap_len]
+        present = [bitmap[i // 8] & (0x80 >> (i % 8)) for i in range(field_num)]
+        rec_len = bitmap_len + sum((8 if f[6] else 4) for i, f in enumerate(fields) if present[i])
+
+        if ind + rec_len > len(data):
+            # Truncated last record, e.g. power loss while logging
+            warn_truncated(rows)
+            break
+
+        ind += bitmap_len
+
+        cols = []
+        for i, f in enumerate(fields):
+            if present[i]:
+                if f[6]:
+                    val, ind = get_f64(data, ind)
+                else:
+                    val, ind = get_f32(data, ind)
+                cols.append("%.*f" % (max(f[3], 0), val))
+            else:
+                cols.append("")
+
+        out.write(";".join(cols) + "\n")
+        rows += 1
+
+    return rows
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: %s log.bin [out.csv]" % sys.argv[0])
+        return 1
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w") as out:
+            convert(data, out)
+    else:
+        convert(data, sys.stdout)
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())